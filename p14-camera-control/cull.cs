@@ -0,0 +1,214 @@
+// Copyright 2022 Yucheng Liu. GNU GPL3 license.
+// GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt
+
+#version 430
+
+// Work group size (matches groupSize in src/gpu/cull.cpp)
+layout (local_size_x = 64) in;
+
+// Buffer layouts (see src/gpu/cull.hpp and src/gpu/indirect.hpp)
+struct Obj {
+    mat4 world;
+    vec4 sphere;
+    int mesh;
+    int lod;
+    float scale;
+    int late;
+};
+
+struct Level {
+    uint first;
+    uint count;
+    float err;
+    uint pad;
+};
+
+struct Mesh {
+    vec4 posScale;
+    vec4 posOffset;
+    int baseVertex;
+    uint firstIndex;
+    int levelCount;
+    int pad;
+    Level levels[8];
+};
+
+struct Cmd {
+    uint count;
+    uint instanceCount;
+    uint firstIndex;
+    int baseVertex;
+    uint baseInstance;
+};
+
+#include "draw.glsl"
+
+layout (std430, binding = 0) writeonly buffer Draws {
+    Draw draws[];
+};
+layout (std430, binding = 1) buffer Objs {
+    Obj objs[];
+};
+layout (std430, binding = 2) readonly buffer Meshes {
+    Mesh meshes[];
+};
+layout (std430, binding = 3) writeonly buffer Cmds {
+    Cmd cmds[];
+};
+// Drawn triangles and occluded objects
+layout (std430, binding = 4) buffer Stats {
+    uint triCount;
+    uint occludedCount;
+};
+// Draw counters of the early (or only) and the late pass
+layout (binding = 0, offset = 0) uniform atomic_uint earlyCount;
+layout (binding = 0, offset = 4) uniform atomic_uint lateCount;
+
+uniform mat4 viewProj;
+// Frustum planes (world space; xyz: inward unit normal; w: distance term)
+uniform vec4 planes[6];
+uniform vec3 camPos;
+uniform float pxPerUnit;
+uniform float maxErrPx;
+uniform float hyst;
+uniform uint objCount;
+// 0: frustum only; 1: early pass; 2: late pass
+uniform int pass;
+// OCCLUSION (injected by the preprocessor; see src/shader/pre.hpp) compiles
+// the Hi-Z test in
+#if OCCLUSION
+// Matrix the spheres are projected with for the occlusion test (the previous
+// frame's in the early pass)
+uniform mat4 occlViewProj;
+// Hi-Z pyramid (see src/gpu/hiz.hpp)
+uniform sampler2D hiz;
+uniform vec2 hizSize;
+uniform int hizLevels;
+#endif
+
+// Finds the projected error of a level (see meshLib::LodSel::errPx)
+float errPx(uint mesh, int level, float scale, float dist) {
+    return meshes[mesh].levels[level].err * scale / max(dist, 1e-3) * pxPerUnit;
+}
+
+// Selects a level with hysteresis (see meshLib::LodSel::select)
+int select(uint mesh, int current, float scale, float dist) {
+    int levels = meshes[mesh].levelCount;
+    current = clamp(current, 0, levels - 1);
+
+    if (errPx(mesh, current, scale, dist) > maxErrPx) {
+        int result = current;
+        while (result > 0 && errPx(mesh, result, scale, dist) > maxErrPx) {
+            result -= 1;
+        }
+        return result;
+    }
+
+    float coarsenPx = maxErrPx * (1.0 - hyst);
+    int result = current;
+    for (int level = current + 1; level < levels; level += 1) {
+        if (errPx(mesh, level, scale, dist) > coarsenPx) {
+            break;
+        }
+        result = level;
+    }
+    return result;
+}
+
+#if OCCLUSION
+// Finds whether a sphere is behind the pyramid's depth (conservative)
+bool occluded(vec4 sphere) {
+    // Screen rectangle and nearest depth of the sphere's bounding box
+    vec3 lo = vec3(1.0);
+    vec3 hi = vec3(-1.0);
+    for (int i = 0; i < 8; i += 1) {
+        vec3 dir = vec3(i & 1, (i >> 1) & 1, (i >> 2) & 1) * 2.0 - 1.0;
+        vec4 clip = occlViewProj * vec4(sphere.xyz + dir * sphere.w, 1.0);
+        // Crossing the near plane: no depth to compare against
+        if (clip.w <= 0.0) {
+            return false;
+        }
+        vec3 ndc = clip.xyz / clip.w;
+        lo = min(lo, ndc);
+        hi = max(hi, ndc);
+    }
+    // Off screen for the pyramid: nothing is known there
+    bvec2 offLo = lessThan(hi.xy, vec2(-1.0));
+    bvec2 offHi = greaterThan(lo.xy, vec2(1.0));
+    if (any(offLo) || any(offHi)) {
+        return false;
+    }
+    vec2 pxLo = clamp(lo.xy * 0.5 + 0.5, 0.0, 1.0) * hizSize;
+    vec2 pxHi = clamp(hi.xy * 0.5 + 0.5, 0.0, 1.0) * hizSize;
+    float depth = lo.z * 0.5 + 0.5;
+
+    // The level where the rectangle spans at most 2x2 texels
+    vec2 size = pxHi - pxLo;
+    float span = max(max(size.x, size.y), 1.0);
+    int level = clamp(int(ceil(log2(span))), 0, hizLevels - 1);
+    ivec2 levelSize = textureSize(hiz, level);
+    ivec2 p0 = min(ivec2(pxLo) >> level, levelSize - 1);
+    ivec2 p1 = min(ivec2(pxHi) >> level, levelSize - 1);
+
+    float d00 = texelFetch(hiz, p0, level).r;
+    float d10 = texelFetch(hiz, ivec2(p1.x, p0.y), level).r;
+    float d01 = texelFetch(hiz, ivec2(p0.x, p1.y), level).r;
+    float d11 = texelFetch(hiz, p1, level).r;
+    return depth > max(max(d00, d10), max(d01, d11));
+}
+#endif
+
+void main() {
+    uint index = gl_GlobalInvocationID.x;
+    if (index >= objCount) {
+        return;
+    }
+
+    Obj obj = objs[index];
+    // The late pass only tests what the early pass left to it
+    if (pass == 2 && obj.late == 0) {
+        return;
+    }
+    if (pass != 2) {
+        objs[index].late = 0;
+        for (int i = 0; i < 6; i += 1) {
+            float d = dot(planes[i].xyz, obj.sphere.xyz) + planes[i].w;
+            if (d < -obj.sphere.w) {
+                return;
+            }
+        }
+    }
+#if OCCLUSION
+    if (pass != 0 && occluded(obj.sphere)) {
+        if (pass == 1) {
+            objs[index].late = 1;
+        } else {
+            atomicAdd(occludedCount, 1u);
+        }
+        return;
+    }
+#endif
+
+    uint mesh = uint(obj.mesh);
+    float dist = distance(obj.world[3].xyz, camPos);
+    int lod = select(mesh, obj.lod, obj.scale, dist);
+    objs[index].lod = lod;
+
+    // Append the draw; the slot order does not matter
+    uint slot;
+    if (pass == 2) {
+        slot = atomicCounterIncrement(lateCount);
+    } else {
+        slot = atomicCounterIncrement(earlyCount);
+    }
+    Level level = meshes[mesh].levels[lod];
+    atomicAdd(triCount, level.count / 3u);
+    cmds[slot].count = level.count;
+    cmds[slot].instanceCount = 1u;
+    cmds[slot].firstIndex = meshes[mesh].firstIndex + level.first;
+    cmds[slot].baseVertex = meshes[mesh].baseVertex;
+    cmds[slot].baseInstance = 0u;
+    draws[slot].mapping = viewProj * obj.world;
+    draws[slot].posScale = meshes[mesh].posScale;
+    draws[slot].posOffset = meshes[mesh].posOffset;
+}
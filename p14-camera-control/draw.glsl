@@ -0,0 +1,9 @@
+// Copyright 2022 Yucheng Liu. GNU GPL3 license.
+// GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt
+
+// Per-draw data (see gpuLib::DrawData in src/gpu/indirect.hpp)
+struct Draw {
+    mat4 mapping;
+    vec4 posScale;
+    vec4 posOffset;
+};
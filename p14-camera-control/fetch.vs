@@ -0,0 +1,19 @@
+// Copyright 2022 Yucheng Liu. GNU GPL3 license.
+// GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt
+
+#version 140
+#extension GL_ARB_explicit_attrib_location: require
+#extension GL_ARB_explicit_uniform_location: require
+
+#include "quant.glsl"
+
+out vec4 color;
+
+// Times the vertex fetch (see timeVertexFetch in src/main.cpp): every
+// attribute is read, and every point lands outside the clip volume, so
+// nothing is rasterized
+void main() {
+    float sum = dot(qPosition + qNormal + qColor, vec4(1.0));
+    gl_Position = vec4(2.0 + abs(sum), 0.0, 0.0, 1.0);
+    color = qColor;
+}
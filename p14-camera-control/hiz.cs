@@ -0,0 +1,57 @@
+// Copyright 2022 Yucheng Liu. GNU GPL3 license.
+// GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt
+
+#version 430
+
+// Work group size (matches groupSize in src/gpu/hiz.cpp)
+layout (local_size_x = 8, local_size_y = 8) in;
+
+// Depth copy (read for level 0)
+uniform sampler2D depth;
+// Previous level (read for the other levels)
+layout (r32f, binding = 0) uniform readonly image2D src;
+// Level being built
+layout (r32f, binding = 1) uniform writeonly image2D dst;
+
+uniform bool fromDepth;
+uniform ivec2 srcSize;
+
+float fetch(ivec2 p) {
+    return imageLoad(src, min(p, srcSize - 1)).r;
+}
+
+void main() {
+    ivec2 p = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 dstSize = imageSize(dst);
+    if (any(greaterThanEqual(p, dstSize))) {
+        return;
+    }
+
+    if (fromDepth) {
+        imageStore(dst, p, vec4(texelFetch(depth, p, 0).r));
+        return;
+    }
+
+    // Keep the farthest depth of the texels below
+    ivec2 s = p * 2;
+    float d = max(
+        max(fetch(s), fetch(s + ivec2(1, 0))),
+        max(fetch(s + ivec2(0, 1)), fetch(s + ivec2(1, 1)))
+    );
+
+    // With an odd source size, the last column and row also cover the extra
+    // texel, so no source texel is left out
+    bool lastX = p.x == dstSize.x - 1 && (srcSize.x & 1) == 1;
+    bool lastY = p.y == dstSize.y - 1 && (srcSize.y & 1) == 1;
+    if (lastX) {
+        d = max(d, max(fetch(s + ivec2(2, 0)), fetch(s + ivec2(2, 1))));
+    }
+    if (lastY) {
+        d = max(d, max(fetch(s + ivec2(0, 2)), fetch(s + ivec2(1, 2))));
+    }
+    if (lastX && lastY) {
+        d = max(d, fetch(s + ivec2(2, 2)));
+    }
+
+    imageStore(dst, p, vec4(d));
+}
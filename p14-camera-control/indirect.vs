@@ -0,0 +1,21 @@
+// Copyright 2022 Yucheng Liu. GNU GPL3 license.
+// GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt
+
+#version 430
+#extension GL_ARB_shader_draw_parameters: require
+
+#include "quant.glsl"
+#include "draw.glsl"
+
+layout (std430, binding = 0) readonly buffer Draws {
+    Draw draws[];
+};
+
+out vec4 color;
+
+void main() {
+    Draw draw = draws[gl_DrawIDARB];
+    vec3 position = qPosition.xyz * draw.posScale.xyz + draw.posOffset.xyz;
+    gl_Position = draw.mapping * vec4(position, 1.0);
+    color = qColor;
+}
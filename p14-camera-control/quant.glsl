@@ -0,0 +1,8 @@
+// Copyright 2022 Yucheng Liu. GNU GPL3 license.
+// GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt
+
+// Quantized attributes (see src/mesh/quant.hpp); the fixed-function vertex
+// fetch normalizes them to [0, 1] (position, color) and [-1, 1] (normal)
+layout (location = 0) in vec4 qPosition;
+layout (location = 1) in vec4 qNormal;
+layout (location = 2) in vec4 qColor;
@@ -5,11 +5,16 @@
 #extension GL_ARB_explicit_attrib_location: require
 #extension GL_ARB_explicit_uniform_location: require
 
-layout (location = 0) in vec3 position;
+#include "quant.glsl"
+
 uniform mat4 mapping;
+// Per-mesh dequantization: position = qPosition.xyz * posScale + posOffset
+uniform vec3 posScale;
+uniform vec3 posOffset;
 out vec4 color;
 
 void main() {
+    vec3 position = qPosition.xyz * posScale + posOffset;
     gl_Position = mapping * vec4(position, 1.0);
-    color = vec4(clamp(position, 0.0, 1.0), 1.0);
+    color = qColor;
 }
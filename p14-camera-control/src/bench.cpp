@@ -0,0 +1,1275 @@
+/* File name: bench.cpp
+ * 
+ * Intro:
+ * C++ implementation of the program defined in bench.hpp. */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#include "bench.hpp"
+
+static Bench const benches[] = {
+    {"pipeline", benchPipeline},
+    {"alloc", benchAlloc},
+    {"occl", benchOccl},
+    {"soft", benchSoft},
+    {"bvh", benchBvh},
+    {"pick", benchPick},
+    {"grid", benchGrid},
+    {"collide", benchCollide},
+    {"submit", benchSubmit},
+    {"capture", benchCapture},
+    {"frame", benchFrame},
+    {"graph", benchGraph},
+};
+
+int main(int argc, char **argv) {
+    for (Bench const &bench : benches) {
+        if (selected(bench.name, argc, argv)) {
+            bench.run();
+        }
+    }
+    return 0;
+}
+
+static bool selected(char const *name, int argc, char **argv) {
+    if (argc <= 1) {
+        return true;
+    }
+    for (int i = 1; i < argc; i += 1) {
+        if (strcmp(argv[i], name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static double now() {
+    auto t = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration<double>(t).count();
+}
+
+// clang-format off
+static void showResult(
+    char const *bench, char const *variant, long count, double seconds
+) {
+    // clang-format on
+    double nsPerItem = seconds * 1e9 / (double)count;
+    printf("%s: %-28s %10ld items ", bench, variant, count);
+    printf("%10.3f ms %8.2f ns/item\n", seconds * 1e3, nsPerItem);
+    fflush(stdout);
+}
+
+// clang-format off
+static bool mappingsClose(
+    glm::mat4 const &a, glm::mat4 const &b, float tolerance
+) {
+    // clang-format on
+    for (int i = 0; i < 4; i += 1) {
+        for (int j = 0; j < 4; j += 1) {
+            float mag = glm::max(std::fabs(a[i][j]), std::fabs(b[i][j]));
+            float eps = tolerance * glm::max(mag, 1.0f);
+            if (!glm::epsilonEqual(a[i][j], b[i][j], eps)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static void benchPipeline() {
+    long const count = 2000000;
+    Trans trans;
+    Persp persp(winWidth, winHeight, 1.0f, 100.0f, 60.0f);
+    Cam cam;
+    Pipeline runtime(&trans, &persp, &cam);
+    pipelineLib::Pipeline<Trans, Persp, Cam> fixed(&trans, &persp, &cam);
+    pipelineLib::Pipeline<Trans> worldOnly(&trans);
+
+    // The pipelines multiply in different orders, so the rounding differs
+    if (!mappingsClose(runtime.mapping(), fixed.mapping(), 1e-5f)) {
+        printf("pipeline: error: runtime and fixed mappings differ\n");
+    }
+
+    // Same per-object work as display(): move the object, find the mapping
+    double start = now();
+    for (long i = 0; i < count; i += 1) {
+        trans.rot(0.0f, 0.1f * i, 0.0f);
+        sink = runtime.mapping()[3][0];
+    }
+    showResult("pipeline", "runtime Pipeline", count, now() - start);
+
+    start = now();
+    for (long i = 0; i < count; i += 1) {
+        trans.rot(0.0f, 0.1f * i, 0.0f);
+        sink = fixed.mapping()[3][0];
+    }
+    showResult("pipeline", "Pipeline<Trans,Persp,Cam>", count, now() - start);
+
+    start = now();
+    for (long i = 0; i < count; i += 1) {
+        trans.rot(0.0f, 0.1f * i, 0.0f);
+        sink = worldOnly.mapping()[3][0];
+    }
+    showResult("pipeline", "Pipeline<Trans>", count, now() - start);
+}
+
+static void benchAlloc() {
+    // About 4096 live allocations of 16 to 16K elements take about 12M
+    // elements: the larger space has room to spare, the smaller is near full
+    uint32_t const roomy = 1u << 26;
+    uint32_t const tight = 1u << 24;
+    gpuLib::Alloc roomyBest(roomy);
+    churnAlloc(roomyBest, "best fit", "roomy");
+    TlsfAlloc roomyTlsf(roomy);
+    churnAlloc(roomyTlsf, "TLSF", "roomy");
+    gpuLib::Alloc tightBest(tight);
+    churnAlloc(tightBest, "best fit", "near full");
+    TlsfAlloc tightTlsf(tight);
+    churnAlloc(tightTlsf, "TLSF", "near full");
+}
+
+// clang-format off
+template <class A>
+static void churnAlloc(
+    A &alloc, char const *placement, char const *space
+) {
+    // clang-format on
+    long const count = 1000000;
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> sizes;
+    uint64_t rng = 1;
+    long failed = 0;
+
+    // Keep about 4096 live allocations of 16 to 16K elements (allocations
+    // outnumber frees until the count is reached)
+    double start = now();
+    for (long i = 0; i < count; i += 1) {
+        rng = rng * 6364136223846793005ull + 1442695040888963407ull;
+        uint32_t r = (uint32_t)(rng >> 33);
+        if (offsets.size() < 4096 and (offsets.empty() or r % 4 != 0)) {
+            uint32_t size = 16u << (r % 11);
+            uint32_t offset = alloc.alloc(size);
+            if (offset != gpuLib::Alloc::noSpace) {
+                offsets.push_back(offset);
+                sizes.push_back(size);
+            } else {
+                failed += 1;
+            }
+        } else {
+            size_t k = r % offsets.size();
+            alloc.free(offsets[k], sizes[k]);
+            offsets[k] = offsets.back();
+            sizes[k] = sizes.back();
+            offsets.pop_back();
+            sizes.pop_back();
+        }
+    }
+    std::string variant = std::string(placement) + ", " + space;
+    showResult("alloc", variant.c_str(), count, now() - start);
+
+    gpuLib::AllocStats stats = alloc.stats();
+    printf("alloc: %s: %ld failed, ", placement, failed);
+    printf("%d allocs, ", stats.allocs);
+    printf("utilization %.1f%%, ", stats.utilization * 100.0f);
+    printf("%d free ranges, ", stats.freeRanges);
+    printf("fragmentation %.1f%%\n", stats.fragmentation * 100.0f);
+    fflush(stdout);
+}
+
+TlsfAlloc::TlsfAlloc(uint32_t capacity) {
+    _capacity = capacity;
+    _used = 0;
+    _allocs = 0;
+    _addFree(0, capacity);
+}
+
+int TlsfAlloc::_bin(uint32_t size) {
+    if (size < (uint32_t)tlsfSubBins) {
+        return (int)size;
+    }
+    // First level: the power of 2; second level: the next 4 bits
+    int level = 31 - __builtin_clz(size);
+    int sub = (int)(size >> (level - 4)) - tlsfSubBins;
+    return (level - 3) * tlsfSubBins + sub;
+}
+
+void TlsfAlloc::_addFree(uint32_t offset, uint32_t size) {
+    int bin = _bin(size);
+    _byOffset[offset] = size;
+    _bins[bin].insert(offset);
+    _nonEmpty.insert(bin);
+}
+
+void TlsfAlloc::_removeFree(uint32_t offset, uint32_t size) {
+    int bin = _bin(size);
+    _byOffset.erase(offset);
+    _bins[bin].erase(offset);
+    if (_bins[bin].empty()) {
+        _nonEmpty.erase(bin);
+    }
+}
+
+uint32_t TlsfAlloc::alloc(uint32_t size) {
+    if (size == 0) {
+        size = 1;
+    }
+
+    // Round up to the next bin's smallest size, so any range of the bin
+    // found fits
+    uint32_t search = size;
+    if (size >= (uint32_t)tlsfSubBins) {
+        int level = 31 - __builtin_clz(size);
+        search += (1u << (level - 4)) - 1;
+    }
+    auto bin = _nonEmpty.lower_bound(_bin(search));
+    if (bin == _nonEmpty.end()) {
+        return gpuLib::Alloc::noSpace;
+    }
+    uint32_t offset = *_bins[*bin].begin();
+    uint32_t rangeSize = _byOffset[offset];
+    _removeFree(offset, rangeSize);
+    if (rangeSize > size) {
+        _addFree(offset + size, rangeSize - size);
+    }
+
+    _used += size;
+    _allocs += 1;
+    return offset;
+}
+
+void TlsfAlloc::free(uint32_t offset, uint32_t size) {
+    if (size == 0) {
+        size = 1;
+    }
+    _used -= size;
+    _allocs -= 1;
+
+    // Coalesce with the neighboring free ranges
+    auto next = _byOffset.lower_bound(offset);
+    if (next != _byOffset.end() and offset + size == next->first) {
+        uint32_t nextSize = next->second;
+        _removeFree(next->first, nextSize);
+        size += nextSize;
+        next = _byOffset.lower_bound(offset);
+    }
+    if (next != _byOffset.begin()) {
+        auto prev = std::prev(next);
+        if (prev->first + prev->second == offset) {
+            uint32_t prevOffset = prev->first;
+            uint32_t prevSize = prev->second;
+            _removeFree(prevOffset, prevSize);
+            offset = prevOffset;
+            size += prevSize;
+        }
+    }
+    _addFree(offset, size);
+}
+
+gpuLib::AllocStats TlsfAlloc::stats() {
+    gpuLib::AllocStats result;
+    result.capacity = _capacity;
+    result.used = _used;
+    result.free = _capacity - _used;
+    result.largestFree = 0;
+    for (auto const &range : _byOffset) {
+        result.largestFree = std::max(result.largestFree, range.second);
+    }
+    result.freeRanges = (int)_byOffset.size();
+    result.allocs = _allocs;
+    result.utilization = _capacity == 0 ? 0.0f : (float)_used / _capacity;
+    if (result.free == 0) {
+        result.fragmentation = 0.0f;
+    } else {
+        result.fragmentation = 1.0f - (float)result.largestFree / result.free;
+    }
+    return result;
+}
+
+static void benchOccl() {
+    int const triCount = 20000;
+    int const sphereCount = 100000;
+    int const rounds = 20;
+    Persp persp(winWidth, winHeight, 1.0f, 100.0f, 60.0f);
+    Cam cam;
+    glm::mat4 viewProj = persp.proj() * cam.view();
+    // One thread, so the kernels compare without the thread scaling
+    Jobs jobs(1);
+    uint64_t rng = 1;
+    auto rand01 = [&rng]() {
+        rng = rng * 6364136223846793005ull + 1442695040888963407ull;
+        return (float)(rng >> 40) / (float)(1 << 24);
+    };
+
+    // Small triangles scattered in front of the camera (+Z)
+    std::vector<glm::vec3> positions;
+    std::vector<unsigned int> indices;
+    for (int i = 0; i < triCount; i += 1) {
+        float x = rand01() * 20.0f - 10.0f;
+        float y = rand01() * 16.0f - 8.0f;
+        glm::vec3 center(x, y, 10.0f + rand01() * 30.0f);
+        for (int j = 0; j < 3; j += 1) {
+            glm::vec3 offset(rand01() * 3.0f, rand01() * 3.0f, rand01());
+            indices.push_back((unsigned int)positions.size());
+            positions.push_back(center + offset);
+        }
+    }
+    std::vector<glm::vec4> spheres;
+    for (int i = 0; i < sphereCount; i += 1) {
+        float x = rand01() * 40.0f - 20.0f;
+        float y = rand01() * 30.0f - 15.0f;
+        spheres.push_back(glm::vec4(x, y, 20.0f + rand01() * 70.0f, 0.5f));
+    }
+
+    Occl occl(winWidth / 4, winHeight / 4);
+    std::vector<unsigned char> visible;
+    char const *variants[] = {"scalar rasterize", "avx2 rasterize"};
+    for (int simd = 0; simd < 2; simd += 1) {
+        occl.simd(simd == 1);
+        if (simd == 1 and !occl.simd()) {
+            printf("occl: avx2 not supported\n");
+            break;
+        }
+        // Each round starts from empty tiles; only the rasterization is
+        // timed
+        double seconds = 0.0;
+        for (int i = 0; i < rounds; i += 1) {
+            occl.clear();
+            // clang-format off
+            occl.addOccluder(
+                viewProj, positions, indices.data(), (int)indices.size()
+            );
+            // clang-format on
+            double start = now();
+            occl.rasterize(jobs);
+            seconds += now() - start;
+        }
+        long count = (long)triCount * rounds;
+        showResult("occl", variants[simd], count, seconds);
+    }
+
+    double start = now();
+    occl.test(jobs, viewProj, spheres, visible);
+    showResult("occl", "test spheres", sphereCount, now() - start);
+
+    OcclStats stats = occl.stats();
+    printf("occl: %d threads, ", jobs.threadCount());
+    printf("%d/%d culled, ", stats.culled, stats.tested);
+    // Once the results are sized, a test makes no heap allocations (main.x
+    // tests every frame)
+    long allocs = heapAllocs();
+    occl.test(jobs, viewProj, spheres, visible);
+    printf("%ld heap allocations per test\n", heapAllocs() - allocs);
+    fflush(stdout);
+}
+
+static void benchSoft() {
+    int const frames = 10;
+    Jobs jobs(0);
+    Scene scene;
+    sceneLib::Gen gen;
+    gen.count(2000);
+    gen.center(glm::vec3(0.0f, 0.0f, gen.extent() + 5.0f));
+    gen.gen(scene, jobs);
+    scene.prepare();
+    Persp persp(winWidth, winHeight, 1.0f, gen.extent() * 4.0f + 10.0f, 60.0f);
+    Cam cam;
+    pipelineLib::Pipeline<Persp, Cam> viewPipeline(&persp, &cam);
+    glm::mat4 viewProj = viewPipeline.mapping();
+    Frustum frustum(viewProj);
+
+    Soft soft(winWidth, winHeight);
+    char const *variants[] = {"scalar frame", "avx2 frame"};
+    for (int simd = 0; simd < 2; simd += 1) {
+        soft.simd(simd == 1);
+        if (simd == 1 and !soft.simd()) {
+            printf("soft: avx2 not supported\n");
+            break;
+        }
+        double start = now();
+        for (int i = 0; i < frames; i += 1) {
+            soft.clear(glm::vec4(0.0f, 0.0f, 0.0f, 0.0f));
+            // The finest level of each object in the frustum
+            for (Obj &obj : scene.objs()) {
+                glm::mat4 world = obj.trans.world();
+                glm::vec4 sphere = scene.spheres()[obj.mesh];
+                glm::vec3 scale = obj.trans.scale();
+                float maxScale = glm::max(scale.x, glm::max(scale.y, scale.z));
+                glm::vec4 center = world * glm::vec4(glm::vec3(sphere), 1.0f);
+                if (!frustum.sphere(glm::vec3(center), sphere.w * maxScale)) {
+                    continue;
+                }
+                meshLib::Quant &quant = scene.quants()[obj.mesh];
+                meshLib::Lod &lod = scene.lods()[obj.mesh];
+                // clang-format off
+                soft.draw(
+                    viewProj * world, quant.scale(), quant.offset(),
+                    quant.vertices(), lod.indices().data(), lod.count(0)
+                );
+                // clang-format on
+            }
+            soft.flush(jobs);
+        }
+        showResult("soft", variants[simd], frames, now() - start);
+
+        // The kernels must agree on the image
+        uint32_t checksum = 0;
+        for (uint32_t color : soft.colors()) {
+            checksum = checksum * 31 + color;
+        }
+        SoftStats stats = soft.stats();
+        printf("soft: %d draws, %ld triangles, ", stats.draws, stats.tris);
+        printf("setup %.2f ms, ", stats.setupMs);
+        printf("raster %.2f ms, ", stats.rasterMs);
+        printf("checksum %08x\n", checksum);
+    }
+    printf("soft: %d threads\n", jobs.threadCount());
+    fflush(stdout);
+}
+
+static void benchBvh() {
+    int const rayCount = 100000;
+    int const bruteRayCount = 100;
+    int const boxCount = 100000;
+    int const frustumCount = 10;
+    Jobs jobs(0);
+    uint64_t rng = 1;
+    auto rand01 = [&rng]() {
+        rng = rng * 6364136223846793005ull + 1442695040888963407ull;
+        return (float)(rng >> 40) / (float)(1 << 24);
+    };
+
+    // World space triangles of a generated scene of over 1M triangles
+    Scene scene;
+    sceneLib::Gen gen;
+    gen.count(1700);
+    gen.center(glm::vec3(0.0f, 0.0f, gen.extent() + 5.0f));
+    gen.gen(scene, jobs);
+    std::vector<glm::vec3> verts;
+    for (Obj &obj : scene.objs()) {
+        Mesh &mesh = scene.meshes()[obj.mesh];
+        glm::mat4 world = obj.trans.world();
+        for (unsigned int index : mesh.indices()) {
+            glm::vec4 pos = world * glm::vec4(mesh.positions()[index], 1.0f);
+            verts.push_back(glm::vec3(pos));
+        }
+    }
+    int triCount = (int)verts.size() / 3;
+    std::vector<BvhBox> boxes(triCount);
+    for (int i = 0; i < triCount; i += 1) {
+        glm::vec3 a = verts[i * 3];
+        glm::vec3 b = verts[i * 3 + 1];
+        glm::vec3 c = verts[i * 3 + 2];
+        boxes[i].lo = glm::min(a, glm::min(b, c));
+        boxes[i].hi = glm::max(a, glm::max(b, c));
+    }
+
+    Bvh bvh;
+    double start = now();
+    bvh.build(boxes, jobs);
+    showResult("bvh", "build triangles", triCount, now() - start);
+    BvhStats stats = bvh.stats();
+    printf("bvh: %d threads, ", jobs.threadCount());
+    printf("%d subtrees, ", stats.subtrees);
+    printf("%d nodes, %d leaves, ", stats.nodes, stats.leaves);
+    printf("depth %d\n", stats.depth);
+
+    // Move everything; the refit keeps the topology
+    for (int i = 0; i < triCount; i += 1) {
+        boxes[i].lo += glm::vec3(0.1f, 0.0f, 0.0f);
+        boxes[i].hi += glm::vec3(0.1f, 0.0f, 0.0f);
+    }
+    start = now();
+    bvh.refit(boxes);
+    showResult("bvh", "refit triangles", triCount, now() - start);
+    for (int i = 0; i < triCount; i += 1) {
+        boxes[i].lo -= glm::vec3(0.1f, 0.0f, 0.0f);
+        boxes[i].hi -= glm::vec3(0.1f, 0.0f, 0.0f);
+    }
+    bvh.refit(boxes);
+
+    // Rays from the camera into the scene
+    std::vector<glm::vec3> dirs(rayCount);
+    for (int i = 0; i < rayCount; i += 1) {
+        dirs[i] = glm::vec3(rand01() - 0.5f, rand01() - 0.5f, 1.0f);
+    }
+    glm::vec3 origin(0.0f, 0.0f, 0.0f);
+    float const far = 1e30f;
+    auto hitTri = [&](glm::vec3 dir, int tri, float tMax) {
+        float t;
+        // clang-format off
+        bool hit = bvhRayTri(
+            origin, dir, verts[tri * 3], verts[tri * 3 + 1], verts[tri * 3 + 2],
+            t
+        );
+        // clang-format on
+        return hit and t < tMax ? t : tMax;
+    };
+    std::vector<float> hits(rayCount);
+    start = now();
+    for (int i = 0; i < rayCount; i += 1) {
+        glm::vec3 dir = dirs[i];
+        // clang-format off
+        hits[i] = bvh.ray(origin, dir, far, [&](int tri, float tMax) {
+            return hitTri(dir, tri, tMax);
+        });
+        // clang-format on
+    }
+    showResult("bvh", "ray closest hit", rayCount, now() - start);
+    int hitCount = 0;
+    for (float t : hits) {
+        hitCount += t < far ? 1 : 0;
+    }
+
+    // Brute force agrees with the BVH on the closest hits
+    int mismatches = 0;
+    start = now();
+    for (int i = 0; i < bruteRayCount; i += 1) {
+        float t = far;
+        for (int j = 0; j < triCount; j += 1) {
+            t = hitTri(dirs[i], j, t);
+        }
+        mismatches += t != hits[i] ? 1 : 0;
+    }
+    showResult("bvh", "ray brute force", bruteRayCount, now() - start);
+    printf("bvh: %d/%d rays hit, ", hitCount, rayCount);
+    printf("%d brute force mismatches\n", mismatches);
+
+    // Box and frustum queries
+    std::vector<int> result;
+    long found = 0;
+    start = now();
+    for (int i = 0; i < boxCount; i += 1) {
+        float x = rand01() * 100.0f - 50.0f;
+        float y = rand01() * 100.0f - 50.0f;
+        glm::vec3 lo(x, y, rand01() * 100.0f + 5.0f);
+        result.clear();
+        bvh.box(lo, lo + glm::vec3(1.0f, 1.0f, 1.0f), result);
+        found += (long)result.size();
+    }
+    showResult("bvh", "box query", boxCount, now() - start);
+    printf("bvh: %.1f triangles per box\n", (double)found / boxCount);
+
+    Persp persp(winWidth, winHeight, 1.0f, gen.extent() * 4.0f + 10.0f, 60.0f);
+    Cam cam;
+    pipelineLib::Pipeline<Persp, Cam> viewPipeline(&persp, &cam);
+    Frustum frustum(viewPipeline.mapping());
+    start = now();
+    for (int i = 0; i < frustumCount; i += 1) {
+        result.clear();
+        bvh.frustum(frustum, result);
+    }
+    showResult("bvh", "frustum query", frustumCount, now() - start);
+    printf("bvh: %zu/%d triangles in the frustum\n", result.size(), triCount);
+    sink = (float)found;
+    fflush(stdout);
+}
+
+static void benchPick() {
+    int const pickCount = 100000;
+    int const bruteCount = 20;
+    Jobs jobs(0);
+    uint64_t rng = 1;
+    auto rand01 = [&rng]() {
+        rng = rng * 6364136223846793005ull + 1442695040888963407ull;
+        return (float)(rng >> 40) / (float)(1 << 24);
+    };
+
+    Scene scene;
+    sceneLib::Gen gen;
+    gen.count(1700);
+    gen.center(glm::vec3(0.0f, 0.0f, gen.extent() + 5.0f));
+    gen.gen(scene, jobs);
+    scene.prepare();
+    Persp persp(winWidth, winHeight, 1.0f, gen.extent() * 4.0f + 10.0f, 60.0f);
+    Cam cam;
+    pipelineLib::Pipeline<Persp, Cam> viewPipeline(&persp, &cam);
+    glm::mat4 viewProj = viewPipeline.mapping();
+
+    // Objects' boxes from their bounding spheres, as in main.x
+    std::vector<BvhBox> boxes(scene.objs().size());
+    for (size_t i = 0; i < scene.objs().size(); i += 1) {
+        Obj &obj = scene.objs()[i];
+        glm::vec4 sphere = scene.spheres()[obj.mesh];
+        glm::vec3 scale = obj.trans.scale();
+        float maxScale = glm::max(scale.x, glm::max(scale.y, scale.z));
+        glm::mat4 world = obj.trans.world();
+        glm::vec4 center = world * glm::vec4(glm::vec3(sphere), 1.0f);
+        glm::vec3 radius(sphere.w * maxScale);
+        boxes[i].lo = glm::vec3(center) - radius;
+        boxes[i].hi = glm::vec3(center) + radius;
+    }
+    Bvh objBvh;
+    Pick pick;
+    double start = now();
+    objBvh.build(boxes, jobs);
+    scene.buildBvhs(jobs);
+    long triCount = scene.triCount();
+    showResult("pick", "build BVHs", triCount, now() - start);
+
+    std::vector<PickHit> hits(pickCount);
+    std::vector<glm::vec3> origins(pickCount);
+    std::vector<glm::vec3> dirs(pickCount);
+    for (int i = 0; i < pickCount; i += 1) {
+        int x = (int)(rand01() * winWidth);
+        int y = (int)(rand01() * winHeight);
+        pickRay(viewProj, x, y, winWidth, winHeight, origins[i], dirs[i]);
+    }
+    long tested = 0;
+    start = now();
+    for (int i = 0; i < pickCount; i += 1) {
+        hits[i] = pick.ray(scene, objBvh, origins[i], dirs[i]);
+        tested += pick.tested();
+    }
+    showResult("pick", "pick", pickCount, now() - start);
+    int hitCount = 0;
+    for (PickHit &hit : hits) {
+        hitCount += hit.obj >= 0 ? 1 : 0;
+    }
+
+    // Brute force over all objects' triangles in world space
+    int mismatches = 0;
+    start = now();
+    for (int i = 0; i < bruteCount; i += 1) {
+        int bestObj = -1;
+        float bestT = 1.0f;
+        for (size_t j = 0; j < scene.objs().size(); j += 1) {
+            Obj &obj = scene.objs()[j];
+            Mesh &mesh = scene.meshes()[obj.mesh];
+            glm::mat4 world = obj.trans.world();
+            std::vector<unsigned int> &indices = mesh.indices();
+            for (size_t k = 0; k + 2 < indices.size(); k += 3) {
+                glm::vec3 v[3];
+                for (int m = 0; m < 3; m += 1) {
+                    glm::vec3 pos = mesh.positions()[indices[k + m]];
+                    v[m] = glm::vec3(world * glm::vec4(pos, 1.0f));
+                }
+                float t;
+                bool hit = bvhRayTri(origins[i], dirs[i], v[0], v[1], v[2], t);
+                if (hit and t < bestT) {
+                    bestT = t;
+                    bestObj = (int)j;
+                }
+            }
+        }
+        mismatches += bestObj != hits[i].obj ? 1 : 0;
+    }
+    showResult("pick", "brute force", bruteCount, now() - start);
+    printf("pick: %ld triangles, ", triCount);
+    printf("%d/%d picks hit, ", hitCount, pickCount);
+    printf("%.1f objects tested per pick, ", (double)tested / pickCount);
+    printf("%d brute force mismatches\n", mismatches);
+    fflush(stdout);
+}
+
+static void benchGrid() {
+    int const objCount = 100000;
+    int const frames = 60;
+    int const queryCount = 10000;
+    int const bruteCount = 100;
+    float const extent = 400.0f;
+    float const dt = 1.0f / 60.0f;
+    Jobs jobs(0);
+    uint64_t rng = 1;
+    auto rand01 = [&rng]() {
+        rng = rng * 6364136223846793005ull + 1442695040888963407ull;
+        return (float)(rng >> 40) / (float)(1 << 24);
+    };
+    auto randPos = [&]() {
+        float x = (rand01() - 0.5f) * extent;
+        float y = (rand01() - 0.5f) * extent;
+        return glm::vec3(x, y, (rand01() - 0.5f) * extent);
+    };
+
+    std::vector<int> ids(objCount);
+    std::vector<glm::vec3> positions(objCount);
+    std::vector<glm::vec3> velocities(objCount);
+    std::vector<float> radii(objCount);
+    for (int i = 0; i < objCount; i += 1) {
+        ids[i] = i;
+        positions[i] = randPos();
+        velocities[i] = (randPos() / extent) * 20.0f;
+        radii[i] = 0.5f + rand01() * 1.5f;
+    }
+
+    Grid grid(8.0f);
+    double start = now();
+    grid.insert(ids, positions, radii);
+    showResult("grid", "batch insert", objCount, now() - start);
+
+    // Every object moves every frame
+    start = now();
+    for (int f = 0; f < frames; f += 1) {
+        for (int i = 0; i < objCount; i += 1) {
+            positions[i] += velocities[i] * dt;
+            grid.move(i, positions[i]);
+        }
+    }
+    long moveCount = (long)objCount * frames;
+    showResult("grid", "move", moveCount, now() - start);
+    GridStats stats = grid.stats();
+    printf("grid: %d objects, %d cells, ", stats.objs, stats.cells);
+    printf("largest cell %d, ", stats.maxBucket);
+    double cellMoved = (double)stats.cellMoves / (double)moveCount;
+    printf("%.1f%% of the moves changed cells\n", cellMoved * 100.0);
+
+    // The alternative: rebuild a BVH over the moved objects every frame
+    std::vector<BvhBox> boxes(objCount);
+    for (int i = 0; i < objCount; i += 1) {
+        glm::vec3 radius(radii[i], radii[i], radii[i]);
+        boxes[i].lo = positions[i] - radius;
+        boxes[i].hi = positions[i] + radius;
+    }
+    Bvh bvh;
+    start = now();
+    bvh.build(boxes, jobs);
+    showResult("grid", "bvh rebuild (for reference)", objCount, now() - start);
+
+    std::vector<int> result;
+    long found = 0;
+    start = now();
+    for (int i = 0; i < queryCount; i += 1) {
+        result.clear();
+        grid.sphere(randPos(), 10.0f, result);
+        found += (long)result.size();
+    }
+    showResult("grid", "sphere query", queryCount, now() - start);
+    printf("grid: %.1f objects per sphere\n", (double)found / queryCount);
+
+    std::vector<glm::vec3> targets(queryCount);
+    std::vector<int> nearests(queryCount);
+    for (int i = 0; i < queryCount; i += 1) {
+        targets[i] = randPos();
+    }
+    start = now();
+    for (int i = 0; i < queryCount; i += 1) {
+        nearests[i] = grid.nearest(targets[i], 50.0f);
+    }
+    showResult("grid", "nearest query", queryCount, now() - start);
+
+    // Brute force agrees on the nearest distances
+    int mismatches = 0;
+    for (int i = 0; i < bruteCount; i += 1) {
+        float best = 50.0f * 50.0f;
+        for (int j = 0; j < objCount; j += 1) {
+            glm::vec3 offset = positions[j] - targets[i];
+            best = glm::min(best, glm::dot(offset, offset));
+        }
+        glm::vec3 offset = positions[nearests[i]] - targets[i];
+        mismatches += glm::dot(offset, offset) != best ? 1 : 0;
+    }
+    printf("grid: %d brute force mismatches\n", mismatches);
+
+    std::vector<int> removed(ids.begin(), ids.begin() + objCount / 2);
+    start = now();
+    grid.remove(removed);
+    showResult("grid", "batch remove", (long)removed.size(), now() - start);
+    fflush(stdout);
+}
+
+static void benchCollide() {
+    int const moveCount = 100000;
+    int const bruteCount = 200;
+    float const stepLen = 2.0f;
+    Jobs jobs(0);
+    uint64_t rng = 1;
+    auto rand01 = [&rng]() {
+        rng = rng * 6364136223846793005ull + 1442695040888963407ull;
+        return (float)(rng >> 40) / (float)(1 << 24);
+    };
+
+    // A generated scene of over 1M triangles, and its objects' boxes from
+    // their bounding spheres, as in main.x
+    Scene scene;
+    sceneLib::Gen gen;
+    gen.count(1700);
+    gen.gen(scene, jobs);
+    scene.prepare();
+    std::vector<BvhBox> boxes(scene.objs().size());
+    for (size_t i = 0; i < scene.objs().size(); i += 1) {
+        Obj &obj = scene.objs()[i];
+        glm::vec4 sphere = scene.spheres()[obj.mesh];
+        glm::vec3 scale = obj.trans.scale();
+        float maxScale = glm::max(scale.x, glm::max(scale.y, scale.z));
+        glm::mat4 world = obj.trans.world();
+        glm::vec4 center = world * glm::vec4(glm::vec3(sphere), 1.0f);
+        glm::vec3 radius(sphere.w * maxScale);
+        boxes[i].lo = glm::vec3(center) - radius;
+        boxes[i].hi = glm::vec3(center) + radius;
+    }
+    long triCount = scene.triCount();
+
+    Bvh objBvh;
+    camLib::Collider collider;
+    double start = now();
+    objBvh.build(boxes, jobs);
+    scene.buildBvhs(jobs);
+    collider.attach(scene, objBvh);
+    showResult("collide", "build object and mesh BVHs", triCount,
+               now() - start);
+
+    float extent = gen.extent();
+    auto randPos = [&]() {
+        float x = (rand01() - 0.5f) * extent;
+        float y = (rand01() - 0.5f) * extent;
+        return glm::vec3(x, y, (rand01() - 0.5f) * extent);
+    };
+    auto randStep = [&]() {
+        glm::vec3 dir(rand01() - 0.5f, rand01() - 0.5f, rand01() - 0.5f);
+        return glm::normalize(dir + glm::vec3(1e-6f)) * stepLen;
+    };
+
+    // A walk through the scene, as the camera moves
+    glm::vec3 pos = randPos();
+    long objs = 0;
+    long tested = 0;
+    int hits = 0;
+    double maxUs = 0.0;
+    start = now();
+    for (int i = 0; i < moveCount; i += 1) {
+        if (i % 100 == 0) {
+            pos = randPos();
+        }
+        pos = collider.move(pos, randStep());
+        camLib::CollideStats stats = collider.stats();
+        objs += stats.objs;
+        tested += stats.tested;
+        hits += stats.hit ? 1 : 0;
+        maxUs = glm::max(maxUs, stats.us);
+    }
+    showResult("collide", "move", moveCount, now() - start);
+    printf("collide: %.1f%% of the moves hit, ", hits * 100.0 / moveCount);
+    printf("%.1f objects, ", (double)objs / moveCount);
+    printf("%.1f triangles tested per move, ", (double)tested / moveCount);
+    printf("slowest %.1f us\n", maxUs);
+
+    // Brute force over the world space triangles of all objects
+    std::vector<glm::vec3> verts;
+    for (Obj &obj : scene.objs()) {
+        Mesh &mesh = scene.meshes()[obj.mesh];
+        glm::mat4 world = obj.trans.world();
+        for (unsigned int index : mesh.indices()) {
+            glm::vec4 pos = world * glm::vec4(mesh.positions()[index], 1.0f);
+            verts.push_back(glm::vec3(pos));
+        }
+    }
+    // The squared distance from a segment (the capsule's axis) to the
+    // nearest triangle
+    auto nearestSq = [&](glm::vec3 p, glm::vec3 q) {
+        float best = 1e30f;
+        glm::vec3 segLo = glm::min(p, q);
+        glm::vec3 segHi = glm::max(p, q);
+        for (long i = 0; i < triCount; i += 1) {
+            glm::vec3 a = verts[i * 3];
+            glm::vec3 b = verts[i * 3 + 1];
+            glm::vec3 c = verts[i * 3 + 2];
+            // The boxes' distance bounds the triangle's from below
+            glm::vec3 lo = glm::min(a, glm::min(b, c)) - segHi;
+            glm::vec3 hi = segLo - glm::max(a, glm::max(b, c));
+            glm::vec3 out = glm::max(lo, glm::max(hi, glm::vec3(0.0f)));
+            if (glm::dot(out, out) >= best) {
+                continue;
+            }
+            best = glm::min(best, segTriDistSq(p, q, a, b, c));
+        }
+        return best;
+    };
+
+    // Brute force agrees that moves from free space stay in free space all
+    // along the way: the segment of each move, swept by the sphere, touches
+    // no triangle (so moves that tunnel through thin triangles show up)
+    float minDist = collider.radius() * 0.99f;
+    int checked = 0;
+    int checkedHits = 0;
+    int mismatches = 0;
+    while (checked < bruteCount) {
+        // Half of the moves are random, and half head at a random triangle
+        // from in front of it, so that they hit
+        glm::vec3 from = randPos();
+        glm::vec3 step = randStep();
+        if (checked % 2 == 1) {
+            long tri = (long)(rand01() * (float)(triCount - 1));
+            glm::vec3 a = verts[tri * 3];
+            glm::vec3 b = verts[tri * 3 + 1];
+            glm::vec3 c = verts[tri * 3 + 2];
+            glm::vec3 n = glm::cross(b - a, c - a);
+            if (glm::dot(n, n) <= 1e-12f) {
+                continue;
+            }
+            n = glm::normalize(n);
+            float gap = collider.radius() * 1.5f + rand01() * stepLen * 0.5f;
+            from = (a + b + c) / 3.0f + n * gap;
+            step = glm::normalize(randStep() * 0.25f - n * stepLen) * stepLen;
+        }
+        if (nearestSq(from, from) < minDist * minDist) {
+            continue;
+        }
+        glm::vec3 to = collider.move(from, step);
+        checkedHits += collider.stats().hit ? 1 : 0;
+        mismatches += nearestSq(from, to) < minDist * minDist ? 1 : 0;
+        checked += 1;
+    }
+    printf("collide: %d brute force mismatches ", mismatches);
+    printf("(%d moves, %d hit)\n", checked, checkedHits);
+    fflush(stdout);
+}
+
+static glm::vec3 closestOnTri(glm::vec3 p, glm::vec3 a, glm::vec3 b,
+                              glm::vec3 c) {
+    // By the triangle's Voronoi regions
+    glm::vec3 ab = b - a;
+    glm::vec3 ac = c - a;
+    glm::vec3 ap = p - a;
+    glm::vec3 bp = p - b;
+    glm::vec3 cp = p - c;
+    float d1 = glm::dot(ab, ap);
+    float d2 = glm::dot(ac, ap);
+    float d3 = glm::dot(ab, bp);
+    float d4 = glm::dot(ac, bp);
+    float d5 = glm::dot(ab, cp);
+    float d6 = glm::dot(ac, cp);
+    float va = d3 * d6 - d5 * d4;
+    float vb = d5 * d2 - d1 * d6;
+    float vc = d1 * d4 - d3 * d2;
+    if (d1 <= 0.0f and d2 <= 0.0f) {
+        return a;
+    } else if (d3 >= 0.0f and d4 <= d3) {
+        return b;
+    } else if (d6 >= 0.0f and d5 <= d6) {
+        return c;
+    } else if (vc <= 0.0f and d1 >= 0.0f and d3 <= 0.0f) {
+        return a + ab * (d1 / (d1 - d3));
+    } else if (vb <= 0.0f and d2 >= 0.0f and d6 <= 0.0f) {
+        return a + ac * (d2 / (d2 - d6));
+    } else if (va <= 0.0f and d4 - d3 >= 0.0f and d5 - d6 >= 0.0f) {
+        float w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+        return b + (c - b) * w;
+    }
+    float denom = 1.0f / (va + vb + vc);
+    return a + ab * (vb * denom) + ac * (vc * denom);
+}
+
+static float segSegDistSq(glm::vec3 p1, glm::vec3 q1, glm::vec3 p2,
+                          glm::vec3 q2) {
+    // The closest parameters s and t, clamped to the segments
+    glm::vec3 d1 = q1 - p1;
+    glm::vec3 d2 = q2 - p2;
+    glm::vec3 r = p1 - p2;
+    float a = glm::dot(d1, d1);
+    float e = glm::dot(d2, d2);
+    float f = glm::dot(d2, r);
+    float s = 0.0f;
+    float t = 0.0f;
+    if (a <= 1e-12f and e <= 1e-12f) {
+        return glm::dot(r, r);
+    }
+    if (a <= 1e-12f) {
+        t = glm::clamp(f / e, 0.0f, 1.0f);
+    } else {
+        float c = glm::dot(d1, r);
+        if (e <= 1e-12f) {
+            s = glm::clamp(-c / a, 0.0f, 1.0f);
+        } else {
+            float b = glm::dot(d1, d2);
+            float denom = a * e - b * b;
+            if (denom > 0.0f) {
+                s = glm::clamp((b * f - c * e) / denom, 0.0f, 1.0f);
+            }
+            t = (b * s + f) / e;
+            if (t < 0.0f) {
+                t = 0.0f;
+                s = glm::clamp(-c / a, 0.0f, 1.0f);
+            } else if (t > 1.0f) {
+                t = 1.0f;
+                s = glm::clamp((b - c) / a, 0.0f, 1.0f);
+            }
+        }
+    }
+    glm::vec3 gap = (p1 + d1 * s) - (p2 + d2 * t);
+    return glm::dot(gap, gap);
+}
+
+static float segTriDistSq(glm::vec3 p, glm::vec3 q, glm::vec3 a, glm::vec3 b,
+                          glm::vec3 c) {
+    // A segment that crosses the triangle touches it
+    float t;
+    if (bvhRayTri(p, q - p, a, b, c, t) and t <= 1.0f) {
+        return 0.0f;
+    }
+    // Otherwise the nearest points are on the segment's ends or on the
+    // triangle's edges
+    glm::vec3 toP = p - closestOnTri(p, a, b, c);
+    glm::vec3 toQ = q - closestOnTri(q, a, b, c);
+    float result = glm::min(glm::dot(toP, toP), glm::dot(toQ, toQ));
+    result = glm::min(result, segSegDistSq(p, q, a, b));
+    result = glm::min(result, segSegDistSq(p, q, b, c));
+    result = glm::min(result, segSegDistSq(p, q, c, a));
+    return result;
+}
+
+static void benchSubmit() {
+    int const frameCount = 20;
+    long const counts[] = {10000, 100000};
+    Jobs jobs(0);
+
+    for (long count : counts) {
+        Scene scene;
+        sceneLib::Gen gen;
+        gen.count(count);
+        gen.gen(scene, jobs);
+        scene.prepare();
+        // As main.x's sorted draw list: the draws of a mesh in a row
+        std::vector<Obj> &objs = scene.objs();
+        // clang-format off
+        std::sort(
+            objs.begin(), objs.end(),
+            [](Obj const &a, Obj const &b) { return a.mesh < b.mesh; }
+        );
+        // clang-format on
+        Persp persp(winWidth, winHeight, 1.0f, 1000.0f, 60.0f);
+        Cam cam;
+        pipelineLib::Pipeline<Persp, Cam> viewPipeline(&persp, &cam);
+        glm::mat4 viewProj = viewPipeline.mapping();
+
+        // Direct: a mapping uniform and a draw per object, and the
+        // dequantization uniforms whenever the mesh changes
+        long directCalls = 0;
+        double start = now();
+        for (int frame = 0; frame < frameCount; frame += 1) {
+            int lastMesh = -1;
+            for (Obj &obj : objs) {
+                glm::mat4 mapping = viewProj * obj.trans.world();
+                glCall(&mapping, sizeof(mapping));
+                meshLib::Quant &quant = scene.quants()[obj.mesh];
+                if (obj.mesh != lastMesh) {
+                    glm::vec3 scale = quant.scale();
+                    glm::vec3 offset = quant.offset();
+                    glCall(&scale, sizeof(scale));
+                    glCall(&offset, sizeof(offset));
+                    directCalls += 2;
+                    lastMesh = obj.mesh;
+                }
+                meshLib::Lod &lod = scene.lods()[obj.mesh];
+                int draw[2] = {lod.first(obj.lod), lod.count(obj.lod)};
+                glCall(draw, sizeof(draw));
+                directCalls += 2;
+            }
+        }
+        std::string variant = "direct, " + std::to_string(count) + " objs";
+        showResult("submit", variant.c_str(), count * frameCount,
+                   now() - start);
+        printf("submit: direct: %ld GL calls/frame\n",
+               directCalls / frameCount);
+
+        // Indirect: a command and a data record per object, uploaded with
+        // one copy each and drawn with one call (and the binds around it)
+        std::vector<gpuLib::DrawCmd> cmds;
+        std::vector<gpuLib::DrawData> datas;
+        long indirectCalls = 0;
+        start = now();
+        for (int frame = 0; frame < frameCount; frame += 1) {
+            cmds.clear();
+            datas.clear();
+            for (Obj &obj : objs) {
+                meshLib::Lod &lod = scene.lods()[obj.mesh];
+                meshLib::Quant &quant = scene.quants()[obj.mesh];
+                gpuLib::DrawCmd cmd;
+                cmd.count = lod.count(obj.lod);
+                cmd.instanceCount = 1;
+                cmd.firstIndex = lod.first(obj.lod);
+                cmd.baseVertex = 0;
+                cmd.baseInstance = 0;
+                gpuLib::DrawData data;
+                data.mapping = viewProj * obj.trans.world();
+                data.posScale = glm::vec4(quant.scale(), 0.0f);
+                data.posOffset = glm::vec4(quant.offset(), 0.0f);
+                cmds.push_back(cmd);
+                datas.push_back(data);
+            }
+            // Buffer binds and uploads, storage binding, and the draw
+            glCall(cmds.data(), cmds.size() * sizeof(gpuLib::DrawCmd));
+            glCall(datas.data(), datas.size() * sizeof(gpuLib::DrawData));
+            indirectCalls += 6;
+        }
+        variant = "indirect, " + std::to_string(count) + " objs";
+        showResult("submit", variant.c_str(), count * frameCount,
+                   now() - start);
+        printf("submit: indirect: %ld GL calls/frame, %zu B uploaded\n",
+               indirectCalls / frameCount,
+               cmds.size() * sizeof(gpuLib::DrawCmd) +
+                   datas.size() * sizeof(gpuLib::DrawData));
+    }
+    fflush(stdout);
+}
+
+static void glCall(void const *args, size_t size) {
+    // A driver copies the arguments into its command stream
+    static std::vector<unsigned char> stream(1 << 24);
+    static size_t at = 0;
+    size = std::min(size, stream.size());
+    if (at + size > stream.size()) {
+        at = 0;
+    }
+    memcpy(stream.data() + at, args, size);
+    at += size;
+}
+
+static void benchCapture() {
+    int const width = 1920;
+    int const height = 1080;
+    int const frameCount = 60;
+
+    // A frame with detail in every channel, as GL reads it back
+    std::vector<unsigned char> rgba((size_t)width * height * 4);
+    for (int y = 0; y < height; y += 1) {
+        for (int x = 0; x < width; x += 1) {
+            unsigned char *p = &rgba[((size_t)y * width + x) * 4];
+            p[0] = (unsigned char)x;
+            p[1] = (unsigned char)y;
+            p[2] = (unsigned char)(x * y >> 4);
+            p[3] = 255;
+        }
+    }
+
+    char const *const paths[] = {"bench.png", "bench.y4m"};
+    char const *const variants[] = {"encode png 1080p", "encode y4m 1080p"};
+    for (int i = 0; i < 2; i += 1) {
+        captureLib::Encoder encoder;
+        // Encoded in memory only; the PNG files are opened per frame
+        encoder.open(paths[i], width, height, 60);
+        size_t bytes = 0;
+        double start = now();
+        for (int j = 0; j < frameCount; j += 1) {
+            bytes = encoder.encode(rgba.data()).size();
+        }
+        double seconds = now() - start;
+        showResult("capture", variants[i], frameCount, seconds);
+        printf("capture: %.1f MB/frame, ", bytes / 1e6);
+        printf("%.0f frames/s on the encoder thread\n",
+               frameCount / seconds);
+        encoder.close();
+        remove(paths[i]);
+    }
+    fflush(stdout);
+}
+
+static void benchFrame() {
+    int const itemCount = 100000;
+    int const frameCount = 100;
+    // The first frame overflows, and the buffers grow as their slots come
+    // around
+    int const warmFrames = frameArenaMaxBuffers + 1;
+
+    std::vector<uint64_t> keys(itemCount);
+    uint64_t rng = 1;
+    for (int i = 0; i < itemCount; i += 1) {
+        rng = rng * 6364136223846793005ull + 1442695040888963407ull;
+        keys[i] = (rng >> 40) << 32 | (uint32_t)i;
+    }
+    glm::mat4 mapping(1.0f);
+    auto byKey = [](DrawItem const &a, DrawItem const &b) {
+        return a.key < b.key;
+    };
+
+    // Each frame builds a sorted draw list, on the heap as a returned vector
+    // would, then from the frame arena
+    for (int variant = 0; variant < 2; variant += 1) {
+        FrameArena arena(frameArenaMaxBuffers, 1 << 20);
+        long steadyAllocs = 0;
+        double start = now();
+        for (int frame = 0; frame < frameCount; frame += 1) {
+            long allocs = heapAllocs();
+            int obj = 0;
+            if (variant == 0) {
+                std::vector<DrawItem> list;
+                for (int i = 0; i < itemCount; i += 1) {
+                    list.push_back(DrawItem{keys[i], i, mapping});
+                }
+                std::sort(list.begin(), list.end(), byKey);
+                obj = list[frame].obj;
+            } else {
+                arena.begin(frame);
+                FrameVector<DrawItem> list{FrameAlloc<DrawItem>(arena)};
+                list.reserve(itemCount);
+                for (int i = 0; i < itemCount; i += 1) {
+                    list.push_back(DrawItem{keys[i], i, mapping});
+                }
+                std::sort(list.begin(), list.end(), byKey);
+                obj = list[frame].obj;
+            }
+            sink = sink + (float)obj;
+            if (frame >= warmFrames) {
+                steadyAllocs += heapAllocs() - allocs;
+            }
+        }
+        char const *variants[] = {"draw list (heap)", "draw list (arena)"};
+        double seconds = now() - start;
+        showResult("frame", variants[variant], (long)itemCount * frameCount,
+                   seconds);
+        printf("frame: %.2f heap allocations/frame in steady state",
+               steadyAllocs / (double)(frameCount - warmFrames));
+        if (variant == 1) {
+            FrameArenaStats stats = arena.stats();
+            printf(", arena peak %zu B, ", stats.peak);
+            printf("%ld buffer growths", stats.grows);
+        }
+        printf("\n");
+    }
+    fflush(stdout);
+}
+
+static void benchGraph() {
+    int const planCount = 10000;
+    gpuLib::GraphDesc const desc{winWidth, winHeight, GL_RGBA8};
+
+    // The tone pass writes C, so the same-writes heuristic would pick reuse
+    // next, but reuse draws over what present reads and must follow it
+    gpuLib::Plan plan;
+    int back = plan.import("back buffer", 0, winWidth, winHeight);
+    int a = plan.texture("A", desc);
+    int b = plan.texture("B", desc);
+    int c = plan.texture("C", desc);
+    int u = plan.texture("U", desc);
+    int scene = plan.pass("scene");
+    plan.write(scene, a);
+    int blur = plan.pass("blur");
+    plan.read(blur, a);
+    plan.write(blur, b);
+    int debug = plan.pass("debug");
+    plan.write(debug, u);
+    int tone = plan.pass("tone");
+    plan.read(tone, b);
+    plan.write(tone, c);
+    int present = plan.pass("present");
+    plan.read(present, c);
+    plan.write(present, back);
+    int reuse = plan.pass("reuse");
+    plan.write(reuse, c);
+    int capture = plan.pass("capture");
+    plan.read(capture, c);
+    plan.keep(capture);
+    bool planned = plan.plan();
+    plan.dump(stdout);
+
+    std::vector<int> const &order = plan.order();
+    auto position = [&order](int pass) {
+        return std::find(order.begin(), order.end(), pass) - order.begin();
+    };
+    std::vector<gpuLib::Plan::Resource> const &res = plan.resources();
+    std::vector<gpuLib::Plan::Pass> const &passes = plan.passes();
+    int failures = planned ? 0 : 1;
+    failures += passes[debug].culled ? 0 : 1;
+    failures += position(reuse) > position(present) ? 0 : 1;
+    failures += res[c].texture == res[a].texture ? 0 : 1;
+    failures += res[b].texture != res[a].texture ? 0 : 1;
+    failures += plan.stats().textures == 2 ? 0 : 1;
+    printf("graph: %d of 6 checks failed\n", failures);
+
+    double start = now();
+    for (int i = 0; i < planCount; i += 1) {
+        plan.plan();
+    }
+    double seconds = now() - start;
+    sink = sink + (float)plan.stats().bytes;
+    showResult("graph", "plan 7 passes", planCount, seconds);
+}
@@ -0,0 +1,155 @@
+/* File name: bench.hpp
+ * 
+ * Intro:
+ * C++ header of a program that runs microbenchmarks on the custom libraries
+ * of the camera control program. The benchmarks run on the CPU only and need
+ * no window or GL context.
+ * 
+ * Usage:
+ * ./bench.x [name ...]
+ * Runs the named benchmarks (all of them if no names are given). */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+// Include C++ libraries
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+// Include C libraries
+#include <cstdio>
+// Include GLEW before other GL libraries (for the mesh headers' types only)
+#include <GL/glew.h>
+// Include GL-related libraries
+#include <glm/glm.hpp>
+#include <glm/ext.hpp>
+// Include custom libraries
+#include "trans.hpp"
+#include "persp.hpp"
+#include "cam.hpp"
+#include "pipeline.hpp"
+#include "pipeline/fixed.hpp"
+#include "gpu/alloc.hpp"
+#include "gpu/indirect.hpp"
+#include "gpu/plan.hpp"
+#include "jobs.hpp"
+#include "occl.hpp"
+#include "frustum.hpp"
+#include "scene.hpp"
+#include "scene/gen.hpp"
+#include "soft.hpp"
+#include "bvh.hpp"
+#include "pick.hpp"
+#include "grid.hpp"
+#include "cam/collide.hpp"
+#include "capture/encode.hpp"
+#include "frame.hpp"
+#include "draw.hpp"
+
+// Define variables
+static int const winWidth = 1024;
+static int const winHeight = 768;
+/* Result sink that keeps the optimizer from dropping benchmarked work. */
+static volatile float sink;
+
+// Define types
+/* Benchmark entry. */
+struct Bench {
+    char const *name;
+    void (*run)();
+};
+/* TLSF (two-level segregated fit) placement over the same address space as
+ * gpuLib::Alloc, for comparing their fragmentation: free ranges are binned
+ * by size (tlsfSubBins bins per power of 2), and an allocation takes a range
+ * from the first non-empty bin whose sizes are all large enough (a good fit,
+ * found in constant time, rather than the best fit). */
+static int const tlsfSubBins = 16;
+static int const tlsfBins = 29 * tlsfSubBins;
+class TlsfAlloc {
+   private:
+    uint32_t _capacity;
+    uint32_t _used;
+    int _allocs;
+    /* Free ranges, by offset (offset to size). */
+    std::map<uint32_t, uint32_t> _byOffset;
+    /* Free range offsets of each bin, and the non-empty bins. */
+    std::set<uint32_t> _bins[tlsfBins];
+    std::set<int> _nonEmpty;
+
+    /* Finds the bin of a size. */
+    static int _bin(uint32_t size);
+    void _addFree(uint32_t offset, uint32_t size);
+    void _removeFree(uint32_t offset, uint32_t size);
+
+   public:
+    TlsfAlloc(uint32_t capacity);
+    /* As gpuLib::Alloc's. */
+    uint32_t alloc(uint32_t size);
+    void free(uint32_t offset, uint32_t size);
+    gpuLib::AllocStats stats();
+};
+
+// Define functions
+/* Finds whether the benchmark is selected by the command line. */
+static bool selected(char const *, int, char **);
+/* Reads a monotonic clock (unit: seconds). */
+static double now();
+/* Shows a benchmark result line in stdout. */
+static void showResult(char const *, char const *, long, double);
+/* Finds whether two matrices are equal within a relative tolerance per
+ * element (of the larger magnitude, at least 1). */
+static bool mappingsClose(glm::mat4 const &, glm::mat4 const &, float);
+/* Compares the runtime and fixed pipelines on the per-object hot path. */
+static void benchPipeline();
+/* Churns the GPU offset allocator with mesh-sized allocations and frees,
+ * with room to spare and near full, against TLSF placement. */
+static void benchAlloc();
+/* Churns an allocator of a capacity, and shows the time and fragmentation. */
+template <class A>
+static void churnAlloc(A &, char const *, char const *);
+/* Compares the scalar and AVX2 occluder rasterization kernels on one thread
+ * (from empty tiles each round), times the occludee tests, and counts their
+ * heap allocations. */
+static void benchOccl();
+/* Compares the scalar and AVX2 software rendering kernels on a generated
+ * scene. */
+static void benchSoft();
+/* Times the BVH build, refit, and queries over the triangles of a generated
+ * scene, against brute force rays. */
+static void benchBvh();
+/* Times picking at random screen positions of a generated scene, and checks
+ * the picks against brute force. */
+static void benchPick();
+/* Moves 100K objects every frame in the hashed grid, compared with BVH
+ * rebuilds, and times its queries. */
+static void benchGrid();
+/* Times the camera collider's moves through a generated scene, and checks
+ * against brute force that the moves' segments stay a radius away from the
+ * triangles. */
+static void benchCollide();
+/* Finds the point of a triangle nearest to a point. */
+static glm::vec3 closestOnTri(glm::vec3, glm::vec3, glm::vec3, glm::vec3);
+/* Finds the squared distance between two segments. */
+static float segSegDistSq(glm::vec3, glm::vec3, glm::vec3, glm::vec3);
+/* Finds the squared distance between a segment and a triangle. */
+static float segTriDistSq(glm::vec3, glm::vec3, glm::vec3, glm::vec3,
+                          glm::vec3);
+/* Compares the CPU side of the direct and indirect submissions of 10K and
+ * 100K objects (the GL calls are stood in for, so no driver time), and
+ * counts their GL calls per frame. */
+static void benchSubmit();
+/* Stands in for a GL call that takes a copy of its arguments. */
+static void glCall(void const *, size_t);
+/* Times the capture encoders on 1080p frames (in memory). */
+static void benchCapture();
+/* Builds and sorts a 100K draw list every frame, on the heap and from the
+ * frame arena, and counts the heap allocations per frame. */
+static void benchFrame();
+/* Plans a render graph (culled, reordered, and aliased), checks its
+ * decisions, and times planning it again. */
+static void benchGraph();
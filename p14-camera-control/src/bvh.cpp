@@ -0,0 +1,497 @@
+/* File name: bvh.cpp
+ *
+ * Intro:
+ * C++ implementation of the bounding volume hierarchy custom library. */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#include "bvh.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+/* Largest SAH bin count per axis (small ranges use one bin per primitive). */
+static int const binMax = 16;
+/* Splits deeper than this use the median, so the depth stays bounded. */
+static int const sahMaxDepth = 64;
+/* Smallest primitive count of a range binned in parallel. */
+static int const parallelMin = 1024;
+
+/* SAH bin. */
+struct SahBin {
+    BvhBox box;
+    int count;
+};
+
+/* Reads a monotonic clock (unit: milliseconds). */
+static double nowMs() {
+    auto t = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration<double, std::milli>(t).count();
+}
+
+/* Initializes an empty box (that grows to any box). */
+static BvhBox emptyBox() {
+    float inf = std::numeric_limits<float>::infinity();
+    BvhBox box;
+    box.lo = glm::vec3(inf, inf, inf);
+    box.hi = glm::vec3(-inf, -inf, -inf);
+    return box;
+}
+
+/* Grows a box to contain another box. */
+static void growBox(BvhBox &box, BvhBox const &other) {
+    box.lo = glm::min(box.lo, other.lo);
+    box.hi = glm::max(box.hi, other.hi);
+}
+
+/* Finds half the surface area of a box (0 if it is empty). */
+static float halfArea(BvhBox const &box) {
+    glm::vec3 size = glm::max(box.hi - box.lo, glm::vec3(0.0f, 0.0f, 0.0f));
+    return size.x * size.y + size.y * size.z + size.z * size.x;
+}
+
+/* Finds the bin of a center. */
+static int binOf(float center, float lo, float scale, int binCount) {
+    int bin = (int)((center - lo) * scale);
+    return bin < 0 ? 0 : (bin < binCount ? bin : binCount - 1);
+}
+
+/* Finds whether a box is entirely inside a frustum. */
+static bool boxInside(Frustum &frustum, glm::vec3 lo, glm::vec3 hi) {
+    for (int i = 0; i < 6; i += 1) {
+        // The corner farthest behind the plane
+        glm::vec4 plane = frustum.plane(i);
+        glm::vec3 corner;
+        for (int j = 0; j < 3; j += 1) {
+            corner[j] = plane[j] > 0.0f ? lo[j] : hi[j];
+        }
+        if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+Bvh::Bvh() {
+    _leafSize = 4;
+    _stats.nodes = 0;
+    _stats.leaves = 0;
+    _stats.depth = 0;
+    _stats.subtrees = 0;
+    _stats.buildMs = 0.0;
+    _stats.refitMs = 0.0;
+}
+
+int Bvh::leafSize() {
+    return _leafSize;
+}
+
+int Bvh::leafSize(int newVal) {
+    int oldVal = _leafSize;
+    _leafSize = newVal > 1 ? newVal : 1;
+    return oldVal;
+}
+
+bool Bvh::_findSplit(int begin, int end, Jobs *jobs, Split &split) {
+    // Bounds of the centers
+    BvhBox bounds = emptyBox();
+    for (int i = begin; i < end; i += 1) {
+        glm::vec3 center = _refs[i].center;
+        bounds.lo = glm::min(bounds.lo, center);
+        bounds.hi = glm::max(bounds.hi, center);
+    }
+    glm::vec3 extent = bounds.hi - bounds.lo;
+    split.axis = 0;
+    for (int axis = 1; axis < 3; axis += 1) {
+        split.axis = extent[axis] > extent[split.axis] ? axis : split.axis;
+    }
+    if (extent[split.axis] <= 0.0f) {
+        return false;
+    }
+
+    // Bin the primitives on each axis (per worker with jobs)
+    int binCount = end - begin < binMax ? end - begin : binMax;
+    int binSets = jobs != nullptr ? jobs->threadCount() : 1;
+    std::vector<SahBin> bins(binSets * 3 * binCount);
+    for (SahBin &bin : bins) {
+        bin.box = emptyBox();
+        bin.count = 0;
+    }
+    glm::vec3 scale;
+    for (int axis = 0; axis < 3; axis += 1) {
+        float size = extent[axis];
+        scale[axis] = size > 0.0f ? (float)binCount / size : 0.0f;
+    }
+    auto binRange = [&](int first, int last, int worker) {
+        SahBin *workerBins = &bins[worker * 3 * binCount];
+        for (int i = first; i < last; i += 1) {
+            Ref const &ref = _refs[begin + i];
+            glm::vec3 center = ref.center;
+            for (int axis = 0; axis < 3; axis += 1) {
+                float lo = bounds.lo[axis];
+                int bin = binOf(center[axis], lo, scale[axis], binCount);
+                SahBin &target = workerBins[axis * binCount + bin];
+                growBox(target.box, ref.box);
+                target.count += 1;
+            }
+        }
+    };
+    if (jobs != nullptr) {
+        jobs->parallelFor(end - begin, 4096, binRange);
+        for (int w = 1; w < binSets; w += 1) {
+            for (int j = 0; j < 3 * binCount; j += 1) {
+                growBox(bins[j].box, bins[w * 3 * binCount + j].box);
+                bins[j].count += bins[w * 3 * binCount + j].count;
+            }
+        }
+    } else {
+        binRange(0, end - begin, 0);
+    }
+
+    // Sweep the planes between the bins; cost = sum of area * count
+    float bestCost = std::numeric_limits<float>::infinity();
+    split.bin = -1;
+    for (int axis = 0; axis < 3; axis += 1) {
+        SahBin *axisBins = &bins[axis * binCount];
+        float rightCosts[binMax];
+        BvhBox right = emptyBox();
+        int rightCount = 0;
+        for (int i = binCount - 1; i > 0; i -= 1) {
+            growBox(right, axisBins[i].box);
+            rightCount += axisBins[i].count;
+            rightCosts[i] = halfArea(right) * (float)rightCount;
+        }
+        BvhBox left = emptyBox();
+        int leftCount = 0;
+        for (int i = 0; i + 1 < binCount; i += 1) {
+            growBox(left, axisBins[i].box);
+            leftCount += axisBins[i].count;
+            int rest = end - begin - leftCount;
+            if (leftCount == 0 or rest == 0) {
+                continue;
+            }
+            float cost = halfArea(left) * (float)leftCount + rightCosts[i + 1];
+            if (cost < bestCost) {
+                bestCost = cost;
+                split.axis = axis;
+                split.bin = i;
+                split.lo = bounds.lo[axis];
+                split.scale = scale[axis];
+                split.binCount = binCount;
+            }
+        }
+    }
+    return split.bin >= 0;
+}
+
+int Bvh::_partition(Task const &task, Jobs *jobs) {
+    Split split;
+    if (task.depth < sahMaxDepth and
+        _findSplit(task.begin, task.end, jobs, split)) {
+        auto first = _refs.begin() + task.begin;
+        auto last = _refs.begin() + task.end;
+        auto mid = std::partition(first, last, [&](Ref const &ref) {
+            float center = ref.center[split.axis];
+            int bin = binOf(center, split.lo, split.scale, split.binCount);
+            return bin <= split.bin;
+        });
+        return (int)(mid - _refs.begin());
+    }
+
+    // Median split on the longest axis (any split if the centers coincide)
+    int axis = split.axis;
+    int mid = (task.begin + task.end) / 2;
+    // clang-format off
+    std::nth_element(
+        _refs.begin() + task.begin, _refs.begin() + mid,
+        _refs.begin() + task.end,
+        [&](Ref const &a, Ref const &b) {
+            return a.center[axis] < b.center[axis];
+        }
+    );
+    // clang-format on
+    return mid;
+}
+
+void Bvh::_buildSubtree(Task const &task, std::vector<BvhNode> &nodes) {
+    nodes.clear();
+    nodes.push_back(BvhNode());
+    std::vector<Task> stack;
+    Task root = task;
+    root.node = 0;
+    stack.push_back(root);
+    while (!stack.empty()) {
+        Task current = stack.back();
+        stack.pop_back();
+        int count = current.end - current.begin;
+        if (count <= _leafSize) {
+            nodes[current.node].first = (uint32_t)current.begin;
+            nodes[current.node].count = (uint32_t)count;
+            continue;
+        }
+
+        int mid = _partition(current, nullptr);
+        int left = (int)nodes.size();
+        nodes.push_back(BvhNode());
+        nodes.push_back(BvhNode());
+        nodes[current.node].first = (uint32_t)left;
+        nodes[current.node].count = 0;
+        stack.push_back({left + 1, mid, current.end, current.depth + 1});
+        stack.push_back({left, current.begin, mid, current.depth + 1});
+    }
+}
+
+void Bvh::_fit() {
+    // Children come after their parents, so a backward pass sees them first
+    for (int i = (int)_nodes.size() - 1; i >= 0; i -= 1) {
+        BvhNode &node = _nodes[i];
+        BvhBox box = emptyBox();
+        if (node.count > 0) {
+            for (uint32_t j = 0; j < node.count; j += 1) {
+                growBox(box, _boxes[_prims[node.first + j]]);
+            }
+        } else {
+            for (int j = 0; j < 2; j += 1) {
+                BvhNode const &child = _nodes[node.first + j];
+                BvhBox childBox;
+                childBox.lo = glm::vec3(child.lo[0], child.lo[1], child.lo[2]);
+                childBox.hi = glm::vec3(child.hi[0], child.hi[1], child.hi[2]);
+                growBox(box, childBox);
+            }
+        }
+        for (int j = 0; j < 3; j += 1) {
+            node.lo[j] = box.lo[j];
+            node.hi[j] = box.hi[j];
+        }
+    }
+}
+
+void Bvh::build(std::vector<BvhBox> const &boxes, Jobs &jobs) {
+    double start = nowMs();
+
+    int count = (int)boxes.size();
+    _boxes = boxes;
+    _refs.resize(count);
+    for (int i = 0; i < count; i += 1) {
+        _refs[i].center = (boxes[i].lo + boxes[i].hi) * 0.5f;
+        _refs[i].box = boxes[i];
+        _refs[i].prim = i;
+    }
+    _nodes.clear();
+    _prims.clear();
+    _stats.subtrees = 0;
+    if (count == 0) {
+        _stats.nodes = 0;
+        _stats.leaves = 0;
+        _stats.depth = 0;
+        _stats.buildMs = nowMs() - start;
+        return;
+    }
+
+    // Split the large ranges near the root with parallel binning, until
+    // there are enough subtrees to keep the workers busy
+    int subtreeMax = count / (jobs.threadCount() * 8);
+    subtreeMax = subtreeMax > parallelMin ? subtreeMax : parallelMin;
+    std::vector<Task> pending;
+    std::vector<Task> subtrees;
+    _nodes.push_back(BvhNode());
+    pending.push_back({0, 0, count, 0});
+    while (!pending.empty()) {
+        Task task = pending.back();
+        pending.pop_back();
+        if (task.end - task.begin <= subtreeMax) {
+            subtrees.push_back(task);
+            continue;
+        }
+        int mid = _partition(task, &jobs);
+        int left = (int)_nodes.size();
+        _nodes.push_back(BvhNode());
+        _nodes.push_back(BvhNode());
+        _nodes[task.node].first = (uint32_t)left;
+        _nodes[task.node].count = 0;
+        pending.push_back({left + 1, mid, task.end, task.depth + 1});
+        pending.push_back({left, task.begin, mid, task.depth + 1});
+    }
+
+    // Build the subtrees in parallel; they own disjoint primitive ranges
+    int subtreeCount = (int)subtrees.size();
+    std::vector<std::vector<BvhNode>> subtreeNodes(subtreeCount);
+    // clang-format off
+    jobs.parallelFor(subtreeCount, 1, [&](int begin, int end, int worker) {
+        for (int i = begin; i < end; i += 1) {
+            _buildSubtree(subtrees[i], subtreeNodes[i]);
+        }
+    });
+    // clang-format on
+
+    // Splice the subtrees in; each root replaces its task's node
+    for (int i = 0; i < subtreeCount; i += 1) {
+        std::vector<BvhNode> &nodes = subtreeNodes[i];
+        uint32_t base = (uint32_t)_nodes.size();
+        for (BvhNode &node : nodes) {
+            if (node.count == 0) {
+                node.first = base + node.first - 1;
+            }
+        }
+        _nodes[subtrees[i].node] = nodes[0];
+        _nodes.insert(_nodes.end(), nodes.begin() + 1, nodes.end());
+    }
+    _stats.subtrees = subtreeCount;
+
+    // The leaves index the primitives in the references' final order
+    _prims.resize(count);
+    for (int i = 0; i < count; i += 1) {
+        _prims[i] = _refs[i].prim;
+    }
+    std::vector<Ref>().swap(_refs);
+    _fit();
+
+    // Depths follow the parents, which come first
+    std::vector<int> depths(_nodes.size(), 0);
+    _stats.nodes = (int)_nodes.size();
+    _stats.leaves = 0;
+    _stats.depth = 0;
+    for (size_t i = 0; i < _nodes.size(); i += 1) {
+        BvhNode const &node = _nodes[i];
+        if (node.count > 0) {
+            _stats.leaves += 1;
+            _stats.depth = depths[i] > _stats.depth ? depths[i] : _stats.depth;
+        } else {
+            depths[node.first] = depths[i] + 1;
+            depths[node.first + 1] = depths[i] + 1;
+        }
+    }
+    _stats.buildMs = nowMs() - start;
+}
+
+void Bvh::refit(std::vector<BvhBox> const &boxes) {
+    double start = nowMs();
+    _boxes = boxes;
+    _fit();
+    _stats.refitMs = nowMs() - start;
+}
+
+void Bvh::box(glm::vec3 lo, glm::vec3 hi, std::vector<int> &result) {
+    if (_nodes.empty()) {
+        return;
+    }
+    int stack[stackSize];
+    int top = 0;
+    stack[top] = 0;
+    top += 1;
+    while (top > 0) {
+        top -= 1;
+        BvhNode const &node = _nodes[stack[top]];
+        bool overlaps = true;
+        for (int i = 0; i < 3; i += 1) {
+            overlaps = overlaps and node.lo[i] <= hi[i] and lo[i] <= node.hi[i];
+        }
+        if (!overlaps) {
+            continue;
+        }
+        if (node.count == 0) {
+            stack[top] = (int)node.first;
+            stack[top + 1] = (int)node.first + 1;
+            top += 2;
+            continue;
+        }
+        for (uint32_t i = 0; i < node.count; i += 1) {
+            int prim = _prims[node.first + i];
+            BvhBox const &primBox = _boxes[prim];
+            bool primOverlaps = true;
+            for (int j = 0; j < 3; j += 1) {
+                primOverlaps = primOverlaps and primBox.lo[j] <= hi[j] and
+                               lo[j] <= primBox.hi[j];
+            }
+            if (primOverlaps) {
+                result.push_back(prim);
+            }
+        }
+    }
+}
+
+void Bvh::frustum(Frustum &frustum, std::vector<int> &result) {
+    if (_nodes.empty()) {
+        return;
+    }
+    int stack[stackSize];
+    int top = 0;
+    stack[top] = 0;
+    top += 1;
+    while (top > 0) {
+        top -= 1;
+        BvhNode const &node = _nodes[stack[top]];
+        glm::vec3 lo(node.lo[0], node.lo[1], node.lo[2]);
+        glm::vec3 hi(node.hi[0], node.hi[1], node.hi[2]);
+        if (!frustum.box(lo, hi)) {
+            continue;
+        }
+        if (boxInside(frustum, lo, hi)) {
+            // A subtree's primitives are contiguous, from its leftmost leaf
+            // to its rightmost leaf
+            BvhNode const *first = &node;
+            BvhNode const *last = &node;
+            while (first->count == 0) {
+                first = &_nodes[first->first];
+            }
+            while (last->count == 0) {
+                last = &_nodes[last->first + 1];
+            }
+            auto begin = _prims.begin() + first->first;
+            auto end = _prims.begin() + last->first + last->count;
+            result.insert(result.end(), begin, end);
+            continue;
+        }
+        if (node.count == 0) {
+            stack[top] = (int)node.first;
+            stack[top + 1] = (int)node.first + 1;
+            top += 2;
+            continue;
+        }
+        for (uint32_t i = 0; i < node.count; i += 1) {
+            int prim = _prims[node.first + i];
+            if (frustum.box(_boxes[prim].lo, _boxes[prim].hi)) {
+                result.push_back(prim);
+            }
+        }
+    }
+}
+
+std::vector<BvhNode> &Bvh::nodes() {
+    return _nodes;
+}
+
+std::vector<int> &Bvh::prims() {
+    return _prims;
+}
+
+BvhStats Bvh::stats() {
+    return _stats;
+}
+
+bool bvhRayTri(glm::vec3 origin, glm::vec3 dir, glm::vec3 a, glm::vec3 b,
+               glm::vec3 c, float &t) {
+    glm::vec3 edge1 = b - a;
+    glm::vec3 edge2 = c - a;
+    glm::vec3 p = glm::cross(dir, edge2);
+    float det = glm::dot(edge1, p);
+    if (std::fabs(det) < 1e-12f) {
+        return false;
+    }
+    float invDet = 1.0f / det;
+    glm::vec3 s = origin - a;
+    float u = glm::dot(s, p) * invDet;
+    if (u < 0.0f or u > 1.0f) {
+        return false;
+    }
+    glm::vec3 q = glm::cross(s, edge1);
+    float v = glm::dot(dir, q) * invDet;
+    if (v < 0.0f or u + v > 1.0f) {
+        return false;
+    }
+    t = glm::dot(edge2, q) * invDet;
+    return t >= 0.0f;
+}
@@ -0,0 +1,242 @@
+/* File name: bvh.hpp
+ *
+ * Intro:
+ * C++ header of the bounding volume hierarchy custom library.
+ * A binary tree of axis-aligned boxes over primitives given by their boxes
+ * (scene objects, or the triangles of a mesh). It is built top-down with the
+ * binned surface area heuristic (SAH): the large nodes near the root are
+ * binned in parallel, then the remaining subtrees are built in parallel, one
+ * per job. When the primitives move without changing the tree's topology, the
+ * node boxes are refit bottom-up instead of rebuilt. The ray, frustum, and box
+ * queries only visit the nodes that they touch.
+ *
+ * References:
+ * 1. I. Wald, "On fast construction of SAH-based bounding volume
+ *    hierarchies," in Proc. IEEE Symp. Interactive Ray Tracing, 2007.
+ * 2. T. Moller and B. Trumbore, "Fast, minimum storage ray-triangle
+ *    intersection," J. Graphics Tools, vol. 2, no. 1, 1997.
+ *
+ * Dependencies:
+ * 1. GLM library (libglm-dev)
+ * 2. The job system custom library (jobs.hpp)
+ * 3. The view frustum custom library (frustum.hpp) */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#ifndef BVH_HPP
+#define BVH_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/ext.hpp>
+
+#include "jobs.hpp"
+#include "frustum.hpp"
+
+/* Axis-aligned box. */
+struct BvhBox {
+    glm::vec3 lo;
+    glm::vec3 hi;
+};
+
+/* BVH node (32 bytes).
+ * Inner nodes have count 0, and their children are the nodes first and
+ * first + 1. Leaves hold the primitives prims[first, first + count) of the
+ * BVH. Children always come after their parents. */
+struct BvhNode {
+    float lo[3];
+    uint32_t first;
+    float hi[3];
+    uint32_t count;
+};
+
+static_assert(sizeof(BvhNode) == 32, "BvhNode must be 32 bytes");
+
+/* BVH statistics. */
+struct BvhStats {
+    /* Nodes. */
+    int nodes;
+    /* Leaves. */
+    int leaves;
+    /* Largest leaf depth (the root's depth is 0). */
+    int depth;
+    /* Subtrees built in parallel by the last build. */
+    int subtrees;
+    /* Last build time (unit: milliseconds). */
+    double buildMs;
+    /* Last refit time (unit: milliseconds). */
+    double refitMs;
+};
+
+/* Bvh (Bounding volume hierarchy). */
+class Bvh {
+   private:
+    /* Range of primitives still to be split, and its node. */
+    struct Task {
+        int node;
+        int begin;
+        int end;
+        int depth;
+    };
+
+    /* Split plane: the primitives whose centers fall in the bins up to bin
+     * (of binCount bins over lo + [0, binCount / scale)) on the axis go to
+     * the first child. */
+    struct Split {
+        int axis;
+        int bin;
+        int binCount;
+        float lo;
+        float scale;
+    };
+
+    /* Primitive reference of the build; the references are partitioned
+     * in place, so the boxes stay in cache. */
+    struct Ref {
+        glm::vec3 center;
+        BvhBox box;
+        int prim;
+    };
+
+    std::vector<BvhNode> _nodes;
+    /* Primitive indices, in leaf order. */
+    std::vector<int> _prims;
+    /* Primitive boxes, in primitive order. */
+    std::vector<BvhBox> _boxes;
+    /* Primitive references, in leaf order (only during the build). */
+    std::vector<Ref> _refs;
+    /* Largest primitive count of a leaf. */
+    int _leafSize;
+    BvhStats _stats;
+
+    /* Finds the binned SAH split of the primitives [begin, end); returns
+     * false if their centers all fall in one bin (split.axis is still the
+     * longest axis). With jobs, the binning runs in parallel. */
+    bool _findSplit(int begin, int end, Jobs *jobs, Split &split);
+    /* Partitions the primitives of a task in place; returns where the second
+     * child's primitives begin. */
+    int _partition(Task const &task, Jobs *jobs);
+    /* Builds the subtree of a task into nodes (its root is nodes[0]). */
+    void _buildSubtree(Task const &task, std::vector<BvhNode> &nodes);
+    /* Fits the node boxes bottom-up to the primitive boxes. */
+    void _fit();
+
+   public:
+    /* Traversal stack size (deeper splits fall back to median splits). */
+    static int const stackSize = 128;
+
+    /* Initializes an empty BVH. Leaves hold up to 4 primitives. */
+    Bvh();
+    /* Reads the largest primitive count of a leaf. */
+    int leafSize();
+    /* Reads and updates the largest primitive count of a leaf (takes effect
+     * at the next build). */
+    int leafSize(int newVal);
+    /* Builds the BVH over the primitives' boxes. */
+    void build(std::vector<BvhBox> const &boxes, Jobs &jobs);
+    /* Refits the node boxes to moved primitives; boxes must hold the same
+     * primitives in the same order as at the build. */
+    void refit(std::vector<BvhBox> const &boxes);
+    /* Finds the primitives whose boxes overlap a box. The primitives are
+     * appended to result, in no particular order. */
+    void box(glm::vec3 lo, glm::vec3 hi, std::vector<int> &result);
+    /* Finds the primitives whose boxes touch a frustum (conservative). The
+     * primitives are appended to result, in no particular order. */
+    void frustum(Frustum &frustum, std::vector<int> &result);
+    /* Finds the closest hit of a ray along dir (need not be normalized) from
+     * origin, up to the distance tMax (unit: lengths of dir). For each
+     * primitive whose box the ray enters before the closest hit so far,
+     * hit(prim, tMax) is called; it returns the primitive's hit distance if
+     * it is below tMax, or tMax otherwise. Returns the closest hit distance,
+     * or tMax if nothing is hit. */
+    template <class Hit>
+    float ray(glm::vec3 origin, glm::vec3 dir, float tMax, Hit const &hit);
+    /* Reads the nodes' reference (the root is node 0). */
+    std::vector<BvhNode> &nodes();
+    /* Reads the primitive indices' reference, in leaf order. */
+    std::vector<int> &prims();
+    /* Reads the statistics. */
+    BvhStats stats();
+};
+
+/* Finds where a ray enters a node's box; returns false if it misses the box
+ * or enters it beyond tMax. invDir: the reciprocals of the ray direction. */
+inline bool bvhRayBox(BvhNode const &node, glm::vec3 origin, glm::vec3 invDir,
+                      float tMax, float &tEnter) {
+    float t0 = 0.0f;
+    float t1 = tMax;
+    for (int i = 0; i < 3; i += 1) {
+        float tNear = (node.lo[i] - origin[i]) * invDir[i];
+        float tFar = (node.hi[i] - origin[i]) * invDir[i];
+        if (tNear > tFar) {
+            float tSwap = tNear;
+            tNear = tFar;
+            tFar = tSwap;
+        }
+        // NaNs (from a zero direction on a box face) keep the old bounds
+        t0 = tNear > t0 ? tNear : t0;
+        t1 = tFar < t1 ? tFar : t1;
+    }
+    tEnter = t0;
+    return t0 <= t1;
+}
+
+/* Finds the hit distance t of a ray on a triangle (both sides); returns false
+ * if the ray misses it. */
+bool bvhRayTri(glm::vec3 origin, glm::vec3 dir, glm::vec3 a, glm::vec3 b,
+               glm::vec3 c, float &t);
+
+template <class Hit>
+float Bvh::ray(glm::vec3 origin, glm::vec3 dir, float tMax, Hit const &hit) {
+    if (_nodes.empty()) {
+        return tMax;
+    }
+    glm::vec3 invDir = 1.0f / dir;
+    float tEnter;
+    if (!bvhRayBox(_nodes[0], origin, invDir, tMax, tEnter)) {
+        return tMax;
+    }
+
+    // The build keeps the depth below stackSize
+    int stack[stackSize];
+    int top = 0;
+    stack[top] = 0;
+    top += 1;
+    while (top > 0) {
+        top -= 1;
+        BvhNode const &node = _nodes[stack[top]];
+        if (node.count > 0) {
+            for (uint32_t i = 0; i < node.count; i += 1) {
+                tMax = hit(_prims[node.first + i], tMax);
+            }
+            continue;
+        }
+
+        // Visit the nearer child first, so far nodes are often skipped
+        float tLeft;
+        float tRight;
+        int left = (int)node.first;
+        int right = left + 1;
+        bool hitLeft = bvhRayBox(_nodes[left], origin, invDir, tMax, tLeft);
+        bool hitRight = bvhRayBox(_nodes[right], origin, invDir, tMax, tRight);
+        if (hitLeft and hitRight and tRight < tLeft) {
+            stack[top] = left;
+            stack[top + 1] = right;
+            top += 2;
+        } else if (hitLeft and hitRight) {
+            stack[top] = right;
+            stack[top + 1] = left;
+            top += 2;
+        } else if (hitLeft or hitRight) {
+            stack[top] = hitLeft ? left : right;
+            top += 1;
+        }
+    }
+    return tMax;
+}
+
+// BVH_HPP
+#endif
@@ -0,0 +1,279 @@
+/* File name: collide.cpp
+ *
+ * Intro:
+ * C++ implementation of the cam (Camera) libraries' collide (Collision)
+ * module. */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#include "collide.hpp"
+#include "../scene.hpp"
+
+#include <chrono>
+#include <cmath>
+
+/* Slide iterations per movement. */
+static int const maxIterations = 4;
+/* Gap kept between the sphere and the surfaces (unit: radii). */
+static float const skin = 0.005f;
+
+/* Finds the first time in (0, maxRoot) at which a * t^2 + b * t + c, the
+ * squared distance to a feature minus 1, reaches 0; returns false if there is
+ * none. A sphere that already overlaps the feature hits it at 0 if it moves
+ * in deeper, and is free to move out. */
+static bool lowestRoot(float a, float b, float c, float maxRoot, float &root) {
+    if (c < 0.0f) {
+        root = 0.0f;
+        return b < 0.0f;
+    }
+    float det = b * b - 4.0f * a * c;
+    if (det < 0.0f or a == 0.0f) {
+        return false;
+    }
+    float sqrtDet = std::sqrt(det);
+    // a > 0, so the smaller root is the first touch
+    float r1 = (-b - sqrtDet) / (2.0f * a);
+    if (r1 > 0.0f and r1 < maxRoot) {
+        root = r1;
+        return true;
+    }
+    return false;
+}
+
+/* Finds whether a point on a triangle's plane is inside the triangle. */
+static bool insideTri(glm::vec3 p, glm::vec3 a, glm::vec3 b, glm::vec3 c) {
+    glm::vec3 n = glm::cross(b - a, c - a);
+    float ab = glm::dot(glm::cross(b - a, p - a), n);
+    float bc = glm::dot(glm::cross(c - b, p - b), n);
+    float ca = glm::dot(glm::cross(a - c, p - c), n);
+    return ab >= 0.0f and bc >= 0.0f and ca >= 0.0f;
+}
+
+namespace camLib {
+
+Collider::Collider() {
+    _scene = nullptr;
+    _objBvh = nullptr;
+    _radius = 0.25f;
+    _stats.iterations = 0;
+    _stats.objs = 0;
+    _stats.tested = 0;
+    _stats.hit = false;
+    _stats.us = 0.0;
+}
+
+float Collider::radius() {
+    return _radius;
+}
+
+float Collider::radius(float newVal) {
+    float oldVal = _radius;
+    _radius = newVal;
+    return oldVal;
+}
+
+void Collider::attach(Scene &scene, Bvh &objBvh) {
+    _scene = &scene;
+    _objBvh = &objBvh;
+}
+
+void Collider::_findTris(glm::vec3 lo, glm::vec3 hi) {
+    _verts.clear();
+    _objs.clear();
+    _objBvh->box(lo, hi, _objs);
+    _stats.objs += (int)_objs.size();
+    for (int obj : _objs) {
+        Obj &object = _scene->objs()[obj];
+        Mesh &mesh = _scene->meshes()[object.mesh];
+        std::vector<glm::vec3> &positions = mesh.positions();
+        std::vector<unsigned int> &indices = mesh.indices();
+        glm::mat4 world = object.trans.world();
+        glm::mat4 inv = glm::inverse(world);
+
+        // The object space box around the world space box's corners
+        glm::vec3 objLo(1e30f, 1e30f, 1e30f);
+        glm::vec3 objHi(-1e30f, -1e30f, -1e30f);
+        for (int i = 0; i < 8; i += 1) {
+            float x = (i & 1) ? hi.x : lo.x;
+            float y = (i & 2) ? hi.y : lo.y;
+            float z = (i & 4) ? hi.z : lo.z;
+            glm::vec3 corner = glm::vec3(inv * glm::vec4(x, y, z, 1.0f));
+            objLo = glm::min(objLo, corner);
+            objHi = glm::max(objHi, corner);
+        }
+        _tris.clear();
+        _scene->meshBvhs()[object.mesh].box(objLo, objHi, _tris);
+        for (int tri : _tris) {
+            for (int i = 0; i < 3; i += 1) {
+                glm::vec3 pos = positions[indices[tri * 3 + i]];
+                _verts.push_back(glm::vec3(world * glm::vec4(pos, 1.0f)));
+            }
+        }
+    }
+}
+
+void Collider::_sweepTri(glm::vec3 base, glm::vec3 vel, glm::vec3 const *tri,
+                         float &t, glm::vec3 &point) {
+    // In radius units, so the sphere is a unit sphere
+    float invRadius = 1.0f / _radius;
+    glm::vec3 p[3];
+    for (int i = 0; i < 3; i += 1) {
+        p[i] = tri[i] * invRadius;
+    }
+    glm::vec3 n = glm::cross(p[1] - p[0], p[2] - p[0]);
+    float nLen = glm::length(n);
+    if (nLen == 0.0f) {
+        return;
+    }
+    n /= nLen;
+
+    // Both sides collide; face the plane towards the sphere
+    float dist = glm::dot(n, base - p[0]);
+    if (dist < 0.0f) {
+        n = -n;
+        dist = -dist;
+    }
+    float nDotVel = glm::dot(n, vel);
+
+    // The face: where the sphere first touches the plane. Moving away from or
+    // along the plane never reaches it
+    if (dist >= 1.0f) {
+        if (nDotVel >= 0.0f) {
+            return;
+        }
+        float t0 = (1.0f - dist) / nDotVel;
+        // Nothing on the plane is touched before the plane itself
+        if (t0 >= t) {
+            return;
+        }
+        glm::vec3 onPlane = base + vel * t0 - n;
+        if (insideTri(onPlane, p[0], p[1], p[2])) {
+            t = t0;
+            point = onPlane * _radius;
+            return;
+        }
+    } else if (nDotVel < 0.0f) {
+        // Already touching the plane, and moving deeper
+        glm::vec3 onPlane = base - n * dist;
+        if (insideTri(onPlane, p[0], p[1], p[2])) {
+            t = 0.0f;
+            point = onPlane * _radius;
+            return;
+        }
+    }
+
+    // The vertices and edges: the first time they are one radius away
+    float velSq = glm::dot(vel, vel);
+    float tHit = t;
+    bool hit = false;
+    glm::vec3 hitPoint;
+    for (int i = 0; i < 3; i += 1) {
+        float a = velSq;
+        float b = 2.0f * glm::dot(vel, base - p[i]);
+        float c = glm::dot(p[i] - base, p[i] - base) - 1.0f;
+        float root;
+        if (lowestRoot(a, b, c, tHit, root)) {
+            tHit = root;
+            hit = true;
+            hitPoint = p[i];
+        }
+    }
+    for (int i = 0; i < 3; i += 1) {
+        glm::vec3 edge = p[(i + 1) % 3] - p[i];
+        glm::vec3 toVertex = p[i] - base;
+        float edgeSq = glm::dot(edge, edge);
+        float edgeDotVel = glm::dot(edge, vel);
+        float edgeDotTo = glm::dot(edge, toVertex);
+        float toSq = glm::dot(toVertex, toVertex);
+        // The squared distance to the edge's line, times edgeSq
+        float a = edgeSq * velSq - edgeDotVel * edgeDotVel;
+        float b = 2.0f * (edgeDotVel * edgeDotTo -
+                          edgeSq * glm::dot(vel, toVertex));
+        float c = edgeSq * (toSq - 1.0f) - edgeDotTo * edgeDotTo;
+        float root;
+        if (lowestRoot(a, b, c, tHit, root)) {
+            // Only the part of the line between the vertices
+            float f = (edgeDotVel * root - edgeDotTo) / edgeSq;
+            if (f >= 0.0f and f <= 1.0f) {
+                tHit = root;
+                hit = true;
+                hitPoint = p[i] + edge * f;
+            }
+        }
+    }
+    if (hit) {
+        t = tHit;
+        point = hitPoint * _radius;
+    }
+}
+
+glm::vec3 Collider::move(glm::vec3 pos, glm::vec3 step) {
+    auto start = std::chrono::steady_clock::now();
+    _stats.iterations = 0;
+    _stats.objs = 0;
+    _stats.tested = 0;
+    _stats.hit = false;
+    if (_scene == nullptr) {
+        _stats.us = 0.0;
+        return pos + step;
+    }
+
+    float skinLen = skin * _radius;
+    for (int i = 0; i < maxIterations; i += 1) {
+        float stepLen = glm::length(step);
+        if (stepLen <= skinLen) {
+            break;
+        }
+        _stats.iterations += 1;
+
+        // The triangles the sphere may touch along this step
+        glm::vec3 reach(_radius, _radius, _radius);
+        glm::vec3 lo = glm::min(pos, pos + step) - reach;
+        glm::vec3 hi = glm::max(pos, pos + step) + reach;
+        _findTris(lo, hi);
+        int triCount = (int)_verts.size() / 3;
+        _stats.tested += triCount;
+
+        float t = 1.0f;
+        glm::vec3 point;
+        float invRadius = 1.0f / _radius;
+        for (int tri = 0; tri < triCount; tri += 1) {
+            glm::vec3 const *verts = &_verts[tri * 3];
+            _sweepTri(pos * invRadius, step * invRadius, verts, t, point);
+        }
+        if (t >= 1.0f) {
+            pos += step;
+            break;
+        }
+        _stats.hit = true;
+
+        // Stop just short of the contact
+        glm::vec3 dir = step / stepLen;
+        float travel = glm::max(stepLen * t - skinLen, 0.0f);
+        glm::vec3 contactPos = pos + dir * travel;
+
+        // Slide the rest of the step along the tangent plane at the contact
+        glm::vec3 normal = contactPos - point;
+        float normalLen = glm::length(normal);
+        if (normalLen == 0.0f) {
+            pos = contactPos;
+            break;
+        }
+        normal /= normalLen;
+        glm::vec3 rest = step * (1.0f - t);
+        step = rest - normal * glm::dot(rest, normal);
+        pos = contactPos;
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    std::chrono::duration<double, std::micro> elapsed = end - start;
+    _stats.us = elapsed.count();
+    return pos;
+}
+
+CollideStats Collider::stats() {
+    return _stats;
+}
+
+}  // namespace camLib
@@ -0,0 +1,103 @@
+/* File name: collide.hpp
+ *
+ * Intro:
+ * C++ header of the cam (Camera) libraries' collide (Collision) module.
+ * The camera is a sphere swept along each movement step. The triangles that
+ * the step's swept box touches are found in two levels, as picking's rays
+ * are (see ../pick.hpp): the objects' BVH finds the objects whose boxes it
+ * touches, and the box, mapped into each object's space through the inverse
+ * of its transformation, finds the triangles in the BVH of the object's
+ * mesh (the scene's, which picking shares). Only those triangles are moved
+ * to world space, where the sphere is swept against their faces, edges, and
+ * vertices; so the meshes are shared by their objects, and moving objects
+ * need no update here. On contact, the
+ * sphere stops just short of the contact point and the rest of the step
+ * slides along the contact's tangent plane, for a few iterations at most.
+ *
+ * References:
+ * 1. K. Fauerby, "Improved collision detection and response," 2003.
+ *
+ * Dependencies:
+ * 1. GLM library (libglm-dev)
+ * 2. The bounding volume hierarchy custom library (../bvh.hpp)
+ * 3. The scene libraries' main module (../scene.hpp) */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#ifndef CAM__COLLIDE_HPP
+#define CAM__COLLIDE_HPP
+
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/ext.hpp>
+
+#include "../bvh.hpp"
+
+// Forward declare Scene (from ../scene.hpp)
+class Scene;
+// Include ../scene.hpp in cam/collide.cpp to complete the declarations above
+
+/* Camera library */
+namespace camLib {
+
+/* Collision statistics (of the last movement). */
+struct CollideStats {
+    /* Slide iterations. */
+    int iterations;
+    /* Objects whose boxes the steps touched. */
+    int objs;
+    /* Triangles swept against. */
+    int tested;
+    /* Whether the movement hit anything. */
+    bool hit;
+    /* Movement time (unit: microseconds). */
+    double us;
+};
+
+/* Collision (of the camera). */
+class Collider {
+   private:
+    Scene *_scene;
+    /* BVH over the objects' world space boxes (in object order). */
+    Bvh *_objBvh;
+    /* Radius of the camera's sphere. */
+    float _radius;
+    /* Objects and mesh triangles found by the last queries. */
+    std::vector<int> _objs;
+    std::vector<int> _tris;
+    /* World space triangles of the step (3 vertices each). */
+    std::vector<glm::vec3> _verts;
+    CollideStats _stats;
+
+    /* Finds the world space triangles that a world space box touches. */
+    void _findTris(glm::vec3 lo, glm::vec3 hi);
+    /* Sweeps the unit sphere (in radius units) from base along vel against
+     * a world space triangle; updates t and point if it touches the
+     * triangle before t. */
+    void _sweepTri(glm::vec3 base, glm::vec3 vel, glm::vec3 const *tri,
+                   float &t, glm::vec3 &point);
+
+   public:
+    /* Initializes a collider with no scene. radius: 0.25. */
+    Collider();
+    /* Reads the radius of the camera's sphere. */
+    float radius();
+    /* Reads and updates the radius of the camera's sphere. */
+    float radius(float newVal);
+    /* Collides with the objects of a scene, whose mesh BVHs must be built.
+     * objBvh: the BVH over the objects' world space boxes (in object order),
+     * which the caller keeps up to date as the objects move. */
+    void attach(Scene &scene, Bvh &objBvh);
+    /* Moves the camera's sphere from pos by step; returns the position it
+     * reaches, sliding along the surfaces that it touches. */
+    glm::vec3 move(glm::vec3 pos, glm::vec3 step);
+    /* Reads the statistics. */
+    CollideStats stats();
+};
+
+}  // namespace camLib
+
+// CAM__COLLIDE_HPP
+#endif
@@ -8,6 +8,7 @@
 
 #include "ctrl.hpp"
 #include "../cam.hpp"
+#include "collide.hpp"
 
 namespace camLib {
 
@@ -15,6 +16,7 @@ Ctrl::Ctrl() {
     _enabled = false;
     _subject = nullptr;
     _moveStep = 1.0f;
+    _collider = nullptr;
 }
 
 bool Ctrl::enabled() {
@@ -47,6 +49,16 @@ float Ctrl::moveStep(float newVal) {
     return oldVal;
 }
 
+Collider *Ctrl::collider() {
+    return _collider;
+}
+
+Collider *Ctrl::collider(Collider *newVal) {
+    Collider *oldVal = _collider;
+    _collider = newVal;
+    return oldVal;
+}
+
 bool Ctrl::onKey(int key) {
     bool result;
 
@@ -82,30 +94,37 @@ bool Ctrl::onKey(int key) {
 
 // Implement action helper functions
 
+void Ctrl::_move(glm::vec3 step) {
+    glm::vec3 pos = _subject->pos();
+    glm::vec3 newPos;
+    if (_collider == nullptr) {
+        newPos = pos + step;
+    } else {
+        newPos = _collider->move(pos, step);
+    }
+    _subject->pos(newPos);
+}
+
 void Ctrl::_moveOn() {
     glm::vec3 unitAim = glm::normalize(_subject->aim());
-    glm::vec3 newPos = _subject->pos() + unitAim * _moveStep;
-    _subject->pos(newPos);
+    _move(unitAim * _moveStep);
 }
 
 void Ctrl::_moveBack() {
     glm::vec3 unitAim = glm::normalize(_subject->aim());
-    glm::vec3 newPos = _subject->pos() - unitAim * _moveStep;
-    _subject->pos(newPos);
+    _move(-unitAim * _moveStep);
 }
 
 void Ctrl::_moveLeft() {
     glm::vec3 left = glm::cross(_subject->up(), _subject->aim());
     glm::vec3 unitLeft = glm::normalize(left);
-    glm::vec3 newPos = _subject->pos() + unitLeft * _moveStep;
-    _subject->pos(newPos);
+    _move(unitLeft * _moveStep);
 }
 
 void Ctrl::_moveRight() {
     glm::vec3 right = glm::cross(_subject->aim(), _subject->up());
     glm::vec3 unitRight = glm::normalize(right);
-    glm::vec3 newPos = _subject->pos() + unitRight * _moveStep;
-    _subject->pos(newPos);
+    _move(unitRight * _moveStep);
 }
 
 }  // namespace camLib
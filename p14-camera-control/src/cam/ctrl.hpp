@@ -6,7 +6,8 @@
  * Dependencies:
  * 1. GLUT library (freeglut3-dev)
  * 2. GLM library (libglm-dev)
- * 3. The cam libraries' main module (../cam.hpp) */
+ * 3. The cam libraries' main module (../cam.hpp)
+ * 4. The cam libraries' collide module (collide.hpp) */
 
 /* Copyright 2022 Yucheng Liu. GNU GPL3 license.
  * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
@@ -25,6 +26,9 @@ class Cam;
 /* Camera library */
 namespace camLib {
 
+// Forward declare Collider (from collide.hpp)
+class Collider;
+
 /* (Camera) control. */
 class Ctrl {
    private:
@@ -33,9 +37,13 @@ class Ctrl {
     Cam *_subject;
     /* Step size of the subject's movement. */
     float _moveStep;
+    /* Collision of the subject's movement (nullptr if off). */
+    Collider *_collider;
 
     // Action helper functions
 
+    /* Moves the subject by step, through the collider if there is one. */
+    void _move(glm::vec3 step);
     void _moveOn();
     void _moveBack();
     void _moveLeft();
@@ -43,7 +51,7 @@ class Ctrl {
 
    public:
     /* Constructs a default control.
-     * enabled: false; subject: nullptr; moveStep: 1.*/
+     * enabled: false; subject: nullptr; moveStep: 1; collider: nullptr. */
     Ctrl();
     /* Reads the enabled status. */
     bool enabled();
@@ -57,6 +65,10 @@ class Ctrl {
     float moveStep();
     /* Reads and updates the movement step. */
     float moveStep(float newVal);
+    /* Reads the collider. */
+    Collider *collider();
+    /* Reads and updates the collider (nullptr turns collision off). */
+    Collider *collider(Collider *newVal);
     /* Triggers an action based on the keyboard input. */
     bool onKey(int key);
 };
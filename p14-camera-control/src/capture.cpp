@@ -0,0 +1,205 @@
+/* File name: capture.cpp
+ *
+ * Intro:
+ * C++ implementation of the frame capture custom library. */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#include "capture.hpp"
+
+#include <chrono>
+#include <cstring>
+
+/* Longest single wait for a read before its fence is polled again (unit:
+ * nanoseconds). */
+static GLuint64 const waitTimeout = 100000000;
+
+/* Reads a steady clock (unit: milliseconds). */
+static double nowMs() {
+    auto t = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration<double, std::milli>(t).count();
+}
+
+Capture::Capture(gpuLib::Res &res, int width, int height) : _res(res) {
+    _width = width;
+    _height = height;
+    for (int i = 0; i < captureRing; i += 1) {
+        _fences[i] = 0;
+    }
+    _next = 0;
+    _active = false;
+    _stopping = false;
+    _stats = CaptureStats{0, 0, 0, 0, 0.0, 0.0, 0.0};
+}
+
+Capture::~Capture() {
+    stop();
+}
+
+bool Capture::start(char const *path, int fps) {
+    stop();
+    if (!_encoder.open(path, _width, _height, fps)) {
+        return false;
+    }
+    _path = path;
+
+    // RGBA8 rows, packed with no padding
+    long bytes = (long)_width * _height * 4;
+    for (int i = 0; i < captureRing; i += 1) {
+        _buffers[i] = _res.create(gpuLib::resBuffer);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, _res.name(_buffers[i]));
+        glBufferData(GL_PIXEL_PACK_BUFFER, bytes, NULL, GL_STREAM_READ);
+        _res.bytes(_buffers[i], bytes);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    _next = 0;
+    _stopping = false;
+    _stats = CaptureStats{0, 0, 0, 0, 0.0, 0.0, 0.0};
+    _active = true;
+    _thread = std::thread(&Capture::_run, this);
+    return true;
+}
+
+bool Capture::active() {
+    return _active;
+}
+
+std::string const &Capture::path() {
+    return _path;
+}
+
+void Capture::_map(int slot) {
+    GLsync fence = _fences[slot];
+    if (fence == 0) {
+        return;
+    }
+    GLenum status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+    while (status == GL_TIMEOUT_EXPIRED) {
+        status = glClientWaitSync(fence, 0, waitTimeout);
+    }
+    glDeleteSync(fence);
+    _fences[slot] = 0;
+
+    // Take a spare frame unless the encoder is too far behind
+    std::vector<unsigned char> pixels;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if ((int)_queue.size() >= captureQueueMax) {
+            _stats.dropped += 1;
+            return;
+        }
+        if (!_spares.empty()) {
+            pixels.swap(_spares.back());
+            _spares.pop_back();
+        }
+    }
+
+    size_t bytes = (size_t)_width * _height * 4;
+    pixels.resize(bytes);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, _res.name(_buffers[slot]));
+    // clang-format off
+    void const *mapped = glMapBufferRange(
+        GL_PIXEL_PACK_BUFFER, 0, bytes, GL_MAP_READ_BIT
+    );
+    // clang-format on
+    if (mapped != nullptr) {
+        memcpy(pixels.data(), mapped, bytes);
+    }
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    if (mapped == nullptr) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stats.dropped += 1;
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _queue.push_back(std::move(pixels));
+    }
+    _wake.notify_one();
+}
+
+void Capture::frame() {
+    if (!_active) {
+        return;
+    }
+    double start = nowMs();
+
+    // The slot's last read was issued a ring ago, so it is likely done
+    int slot = _next;
+    _map(slot);
+
+    // The read goes into the buffer; the call does not wait for the GPU
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, _res.name(_buffers[slot]));
+    glReadBuffer(GL_BACK);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    // clang-format off
+    glReadPixels(
+        0, 0, _width, _height, GL_RGBA, GL_UNSIGNED_BYTE, (void *)0
+    );
+    // clang-format on
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    _fences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    _next = (slot + 1) % captureRing;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stats.captured += 1;
+    _stats.readMs = nowMs() - start;
+    _stats.totalReadMs += _stats.readMs;
+}
+
+void Capture::_run() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true) {
+        _wake.wait(lock, [this]() { return _stopping or !_queue.empty(); });
+        if (_queue.empty()) {
+            // Stopping, and every queued frame is written
+            break;
+        }
+        std::vector<unsigned char> pixels = std::move(_queue.front());
+        _queue.pop_front();
+
+        lock.unlock();
+        double start = nowMs();
+        bool ok = _encoder.write(pixels.data());
+        double ms = nowMs() - start;
+        lock.lock();
+
+        _stats.written += ok ? 1 : 0;
+        _stats.failed += ok ? 0 : 1;
+        _stats.totalEncodeMs += ms;
+        _spares.push_back(std::move(pixels));
+    }
+}
+
+void Capture::stop() {
+    if (!_active) {
+        return;
+    }
+
+    // The reads in flight, oldest first
+    for (int i = 0; i < captureRing; i += 1) {
+        _map((_next + i) % captureRing);
+    }
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = true;
+    }
+    _wake.notify_one();
+    _thread.join();
+    _encoder.close();
+
+    for (int i = 0; i < captureRing; i += 1) {
+        _res.release(_buffers[i]);
+    }
+    _spares.clear();
+    _active = false;
+}
+
+CaptureStats Capture::stats() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _stats;
+}
@@ -0,0 +1,117 @@
+/* File name: capture.hpp
+ *
+ * Intro:
+ * C++ header of the frame capture custom library.
+ * Rendered frames are read back without stalling the frames: each frame's
+ * back buffer is read into one of a ring of pixel pack buffers, which the
+ * GPU fills on its own time, and the buffer is mapped only when the ring
+ * comes back around to it a few frames later, once its fence has signaled.
+ * The pixels are copied out and handed to an encoder thread, which writes
+ * them as PNG files or a Y4M stream (see capture/encode.hpp). If the encoder
+ * falls behind, frames are dropped (and counted) rather than queued without
+ * bound.
+ *
+ * Dependencies:
+ * 1. GLEW library (libglew-dev); needs GL 3.2 (ARB_sync) for the fences
+ * 2. The capture libraries' encode module (capture/encode.hpp)
+ * 3. The gpu libraries' res module (gpu/res.hpp) */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#ifndef CAPTURE_HPP
+#define CAPTURE_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "capture/encode.hpp"
+#include "gpu/res.hpp"
+
+/* Pixel pack buffers in the ring (frames between a read and its map). */
+static int const captureRing = 3;
+/* Most frames waiting for the encoder. */
+static int const captureQueueMax = 8;
+
+/* Capture statistics. */
+struct CaptureStats {
+    /* Frames read back. */
+    long captured;
+    /* Frames written, and the writes that failed. */
+    long written;
+    long failed;
+    /* Frames dropped because the encoder fell behind. */
+    long dropped;
+    /* Render thread time of the last frame: the read, the map, and the copy
+     * (unit: milliseconds). */
+    double readMs;
+    /* Total render thread time (unit: milliseconds). */
+    double totalReadMs;
+    /* Total encoder thread time (unit: milliseconds). */
+    double totalEncodeMs;
+};
+
+/* Capture (of rendered frames). */
+class Capture {
+   private:
+    gpuLib::Res &_res;
+    int _width;
+    int _height;
+    std::string _path;
+    /* Pixel pack buffers, and the fences of their reads (0 if idle). */
+    gpuLib::ResHandle _buffers[captureRing];
+    GLsync _fences[captureRing];
+    /* Ring slot of the next read. */
+    int _next;
+    captureLib::Encoder _encoder;
+    std::thread _thread;
+    /* Guards the queue, the spare frames, the statistics, and stopping. */
+    std::mutex _mutex;
+    /* Wakes the encoder when a frame is queued or the capture stops. */
+    std::condition_variable _wake;
+    /* Frames waiting for the encoder, oldest first. */
+    std::deque<std::vector<unsigned char>> _queue;
+    /* Frames the encoder is done with, reused by later copies. */
+    std::vector<std::vector<unsigned char>> _spares;
+    bool _active;
+    bool _stopping;
+    CaptureStats _stats;
+
+    /* Waits for a ring slot's read, and queues its pixels for the encoder
+     * (or drops them if the queue is full). */
+    void _map(int slot);
+    /* Runs the encoder thread. */
+    void _run();
+
+   public:
+    /* Constructs an inactive capture of frames of a size, with pixel pack
+     * buffers of a resource manager. */
+    Capture(gpuLib::Res &res, int width, int height);
+    /* Stops the capture. */
+    ~Capture();
+    /* Starts capturing to a path ("x.png" writes x00000.png, ...; "x.y4m"
+     * writes one stream of the frame rate); returns false if it cannot be
+     * written. */
+    bool start(char const *path, int fps);
+    /* Finds whether the capture is running. */
+    bool active();
+    /* Reads the capture path. */
+    std::string const &path();
+    /* Reads the finished frame from the back buffer (before the swap), and
+     * queues the frame read a ring ago. */
+    void frame();
+    /* Stops the capture: queues the reads in flight, and waits for the
+     * encoder to write every queued frame. */
+    void stop();
+    /* Reads the statistics. */
+    CaptureStats stats();
+};
+
+// CAPTURE_HPP
+#endif
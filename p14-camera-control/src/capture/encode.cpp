@@ -0,0 +1,294 @@
+/* File name: encode.cpp
+ *
+ * Intro:
+ * C++ implementation of the capture libraries' encode (Frame encoding)
+ * module. */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#include "encode.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+/* Most bytes of a stored deflate block. */
+static size_t const storedMax = 65535;
+/* Most bytes summed before the Adler-32 sums must be reduced (so they cannot
+ * overflow). */
+static size_t const adlerMax = 5552;
+
+/* CRC-32 (of PNG chunks) lookup tables, for 8 bytes at a time: entries[k]
+ * holds the CRCs of the bytes followed by k zero bytes. */
+struct CrcTable {
+    uint32_t entries[8][256];
+
+    CrcTable() {
+        for (uint32_t i = 0; i < 256; i += 1) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k += 1) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            entries[0][i] = c;
+        }
+        for (int k = 1; k < 8; k += 1) {
+            for (int i = 0; i < 256; i += 1) {
+                uint32_t c = entries[k - 1][i];
+                entries[k][i] = entries[0][c & 0xFF] ^ (c >> 8);
+            }
+        }
+    }
+};
+static CrcTable const crcTable;
+
+/* Continues a CRC-32 (before its final inversion) over some bytes. */
+static uint32_t crcUpdate(uint32_t crc, unsigned char const *data,
+                          size_t size) {
+    uint32_t const(*t)[256] = crcTable.entries;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        unsigned char const *d = data + i;
+        uint32_t word = d[0] | d[1] << 8 | d[2] << 16 | (uint32_t)d[3] << 24;
+        uint32_t lo = crc ^ word;
+        crc = t[7][lo & 0xFF] ^ t[6][lo >> 8 & 0xFF] ^ t[5][lo >> 16 & 0xFF] ^
+              t[4][lo >> 24] ^ t[3][d[4]] ^ t[2][d[5]] ^ t[1][d[6]] ^
+              t[0][d[7]];
+    }
+    for (; i < size; i += 1) {
+        crc = t[0][(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+/* Appends a big endian 32-bit integer. */
+static void putU32(std::vector<unsigned char> &bytes, uint32_t value) {
+    bytes.push_back((unsigned char)(value >> 24));
+    bytes.push_back((unsigned char)(value >> 16));
+    bytes.push_back((unsigned char)(value >> 8));
+    bytes.push_back((unsigned char)value);
+}
+
+/* Closes a PNG chunk that starts at begin (its length field): fills in the
+ * length and appends the CRC of its type and data. */
+static void endChunk(std::vector<unsigned char> &bytes, size_t begin) {
+    uint32_t length = (uint32_t)(bytes.size() - begin - 8);
+    for (int i = 0; i < 4; i += 1) {
+        bytes[begin + i] = (unsigned char)(length >> (24 - i * 8));
+    }
+    uint32_t crc = crcUpdate(0xFFFFFFFFu, &bytes[begin + 4], length + 4);
+    putU32(bytes, crc ^ 0xFFFFFFFFu);
+}
+
+/* Opens a PNG chunk of a type; returns its beginning. */
+static size_t beginChunk(std::vector<unsigned char> &bytes,
+                         char const *type) {
+    size_t begin = bytes.size();
+    putU32(bytes, 0);
+    bytes.insert(bytes.end(), type, type + 4);
+    return begin;
+}
+
+/* Finds the BT.601 limited range luma of an RGB color. */
+static unsigned char rgbToY(int r, int g, int b) {
+    return (unsigned char)(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+}
+
+namespace captureLib {
+
+Fmt encodeFmt(char const *path) {
+    size_t length = strlen(path);
+    bool y4m = length >= 4 and strcmp(path + length - 4, ".y4m") == 0;
+    return y4m ? fmtY4m : fmtPng;
+}
+
+Encoder::Encoder() {
+    _fmt = fmtPng;
+    _file = NULL;
+    _width = 0;
+    _height = 0;
+    _frames = 0;
+}
+
+Encoder::~Encoder() {
+    close();
+}
+
+bool Encoder::open(char const *path, int width, int height, int fps) {
+    close();
+    _fmt = encodeFmt(path);
+    _path = path;
+    _width = width;
+    _height = height;
+    _frames = 0;
+    if (_fmt == fmtPng) {
+        // The frame number goes before the extension
+        size_t length = _path.size();
+        if (length >= 4 and _path.compare(length - 4, 4, ".png") == 0) {
+            _path.resize(length - 4);
+        }
+        return true;
+    }
+
+    if (width % 2 != 0 or height % 2 != 0) {
+        return false;
+    }
+    _file = fopen(path, "wb");
+    if (_file == NULL) {
+        return false;
+    }
+    fprintf(_file, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", width,
+            height, fps);
+    return ferror(_file) == 0;
+}
+
+void Encoder::_png(unsigned char const *rgba) {
+    std::vector<unsigned char> &bytes = _bytes;
+    bytes.clear();
+    unsigned char const signature[] = {0x89, 'P', 'N', 'G', '\r', '\n',
+                                       0x1A, '\n'};
+    bytes.insert(bytes.end(), signature, signature + 8);
+
+    // 8-bit RGB, no interlacing
+    size_t chunk = beginChunk(bytes, "IHDR");
+    putU32(bytes, (uint32_t)_width);
+    putU32(bytes, (uint32_t)_height);
+    unsigned char const header[] = {8, 2, 0, 0, 0};
+    bytes.insert(bytes.end(), header, header + 5);
+    endChunk(bytes, chunk);
+
+    // The filtered rows (filter byte 0, then RGB), from the top
+    size_t rowBytes = (size_t)_width * 3 + 1;
+    size_t rawBytes = rowBytes * _height;
+    _raw.resize(rawBytes);
+    for (int y = 0; y < _height; y += 1) {
+        size_t srcRow = (size_t)(_height - 1 - y) * _width;
+        unsigned char const *src = rgba + srcRow * 4;
+        unsigned char *dst = &_raw[y * rowBytes];
+        *dst++ = 0;
+        for (int x = 0; x < _width; x += 1) {
+            *dst++ = src[x * 4];
+            *dst++ = src[x * 4 + 1];
+            *dst++ = src[x * 4 + 2];
+        }
+    }
+
+    // Their zlib stream, in stored blocks
+    chunk = beginChunk(bytes, "IDAT");
+    bytes.push_back(0x78);
+    bytes.push_back(0x01);
+    for (size_t done = 0; done < rawBytes; done += storedMax) {
+        size_t size = std::min(storedMax, rawBytes - done);
+        // Final flag, length, and its complement
+        bytes.push_back(done + size == rawBytes ? 1 : 0);
+        bytes.push_back((unsigned char)size);
+        bytes.push_back((unsigned char)(size >> 8));
+        bytes.push_back((unsigned char)~size);
+        bytes.push_back((unsigned char)(~size >> 8));
+        bytes.insert(bytes.end(), &_raw[done], &_raw[done] + size);
+    }
+    uint32_t adlerA = 1;
+    uint32_t adlerB = 0;
+    for (size_t done = 0; done < rawBytes; done += adlerMax) {
+        size_t end = std::min(rawBytes, done + adlerMax);
+        for (size_t i = done; i < end; i += 1) {
+            adlerA += _raw[i];
+            adlerB += adlerA;
+        }
+        adlerA %= 65521;
+        adlerB %= 65521;
+    }
+    putU32(bytes, adlerB << 16 | adlerA);
+    endChunk(bytes, chunk);
+
+    chunk = beginChunk(bytes, "IEND");
+    endChunk(bytes, chunk);
+}
+
+void Encoder::_y4m(unsigned char const *rgba) {
+    std::vector<unsigned char> &bytes = _bytes;
+    char const frameHeader[] = "FRAME\n";
+    size_t lumaBytes = (size_t)_width * _height;
+    size_t chromaBytes = lumaBytes / 4;
+    bytes.resize(6 + lumaBytes + chromaBytes * 2);
+    memcpy(bytes.data(), frameHeader, 6);
+    unsigned char *lumas = &bytes[6];
+    unsigned char *us = lumas + lumaBytes;
+    unsigned char *vs = us + chromaBytes;
+
+    // Each 2x2 block shares the average of its chroma, from the top
+    int halfWidth = _width / 2;
+    for (int y = 0; y < _height; y += 2) {
+        size_t topRow = (size_t)(_height - 1 - y) * _width;
+        unsigned char const *top = rgba + topRow * 4;
+        unsigned char const *bottom = top - (size_t)_width * 4;
+        unsigned char *lumaTop = lumas + (size_t)y * _width;
+        unsigned char *lumaBottom = lumaTop + _width;
+        unsigned char *uRow = us + (size_t)(y / 2) * halfWidth;
+        unsigned char *vRow = vs + (size_t)(y / 2) * halfWidth;
+        for (int x = 0; x < halfWidth; x += 1) {
+            unsigned char const *p[4] = {top + x * 8, top + x * 8 + 4,
+                                         bottom + x * 8, bottom + x * 8 + 4};
+            int r = 0;
+            int g = 0;
+            int b = 0;
+            for (int j = 0; j < 4; j += 1) {
+                r += p[j][0];
+                g += p[j][1];
+                b += p[j][2];
+            }
+            lumaTop[x * 2] = rgbToY(p[0][0], p[0][1], p[0][2]);
+            lumaTop[x * 2 + 1] = rgbToY(p[1][0], p[1][1], p[1][2]);
+            lumaBottom[x * 2] = rgbToY(p[2][0], p[2][1], p[2][2]);
+            lumaBottom[x * 2 + 1] = rgbToY(p[3][0], p[3][1], p[3][2]);
+            // The chroma of the average color (sums of 4, so 2 more bits)
+            int u = ((-38 * r - 74 * g + 112 * b + 512) >> 10) + 128;
+            int v = ((112 * r - 94 * g - 18 * b + 512) >> 10) + 128;
+            uRow[x] = (unsigned char)u;
+            vRow[x] = (unsigned char)v;
+        }
+    }
+}
+
+std::vector<unsigned char> const &Encoder::encode(
+    unsigned char const *rgba) {
+    if (_fmt == fmtPng) {
+        _png(rgba);
+    } else {
+        _y4m(rgba);
+    }
+    return _bytes;
+}
+
+bool Encoder::write(unsigned char const *rgba) {
+    encode(rgba);
+    bool ok = false;
+    if (_fmt == fmtPng) {
+        char number[16];
+        snprintf(number, sizeof(number), "%05ld.png", _frames);
+        std::string name = _path + number;
+        FILE *file = fopen(name.c_str(), "wb");
+        if (file != NULL) {
+            fwrite(_bytes.data(), 1, _bytes.size(), file);
+            ok = ferror(file) == 0;
+            fclose(file);
+        }
+    } else if (_file != NULL) {
+        fwrite(_bytes.data(), 1, _bytes.size(), _file);
+        ok = ferror(_file) == 0;
+    }
+    _frames += ok ? 1 : 0;
+    return ok;
+}
+
+void Encoder::close() {
+    if (_file != NULL) {
+        fclose(_file);
+        _file = NULL;
+    }
+}
+
+long Encoder::frames() {
+    return _frames;
+}
+
+}  // namespace captureLib
@@ -0,0 +1,75 @@
+/* File name: encode.hpp
+ *
+ * Intro:
+ * C++ header of the capture libraries' encode (Frame encoding) module.
+ * An encoder writes RGBA8 frames (rows from the bottom, as GL reads them)
+ * either as a sequence of PNG files or as one Y4M (YUV4MPEG2) stream. The
+ * PNG files are deflated with stored (uncompressed) blocks, so encoding
+ * costs two checksums and a copy; any PNG reader opens them, and they
+ * compress well offline. The Y4M stream is 4:2:0 (BT.601, limited range),
+ * which video tools read directly. It touches no GL state, so it runs on the
+ * CPU only. */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#ifndef CAPTURE__ENCODE_HPP
+#define CAPTURE__ENCODE_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/* Capture library */
+namespace captureLib {
+
+/* Frame file format. */
+enum Fmt { fmtPng, fmtY4m };
+
+/* Finds the format of a capture path: Y4M for ".y4m", else PNG. */
+Fmt encodeFmt(char const *path);
+
+/* Encoder. */
+class Encoder {
+   private:
+    Fmt _fmt;
+    /* Y4M stream file, or PNG file name prefix. */
+    std::string _path;
+    FILE *_file;
+    int _width;
+    int _height;
+    long _frames;
+    /* Scratch of the encoded frame, and of the PNG rows. */
+    std::vector<unsigned char> _bytes;
+    std::vector<unsigned char> _raw;
+
+    /* Encodes a frame as a PNG file into _bytes. */
+    void _png(unsigned char const *rgba);
+    /* Encodes a frame as a Y4M frame into _bytes. */
+    void _y4m(unsigned char const *rgba);
+
+   public:
+    /* Constructs a closed encoder. */
+    Encoder();
+    /* Closes the stream. */
+    ~Encoder();
+    /* Opens a capture of the path's format ("x.png" writes x00000.png, ...;
+     * "x.y4m" writes one stream) for frames of a size (even, for Y4M) and
+     * rate; returns false if the stream cannot be written. */
+    bool open(char const *path, int width, int height, int fps);
+    /* Encodes and writes a frame (RGBA8, rows from the bottom); returns
+     * false on failure. */
+    bool write(unsigned char const *rgba);
+    /* Closes the stream. */
+    void close();
+    /* Reads the frames written. */
+    long frames();
+    /* Encodes a frame without writing it; returns its encoded bytes. */
+    std::vector<unsigned char> const &encode(unsigned char const *rgba);
+};
+
+}  // namespace captureLib
+
+// CAPTURE__ENCODE_HPP
+#endif
@@ -0,0 +1,31 @@
+/* File name: draw.hpp
+ *
+ * Intro:
+ * C++ header of the draw list item of the camera control program.
+ * The CPU draw paths of main.x build a draw list every frame from the frame
+ * arena (see frame.hpp) and sort it by key; bench.x's frame benchmark builds
+ * the same list.
+ *
+ * Dependencies:
+ * 1. GLM library (libglm-dev) */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#ifndef DRAW_HPP
+#define DRAW_HPP
+
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+/* Draw of the CPU paths' draw list. */
+struct DrawItem {
+    /* Sort key: the mesh, the level of detail, then the object. */
+    uint64_t key;
+    int obj;
+    glm::mat4 mapping;
+};
+
+// DRAW_HPP
+#endif
@@ -0,0 +1,174 @@
+/* File name: frame.cpp
+ *
+ * Intro:
+ * C++ implementation of the frame arena custom library. */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#include "frame.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+/* Heap allocations so far (see operator new below). */
+static std::atomic<long> heapAllocCount(0);
+
+/* Rounds a size up to a power of 2. */
+static size_t ceilPow2(size_t size) {
+    size_t pow2 = 1;
+    while (pow2 < size) {
+        pow2 *= 2;
+    }
+    return pow2;
+}
+
+FrameArena::FrameArena(int buffers, size_t capacity) {
+    _bufferCount = std::max(1, std::min(buffers, frameArenaMaxBuffers));
+    for (int i = 0; i < frameArenaMaxBuffers; i += 1) {
+        Buffer &buffer = _buffers[i];
+        buffer.size = i < _bufferCount ? capacity : 0;
+        buffer.data = buffer.size > 0 ? new unsigned char[buffer.size] : NULL;
+        buffer.used = 0;
+    }
+    _slot = 0;
+    _poison = frameArenaPoison;
+    _stats = FrameArenaStats{0, 0, 0, 0, capacity, 0};
+}
+
+FrameArena::~FrameArena() {
+    for (Buffer &buffer : _buffers) {
+        for (unsigned char *block : buffer.overflows) {
+            delete[] block;
+        }
+        delete[] buffer.data;
+    }
+}
+
+void FrameArena::begin(int slot) {
+    _slot = slot % _bufferCount;
+    Buffer &buffer = _buffers[_slot];
+    if (_poison and buffer.used > 0) {
+        memset(buffer.data, frameArenaDead, buffer.used);
+    }
+    buffer.used = 0;
+    for (unsigned char *block : buffer.overflows) {
+        delete[] block;
+    }
+    buffer.overflows.clear();
+
+    // A frame that overflowed grows every buffer as its slot comes around
+    _stats.capacity = std::max(_stats.capacity, ceilPow2(_stats.peak));
+    if (buffer.size < _stats.capacity) {
+        delete[] buffer.data;
+        buffer.size = _stats.capacity;
+        buffer.data = new unsigned char[buffer.size];
+        _stats.grows += 1;
+    }
+    _stats.used = 0;
+    _stats.allocs = 0;
+    _stats.overflow = 0;
+}
+
+void *FrameArena::alloc(size_t size, size_t align) {
+    Buffer &buffer = _buffers[_slot];
+    size_t at = (buffer.used + align - 1) & ~(align - 1);
+    unsigned char *data = NULL;
+    // The used bytes count the padding, so the buffers grow to fit it
+    if (at + size <= buffer.size) {
+        data = buffer.data + at;
+        _stats.used += at + size - buffer.used;
+        buffer.used = at + size;
+    } else {
+        // Until the slot's next begin, from the heap (aligned by hand)
+        unsigned char *block = new unsigned char[size + align];
+        buffer.overflows.push_back(block);
+        uintptr_t address = ((uintptr_t)block + align - 1) & ~(align - 1);
+        data = (unsigned char *)address;
+        _stats.used += size + align;
+        _stats.overflow += size;
+    }
+    if (_poison) {
+        memset(data, frameArenaFresh, size);
+    }
+
+    _stats.allocs += 1;
+    _stats.peak = std::max(_stats.peak, _stats.used);
+    return data;
+}
+
+int FrameArena::slot() {
+    return _slot;
+}
+
+bool FrameArena::poison() {
+    return _poison;
+}
+
+bool FrameArena::poison(bool newVal) {
+    bool oldVal = _poison;
+    _poison = newVal;
+    return oldVal;
+}
+
+FrameArenaStats FrameArena::stats() {
+    return _stats;
+}
+
+long heapAllocs() {
+    return heapAllocCount.load(std::memory_order_relaxed);
+}
+
+/* The global allocation functions, replaced to count the calls. All the
+ * plain forms are replaced together (single and array, sized and nothrow
+ * deletes), so whichever form the compiler picks, the allocation is counted
+ * and the memory goes back to free. */
+void *operator new(size_t size) {
+    heapAllocCount.fetch_add(1, std::memory_order_relaxed);
+    void *data = malloc(size > 0 ? size : 1);
+    if (data == NULL) {
+        throw std::bad_alloc();
+    }
+    return data;
+}
+
+void *operator new(size_t size, std::nothrow_t const &) noexcept {
+    heapAllocCount.fetch_add(1, std::memory_order_relaxed);
+    return malloc(size > 0 ? size : 1);
+}
+
+void *operator new[](size_t size) {
+    return operator new(size);
+}
+
+void *operator new[](size_t size, std::nothrow_t const &tag) noexcept {
+    return operator new(size, tag);
+}
+
+void operator delete(void *data) noexcept {
+    free(data);
+}
+
+void operator delete(void *data, size_t) noexcept {
+    free(data);
+}
+
+void operator delete(void *data, std::nothrow_t const &) noexcept {
+    free(data);
+}
+
+void operator delete[](void *data) noexcept {
+    free(data);
+}
+
+void operator delete[](void *data, size_t) noexcept {
+    free(data);
+}
+
+void operator delete[](void *data, std::nothrow_t const &) noexcept {
+    free(data);
+}
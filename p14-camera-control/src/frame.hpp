@@ -0,0 +1,143 @@
+/* File name: frame.hpp
+ *
+ * Intro:
+ * C++ header of the frame arena custom library.
+ * Transient per-frame data (draw lists, sort keys, staging) is allocated
+ * from a linear arena instead of the heap: an allocation bumps an offset,
+ * nothing is freed on its own, and beginning a frame drops everything at
+ * once by resetting the offset. The arena keeps one buffer per frame in
+ * flight (see gpu/frames.hpp), and a frame resets only its own slot's
+ * buffer, so the data of the frames before it stays valid while they are in
+ * flight. An allocation that does not fit falls back to the heap until the
+ * slot comes around again, when its buffer grows to the largest frame seen;
+ * so after the first few frames, frames stop touching the heap. STL
+ * containers take the arena through FrameAlloc (a vector that grows leaves
+ * its old storage behind until the reset, so reserve first). In debug
+ * builds (without NDEBUG, as "make DEBUG=1" builds), fresh allocations and
+ * reset buffers are poisoned, so reads of uninitialized or expired data show
+ * up as 0xCD and 0xDD bytes.
+ * The module also counts the heap allocations of the whole program (it
+ * replaces the global operator new), to check that frames make none.
+ *
+ * Dependencies:
+ * None */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#ifndef FRAME_HPP
+#define FRAME_HPP
+
+#include <cstddef>
+#include <vector>
+
+/* Most buffers (frames in flight). */
+static int const frameArenaMaxBuffers = 3;
+/* Whether the arena poisons memory by default (in debug builds). */
+#ifdef NDEBUG
+static bool const frameArenaPoison = false;
+#else
+static bool const frameArenaPoison = true;
+#endif
+/* Poison bytes of fresh allocations and of reset buffers. */
+static unsigned char const frameArenaFresh = 0xCD;
+static unsigned char const frameArenaDead = 0xDD;
+
+/* Frame arena statistics. */
+struct FrameArenaStats {
+    /* Bytes and allocations of the current frame. */
+    size_t used;
+    long allocs;
+    /* Bytes of the current frame that fell back to the heap. */
+    size_t overflow;
+    /* Most bytes of any frame. */
+    size_t peak;
+    /* Bytes of each buffer. */
+    size_t capacity;
+    /* Buffer growths. */
+    long grows;
+};
+
+/* Frame arena. */
+class FrameArena {
+   private:
+    /* Buffer of a slot. */
+    struct Buffer {
+        unsigned char *data;
+        size_t size;
+        /* Bytes used (from the start). */
+        size_t used;
+        /* Heap blocks of the allocations that did not fit. */
+        std::vector<unsigned char *> overflows;
+    };
+
+    Buffer _buffers[frameArenaMaxBuffers];
+    int _bufferCount;
+    /* Slot of the current frame. */
+    int _slot;
+    bool _poison;
+    FrameArenaStats _stats;
+
+   public:
+    /* Constructs an arena of a buffer count (clamped to 1 to
+     * frameArenaMaxBuffers) and initial buffer size (unit: bytes); the
+     * current frame is slot 0's. */
+    FrameArena(int buffers, size_t capacity);
+    /* Frees the buffers. */
+    ~FrameArena();
+    /* Begins a frame on a slot (modulo the buffer count): drops that slot's
+     * allocations, and grows its buffer to the largest frame seen. */
+    void begin(int slot);
+    /* Allocates bytes of an alignment (a power of 2) for the current frame;
+     * the memory stays valid until the slot's next begin. */
+    void *alloc(size_t size, size_t align);
+    /* Allocates uninitialized elements for the current frame. */
+    template <class T>
+    T *alloc(size_t count) {
+        return (T *)alloc(count * sizeof(T), alignof(T));
+    }
+    /* Reads the slot of the current frame. */
+    int slot();
+    /* Reads whether memory is poisoned. */
+    bool poison();
+    /* Reads and updates whether memory is poisoned. */
+    bool poison(bool newVal);
+    /* Reads the statistics. */
+    FrameArenaStats stats();
+};
+
+/* Frame alloc(ator): an STL allocator of the current frame of an arena;
+ * deallocation does nothing. */
+template <class T>
+struct FrameAlloc {
+    typedef T value_type;
+    FrameArena *arena;
+
+    FrameAlloc(FrameArena &arena) : arena(&arena) {}
+    template <class U>
+    FrameAlloc(FrameAlloc<U> const &other) : arena(other.arena) {}
+    T *allocate(size_t count) {
+        return arena->alloc<T>(count);
+    }
+    void deallocate(T *, size_t) {}
+};
+
+template <class T, class U>
+bool operator==(FrameAlloc<T> const &a, FrameAlloc<U> const &b) {
+    return a.arena == b.arena;
+}
+
+template <class T, class U>
+bool operator!=(FrameAlloc<T> const &a, FrameAlloc<U> const &b) {
+    return a.arena != b.arena;
+}
+
+/* Vector of the current frame of an arena. */
+template <class T>
+using FrameVector = std::vector<T, FrameAlloc<T>>;
+
+/* Reads the heap allocations (operator new calls, on all threads) so far. */
+long heapAllocs();
+
+// FRAME_HPP
+#endif
@@ -0,0 +1,65 @@
+/* File name: frustum.cpp
+ *
+ * Intro:
+ * C++ implementation of the view frustum custom library. */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#include "frustum.hpp"
+
+Frustum::Frustum() {
+    for (int i = 0; i < 6; i += 1) {
+        _planes[i] = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    }
+}
+
+Frustum::Frustum(glm::mat4 viewProj) {
+    // Rows of the matrix (GLM matrices are column major)
+    glm::vec4 rows[4];
+    for (int i = 0; i < 4; i += 1) {
+        glm::mat4 &m = viewProj;
+        rows[i] = glm::vec4(m[0][i], m[1][i], m[2][i], m[3][i]);
+    }
+
+    // clip.w +- clip.x/y/z >= 0 for each pair of planes
+    for (int i = 0; i < 3; i += 1) {
+        _planes[i * 2] = rows[3] + rows[i];
+        _planes[i * 2 + 1] = rows[3] - rows[i];
+    }
+    for (int i = 0; i < 6; i += 1) {
+        float len = glm::length(glm::vec3(_planes[i]));
+        if (len > 0.0f) {
+            _planes[i] /= len;
+        }
+    }
+}
+
+glm::vec4 Frustum::plane(int index) {
+    return _planes[index];
+}
+
+bool Frustum::sphere(glm::vec3 center, float radius) {
+    for (int i = 0; i < 6; i += 1) {
+        glm::vec4 &p = _planes[i];
+        if (glm::dot(glm::vec3(p), center) + p.w < -radius) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Frustum::box(glm::vec3 lo, glm::vec3 hi) {
+    for (int i = 0; i < 6; i += 1) {
+        glm::vec4 &p = _planes[i];
+        // The box corner farthest along the plane normal
+        glm::vec3 far;
+        for (int j = 0; j < 3; j += 1) {
+            far[j] = p[j] >= 0.0f ? hi[j] : lo[j];
+        }
+        if (glm::dot(glm::vec3(p), far) + p.w < 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,46 @@
+/* File name: frustum.hpp
+ *
+ * Intro:
+ * C++ header of the view frustum custom library.
+ * 
+ * References:
+ * 1. G. Gribb and K. Hartmann, "Fast extraction of viewing frustum planes
+ *    from the world-view-projection matrix," 2001.
+ * 
+ * Dependencies:
+ * 1. GLM library (libglm-dev) */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#ifndef FRUSTUM_HPP
+#define FRUSTUM_HPP
+
+#include <glm/glm.hpp>
+#include <glm/ext.hpp>
+
+/* View frustum. */
+class Frustum {
+   private:
+    /* Planes (left, right, bottom, top, near, far); xyz is the inward unit
+     * normal and w is the distance term. */
+    glm::vec4 _planes[6];
+
+   public:
+    /* Initializes a frustum that contains everything. */
+    Frustum();
+    /* Initializes the frustum of a view projection matrix.
+     * Note:
+     * With the mapping matrix of an object, the planes are in object space;
+     * with the projection view matrix, they are in world space. */
+    Frustum(glm::mat4 viewProj);
+    /* Reads a plane (0 to 5: left, right, bottom, top, near, far). */
+    glm::vec4 plane(int index);
+    /* Finds whether a sphere touches the frustum (conservative). */
+    bool sphere(glm::vec3 center, float radius);
+    /* Finds whether an axis-aligned box touches the frustum (conservative). */
+    bool box(glm::vec3 lo, glm::vec3 hi);
+};
+
+// FRUSTUM_HPP
+#endif
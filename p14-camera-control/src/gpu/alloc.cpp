@@ -0,0 +1,131 @@
+/* File name: alloc.cpp
+ *
+ * Intro:
+ * C++ implementation of the gpu (GPU memory) libraries' alloc (Allocation)
+ * module. */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#include "alloc.hpp"
+
+#include <iterator>
+
+namespace gpuLib {
+
+Alloc::Alloc(uint32_t capacity) {
+    _capacity = 0;
+    reset(capacity);
+}
+
+uint32_t Alloc::alloc(uint32_t size) {
+    if (size == 0) {
+        size = 1;
+    }
+
+    // Best fit: the smallest free range that is large enough
+    auto fit = _bySize.lower_bound(size);
+    if (fit == _bySize.end()) {
+        return noSpace;
+    }
+    uint32_t offset = fit->second;
+    uint32_t rangeSize = fit->first;
+    _removeFree(_byOffset.find(offset));
+
+    // Return the tail to the free ranges
+    if (rangeSize > size) {
+        _addFree(offset + size, rangeSize - size);
+    }
+
+    _used += size;
+    _allocs += 1;
+    return offset;
+}
+
+void Alloc::free(uint32_t offset, uint32_t size) {
+    if (size == 0) {
+        size = 1;
+    }
+    _used -= size;
+    _allocs -= 1;
+
+    // Coalesce with the neighboring free ranges
+    auto next = _byOffset.lower_bound(offset);
+    if (next != _byOffset.end() and offset + size == next->first) {
+        size += next->second;
+        _removeFree(next);
+        next = _byOffset.lower_bound(offset);
+    }
+    if (next != _byOffset.begin()) {
+        auto prev = std::prev(next);
+        if (prev->first + prev->second == offset) {
+            offset = prev->first;
+            size += prev->second;
+            _removeFree(prev);
+        }
+    }
+    _addFree(offset, size);
+}
+
+void Alloc::grow(uint32_t capacity) {
+    if (capacity <= _capacity) {
+        return;
+    }
+    uint32_t oldCapacity = _capacity;
+    _capacity = capacity;
+    // Account the new space as a temporary allocation and free it, so that
+    // it coalesces with a free range at the old end
+    _used += capacity - oldCapacity;
+    _allocs += 1;
+    free(oldCapacity, capacity - oldCapacity);
+}
+
+void Alloc::reset(uint32_t capacity) {
+    _capacity = capacity;
+    _used = 0;
+    _allocs = 0;
+    _byOffset.clear();
+    _bySize.clear();
+    if (capacity > 0) {
+        _addFree(0, capacity);
+    }
+}
+
+uint32_t Alloc::capacity() {
+    return _capacity;
+}
+
+AllocStats Alloc::stats() {
+    AllocStats result;
+    result.capacity = _capacity;
+    result.used = _used;
+    result.free = _capacity - _used;
+    result.largestFree = _bySize.empty() ? 0 : _bySize.rbegin()->first;
+    result.freeRanges = (int)_byOffset.size();
+    result.allocs = _allocs;
+    result.utilization = _capacity == 0 ? 0.0f : (float)_used / _capacity;
+    if (result.free == 0) {
+        result.fragmentation = 0.0f;
+    } else {
+        result.fragmentation = 1.0f - (float)result.largestFree / result.free;
+    }
+    return result;
+}
+
+void Alloc::_addFree(uint32_t offset, uint32_t size) {
+    _byOffset[offset] = size;
+    _bySize.emplace(size, offset);
+}
+
+void Alloc::_removeFree(std::map<uint32_t, uint32_t>::iterator range) {
+    auto sized = _bySize.equal_range(range->second);
+    for (auto it = sized.first; it != sized.second; ++it) {
+        if (it->second == range->first) {
+            _bySize.erase(it);
+            break;
+        }
+    }
+    _byOffset.erase(range);
+}
+
+}  // namespace gpuLib
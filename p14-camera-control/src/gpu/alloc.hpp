@@ -0,0 +1,82 @@
+/* File name: alloc.hpp
+ *
+ * Intro:
+ * C++ header of the gpu (GPU memory) libraries' alloc (Allocation) module.
+ * An offset allocator hands out ranges of an abstract address space (such as
+ * the elements of one large GL buffer) with best-fit placement and free range
+ * coalescing. It touches no GL state, so it runs on the CPU only. */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#ifndef GPU__ALLOC_HPP
+#define GPU__ALLOC_HPP
+
+#include <cstdint>
+#include <map>
+
+/* GPU memory library */
+namespace gpuLib {
+
+/* Allocation statistics (unit: address space units). */
+struct AllocStats {
+    /* Address space size. */
+    uint32_t capacity;
+    /* Allocated size. */
+    uint32_t used;
+    /* Free size. */
+    uint32_t free;
+    /* Largest free range's size. */
+    uint32_t largestFree;
+    /* Free range count. */
+    int freeRanges;
+    /* Live allocation count. */
+    int allocs;
+    /* Used / capacity. */
+    float utilization;
+    /* 1 - largestFree / free; 0 means all free space is in one range. */
+    float fragmentation;
+};
+
+/* Offset allocation. */
+class Alloc {
+   private:
+    /* Address space size. */
+    uint32_t _capacity;
+    /* Allocated size. */
+    uint32_t _used;
+    /* Live allocation count. */
+    int _allocs;
+    /* Free ranges, by offset (offset to size). */
+    std::map<uint32_t, uint32_t> _byOffset;
+    /* Free ranges, by size (size to offset); for best-fit lookups. */
+    std::multimap<uint32_t, uint32_t> _bySize;
+
+    void _addFree(uint32_t offset, uint32_t size);
+    void _removeFree(std::map<uint32_t, uint32_t>::iterator range);
+
+   public:
+    /* Returned by alloc when no free range is large enough. */
+    static uint32_t const noSpace = 0xFFFFFFFFu;
+
+    /* Initializes an allocation with the specified (free) capacity. */
+    Alloc(uint32_t capacity);
+    /* Allocates a range of the specified size and returns its offset.
+     * Returns noSpace if no free range is large enough. */
+    uint32_t alloc(uint32_t size);
+    /* Frees the range at the offset with the size it was allocated with. */
+    void free(uint32_t offset, uint32_t size);
+    /* Grows the capacity; the new space is free. */
+    void grow(uint32_t capacity);
+    /* Frees everything and updates the capacity. */
+    void reset(uint32_t capacity);
+    /* Reads the capacity. */
+    uint32_t capacity();
+    /* Finds the statistics. */
+    AllocStats stats();
+};
+
+}  // namespace gpuLib
+
+// GPU__ALLOC_HPP
+#endif
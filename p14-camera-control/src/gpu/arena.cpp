@@ -0,0 +1,169 @@
+/* File name: arena.cpp
+ *
+ * Intro:
+ * C++ implementation of the gpu (GPU memory) libraries' arena module. */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#include "arena.hpp"
+
+#include <algorithm>
+
+namespace gpuLib {
+
+Arena::Arena(Res &res, int elemSize, uint32_t capacity)
+    : _res(res), _alloc(capacity) {
+    _elemSize = elemSize;
+    _buffer = 0;
+    _gen = 0;
+}
+
+Arena::~Arena() {
+    _res.release(_bufferRes);
+}
+
+int Arena::alloc(uint32_t count) {
+    if (_buffer == 0) {
+        _move(_alloc.capacity(), false);
+    }
+
+    uint32_t offset = _alloc.alloc(count);
+    if (offset == Alloc::noSpace) {
+        uint32_t capacity = _alloc.capacity() * 2;
+        capacity = std::max(capacity, _alloc.capacity() + count);
+        _move(capacity, false);
+        offset = _alloc.alloc(count);
+    }
+
+    Block block = {offset, std::max(count, 1u), true};
+    int handle;
+    if (_freeHandles.empty()) {
+        handle = (int)_blocks.size();
+        _blocks.push_back(block);
+    } else {
+        handle = _freeHandles.back();
+        _freeHandles.pop_back();
+        _blocks[handle] = block;
+    }
+    return handle;
+}
+
+void Arena::free(int handle) {
+    Block &block = _blocks[handle];
+    if (!block.live) {
+        return;
+    }
+    _alloc.free(block.offset, block.size);
+    block.live = false;
+    _freeHandles.push_back(handle);
+}
+
+void Arena::upload(int handle, void const *data, uint32_t count) {
+    Block &block = _blocks[handle];
+    count = std::min(count, block.size);
+    // The copy write target leaves the vertex array bindings alone
+    glBindBuffer(GL_COPY_WRITE_BUFFER, _buffer);
+    // clang-format off
+    glBufferSubData(
+        GL_COPY_WRITE_BUFFER, block.offset * _elemSize, count * _elemSize, data
+    );
+    // clang-format on
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+uint32_t Arena::offset(int handle) {
+    return _blocks[handle].offset;
+}
+
+uint32_t Arena::size(int handle) {
+    return _blocks[handle].size;
+}
+
+GLuint Arena::buffer() {
+    return _buffer;
+}
+
+unsigned int Arena::gen() {
+    return _gen;
+}
+
+int Arena::elemSize() {
+    return (int)_elemSize;
+}
+
+AllocStats Arena::stats() {
+    return _alloc.stats();
+}
+
+void Arena::compact() {
+    _move(_alloc.capacity(), true);
+}
+
+bool Arena::compactIfFragmented(float threshold) {
+    if (_alloc.stats().fragmentation <= threshold) {
+        return false;
+    }
+    compact();
+    return true;
+}
+
+void Arena::_move(uint32_t capacity, bool pack) {
+    ResHandle newRes = _res.create(resBuffer);
+    GLuint newBuffer = _res.name(newRes);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, newBuffer);
+    // clang-format off
+    glBufferData(
+        GL_COPY_WRITE_BUFFER, capacity * _elemSize, NULL, GL_STATIC_DRAW
+    );
+    // clang-format on
+    _res.bytes(newRes, capacity * _elemSize);
+
+    if (_buffer != 0) {
+        glBindBuffer(GL_COPY_READ_BUFFER, _buffer);
+        if (pack) {
+            // Pack the live blocks in offset order
+            std::vector<int> order;
+            for (size_t i = 0; i < _blocks.size(); i += 1) {
+                if (_blocks[i].live) {
+                    order.push_back((int)i);
+                }
+            }
+            std::sort(order.begin(), order.end(), [this](int a, int b) {
+                return _blocks[a].offset < _blocks[b].offset;
+            });
+            _alloc.reset(capacity);
+            for (int handle : order) {
+                Block &block = _blocks[handle];
+                uint32_t newOffset = _alloc.alloc(block.size);
+                // clang-format off
+                glCopyBufferSubData(
+                    GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                    block.offset * _elemSize, newOffset * _elemSize,
+                    block.size * _elemSize
+                );
+                // clang-format on
+                block.offset = newOffset;
+            }
+        } else {
+            // Keep the offsets and add the new space at the end
+            // clang-format off
+            glCopyBufferSubData(
+                GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                0, 0, _alloc.capacity() * _elemSize
+            );
+            // clang-format on
+            _alloc.grow(capacity);
+        }
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        // Deleted once the GPU is done copying from it
+        _res.release(_bufferRes);
+    }
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    _buffer = newBuffer;
+    _bufferRes = newRes;
+    _gen += 1;
+}
+
+}  // namespace gpuLib
@@ -0,0 +1,101 @@
+/* File name: arena.hpp
+ *
+ * Intro:
+ * C++ header of the gpu (GPU memory) libraries' arena module.
+ * An arena is one large GL buffer that is sub-allocated among many meshes.
+ * Allocations are addressed by handles, so the arena can grow and compact
+ * (defragment) itself by moving the allocations to a new buffer. The buffers
+ * are owned by a resource manager, which deletes an old buffer once the GPU
+ * is done with it.
+ * 
+ * Dependencies:
+ * 1. GLEW library (libglew-dev); needs GL 3.1 (glCopyBufferSubData)
+ * 2. The gpu libraries' alloc module (alloc.hpp)
+ * 3. The gpu libraries' res module (res.hpp) */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#ifndef GPU__ARENA_HPP
+#define GPU__ARENA_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "alloc.hpp"
+#include "res.hpp"
+
+/* GPU memory library */
+namespace gpuLib {
+
+/* (GPU buffer) arena. */
+class Arena {
+   private:
+    /* Allocation of a handle. */
+    struct Block {
+        /* Offset (unit: elements). */
+        uint32_t offset;
+        /* Size (unit: elements). */
+        uint32_t size;
+        bool live;
+    };
+
+    /* Element size (unit: bytes). */
+    GLsizeiptr _elemSize;
+    Res &_res;
+    /* GL buffer name (0 before the first allocation), and its handle. */
+    GLuint _buffer;
+    ResHandle _bufferRes;
+    /* Buffer generation; increases whenever the buffer name changes. */
+    unsigned int _gen;
+    Alloc _alloc;
+    std::vector<Block> _blocks;
+    /* Handles of the freed blocks, reused by later allocations. */
+    std::vector<int> _freeHandles;
+
+    /* Moves the live blocks to a new buffer of the specified capacity.
+     * Packs the blocks at the front if pack is true. */
+    void _move(uint32_t capacity, bool pack);
+
+   public:
+    /* Initializes an arena of the specified element size (unit: bytes) and
+     * initial capacity (unit: elements), with buffers of a resource manager.
+     * The GL buffer is created on the first allocation. */
+    Arena(Res &res, int elemSize, uint32_t capacity);
+    /* Releases the GL buffer. */
+    ~Arena();
+    /* Allocates count elements and returns the allocation's handle.
+     * Grows the buffer (to at least twice its size) if it is out of space. */
+    int alloc(uint32_t count);
+    /* Frees the allocation of the handle. */
+    void free(int handle);
+    /* Uploads count elements to the allocation of the handle. */
+    void upload(int handle, void const *data, uint32_t count);
+    /* Reads the offset of the allocation of the handle (unit: elements). */
+    uint32_t offset(int handle);
+    /* Reads the size of the allocation of the handle (unit: elements). */
+    uint32_t size(int handle);
+    /* Reads the GL buffer name. */
+    GLuint buffer();
+    /* Reads the buffer generation.
+     * Note:
+     * Vertex arrays that read the buffer must be rebuilt when it changes. */
+    unsigned int gen();
+    /* Reads the element size (unit: bytes). */
+    int elemSize();
+    /* Finds the allocation statistics (unit: elements). */
+    AllocStats stats();
+    /* Compacts (defragments) the arena by packing the allocations at the
+     * front of a new buffer. Handles stay valid; offsets change. */
+    void compact();
+    /* Compacts the arena if its fragmentation is above the threshold.
+     * Returns whether it compacted. */
+    bool compactIfFragmented(float threshold);
+};
+
+}  // namespace gpuLib
+
+// GPU__ARENA_HPP
+#endif
@@ -0,0 +1,358 @@
+/* File name: cull.cpp
+ *
+ * Intro:
+ * C++ implementation of the gpu (GPU memory) libraries' cull (GPU culling)
+ * module. */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#include "cull.hpp"
+
+#include <cstddef>
+
+#include "../frustum.hpp"
+#include "../mesh/lod.hpp"
+
+namespace gpuLib {
+
+/* Work group size (matches local_size_x in cull.cs). */
+static int const groupSize = 64;
+
+/* Creates a buffer with a resource manager; returns its GL name. */
+static GLuint createBuffer(Res &res, ResHandle &handle) {
+    handle = res.create(resBuffer);
+    return res.name(handle);
+}
+
+Cull::Cull(Res &res) : _res(res) {
+    _program = 0;
+    _objBuffer = 0;
+    _meshBuffer = 0;
+    _cmdBuffers[0] = 0;
+    _cmdBuffers[1] = 0;
+    _dataBuffers[0] = 0;
+    _dataBuffers[1] = 0;
+    _counterBuffer = 0;
+    _statBuffer = 0;
+    _objCount = 0;
+    _countDraw = false;
+    _viewProj = glm::mat4(1.0f);
+    _camPos = glm::vec3(0.0f, 0.0f, 0.0f);
+    _pxPerUnit = 1.0f;
+    _maxErrPx = 1.0f;
+    _hyst = 0.0f;
+    _drawPass = 0;
+}
+
+Cull::~Cull() {
+    _res.release(_objRes);
+    _res.release(_meshRes);
+    for (int i = 0; i < 2; i += 1) {
+        _res.release(_cmdRes[i]);
+        _res.release(_dataRes[i]);
+    }
+    _res.release(_counterRes);
+    _res.release(_statRes);
+}
+
+GLuint Cull::program() {
+    return _program;
+}
+
+GLuint Cull::program(GLuint newVal) {
+    GLuint oldVal = _program;
+    _program = newVal;
+
+    _viewProjLoc = glGetUniformLocation(_program, "viewProj");
+    _planesLoc = glGetUniformLocation(_program, "planes");
+    _camPosLoc = glGetUniformLocation(_program, "camPos");
+    _pxPerUnitLoc = glGetUniformLocation(_program, "pxPerUnit");
+    _maxErrPxLoc = glGetUniformLocation(_program, "maxErrPx");
+    _hystLoc = glGetUniformLocation(_program, "hyst");
+    _objCountLoc = glGetUniformLocation(_program, "objCount");
+    _passLoc = glGetUniformLocation(_program, "pass");
+    _occlViewProjLoc = glGetUniformLocation(_program, "occlViewProj");
+    _hizSizeLoc = glGetUniformLocation(_program, "hizSize");
+    _hizLevelsLoc = glGetUniformLocation(_program, "hizLevels");
+    return oldVal;
+}
+
+void Cull::meshes(std::vector<CullMesh> const &meshes) {
+    if (_meshBuffer == 0) {
+        _meshBuffer = createBuffer(_res, _meshRes);
+    }
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, _meshBuffer);
+    // clang-format off
+    glBufferData(
+        GL_SHADER_STORAGE_BUFFER, meshes.size() * sizeof(CullMesh),
+        meshes.data(), GL_STATIC_DRAW
+    );
+    // clang-format on
+    _res.bytes(_meshRes, meshes.size() * sizeof(CullMesh));
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void Cull::objs(std::vector<CullObj> const &objs) {
+    if (_objBuffer == 0) {
+        _objBuffer = createBuffer(_res, _objRes);
+        for (int i = 0; i < 2; i += 1) {
+            _cmdBuffers[i] = createBuffer(_res, _cmdRes[i]);
+            _dataBuffers[i] = createBuffer(_res, _dataRes[i]);
+        }
+        _counterBuffer = createBuffer(_res, _counterRes);
+        _statBuffer = createBuffer(_res, _statRes);
+
+        // One counter per pass
+        glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, _counterBuffer);
+        // clang-format off
+        glBufferData(
+            GL_ATOMIC_COUNTER_BUFFER, 2 * sizeof(GLuint), NULL,
+            GL_DYNAMIC_DRAW
+        );
+        // clang-format on
+        _res.bytes(_counterRes, 2 * sizeof(GLuint));
+        glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, 0);
+
+        // Drawn triangles and occluded objects
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, _statBuffer);
+        // clang-format off
+        glBufferData(
+            GL_SHADER_STORAGE_BUFFER, 2 * sizeof(GLuint), NULL,
+            GL_DYNAMIC_DRAW
+        );
+        // clang-format on
+        _res.bytes(_statRes, 2 * sizeof(GLuint));
+
+        _countDraw = GLEW_VERSION_4_6 or GLEW_ARB_indirect_parameters;
+    }
+
+    // The objects' levels of detail live on the GPU from here on
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, _objBuffer);
+    // clang-format off
+    glBufferData(
+        GL_SHADER_STORAGE_BUFFER, objs.size() * sizeof(CullObj), objs.data(),
+        GL_DYNAMIC_DRAW
+    );
+    // clang-format on
+    _res.bytes(_objRes, objs.size() * sizeof(CullObj));
+
+    // Only resize the outputs when the object count changes
+    if ((int)objs.size() != _objCount) {
+        _objCount = (int)objs.size();
+        for (int i = 0; i < 2; i += 1) {
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, _cmdBuffers[i]);
+            // clang-format off
+            glBufferData(
+                GL_SHADER_STORAGE_BUFFER, _objCount * sizeof(DrawCmd), NULL,
+                GL_DYNAMIC_DRAW
+            );
+            // clang-format on
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, _dataBuffers[i]);
+            // clang-format off
+            glBufferData(
+                GL_SHADER_STORAGE_BUFFER, _objCount * sizeof(DrawData), NULL,
+                GL_DYNAMIC_DRAW
+            );
+            // clang-format on
+            _res.bytes(_cmdRes[i], _objCount * sizeof(DrawCmd));
+            _res.bytes(_dataRes[i], _objCount * sizeof(DrawData));
+        }
+    }
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void Cull::obj(int index, CullObj const &obj) {
+    if (index < 0 or index >= _objCount) {
+        return;
+    }
+    GLintptr base = (GLintptr)index * sizeof(CullObj);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, _objBuffer);
+    // The fields before lod, and scale, skipping the shader's lod and late
+    GLsizeiptr head = offsetof(CullObj, lod);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, base, head, &obj);
+    // clang-format off
+    glBufferSubData(
+        GL_SHADER_STORAGE_BUFFER, base + offsetof(CullObj, scale),
+        sizeof(obj.scale), &obj.scale
+    );
+    // clang-format on
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+int Cull::objCount() {
+    return _objCount;
+}
+
+void Cull::view(glm::mat4 const &viewProj, glm::vec3 camPos,
+                meshLib::LodSel &lodSel) {
+    _viewProj = viewProj;
+    _camPos = camPos;
+    _pxPerUnit = lodSel.pxPerUnit();
+    _maxErrPx = lodSel.maxErrPx();
+    _hyst = lodSel.hyst();
+}
+
+void Cull::cull() {
+    _reset();
+    _run(0, nullptr, _viewProj);
+}
+
+void Cull::cullEarly(HiZ &hiz, glm::mat4 const &prevViewProj) {
+    _reset();
+    _run(1, hiz.valid() ? &hiz : nullptr, prevViewProj);
+}
+
+void Cull::cullLate(HiZ &hiz) {
+    _run(2, &hiz, _viewProj);
+}
+
+void Cull::_reset() {
+    if (_objCount == 0) {
+        return;
+    }
+
+    GLuint zeros[2] = {0, 0};
+    glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, _counterBuffer);
+    glBufferSubData(GL_ATOMIC_COUNTER_BUFFER, 0, sizeof(zeros), zeros);
+    glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, 0);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, _statBuffer);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(zeros), zeros);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void Cull::_run(int pass, HiZ *hiz, glm::mat4 const &occlViewProj) {
+    if (_objCount == 0) {
+        return;
+    }
+    int slot = pass == 2 ? 1 : 0;
+    _drawPass = slot;
+
+    // Without a GPU side draw count, empty the commands so the slots past
+    // the count draw nothing
+    if (!_countDraw) {
+        GLuint zero = 0;
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, _cmdBuffers[slot]);
+        // clang-format off
+        glClearBufferData(
+            GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER,
+            GL_UNSIGNED_INT, &zero
+        );
+        // clang-format on
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+
+    // The planes are in world space, like the objects' spheres
+    Frustum frustum(_viewProj);
+    glm::vec4 planes[6];
+    for (int i = 0; i < 6; i += 1) {
+        planes[i] = frustum.plane(i);
+    }
+
+    GLint lastProgram = 0;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &lastProgram);
+    glUseProgram(_program);
+    glUniformMatrix4fv(_viewProjLoc, 1, GL_FALSE, glm::value_ptr(_viewProj));
+    glUniform4fv(_planesLoc, 6, glm::value_ptr(planes[0]));
+    glUniform3fv(_camPosLoc, 1, glm::value_ptr(_camPos));
+    glUniform1f(_pxPerUnitLoc, _pxPerUnit);
+    glUniform1f(_maxErrPxLoc, _maxErrPx);
+    glUniform1f(_hystLoc, _hyst);
+    glUniform1ui(_objCountLoc, (GLuint)_objCount);
+
+    // Pass 0 and an early pass without a pyramid only test the frustum
+    glUniform1i(_passLoc, hiz == nullptr ? 0 : pass);
+    // clang-format off
+    glUniformMatrix4fv(
+        _occlViewProjLoc, 1, GL_FALSE, glm::value_ptr(occlViewProj)
+    );
+    // clang-format on
+    if (hiz != nullptr) {
+        glUniform2f(_hizSizeLoc, (float)hiz->width(), (float)hiz->height());
+        glUniform1i(_hizLevelsLoc, hiz->levelCount());
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, hiz->texture());
+    }
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, _dataBuffers[slot]);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, _objBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, _meshBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, _cmdBuffers[slot]);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, _statBuffer);
+    glBindBufferBase(GL_ATOMIC_COUNTER_BUFFER, 0, _counterBuffer);
+    glDispatchCompute((_objCount + groupSize - 1) / groupSize, 1, 1);
+    glUseProgram(lastProgram);
+    if (hiz != nullptr) {
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    // The draw reads the commands, the count, and the per-draw data; the
+    // late pass reads the objects the early pass wrote
+    // clang-format off
+    glMemoryBarrier(
+        GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT |
+        GL_ATOMIC_COUNTER_BARRIER_BIT
+    );
+    // clang-format on
+}
+
+void Cull::draw(GLuint binding) {
+    if (_objCount == 0) {
+        return;
+    }
+
+    int slot = _drawPass;
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, _dataBuffers[slot]);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, _cmdBuffers[slot]);
+    if (_countDraw) {
+        GLintptr countOffset = slot * sizeof(GLuint);
+        glBindBuffer(GL_PARAMETER_BUFFER_ARB, _counterBuffer);
+        // clang-format off
+        glMultiDrawElementsIndirectCountARB(
+            GL_TRIANGLES, GL_UNSIGNED_INT, 0, countOffset, _objCount, 0
+        );
+        // clang-format on
+        glBindBuffer(GL_PARAMETER_BUFFER_ARB, 0);
+    } else {
+        // clang-format off
+        glMultiDrawElementsIndirect(
+            GL_TRIANGLES, GL_UNSIGNED_INT, 0, _objCount, 0
+        );
+        // clang-format on
+    }
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+CullStats Cull::stats() {
+    CullStats result;
+    result.visible = 0;
+    result.late = 0;
+    result.occluded = 0;
+    result.tris = 0;
+    if (_objCount == 0) {
+        return result;
+    }
+
+    GLuint counts[2] = {0, 0};
+    glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, _counterBuffer);
+    glGetBufferSubData(GL_ATOMIC_COUNTER_BUFFER, 0, sizeof(counts), counts);
+    glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, 0);
+    GLuint stats[2] = {0, 0};
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, _statBuffer);
+    glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(stats), stats);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    result.visible = (int)(counts[0] + counts[1]);
+    result.late = (int)counts[1];
+    result.tris = (long)stats[0];
+    result.occluded = (int)stats[1];
+    return result;
+}
+
+bool cullSupported() {
+    bool compute = GLEW_VERSION_4_3 or GLEW_ARB_compute_shader;
+    bool clear = GLEW_VERSION_4_3 or GLEW_ARB_clear_buffer_object;
+    return compute and clear and indirectSupported();
+}
+
+}  // namespace gpuLib
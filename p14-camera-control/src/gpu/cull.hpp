@@ -0,0 +1,216 @@
+/* File name: cull.hpp
+ *
+ * Intro:
+ * C++ header of the gpu (GPU memory) libraries' cull (GPU culling) module.
+ * A compute shader (cull.cs) tests every object's bounding sphere against the
+ * frustum planes, selects the visible objects' levels of detail, and appends
+ * their draw commands and per-draw data with an atomic counter. The compacted
+ * commands are then drawn with one multi draw indirect call, whose draw count
+ * is read from the counter on the GPU where GL_ARB_indirect_parameters is
+ * supported. Otherwise, the command buffer is cleared each frame and all slots
+ * are drawn; the empty ones draw nothing. Either way, the CPU neither culls
+ * nor rebuilds the draw list.
+ * With a Hi-Z pyramid (hiz.hpp), culling runs in two passes. The early pass
+ * tests the objects against the previous frame's pyramid, reprojected with the
+ * previous frame's matrices, and draws the ones that pass. The late pass tests
+ * the rest against a pyramid of the early pass's depth with the current
+ * matrices, and draws the disoccluded ones.
+ * 
+ * Dependencies:
+ * 1. GLEW library (libglew-dev); needs GL 4.3 (compute shaders, shader
+ *    storage buffers, multi draw indirect) and GL_ARB_shader_draw_parameters
+ * 2. GLM library (libglm-dev)
+ * 3. The gpu libraries' indirect module (indirect.hpp)
+ * 4. The gpu libraries' hiz module (hiz.hpp)
+ * 5. The gpu libraries' res module (res.hpp)
+ * 6. The view frustum custom library (../frustum.hpp)
+ * 7. The mesh libraries' lod module (../mesh/lod.hpp) */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#ifndef GPU__CULL_HPP
+#define GPU__CULL_HPP
+
+#include <vector>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <glm/ext.hpp>
+
+#include "indirect.hpp"
+#include "hiz.hpp"
+#include "res.hpp"
+
+// Forward declare Frustum (from ../frustum.hpp) and LodSel (from
+// ../mesh/lod.hpp)
+class Frustum;
+namespace meshLib {
+class LodSel;
+}
+// Include ../frustum.hpp and ../mesh/lod.hpp in gpu/cull.cpp to complete the
+// declarations above
+
+/* GPU memory library */
+namespace gpuLib {
+
+/* Largest level of detail count of a GPU culled mesh. */
+int const cullMaxLevels = 8;
+
+/* GPU culled object (std430 layout; matches struct Obj in cull.cs). */
+struct CullObj {
+    /* Transformation (object space to world space). */
+    glm::mat4 world;
+    /* World space bounding sphere (xyz: center; w: radius). */
+    glm::vec4 sphere;
+    /* Index of the object's mesh. */
+    GLint mesh;
+    /* Currently selected level of detail (updated by the shader). */
+    GLint lod;
+    /* Largest scale. */
+    float scale;
+    /* Whether the early pass left the object to the late pass (set by the
+     * shader). */
+    GLint late;
+};
+
+/* Level of detail of a GPU culled mesh. */
+struct CullLevel {
+    /* First index, relative to the mesh's first index. */
+    GLuint first;
+    /* Index count. */
+    GLuint count;
+    /* Geometric error (unit: object space lengths). */
+    float err;
+    GLuint pad;
+};
+
+/* GPU culled mesh (std430 layout; matches struct Mesh in cull.cs). */
+struct CullMesh {
+    /* Dequantization scale (xyz; w unused). */
+    glm::vec4 posScale;
+    /* Dequantization offset (xyz; w unused). */
+    glm::vec4 posOffset;
+    /* Base vertex in the vertex arena. */
+    GLint baseVertex;
+    /* First index in the index arena. */
+    GLuint firstIndex;
+    /* Level of detail count. */
+    GLint levelCount;
+    GLint pad;
+    CullLevel levels[cullMaxLevels];
+};
+
+/* GPU culling statistics (of the last frame). */
+struct CullStats {
+    /* Drawn objects. */
+    int visible;
+    /* Drawn objects found by the late pass (disocclusions). */
+    int late;
+    /* Objects inside the frustum but occluded. */
+    int occluded;
+    /* Drawn triangles. */
+    long tris;
+};
+
+/* Cull (GPU culling and draw compaction). */
+class Cull {
+   private:
+    /* Compute shader program. */
+    GLuint _program;
+    /* Uniform locations. */
+    GLint _viewProjLoc;
+    GLint _planesLoc;
+    GLint _camPosLoc;
+    GLint _pxPerUnitLoc;
+    GLint _maxErrPxLoc;
+    GLint _hystLoc;
+    GLint _objCountLoc;
+    GLint _passLoc;
+    GLint _occlViewProjLoc;
+    GLint _hizSizeLoc;
+    GLint _hizLevelsLoc;
+    Res &_res;
+    /* Buffers, and their handles; each pass has its own commands, per-draw
+     * data, and counter. */
+    GLuint _objBuffer;
+    GLuint _meshBuffer;
+    GLuint _cmdBuffers[2];
+    GLuint _dataBuffers[2];
+    GLuint _counterBuffer;
+    GLuint _statBuffer;
+    ResHandle _objRes;
+    ResHandle _meshRes;
+    ResHandle _cmdRes[2];
+    ResHandle _dataRes[2];
+    ResHandle _counterRes;
+    ResHandle _statRes;
+    /* Object count. */
+    int _objCount;
+    /* Whether the draw count is read from the counter on the GPU. */
+    bool _countDraw;
+    /* Frame state (see view). */
+    glm::mat4 _viewProj;
+    glm::vec3 _camPos;
+    float _pxPerUnit;
+    float _maxErrPx;
+    float _hyst;
+    /* Pass whose draws are drawn next (0: early or only, 1: late). */
+    int _drawPass;
+
+    /* Resets the counters and the statistics. */
+    void _reset();
+    /* Runs a pass (0: without occlusion; 1: early; 2: late). */
+    void _run(int pass, HiZ *hiz, glm::mat4 const &occlViewProj);
+
+   public:
+    /* Constructs a culling stage without objects; the GL buffers are created
+     * (with a resource manager) on the first upload. */
+    Cull(Res &res);
+    /* Releases the GL buffers. */
+    ~Cull();
+    /* Reads the compute shader program. */
+    GLuint program();
+    /* Reads and updates the compute shader program (compiled from cull.cs
+     * and linked); finds its uniform locations. */
+    GLuint program(GLuint newVal);
+    /* Uploads the meshes. */
+    void meshes(std::vector<CullMesh> const &meshes);
+    /* Uploads the objects and sizes the command and per-draw data buffers to
+     * hold all of them. */
+    void objs(std::vector<CullObj> const &objs);
+    /* Updates a moved object's transformation, sphere, mesh, and scale in
+     * place; its level of detail and late flag, and the other objects, stay
+     * as the shader left them. */
+    void obj(int index, CullObj const &obj);
+    /* Reads the object count. */
+    int objCount();
+    /* Updates the frame state: the projection view matrix, the camera
+     * position, and the level of detail selection. */
+    void view(glm::mat4 const &viewProj, glm::vec3 camPos, meshLib::LodSel &);
+    /* Culls the objects against the frustum and compacts the visible ones'
+     * draws on the GPU. */
+    void cull();
+    /* Runs the early pass with the previous frame's pyramid and projection
+     * view matrix; without a built pyramid, only the frustum is tested. */
+    void cullEarly(HiZ &hiz, glm::mat4 const &prevViewProj);
+    /* Runs the late pass with a pyramid of the early pass's depth. */
+    void cullLate(HiZ &hiz);
+    /* Draws the last pass's compacted draws with one call.
+     * The per-draw data is bound to the shader storage binding point binding;
+     * the vertex array and the drawing shader program (indirect.vs) must
+     * already be bound. */
+    void draw(GLuint binding);
+    /* Reads back the statistics.
+     * Note:
+     * This waits for the GPU, so it is only for statistics. */
+    CullStats stats();
+};
+
+/* Finds whether the GL context supports GPU culling. */
+bool cullSupported();
+
+}  // namespace gpuLib
+
+// GPU__CULL_HPP
+#endif
@@ -0,0 +1,94 @@
+/* File name: frames.cpp
+ *
+ * Intro:
+ * C++ implementation of the gpu (GPU memory) libraries' frames (Frames in
+ * flight) module. */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#include "frames.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+/* Longest single wait before a fence is polled again (unit: nanoseconds). */
+static GLuint64 const waitTimeout = 100000000;
+
+namespace gpuLib {
+
+Frames::Frames(int depth) {
+    _depth = std::max(1, std::min(depth, framesMaxDepth));
+    for (int i = 0; i < framesMaxDepth; i += 1) {
+        _fences[i] = 0;
+    }
+    _slot = 0;
+    _stats.depth = _depth;
+    _stats.frames = 0;
+    _stats.waits = 0;
+    _stats.waitMs = 0.0;
+    _stats.totalWaitMs = 0.0;
+    _stats.maxWaitMs = 0.0;
+}
+
+void Frames::_wait(int slot) {
+    GLsync fence = _fences[slot];
+    if (fence == 0) {
+        return;
+    }
+    // The first wait flushes, so the fence is sure to reach the GPU
+    GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+    GLenum status = glClientWaitSync(fence, flags, 0);
+    if (status == GL_TIMEOUT_EXPIRED) {
+        auto start = std::chrono::steady_clock::now();
+        while (status == GL_TIMEOUT_EXPIRED) {
+            status = glClientWaitSync(fence, 0, waitTimeout);
+        }
+        auto end = std::chrono::steady_clock::now();
+        std::chrono::duration<double, std::milli> elapsed = end - start;
+        _stats.waits += 1;
+        _stats.waitMs = elapsed.count();
+        _stats.totalWaitMs += _stats.waitMs;
+        _stats.maxWaitMs = std::max(_stats.maxWaitMs, _stats.waitMs);
+    }
+    glDeleteSync(fence);
+    _fences[slot] = 0;
+}
+
+int Frames::depth() {
+    return _depth;
+}
+
+int Frames::depth(int newVal) {
+    int oldVal = _depth;
+    for (int i = 0; i < framesMaxDepth; i += 1) {
+        _wait(i);
+    }
+    _depth = std::max(1, std::min(newVal, framesMaxDepth));
+    _slot = 0;
+    _stats.depth = _depth;
+    return oldVal;
+}
+
+void Frames::begin() {
+    _stats.frames += 1;
+    _stats.waitMs = 0.0;
+    _slot = (_slot + 1) % _depth;
+    _wait(_slot);
+}
+
+void Frames::end() {
+    if (GLEW_VERSION_3_2 or GLEW_ARB_sync) {
+        _fences[_slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+}
+
+int Frames::slot() {
+    return _slot;
+}
+
+FramesStats Frames::stats() {
+    return _stats;
+}
+
+}  // namespace gpuLib
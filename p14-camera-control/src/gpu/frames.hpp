@@ -0,0 +1,81 @@
+/* File name: frames.hpp
+ *
+ * Intro:
+ * C++ header of the gpu (GPU memory) libraries' frames (Frames in flight)
+ * module.
+ * The CPU may record up to depth frames before the GPU finishes the oldest
+ * of them. Each frame is fenced at its end, and a frame begins by waiting
+ * for the fence of the frame depth frames before it, so the CPU runs ahead
+ * of the GPU by a bounded amount instead of by whatever the driver queues.
+ * The frames cycle through depth slots; a resource that the CPU rewrites
+ * every frame is kept once per slot, and the slot of the current frame is
+ * never read by the GPU, so it is updated without stalls or races.
+ *
+ * Dependencies:
+ * 1. GLEW library (libglew-dev); fences need GL 3.2 (ARB_sync), without
+ *    which frames do not wait */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#ifndef GPU__FRAMES_HPP
+#define GPU__FRAMES_HPP
+
+#include <GL/glew.h>
+
+/* GPU memory library */
+namespace gpuLib {
+
+/* Most frames in flight (the size of per-frame resources). */
+static int const framesMaxDepth = 3;
+
+/* Frames in flight statistics. */
+struct FramesStats {
+    int depth;
+    /* Frames begun. */
+    long frames;
+    /* Frames that waited for the GPU. */
+    long waits;
+    /* Time the last frame waited (unit: milliseconds). */
+    double waitMs;
+    /* Total and longest waiting times (unit: milliseconds). */
+    double totalWaitMs;
+    double maxWaitMs;
+};
+
+/* Frames (in flight). */
+class Frames {
+   private:
+    int _depth;
+    /* Fences at the ends of the frames, by slot (0 if none). */
+    GLsync _fences[framesMaxDepth];
+    /* Slot of the current frame. */
+    int _slot;
+    FramesStats _stats;
+
+    /* Waits for a slot's fence and deletes it. */
+    void _wait(int slot);
+
+   public:
+    /* Constructs frames of a depth (clamped to 1 to framesMaxDepth); touches
+     * no GL state. */
+    Frames(int depth);
+    /* Reads the depth. */
+    int depth();
+    /* Reads and updates the depth (waiting for the frames in flight). */
+    int depth(int newVal);
+    /* Begins a frame: waits until the GPU has finished the frame that used
+     * the next slot. */
+    void begin();
+    /* Ends a frame: fences its commands. */
+    void end();
+    /* Reads the slot of the current frame (in 0 to depth - 1). */
+    int slot();
+    /* Reads the statistics. */
+    FramesStats stats();
+};
+
+}  // namespace gpuLib
+
+// GPU__FRAMES_HPP
+#endif
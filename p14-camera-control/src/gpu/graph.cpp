@@ -0,0 +1,200 @@
+/* File name: graph.cpp
+ *
+ * Intro:
+ * C++ implementation of the gpu (GPU memory) libraries' graph (Render graph)
+ * module. */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#include "graph.hpp"
+
+namespace gpuLib {
+
+Graph::Graph(Res &res) : _res(res) {
+    _compiled = false;
+    _stats = GraphStats{0, 0, 0, 0, 0, 0, 0, 0};
+}
+
+int Graph::texture(char const *name, GraphDesc desc) {
+    _compiled = false;
+    return _plan.texture(name, desc);
+}
+
+int Graph::import(char const *name, GLuint framebuffer, int width,
+                  int height) {
+    _compiled = false;
+    return _plan.import(name, framebuffer, width, height);
+}
+
+int Graph::pass(char const *name, Run run) {
+    _runs.push_back(run);
+    _compiled = false;
+    return _plan.pass(name);
+}
+
+void Graph::read(int pass, int resource) {
+    _plan.read(pass, resource);
+    _compiled = false;
+}
+
+void Graph::write(int pass, int resource) {
+    _plan.write(pass, resource);
+    _compiled = false;
+}
+
+void Graph::keep(int pass) {
+    _plan.keep(pass);
+    _compiled = false;
+}
+
+void Graph::_release() {
+    for (ResHandle handle : _textures) {
+        _res.release(handle);
+    }
+    for (ResHandle handle : _framebuffers) {
+        _res.release(handle);
+    }
+    _textures.clear();
+    _framebuffers.clear();
+}
+
+void Graph::_createTextures() {
+    for (GraphDesc const &desc : _plan.textures()) {
+        GraphFormat const *format = graphFormat(desc.format);
+        bool depth = format->format == GL_DEPTH_COMPONENT;
+        GLint filter = depth ? GL_NEAREST : GL_LINEAR;
+        ResHandle handle = _res.create(resTexture);
+        glBindTexture(GL_TEXTURE_2D, _res.name(handle));
+        // clang-format off
+        glTexImage2D(
+            GL_TEXTURE_2D, 0, format->internal, desc.width, desc.height, 0,
+            format->format, format->type, NULL
+        );
+        // clang-format on
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        _res.bytes(handle, (long)desc.width * desc.height * format->bytes);
+        _textures.push_back(handle);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+bool Graph::_createFramebuffers() {
+    bool complete = true;
+    for (std::vector<int> const &textures : _plan.framebuffers()) {
+        ResHandle handle = _res.create(resFramebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, _res.name(handle));
+        std::vector<GLenum> colors;
+        for (int texture : textures) {
+            GraphDesc const &desc = _plan.textures()[texture];
+            GLenum attachment = GL_COLOR_ATTACHMENT0 + (GLenum)colors.size();
+            if (graphFormat(desc.format)->format == GL_DEPTH_COMPONENT) {
+                attachment = GL_DEPTH_ATTACHMENT;
+            } else {
+                colors.push_back(attachment);
+            }
+            // clang-format off
+            glFramebufferTexture2D(
+                GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D,
+                _res.name(_textures[texture]), 0
+            );
+            // clang-format on
+        }
+        if (colors.empty()) {
+            glDrawBuffer(GL_NONE);
+        } else {
+            glDrawBuffers((GLsizei)colors.size(), colors.data());
+        }
+        GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+        complete = complete and status == GL_FRAMEBUFFER_COMPLETE;
+        _framebuffers.push_back(handle);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    return complete;
+}
+
+bool Graph::compile() {
+    _release();
+    // Marked compiled even if it fails, so a broken graph is not rebuilt
+    // every frame
+    _compiled = true;
+    bool planned = _plan.plan();
+    PlanStats plan = _plan.stats();
+    // clang-format off
+    _stats = GraphStats{
+        plan.passes, plan.culled, plan.transients, plan.textures, plan.bytes,
+        plan.unaliasedBytes, plan.framebuffers, _stats.binds
+    };
+    // clang-format on
+    if (!planned) {
+        return false;
+    }
+    _createTextures();
+    return _createFramebuffers();
+}
+
+GLuint Graph::_framebuffer(Plan::Pass const &pass) {
+    if (pass.framebuffer >= 0 and
+        pass.framebuffer < (int)_framebuffers.size()) {
+        return _res.name(_framebuffers[pass.framebuffer]);
+    }
+    if (!pass.writes.empty()) {
+        return _plan.resources()[pass.writes[0]].framebuffer;
+    }
+    return 0;
+}
+
+void Graph::execute() {
+    if (!_compiled) {
+        compile();
+    }
+
+    // Bindings are skipped while consecutive passes share a framebuffer
+    _stats.binds = 0;
+    long bound = -1;
+    for (int index : _plan.order()) {
+        Plan::Pass const &pass = _plan.passes()[index];
+        if (!pass.writes.empty()) {
+            GLuint framebuffer = _framebuffer(pass);
+            if ((long)framebuffer != bound) {
+                glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+                bound = framebuffer;
+                _stats.binds += 1;
+            }
+            GraphDesc const &desc = _plan.resources()[pass.writes[0]].desc;
+            glViewport(0, 0, desc.width, desc.height);
+        }
+        _runs[index]();
+    }
+    if (bound != 0) {
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+}
+
+bool Graph::culled(int pass) {
+    return _plan.passes()[pass].culled;
+}
+
+GLuint Graph::name(int resource) {
+    int texture = _plan.resources()[resource].texture;
+    bool created = texture >= 0 and texture < (int)_textures.size();
+    return created ? _res.name(_textures[texture]) : 0;
+}
+
+GLuint Graph::framebuffer(int pass) {
+    return _framebuffer(_plan.passes()[pass]);
+}
+
+void Graph::dump(FILE *file) {
+    _plan.dump(file);
+    fprintf(file, "  %d binds per frame\n", _stats.binds);
+}
+
+GraphStats Graph::stats() {
+    return _stats;
+}
+
+}  // namespace gpuLib
@@ -0,0 +1,124 @@
+/* File name: graph.hpp
+ *
+ * Intro:
+ * C++ header of the gpu (GPU memory) libraries' graph (Render graph) module.
+ * A frame is declared as passes that read and write resources: transient
+ * textures, which the graph allocates, and imported framebuffers (such as
+ * the window's), which it only binds. Compiling the graph makes its
+ * decisions in a plan (gpu/plan.hpp: culling, ordering, aliasing, and
+ * framebuffer sets), then creates the GL textures and framebuffers the plan
+ * decided on.
+ * A transient's contents are undefined until its first pass writes them, as
+ * its texture may have held another one. Executing the graph binds each
+ * pass's framebuffer (only when it changes) and viewport, and runs the pass.
+ * The compiled graph is dumped in text for debugging.
+ *
+ * Dependencies:
+ * 1. GLEW library (libglew-dev); transient textures need GL 3.0
+ *    (ARB_framebuffer_object)
+ * 2. The gpu libraries' res module (gpu/res.hpp)
+ * 3. The gpu libraries' plan module (gpu/plan.hpp) */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#ifndef GPU__GRAPH_HPP
+#define GPU__GRAPH_HPP
+
+#include <cstdio>
+#include <functional>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "plan.hpp"
+#include "res.hpp"
+
+/* GPU memory library */
+namespace gpuLib {
+
+/* Compiled graph statistics. */
+struct GraphStats {
+    /* Passes declared, and the ones culled. */
+    int passes;
+    int culled;
+    /* Transient resources used, and the textures they share. */
+    int transients;
+    int textures;
+    /* Bytes of the textures, and of one texture per transient. */
+    long bytes;
+    long unaliasedBytes;
+    int framebuffers;
+    /* Framebuffer bindings of the last execution. */
+    int binds;
+};
+
+/* Graph (render graph). */
+class Graph {
+   public:
+    /* Pass body; runs with the pass's framebuffer and viewport bound. */
+    typedef std::function<void()> Run;
+
+   private:
+    Res &_res;
+    Plan _plan;
+    /* Pass bodies. */
+    std::vector<Run> _runs;
+    /* Textures and framebuffers of the plan. */
+    std::vector<ResHandle> _textures;
+    std::vector<ResHandle> _framebuffers;
+    bool _compiled;
+    GraphStats _stats;
+
+    /* Releases the textures and framebuffers. */
+    void _release();
+    /* Creates the textures. */
+    void _createTextures();
+    /* Creates the framebuffers; returns false if one is incomplete. */
+    bool _createFramebuffers();
+    /* Finds the framebuffer bound by a pass. */
+    GLuint _framebuffer(Plan::Pass const &pass);
+
+   public:
+    /* Constructs an empty graph with GL objects of a resource manager;
+     * touches no GL state. */
+    Graph(Res &res);
+    /* Declares a transient texture; returns its resource. */
+    int texture(char const *name, GraphDesc desc);
+    /* Declares an imported framebuffer (0 for the window) of a size;
+     * returns its resource. */
+    int import(char const *name, GLuint framebuffer, int width, int height);
+    /* Declares a pass; returns it. Passes run after the earlier declared
+     * passes they depend on. */
+    int pass(char const *name, Run run);
+    /* Declares that a pass reads a resource. */
+    void read(int pass, int resource);
+    /* Declares that a pass writes a resource (draws into it; a pass writes
+     * either one imported framebuffer or transient textures). */
+    void write(int pass, int resource);
+    /* Keeps a pass from being culled (for its side effects). */
+    void keep(int pass);
+    /* Compiles the graph: plans it, and creates the textures and
+     * framebuffers (releasing the last compilation's); returns false if the
+     * plan fails or a framebuffer is incomplete. */
+    bool compile();
+    /* Runs the kept passes in order (compiles the graph first if needed),
+     * and binds the window's framebuffer again. */
+    void execute();
+    /* Finds whether a pass is culled. */
+    bool culled(int pass);
+    /* Reads the GL texture of a transient resource (0 if unused). */
+    GLuint name(int resource);
+    /* Reads the GL framebuffer that a pass writes (0 for the window). */
+    GLuint framebuffer(int pass);
+    /* Writes the compiled graph (passes in order, with their resources,
+     * lifetimes, textures, and framebuffers) as text. */
+    void dump(FILE *file);
+    /* Reads the statistics. */
+    GraphStats stats();
+};
+
+}  // namespace gpuLib
+
+// GPU__GRAPH_HPP
+#endif
@@ -0,0 +1,181 @@
+/* File name: hiz.cpp
+ *
+ * Intro:
+ * C++ implementation of the gpu (GPU memory) libraries' hiz (Hierarchical Z)
+ * module. */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#include "hiz.hpp"
+
+namespace gpuLib {
+
+/* Work group size (matches local_size_x and local_size_y in hiz.cs). */
+static int const groupSize = 8;
+
+HiZ::HiZ(Res &res, int width, int height) : _res(res) {
+    _program = 0;
+    _depth = 0;
+    _copyFramebuffer = 0;
+    _pyramid = 0;
+    _width = width;
+    _height = height;
+    _levelCount = 1;
+    while ((width | height) >> _levelCount != 0) {
+        _levelCount += 1;
+    }
+    _valid = false;
+}
+
+HiZ::~HiZ() {
+    _res.release(_depthRes);
+    _res.release(_copyFramebufferRes);
+    _res.release(_pyramidRes);
+}
+
+GLuint HiZ::program() {
+    return _program;
+}
+
+GLuint HiZ::program(GLuint newVal) {
+    GLuint oldVal = _program;
+    _program = newVal;
+
+    _fromDepthLoc = glGetUniformLocation(_program, "fromDepth");
+    _srcSizeLoc = glGetUniformLocation(_program, "srcSize");
+    return oldVal;
+}
+
+void HiZ::build(int renderWidth, int renderHeight) {
+    if (_depth == 0) {
+        _depthRes = _res.create(resTexture);
+        _depth = _res.name(_depthRes);
+        glBindTexture(GL_TEXTURE_2D, _depth);
+        glTexStorage2D(GL_TEXTURE_2D, 1, GL_DEPTH_COMPONENT24, _width, _height);
+        _res.bytes(_depthRes, (long)_width * _height * 4);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+        _pyramidRes = _res.create(resTexture);
+        _pyramid = _res.name(_pyramidRes);
+        glBindTexture(GL_TEXTURE_2D, _pyramid);
+        // clang-format off
+        glTexStorage2D(
+            GL_TEXTURE_2D, _levelCount, GL_R32F, _width, _height
+        );
+        // clang-format on
+        long pyramidBytes = 0;
+        for (int level = 0; level < _levelCount; level += 1) {
+            long levelWidth = _width >> level > 1 ? _width >> level : 1;
+            long levelHeight = _height >> level > 1 ? _height >> level : 1;
+            pyramidBytes += levelWidth * levelHeight * 4;
+        }
+        _res.bytes(_pyramidRes, pyramidBytes);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    }
+
+    // Copy the depth; images cannot read depth formats directly
+    if (renderWidth == _width and renderHeight == _height) {
+        glBindTexture(GL_TEXTURE_2D, _depth);
+        glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, _width, _height);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    } else {
+        // A scaled render (see gpu/scale.hpp) is stretched to level 0, so
+        // the culling's screen rectangles still map onto the pyramid
+        GLint lastDraw = 0;
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &lastDraw);
+        if (_copyFramebuffer == 0) {
+            _copyFramebufferRes = _res.create(resFramebuffer);
+            _copyFramebuffer = _res.name(_copyFramebufferRes);
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, _copyFramebuffer);
+            // clang-format off
+            glFramebufferTexture2D(
+                GL_DRAW_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D,
+                _depth, 0
+            );
+            // clang-format on
+        }
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, _copyFramebuffer);
+        // clang-format off
+        glBlitFramebuffer(
+            0, 0, renderWidth, renderHeight, 0, 0, _width, _height,
+            GL_DEPTH_BUFFER_BIT, GL_NEAREST
+        );
+        // clang-format on
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, lastDraw);
+    }
+
+    GLint lastProgram = 0;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &lastProgram);
+    glUseProgram(_program);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, _depth);
+
+    // Level 0 from the depth, then each level from the one before
+    int srcWidth = _width;
+    int srcHeight = _height;
+    for (int level = 0; level < _levelCount; level += 1) {
+        int dstWidth = level == 0 ? _width : srcWidth / 2;
+        int dstHeight = level == 0 ? _height : srcHeight / 2;
+        dstWidth = dstWidth > 1 ? dstWidth : 1;
+        dstHeight = dstHeight > 1 ? dstHeight : 1;
+
+        glUniform1i(_fromDepthLoc, level == 0);
+        glUniform2i(_srcSizeLoc, srcWidth, srcHeight);
+        if (level > 0) {
+            // clang-format off
+            glBindImageTexture(
+                0, _pyramid, level - 1, GL_FALSE, 0, GL_READ_ONLY, GL_R32F
+            );
+            // clang-format on
+        }
+        // clang-format off
+        glBindImageTexture(
+            1, _pyramid, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F
+        );
+        glDispatchCompute(
+            (dstWidth + groupSize - 1) / groupSize,
+            (dstHeight + groupSize - 1) / groupSize, 1
+        );
+        // clang-format on
+        glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+        srcWidth = dstWidth;
+        srcHeight = dstHeight;
+    }
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glUseProgram(lastProgram);
+
+    // The culling shader samples the pyramid
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+    _valid = true;
+}
+
+GLuint HiZ::texture() {
+    return _pyramid;
+}
+
+int HiZ::width() {
+    return _width;
+}
+
+int HiZ::height() {
+    return _height;
+}
+
+int HiZ::levelCount() {
+    return _levelCount;
+}
+
+bool HiZ::valid() {
+    return _valid;
+}
+
+void HiZ::invalidate() {
+    _valid = false;
+}
+
+}  // namespace gpuLib
@@ -0,0 +1,87 @@
+/* File name: hiz.hpp
+ *
+ * Intro:
+ * C++ header of the gpu (GPU memory) libraries' hiz (Hierarchical Z) module.
+ * A Hi-Z pyramid is built from the depth buffer: level 0 is a copy of the
+ * depth, and each next level keeps the farthest depth of the 2x2 (3x3 at odd
+ * edges) texels below it. A box whose nearest depth is farther than the
+ * pyramid's farthest depth over the box's screen rectangle is occluded. The
+ * reduction runs in a compute shader (hiz.cs).
+ * 
+ * Dependencies:
+ * 1. GLEW library (libglew-dev); needs GL 4.3 (compute shaders, image load and
+ *    store, texture storage)
+ * 2. The gpu libraries' res module (res.hpp) */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#ifndef GPU__HIZ_HPP
+#define GPU__HIZ_HPP
+
+#include <GL/glew.h>
+
+#include "res.hpp"
+
+/* GPU memory library */
+namespace gpuLib {
+
+/* HiZ (Hierarchical Z pyramid). */
+class HiZ {
+   private:
+    /* Reduction compute shader program. */
+    GLuint _program;
+    /* Uniform locations. */
+    GLint _fromDepthLoc;
+    GLint _srcSizeLoc;
+    Res &_res;
+    /* Depth copy texture (GL_DEPTH_COMPONENT24), and the framebuffer that
+     * scales a smaller depth into it (0 until one is built), and their
+     * handles. */
+    GLuint _depth;
+    GLuint _copyFramebuffer;
+    ResHandle _depthRes;
+    ResHandle _copyFramebufferRes;
+    /* Pyramid texture (GL_R32F, all levels), and its handle. */
+    GLuint _pyramid;
+    ResHandle _pyramidRes;
+    int _width;
+    int _height;
+    int _levelCount;
+    /* Whether the pyramid has been built. */
+    bool _valid;
+
+   public:
+    /* Constructs a pyramid of the specified level 0 size (unit: pixels); the
+     * GL textures are created (with a resource manager) on the first build.
+     */
+    HiZ(Res &res, int width, int height);
+    /* Releases the GL textures and framebuffer. */
+    ~HiZ();
+    /* Reads the reduction compute shader program. */
+    GLuint program();
+    /* Reads and updates the reduction compute shader program (compiled from
+     * hiz.cs and linked); finds its uniform locations. */
+    GLuint program(GLuint newVal);
+    /* Builds the pyramid from the depth of the read framebuffer, rendered
+     * at a size (unit: pixels) in its lower left corner; a size other than
+     * level 0's is scaled to it (nearest). */
+    void build(int renderWidth, int renderHeight);
+    /* Reads the pyramid texture. */
+    GLuint texture();
+    /* Reads the level 0 width (unit: pixels). */
+    int width();
+    /* Reads the level 0 height (unit: pixels). */
+    int height();
+    /* Reads the level count. */
+    int levelCount();
+    /* Reads whether the pyramid has been built. */
+    bool valid();
+    /* Marks the pyramid as not built (for example, after a camera cut). */
+    void invalidate();
+};
+
+}  // namespace gpuLib
+
+// GPU__HIZ_HPP
+#endif
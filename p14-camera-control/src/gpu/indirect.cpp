@@ -0,0 +1,106 @@
+/* File name: indirect.cpp
+ *
+ * Intro:
+ * C++ implementation of the gpu (GPU memory) libraries' indirect (Indirect
+ * draw) module. */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#include "indirect.hpp"
+
+#include <algorithm>
+
+namespace gpuLib {
+
+Indirect::Indirect(Res &res) : _res(res) {
+    for (int i = 0; i < framesMaxDepth; i += 1) {
+        _cmdBuffers[i] = 0;
+        _dataBuffers[i] = 0;
+        _capacities[i] = 0;
+    }
+}
+
+Indirect::~Indirect() {
+    for (int i = 0; i < framesMaxDepth; i += 1) {
+        _res.release(_cmdRes[i]);
+        _res.release(_dataRes[i]);
+    }
+}
+
+void Indirect::clear() {
+    _cmds.clear();
+    _datas.clear();
+}
+
+void Indirect::add(DrawCmd const &cmd, DrawData const &data) {
+    _cmds.push_back(cmd);
+    _datas.push_back(data);
+}
+
+int Indirect::count() {
+    return (int)_cmds.size();
+}
+
+void Indirect::submit(GLuint binding, int slot) {
+    if (_cmds.empty()) {
+        return;
+    }
+    if (_cmdBuffers[slot] == 0) {
+        _cmdRes[slot] = _res.create(resBuffer);
+        _dataRes[slot] = _res.create(resBuffer);
+        _cmdBuffers[slot] = _res.name(_cmdRes[slot]);
+        _dataBuffers[slot] = _res.name(_dataRes[slot]);
+    }
+    GLuint cmdBuffer = _cmdBuffers[slot];
+    GLuint dataBuffer = _dataBuffers[slot];
+
+    // Grow the slot's stores (to at least twice their size)
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, cmdBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, dataBuffer);
+    if (_cmds.size() > _capacities[slot]) {
+        _capacities[slot] = std::max(_cmds.size(), _capacities[slot] * 2);
+        // clang-format off
+        glBufferData(
+            GL_DRAW_INDIRECT_BUFFER, _capacities[slot] * sizeof(DrawCmd),
+            NULL, GL_DYNAMIC_DRAW
+        );
+        glBufferData(
+            GL_SHADER_STORAGE_BUFFER, _capacities[slot] * sizeof(DrawData),
+            NULL, GL_DYNAMIC_DRAW
+        );
+        // clang-format on
+        _res.bytes(_cmdRes[slot], _capacities[slot] * sizeof(DrawCmd));
+        _res.bytes(_dataRes[slot], _capacities[slot] * sizeof(DrawData));
+    }
+
+    // The GPU is done with this slot's frame, so no write waits for it
+    // clang-format off
+    glBufferSubData(
+        GL_DRAW_INDIRECT_BUFFER, 0, _cmds.size() * sizeof(DrawCmd),
+        _cmds.data()
+    );
+    glBufferSubData(
+        GL_SHADER_STORAGE_BUFFER, 0, _datas.size() * sizeof(DrawData),
+        _datas.data()
+    );
+    // clang-format on
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, dataBuffer);
+
+    // clang-format off
+    glMultiDrawElementsIndirect(
+        GL_TRIANGLES, GL_UNSIGNED_INT, 0, (GLsizei)_cmds.size(), 0
+    );
+    // clang-format on
+
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+bool indirectSupported() {
+    bool multiDraw = GLEW_VERSION_4_3 or GLEW_ARB_multi_draw_indirect;
+    bool storage = GLEW_VERSION_4_3 or GLEW_ARB_shader_storage_buffer_object;
+    bool drawId = GLEW_VERSION_4_6 or GLEW_ARB_shader_draw_parameters;
+    return multiDraw and storage and drawId;
+}
+
+}  // namespace gpuLib
@@ -0,0 +1,98 @@
+/* File name: indirect.hpp
+ *
+ * Intro:
+ * C++ header of the gpu (GPU memory) libraries' indirect (Indirect draw)
+ * module.
+ * An indirect batch collects one draw command and one per-draw data record per
+ * visible object. A single glMultiDrawElementsIndirect call then draws them
+ * all, and the vertex shader fetches its per-draw data from a shader storage
+ * buffer with gl_DrawIDARB. The buffers are kept once per frame in flight
+ * (see frames.hpp), so each frame rewrites the ones the GPU is done with in
+ * place, and they are only respecified when they grow.
+ * 
+ * Dependencies:
+ * 1. GLEW library (libglew-dev); needs GL 4.3 (multi draw indirect, shader
+ *    storage buffers) and GL_ARB_shader_draw_parameters
+ * 2. GLM library (libglm-dev)
+ * 3. The gpu libraries' frames module (frames.hpp)
+ * 4. The gpu libraries' res module (res.hpp) */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#ifndef GPU__INDIRECT_HPP
+#define GPU__INDIRECT_HPP
+
+#include <vector>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <glm/ext.hpp>
+
+#include "frames.hpp"
+#include "res.hpp"
+
+/* GPU memory library */
+namespace gpuLib {
+
+/* Indirect draw command (the DrawElementsIndirectCommand layout). */
+struct DrawCmd {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+};
+
+/* Per-draw data (std430 layout; matches struct Draw in indirect.vs). */
+struct DrawData {
+    /* Object space to clip space mapping. */
+    glm::mat4 mapping;
+    /* Dequantization scale (xyz; w unused). */
+    glm::vec4 posScale;
+    /* Dequantization offset (xyz; w unused). */
+    glm::vec4 posOffset;
+};
+
+/* Indirect (draw batch). */
+class Indirect {
+   private:
+    Res &_res;
+    /* Command buffers (GL_DRAW_INDIRECT_BUFFER), by frame slot. */
+    GLuint _cmdBuffers[framesMaxDepth];
+    /* Per-draw data buffers (GL_SHADER_STORAGE_BUFFER), by frame slot. */
+    GLuint _dataBuffers[framesMaxDepth];
+    /* Handles of the buffers, by frame slot. */
+    ResHandle _cmdRes[framesMaxDepth];
+    ResHandle _dataRes[framesMaxDepth];
+    /* Capacities of the buffers (unit: draws), by frame slot. */
+    size_t _capacities[framesMaxDepth];
+    std::vector<DrawCmd> _cmds;
+    std::vector<DrawData> _datas;
+
+   public:
+    /* Constructs an empty batch; the GL buffers are created (with a resource
+     * manager) on the first submission. */
+    Indirect(Res &res);
+    /* Releases the GL buffers. */
+    ~Indirect();
+    /* Removes all draws. */
+    void clear();
+    /* Adds a draw. */
+    void add(DrawCmd const &cmd, DrawData const &data);
+    /* Reads the draw count. */
+    int count();
+    /* Uploads the draws to the buffers of a frame slot and draws them with
+     * one call.
+     * The per-draw data is bound to the shader storage binding point binding;
+     * the vertex array and the shader program must already be bound. */
+    void submit(GLuint binding, int slot);
+};
+
+/* Finds whether the GL context supports indirect batches. */
+bool indirectSupported();
+
+}  // namespace gpuLib
+
+// GPU__INDIRECT_HPP
+#endif
@@ -0,0 +1,397 @@
+/* File name: plan.cpp
+ *
+ * Intro:
+ * C++ implementation of the gpu (GPU memory) libraries' plan (Render graph
+ * plan) module. */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#include "plan.hpp"
+
+#include <algorithm>
+
+/* Texture formats. */
+static gpuLib::GraphFormat const formats[] = {
+    {GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, 4, "rgba8"},
+    {GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT, 8, "rgba16f"},
+    {GL_R32F, GL_RED, GL_FLOAT, 4, "r32f"},
+    {GL_DEPTH_COMPONENT24, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, 4,
+     "depth24"}};
+static int const formatCount = 4;
+
+/* Finds whether two descriptions match. */
+static bool sameDesc(gpuLib::GraphDesc const &a, gpuLib::GraphDesc const &b) {
+    return a.width == b.width and a.height == b.height and
+           a.format == b.format;
+}
+
+/* Finds whether a list holds a value. */
+static bool holds(std::vector<int> const &list, int value) {
+    return std::find(list.begin(), list.end(), value) != list.end();
+}
+
+namespace gpuLib {
+
+Plan::Plan() {
+    _stats = PlanStats{0, 0, 0, 0, 0, 0, 0};
+}
+
+int Plan::texture(char const *name, GraphDesc desc) {
+    _resources.push_back(Resource{name, desc, false, 0, -1, -1, -1});
+    return (int)_resources.size() - 1;
+}
+
+int Plan::import(char const *name, GLuint framebuffer, int width,
+                 int height) {
+    GraphDesc desc{width, height, 0};
+    _resources.push_back(Resource{name, desc, true, framebuffer, -1, -1, -1});
+    return (int)_resources.size() - 1;
+}
+
+int Plan::pass(char const *name) {
+    _passes.push_back(Pass{name, {}, {}, false, false, -1});
+    return (int)_passes.size() - 1;
+}
+
+void Plan::read(int pass, int resource) {
+    _passes[pass].reads.push_back(resource);
+}
+
+void Plan::write(int pass, int resource) {
+    _passes[pass].writes.push_back(resource);
+}
+
+void Plan::keep(int pass) {
+    _passes[pass].kept = true;
+}
+
+void Plan::_cull() {
+    // The roots: kept passes and writers of imported resources
+    std::vector<int> stack;
+    for (size_t i = 0; i < _passes.size(); i += 1) {
+        Pass &pass = _passes[i];
+        pass.culled = !pass.kept;
+        for (int resource : pass.writes) {
+            if (_resources[resource].imported) {
+                pass.culled = false;
+            }
+        }
+        if (!pass.culled) {
+            stack.push_back((int)i);
+        }
+    }
+
+    // A kept pass keeps the earlier writers of what it reads, and of what it
+    // draws over
+    while (!stack.empty()) {
+        Pass &pass = _passes[stack.back()];
+        int index = stack.back();
+        stack.pop_back();
+        for (int i = 0; i < index; i += 1) {
+            Pass &writer = _passes[i];
+            if (!writer.culled) {
+                continue;
+            }
+            for (int resource : writer.writes) {
+                if (holds(pass.reads, resource) or
+                    holds(pass.writes, resource)) {
+                    writer.culled = false;
+                }
+            }
+            if (!writer.culled) {
+                stack.push_back(i);
+            }
+        }
+    }
+}
+
+void Plan::_sort() {
+    // A pass waits for the earlier passes that write what it touches, and
+    // for those that read what it writes; as they are all declared earlier,
+    // there are no cycles
+    int passCount = (int)_passes.size();
+    std::vector<int> waits(passCount, 0);
+    std::vector<std::vector<int>> after(passCount);
+    for (int i = 0; i < passCount; i += 1) {
+        Pass &pass = _passes[i];
+        if (pass.culled) {
+            continue;
+        }
+        for (int j = 0; j < i; j += 1) {
+            Pass &earlier = _passes[j];
+            if (earlier.culled) {
+                continue;
+            }
+            bool depends = false;
+            for (int resource : earlier.writes) {
+                depends = depends or holds(pass.reads, resource) or
+                          holds(pass.writes, resource);
+            }
+            for (int resource : earlier.reads) {
+                depends = depends or holds(pass.writes, resource);
+            }
+            if (depends) {
+                waits[i] += 1;
+                after[j].push_back(i);
+            }
+        }
+    }
+
+    // Of the passes free to run, one that writes what the last wrote first,
+    // then the first declared
+    _order.clear();
+    std::vector<int> ready;
+    for (int i = 0; i < passCount; i += 1) {
+        if (!_passes[i].culled and waits[i] == 0) {
+            ready.push_back(i);
+        }
+    }
+    while (!ready.empty()) {
+        size_t pick = 0;
+        for (size_t i = 1; i < ready.size(); i += 1) {
+            if (ready[i] < ready[pick]) {
+                pick = i;
+            }
+        }
+        if (!_order.empty()) {
+            std::vector<int> const &lastWrites = _passes[_order.back()].writes;
+            for (size_t i = 0; i < ready.size(); i += 1) {
+                Pass &pass = _passes[ready[i]];
+                if (!pass.writes.empty() and pass.writes == lastWrites) {
+                    pick = i;
+                    break;
+                }
+            }
+        }
+        int index = ready[pick];
+        ready.erase(ready.begin() + pick);
+        _order.push_back(index);
+        for (int next : after[index]) {
+            waits[next] -= 1;
+            if (waits[next] == 0) {
+                ready.push_back(next);
+            }
+        }
+    }
+}
+
+bool Plan::_alias() {
+    for (Resource &resource : _resources) {
+        resource.first = -1;
+        resource.last = -1;
+        resource.texture = -1;
+    }
+    for (int i = 0; i < (int)_order.size(); i += 1) {
+        Pass &pass = _passes[_order[i]];
+        for (std::vector<int> const *list : {&pass.reads, &pass.writes}) {
+            for (int index : *list) {
+                Resource &resource = _resources[index];
+                resource.first = resource.first < 0 ? i : resource.first;
+                resource.last = i;
+            }
+        }
+    }
+
+    // By first use, each transient takes a matching texture that is free by
+    // then, or a new one
+    std::vector<int> transients;
+    for (int i = 0; i < (int)_resources.size(); i += 1) {
+        if (!_resources[i].imported and _resources[i].first >= 0) {
+            transients.push_back(i);
+        }
+    }
+    // clang-format off
+    std::stable_sort(
+        transients.begin(), transients.end(), [this](int a, int b) {
+            return _resources[a].first < _resources[b].first;
+        }
+    );
+    // clang-format on
+    std::vector<int> textureLasts;
+    for (int index : transients) {
+        Resource &resource = _resources[index];
+        GraphFormat const *format = graphFormat(resource.desc.format);
+        if (format == nullptr) {
+            return false;
+        }
+        _stats.unaliasedBytes +=
+            (long)resource.desc.width * resource.desc.height * format->bytes;
+        for (size_t i = 0; i < _textures.size(); i += 1) {
+            if (sameDesc(_textures[i], resource.desc) and
+                textureLasts[i] < resource.first) {
+                resource.texture = (int)i;
+                break;
+            }
+        }
+        if (resource.texture < 0) {
+            resource.texture = (int)_textures.size();
+            _textures.push_back(resource.desc);
+            textureLasts.push_back(0);
+            _stats.bytes +=
+                (long)resource.desc.width * resource.desc.height *
+                format->bytes;
+        }
+        textureLasts[resource.texture] = resource.last;
+    }
+    _stats.transients = (int)transients.size();
+    _stats.textures = (int)_textures.size();
+    return true;
+}
+
+bool Plan::_attach() {
+    for (int index : _order) {
+        Pass &pass = _passes[index];
+        pass.framebuffer = -1;
+        if (pass.writes.empty()) {
+            continue;
+        }
+
+        // An imported framebuffer is bound as it is, and alone; textures
+        // are bound together if they are of one size, with one depth
+        std::vector<int> textures;
+        GraphDesc desc = _resources[pass.writes[0]].desc;
+        int depths = 0;
+        for (int index : pass.writes) {
+            Resource &resource = _resources[index];
+            if (resource.imported and pass.writes.size() != 1) {
+                return false;
+            }
+            if (resource.desc.width != desc.width or
+                resource.desc.height != desc.height) {
+                return false;
+            }
+            if (!resource.imported and
+                graphFormat(resource.desc.format)->format ==
+                    GL_DEPTH_COMPONENT) {
+                depths += 1;
+            }
+            textures.push_back(resource.texture);
+        }
+        if (depths > 1) {
+            return false;
+        }
+        if (_resources[pass.writes[0]].imported) {
+            continue;
+        }
+
+        // Passes that write the same textures share a framebuffer
+        for (size_t i = 0; i < _framebuffers.size(); i += 1) {
+            if (_framebuffers[i] == textures) {
+                pass.framebuffer = (int)i;
+            }
+        }
+        if (pass.framebuffer < 0) {
+            pass.framebuffer = (int)_framebuffers.size();
+            _framebuffers.push_back(textures);
+        }
+    }
+    _stats.framebuffers = (int)_framebuffers.size();
+    return true;
+}
+
+bool Plan::plan() {
+    _order.clear();
+    _textures.clear();
+    _framebuffers.clear();
+    _stats = PlanStats{(int)_passes.size(), 0, 0, 0, 0, 0, 0};
+
+    _cull();
+    _sort();
+    _stats.culled = _stats.passes - (int)_order.size();
+    return _alias() and _attach();
+}
+
+std::vector<Plan::Resource> const &Plan::resources() {
+    return _resources;
+}
+
+std::vector<Plan::Pass> const &Plan::passes() {
+    return _passes;
+}
+
+std::vector<int> const &Plan::order() {
+    return _order;
+}
+
+std::vector<GraphDesc> const &Plan::textures() {
+    return _textures;
+}
+
+std::vector<std::vector<int>> const &Plan::framebuffers() {
+    return _framebuffers;
+}
+
+void Plan::dump(FILE *file) {
+    fprintf(file, "graph: %d passes, ", _stats.passes);
+    fprintf(file, "%d culled, ", _stats.culled);
+    fprintf(file, "%d transients in ", _stats.transients);
+    fprintf(file, "%d textures ", _stats.textures);
+    fprintf(file, "(%ld B, ", _stats.bytes);
+    fprintf(file, "%ld B unaliased), ", _stats.unaliasedBytes);
+    fprintf(file, "%d framebuffers\n", _stats.framebuffers);
+
+    for (size_t i = 0; i < _order.size(); i += 1) {
+        Pass &pass = _passes[_order[i]];
+        fprintf(file, "  %zu: pass %s", i, pass.name.c_str());
+        if (pass.framebuffer >= 0) {
+            fprintf(file, " -> framebuffer %d", pass.framebuffer);
+        } else if (!pass.writes.empty()) {
+            fprintf(file, " -> %s", _resources[pass.writes[0]].name.c_str());
+        }
+        fprintf(file, "%s\n", pass.kept ? " (kept)" : "");
+        for (int j = 0; j < 2; j += 1) {
+            std::vector<int> const &list = j == 0 ? pass.reads : pass.writes;
+            if (list.empty()) {
+                continue;
+            }
+            fprintf(file, "       %s", j == 0 ? "reads" : "writes");
+            for (size_t k = 0; k < list.size(); k += 1) {
+                char const *separator = k == 0 ? " " : ", ";
+                char const *name = _resources[list[k]].name.c_str();
+                fprintf(file, "%s%s", separator, name);
+            }
+            fprintf(file, "\n");
+        }
+    }
+    for (Pass const &pass : _passes) {
+        if (pass.culled) {
+            fprintf(file, "  culled: pass %s\n", pass.name.c_str());
+        }
+    }
+
+    for (Resource &resource : _resources) {
+        fprintf(file, "  resource %s: ", resource.name.c_str());
+        if (resource.imported) {
+            fprintf(file, "imported framebuffer %u ", resource.framebuffer);
+        } else {
+            GraphFormat const *format = graphFormat(resource.desc.format);
+            fprintf(file, "%s ", format != nullptr ? format->name : "?");
+        }
+        fprintf(file, "%dx%d", resource.desc.width, resource.desc.height);
+        if (resource.first < 0) {
+            fprintf(file, ", unused\n");
+            continue;
+        }
+        fprintf(file, ", passes %d to %d", resource.first, resource.last);
+        if (resource.texture >= 0) {
+            fprintf(file, ", texture %d", resource.texture);
+        }
+        fprintf(file, "\n");
+    }
+}
+
+PlanStats Plan::stats() {
+    return _stats;
+}
+
+GraphFormat const *graphFormat(GLenum internal) {
+    for (int i = 0; i < formatCount; i += 1) {
+        if (formats[i].internal == internal) {
+            return &formats[i];
+        }
+    }
+    return nullptr;
+}
+
+}  // namespace gpuLib
@@ -0,0 +1,167 @@
+/* File name: plan.hpp
+ *
+ * Intro:
+ * C++ header of the gpu (GPU memory) libraries' plan (Render graph plan)
+ * module.
+ * A plan holds the passes and resources of a render graph (see graph.hpp)
+ * and makes its compile decisions:
+ * 1. culls the passes whose results nothing uses: a pass is kept if it is
+ *    marked kept (for side effects such as readbacks), if it writes an
+ *    imported resource, or if a kept pass reads or writes over what it
+ *    writes;
+ * 2. orders the kept passes: a pass runs after the earlier declared passes
+ *    that touch its resources, and among the passes free to run, one that
+ *    writes the same resources as the last goes first, so they share a
+ *    framebuffer binding;
+ * 3. aliases the transient textures: each one lives from its first to its
+ *    last pass, and textures of the same size and format whose lifetimes do
+ *    not overlap share one texture;
+ * 4. gives each set of textures that a pass writes one framebuffer.
+ * It creates no GL objects and touches no GL state (the graph creates the
+ * textures and framebuffers it decides on), so it runs on the CPU only.
+ *
+ * Dependencies:
+ * 1. GLEW library (libglew-dev); for the types and format enums only */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#ifndef GPU__PLAN_HPP
+#define GPU__PLAN_HPP
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>
+
+/* GPU memory library */
+namespace gpuLib {
+
+/* Graph resource description. */
+struct GraphDesc {
+    /* Size (unit: pixels). */
+    int width;
+    int height;
+    /* Internal format (GL_RGBA8, GL_RGBA16F, GL_R32F, or
+     * GL_DEPTH_COMPONENT24). */
+    GLenum format;
+};
+
+/* Graph texture format. */
+struct GraphFormat {
+    GLenum internal;
+    /* Pixel format and type of the (empty) upload. */
+    GLenum format;
+    GLenum type;
+    int bytes;
+    char const *name;
+};
+
+/* Plan statistics. */
+struct PlanStats {
+    /* Passes declared, and the ones culled. */
+    int passes;
+    int culled;
+    /* Transient resources used, and the textures they share. */
+    int transients;
+    int textures;
+    /* Bytes of the textures, and of one texture per transient. */
+    long bytes;
+    long unaliasedBytes;
+    int framebuffers;
+};
+
+/* Plan (render graph plan). */
+class Plan {
+   public:
+    /* Resource. */
+    struct Resource {
+        std::string name;
+        GraphDesc desc;
+        /* Imported framebuffer (transients: 0, unused). */
+        bool imported;
+        GLuint framebuffer;
+        /* First and last passes, in execution order (-1 if unused). */
+        int first;
+        int last;
+        /* Texture (transients: -1 if unused). */
+        int texture;
+    };
+    /* Pass. */
+    struct Pass {
+        std::string name;
+        std::vector<int> reads;
+        std::vector<int> writes;
+        bool kept;
+        bool culled;
+        /* Framebuffer (-1 for an imported one, or if nothing is written). */
+        int framebuffer;
+    };
+
+   private:
+    std::vector<Resource> _resources;
+    std::vector<Pass> _passes;
+    /* Kept passes, in execution order. */
+    std::vector<int> _order;
+    /* Descriptions of the textures shared by the transients. */
+    std::vector<GraphDesc> _textures;
+    /* Textures attached to each framebuffer. */
+    std::vector<std::vector<int>> _framebuffers;
+    PlanStats _stats;
+
+    /* Finds the kept passes. */
+    void _cull();
+    /* Finds the execution order. */
+    void _sort();
+    /* Finds the lifetimes and the textures. */
+    bool _alias();
+    /* Finds the framebuffers. */
+    bool _attach();
+
+   public:
+    /* Constructs an empty plan. */
+    Plan();
+    /* Declares a transient texture; returns its resource. */
+    int texture(char const *name, GraphDesc desc);
+    /* Declares an imported framebuffer (0 for the window) of a size;
+     * returns its resource. */
+    int import(char const *name, GLuint framebuffer, int width, int height);
+    /* Declares a pass; returns it. Passes run after the earlier declared
+     * passes they depend on. */
+    int pass(char const *name);
+    /* Declares that a pass reads a resource. */
+    void read(int pass, int resource);
+    /* Declares that a pass writes a resource (draws into it; a pass writes
+     * either one imported framebuffer or transient textures). */
+    void write(int pass, int resource);
+    /* Keeps a pass from being culled (for its side effects). */
+    void keep(int pass);
+    /* Makes the compile decisions: culls, orders, aliases, and finds the
+     * framebuffers; returns false if a transient's format is unsupported or
+     * a pass's writes cannot be bound together. */
+    bool plan();
+    /* Reads the resources. */
+    std::vector<Resource> const &resources();
+    /* Reads the passes. */
+    std::vector<Pass> const &passes();
+    /* Reads the kept passes, in execution order. */
+    std::vector<int> const &order();
+    /* Reads the descriptions of the textures. */
+    std::vector<GraphDesc> const &textures();
+    /* Reads the textures of each framebuffer. */
+    std::vector<std::vector<int>> const &framebuffers();
+    /* Writes the plan (passes in order, with their resources, lifetimes,
+     * textures, and framebuffers) as text. */
+    void dump(FILE *file);
+    /* Reads the statistics. */
+    PlanStats stats();
+};
+
+/* Finds a graph texture format (nullptr if unsupported). */
+GraphFormat const *graphFormat(GLenum internal);
+
+}  // namespace gpuLib
+
+// GPU__PLAN_HPP
+#endif
@@ -0,0 +1,214 @@
+/* File name: res.cpp
+ *
+ * Intro:
+ * C++ implementation of the gpu (GPU memory) libraries' res (GL resources)
+ * module. */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#include "res.hpp"
+
+/* Finds the key of a GL object by type and name. */
+static uint64_t nameKey(gpuLib::ResType type, GLuint name) {
+    return ((uint64_t)type << 32) | name;
+}
+
+namespace gpuLib {
+
+Res::Res() {
+    for (int i = 0; i < resTypeCount; i += 1) {
+        _stats.live[i] = 0;
+        _stats.bytes[i] = 0;
+    }
+    _stats.pending = 0;
+    _stats.pendingBytes = 0;
+    _stats.deleted = 0;
+    _stats.stale = 0;
+}
+
+Res::Slot *Res::_slot(ResHandle handle) {
+    if (handle.gen == 0) {
+        return nullptr;
+    }
+    if (handle.index >= _slots.size() or
+        _slots[handle.index].gen != handle.gen) {
+        _stats.stale += 1;
+        return nullptr;
+    }
+    return &_slots[handle.index];
+}
+
+void Res::_delete(Slot const &slot) {
+    switch (slot.type) {
+        case resBuffer:
+            glDeleteBuffers(1, &slot.name);
+            break;
+        case resShader:
+            glDeleteShader(slot.name);
+            break;
+        case resProgram:
+            glDeleteProgram(slot.name);
+            break;
+        case resVertexArray:
+            glDeleteVertexArrays(1, &slot.name);
+            break;
+        case resFramebuffer:
+            glDeleteFramebuffers(1, &slot.name);
+            break;
+        case resTexture:
+            glDeleteTextures(1, &slot.name);
+            break;
+        case resQuery:
+            glDeleteQueries(1, &slot.name);
+            break;
+    }
+    _stats.pending -= 1;
+    _stats.pendingBytes -= slot.bytes;
+    _stats.deleted += 1;
+}
+
+ResHandle Res::create(ResType type, GLenum shaderType) {
+    GLuint name = 0;
+    switch (type) {
+        case resBuffer:
+            glGenBuffers(1, &name);
+            break;
+        case resShader:
+            name = glCreateShader(shaderType);
+            break;
+        case resProgram:
+            name = glCreateProgram();
+            break;
+        case resVertexArray:
+            glGenVertexArrays(1, &name);
+            break;
+        case resFramebuffer:
+            glGenFramebuffers(1, &name);
+            break;
+        case resTexture:
+            glGenTextures(1, &name);
+            break;
+        case resQuery:
+            glGenQueries(1, &name);
+            break;
+    }
+    return adopt(type, name);
+}
+
+ResHandle Res::adopt(ResType type, GLuint name) {
+    ResHandle handle;
+    if (name == 0) {
+        return handle;
+    }
+    if (_freeSlots.empty()) {
+        handle.index = (uint32_t)_slots.size();
+        _slots.push_back(Slot{0, type, 0, 0, 0});
+    } else {
+        handle.index = _freeSlots.back();
+        _freeSlots.pop_back();
+    }
+
+    // Generations start at 1, so no live handle is null
+    Slot &slot = _slots[handle.index];
+    slot.name = name;
+    slot.type = type;
+    slot.gen += 1;
+    slot.refs = 1;
+    slot.bytes = 0;
+    handle.gen = slot.gen;
+    _names[nameKey(type, name)] = handle.index;
+    _stats.live[type] += 1;
+    return handle;
+}
+
+ResHandle Res::find(ResType type, GLuint name) {
+    ResHandle handle;
+    auto found = _names.find(nameKey(type, name));
+    if (found != _names.end()) {
+        handle.index = found->second;
+        handle.gen = _slots[found->second].gen;
+    }
+    return handle;
+}
+
+bool Res::live(ResHandle handle) {
+    return _slot(handle) != nullptr;
+}
+
+GLuint Res::name(ResHandle handle) {
+    Slot *slot = _slot(handle);
+    return slot == nullptr ? 0 : slot->name;
+}
+
+void Res::bytes(ResHandle handle, long newVal) {
+    Slot *slot = _slot(handle);
+    if (slot == nullptr) {
+        return;
+    }
+    _stats.bytes[slot->type] += newVal - slot->bytes;
+    slot->bytes = newVal;
+}
+
+void Res::ref(ResHandle handle) {
+    Slot *slot = _slot(handle);
+    if (slot != nullptr) {
+        slot->refs += 1;
+    }
+}
+
+void Res::release(ResHandle handle) {
+    Slot *slot = _slot(handle);
+    if (slot == nullptr) {
+        return;
+    }
+    slot->refs -= 1;
+    if (slot->refs > 0) {
+        return;
+    }
+
+    // The slot is free at once (its handles go stale); the object waits
+    _released.push_back(*slot);
+    _names.erase(nameKey(slot->type, slot->name));
+    _stats.live[slot->type] -= 1;
+    _stats.bytes[slot->type] -= slot->bytes;
+    _stats.pending += 1;
+    _stats.pendingBytes += slot->bytes;
+    slot->name = 0;
+    slot->gen += 1;
+    _freeSlots.push_back(handle.index);
+}
+
+void Res::collect() {
+    if (!_released.empty()) {
+        Batch batch;
+        batch.fence = 0;
+        if (GLEW_VERSION_3_2 or GLEW_ARB_sync) {
+            batch.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        }
+        batch.slots.swap(_released);
+        _batches.push_back(std::move(batch));
+    }
+
+    while (!_batches.empty()) {
+        Batch &batch = _batches.front();
+        if (batch.fence != 0) {
+            GLenum status = glClientWaitSync(batch.fence, 0, 0);
+            if (status == GL_TIMEOUT_EXPIRED) {
+                // The later fences have not signaled either
+                break;
+            }
+            glDeleteSync(batch.fence);
+        }
+        for (Slot const &slot : batch.slots) {
+            _delete(slot);
+        }
+        _batches.pop_front();
+    }
+}
+
+ResStats Res::stats() {
+    return _stats;
+}
+
+}  // namespace gpuLib
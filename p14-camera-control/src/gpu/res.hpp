@@ -0,0 +1,136 @@
+/* File name: res.hpp
+ *
+ * Intro:
+ * C++ header of the gpu (GPU memory) libraries' res (GL resources) module.
+ * The GL objects (buffers, shaders, programs, vertex arrays, framebuffers,
+ * textures, and queries) are owned by one manager and addressed by handles. A
+ * handle carries its slot's generation, so a handle kept past its object's
+ * release reads as stale instead of naming whatever object reuses the slot.
+ * Objects are reference counted; an object whose count drops to 0 is not
+ * deleted at once, as the GPU may still be reading it, but once a fence
+ * issued after its release has signaled. The live objects and their bytes
+ * are counted by type.
+ *
+ * Dependencies:
+ * 1. GLEW library (libglew-dev); fences need GL 3.2 (ARB_sync), without
+ *    which objects are deleted at the next collection */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#ifndef GPU__RES_HPP
+#define GPU__RES_HPP
+
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+#include <GL/glew.h>
+
+/* GPU memory library */
+namespace gpuLib {
+
+/* GL object type. */
+// clang-format off
+enum ResType {
+    resBuffer, resShader, resProgram, resVertexArray, resFramebuffer,
+    resTexture, resQuery
+};
+// clang-format on
+static int const resTypeCount = 7;
+static char const *const resTypeNames[] = {
+    "buffer", "shader", "program", "vertex array", "framebuffer",
+    "texture", "query"};
+
+/* Handle of a GL object (of a Res). The default handle is null. */
+struct ResHandle {
+    uint32_t index = 0;
+    /* Generation of the slot; 0 is null. */
+    uint32_t gen = 0;
+};
+
+/* GL object statistics. */
+struct ResStats {
+    /* Live objects and their bytes (buffers and textures), by type. */
+    int live[resTypeCount];
+    long bytes[resTypeCount];
+    /* Released objects waiting for their fences, and their bytes. */
+    int pending;
+    long pendingBytes;
+    /* Objects deleted so far. */
+    long deleted;
+    /* Lookups of stale handles. */
+    long stale;
+};
+
+/* (GL) res(ource manager). */
+class Res {
+   private:
+    /* Object of a slot. */
+    struct Slot {
+        /* GL object name (0 if the slot is free). */
+        GLuint name;
+        ResType type;
+        uint32_t gen;
+        int refs;
+        long bytes;
+    };
+    /* Released objects that wait for one fence. */
+    struct Batch {
+        /* 0 without fences. */
+        GLsync fence;
+        std::vector<Slot> slots;
+    };
+
+    std::vector<Slot> _slots;
+    /* Indices of the free slots, reused by later objects. */
+    std::vector<uint32_t> _freeSlots;
+    /* Slots of the live objects by type and name. */
+    std::unordered_map<uint64_t, uint32_t> _names;
+    /* Objects released since the last collection. */
+    std::vector<Slot> _released;
+    /* Fenced batches, oldest first (fences signal in order). */
+    std::deque<Batch> _batches;
+    ResStats _stats;
+
+    /* Finds the slot of a handle; returns nullptr if the handle is stale. */
+    Slot *_slot(ResHandle handle);
+    /* Deletes a released object. */
+    void _delete(Slot const &slot);
+
+   public:
+    /* Constructs a manager of no objects (touches no GL state). */
+    Res();
+    /* Creates a GL object (of the shader type for shaders) with 1 reference.
+     */
+    ResHandle create(ResType type, GLenum shaderType = 0);
+    /* Takes a GL object made elsewhere, with 1 reference. */
+    ResHandle adopt(ResType type, GLuint name);
+    /* Finds the handle of a live object by its GL name; returns null if the
+     * manager does not own it. */
+    ResHandle find(ResType type, GLuint name);
+    /* Finds whether a handle names a live object. */
+    bool live(ResHandle handle);
+    /* Reads the GL name of a handle's object; returns 0 if the handle is null
+     * or stale. */
+    GLuint name(ResHandle handle);
+    /* Records the bytes of a handle's object (after its store changes). */
+    void bytes(ResHandle handle, long newVal);
+    /* Adds a reference to a handle's object. */
+    void ref(ResHandle handle);
+    /* Drops a reference to a handle's object; at 0 references, the handle
+     * goes stale, and the object is deleted once the GPU is done with it. */
+    void release(ResHandle handle);
+    /* Fences the objects released since the last collection, and deletes
+     * the ones whose fences have signaled (once per frame, without
+     * waiting). */
+    void collect();
+    /* Reads the statistics. */
+    ResStats stats();
+};
+
+}  // namespace gpuLib
+
+// GPU__RES_HPP
+#endif
@@ -0,0 +1,225 @@
+/* File name: scale.cpp
+ *
+ * Intro:
+ * C++ implementation of the gpu (GPU memory) libraries' scale (Dynamic
+ * resolution) module. */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#include "scale.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+/* Weight of a new timing in the smoothed time. */
+static double const smoothing = 0.25;
+/* Share of the target that the predicted time at a higher scale must fit
+ * in before the scale rises (so timing noise does not bounce it). */
+static double const riseMargin = 0.9;
+
+/* Rounds a scale down to a step (allowing for rounding errors). */
+static float floorScale(double scale) {
+    double steps = std::floor(scale / gpuLib::scaleStep + 1e-4);
+    return (float)(steps * gpuLib::scaleStep);
+}
+
+namespace gpuLib {
+
+Scale::Scale(Res &res, int width, int height, float targetMs) : _res(res) {
+    _width = width;
+    _height = height;
+    for (int i = 0; i < scaleQueries; i += 1) {
+        _queries[i] = 0;
+        _queryScales[i] = 1.0f;
+        _queryBusy[i] = false;
+    }
+    _next = 0;
+    _timing = false;
+    _targetMs = std::max(targetMs, 0.0f);
+    _minScale = 0.5f;
+    _scale = 1.0f;
+    _sceneScale = 1.0f;
+    _fullMs = -1.0;
+    _settle = 0;
+    _stats = ScaleStats{1.0f, width, height, 0.0, 0.0, 0, 0, 0, 0};
+}
+
+Scale::~Scale() {
+    for (int i = 0; i < scaleQueries; i += 1) {
+        _res.release(_queryRes[i]);
+    }
+}
+
+void Scale::_read() {
+    // The queries finish in order, so the first busy one is the oldest
+    for (int i = 0; i < scaleQueries; i += 1) {
+        int slot = (_next + i) % scaleQueries;
+        if (!_queryBusy[slot]) {
+            continue;
+        }
+        GLuint available = 0;
+        // clang-format off
+        glGetQueryObjectuiv(
+            _queries[slot], GL_QUERY_RESULT_AVAILABLE, &available
+        );
+        // clang-format on
+        if (!available) {
+            break;
+        }
+        GLuint64 ns = 0;
+        glGetQueryObjectui64v(_queries[slot], GL_QUERY_RESULT, &ns);
+        _queryBusy[slot] = false;
+
+        // Each timing predicts the full resolution time from its own scale
+        double ms = ns / 1000000.0;
+        float scale = _queryScales[slot];
+        double fullMs = ms / (scale * scale);
+        if (_fullMs < 0.0) {
+            _fullMs = fullMs;
+        } else {
+            _fullMs += smoothing * (fullMs - _fullMs);
+        }
+        _settle = std::max(_settle - 1, 0);
+        _stats.gpuMs = ms;
+        _stats.timed += 1;
+        _update();
+    }
+}
+
+void Scale::_update() {
+    // The largest step whose predicted time fits the target
+    float fit = floorScale(std::sqrt(_targetMs / _fullMs));
+    fit = std::max(_minScale, std::min(fit, 1.0f));
+    float rise = floorScale(std::sqrt(_targetMs * riseMargin / _fullMs));
+    float next = std::min(floorScale(_scale + scaleStep), 1.0f);
+    if (fit < _scale - scaleStep * 0.5f) {
+        // Over the target: drop at once
+        _scale = fit;
+        _stats.drops += 1;
+        _settle = scaleQueries;
+    } else if (_settle == 0 and next > _scale and rise >= next) {
+        // Well under it, and the last change is measured: rise a step
+        _scale = next;
+        _stats.rises += 1;
+        _settle = scaleQueries;
+    }
+    _stats.predictedMs = _fullMs * _scale * _scale;
+}
+
+bool Scale::active() {
+    bool framebuffers = GLEW_VERSION_3_0 or GLEW_ARB_framebuffer_object;
+    bool timers = GLEW_VERSION_3_3 or GLEW_ARB_timer_query;
+    return _targetMs > 0.0f and framebuffers and timers;
+}
+
+float Scale::targetMs() {
+    return _targetMs;
+}
+
+float Scale::targetMs(float newVal) {
+    float oldVal = _targetMs;
+    _targetMs = std::max(newVal, 0.0f);
+    _settle = 0;
+    return oldVal;
+}
+
+float Scale::minScale() {
+    return _minScale;
+}
+
+float Scale::minScale(float newVal) {
+    float oldVal = _minScale;
+    _minScale = std::max(scaleStep, std::min(newVal, 1.0f));
+    _scale = std::max(_scale, _minScale);
+    return oldVal;
+}
+
+float Scale::scale() {
+    return active() ? _scale : 1.0f;
+}
+
+int Scale::width() {
+    return std::max(1, (int)std::lround(_width * scale()));
+}
+
+int Scale::height() {
+    return std::max(1, (int)std::lround(_height * scale()));
+}
+
+int Scale::sceneWidth() {
+    float scale = active() ? _sceneScale : 1.0f;
+    return std::max(1, (int)std::lround(_width * scale));
+}
+
+int Scale::sceneHeight() {
+    float scale = active() ? _sceneScale : 1.0f;
+    return std::max(1, (int)std::lround(_height * scale));
+}
+
+void Scale::begin() {
+    if (!active()) {
+        return;
+    }
+    if (_queries[0] == 0) {
+        for (int i = 0; i < scaleQueries; i += 1) {
+            _queryRes[i] = _res.create(resQuery);
+            _queries[i] = _res.name(_queryRes[i]);
+        }
+    }
+
+    // A query still waiting for its read is not reused; the frame goes
+    // untimed instead of waiting
+    _timing = !_queryBusy[_next];
+    if (_timing) {
+        _queryScales[_next] = _scale;
+        glBeginQuery(GL_TIME_ELAPSED, _queries[_next]);
+    } else {
+        _stats.untimed += 1;
+    }
+
+    _sceneScale = _scale;
+    glViewport(0, 0, width(), height());
+}
+
+void Scale::end() {
+    if (!active()) {
+        return;
+    }
+    if (_timing) {
+        glEndQuery(GL_TIME_ELAPSED);
+        _queryBusy[_next] = true;
+        _next = (_next + 1) % scaleQueries;
+        _timing = false;
+    }
+
+    _read();
+    _stats.scale = _scale;
+    _stats.width = width();
+    _stats.height = height();
+}
+
+void Scale::blit(GLuint framebuffer) {
+    int width = sceneWidth();
+    int height = sceneHeight();
+
+    // At full scale the copy is exact; the read binding is put back, so
+    // reads that follow see the draw framebuffer
+    GLint lastRead = 0;
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &lastRead);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    bool full = width == _width and height == _height;
+    // clang-format off
+    glBlitFramebuffer(
+        0, 0, width, height, 0, 0, _width, _height, GL_COLOR_BUFFER_BIT,
+        full ? GL_NEAREST : GL_LINEAR
+    );
+    // clang-format on
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, lastRead);
+}
+
+ScaleStats Scale::stats() {
+    return _stats;
+}
+
+}  // namespace gpuLib
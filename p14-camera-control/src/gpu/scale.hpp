@@ -0,0 +1,146 @@
+/* File name: scale.hpp
+ *
+ * Intro:
+ * C++ header of the gpu (GPU memory) libraries' scale (Dynamic resolution)
+ * module.
+ * The scene is rendered into an offscreen framebuffer (a render graph's, see
+ * gpu/graph.hpp) at a scale of the window size, and the framebuffer is
+ * upscaled to the window with a linear filtered blit. The framebuffer is of
+ * the full size and the scene is drawn into its lower left corner, so a new
+ * scale costs nothing but a new viewport. Each frame's rendering is timed
+ * with a GPU timer query; the queries cycle through a ring and are read only
+ * once their results are available, so the timing never waits for the GPU.
+ * A controller turns the timings into the scale that holds a target GPU
+ * frame time: the time is modeled as proportional to the pixels drawn (the
+ * scale squared), so each timing, taken at the scale of its own frame,
+ * predicts the full resolution time, which is smoothed. The scale drops at
+ * once to the largest step that fits the target, but rises by one step at a
+ * time, and only after the timings of the last change have come in, so it
+ * settles instead of oscillating.
+ *
+ * Dependencies:
+ * 1. GLEW library (libglew-dev); needs GL 3.0 (ARB_framebuffer_object) for
+ *    the framebuffer and GL 3.3 (ARB_timer_query) for the timings, without
+ *    either of which the scene is drawn to the window directly
+ * 2. The gpu libraries' res module (res.hpp) */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#ifndef GPU__SCALE_HPP
+#define GPU__SCALE_HPP
+
+#include <GL/glew.h>
+
+#include "res.hpp"
+
+/* GPU memory library */
+namespace gpuLib {
+
+/* Timer queries in the ring (frames between a timing and its read). */
+static int const scaleQueries = 4;
+/* Scale step (the scale is a multiple of it). */
+static float const scaleStep = 0.05f;
+
+/* Dynamic resolution statistics. */
+struct ScaleStats {
+    float scale;
+    /* Render size at the scale (unit: pixels). */
+    int width;
+    int height;
+    /* GPU time of the last timed frame, and the smoothed prediction of the
+     * time at the scale (unit: milliseconds). */
+    double gpuMs;
+    double predictedMs;
+    /* Frames timed, and frames not timed as their query was still busy. */
+    long timed;
+    long untimed;
+    /* Scale changes (down and up). */
+    long drops;
+    long rises;
+};
+
+/* Scale (dynamic resolution). */
+class Scale {
+   private:
+    Res &_res;
+    /* Full (window) size (unit: pixels). */
+    int _width;
+    int _height;
+    /* Timer queries (and their handles), the scales of their frames, and
+     * whether they wait for a read. */
+    GLuint _queries[scaleQueries];
+    ResHandle _queryRes[scaleQueries];
+    float _queryScales[scaleQueries];
+    bool _queryBusy[scaleQueries];
+    /* Ring slot of the next query. */
+    int _next;
+    /* Whether the current frame is timed. */
+    bool _timing;
+    /* Target GPU frame time (unit: milliseconds; 0 if off). */
+    float _targetMs;
+    float _minScale;
+    float _scale;
+    /* Scale of the last scene (the timings may change the scale before the
+     * scene is upscaled). */
+    float _sceneScale;
+    /* Smoothed full resolution GPU frame time (unit: milliseconds; negative
+     * before the first timing). */
+    double _fullMs;
+    /* Timings left before the scale may rise. */
+    int _settle;
+    ScaleStats _stats;
+
+    /* Reads the available timings, oldest first, and updates the scale. */
+    void _read();
+    /* Updates the scale from the smoothed time. */
+    void _update();
+
+   public:
+    /* Constructs dynamic resolution of a full size (unit: pixels) and a
+     * target GPU frame time (unit: milliseconds; 0 turns it off), with the
+     * timer queries of a resource manager; touches no GL state. */
+    Scale(Res &res, int width, int height, float targetMs);
+    /* Releases the timer queries. */
+    ~Scale();
+    /* Finds whether the scene is rendered offscreen (the target is on, and
+     * the GL context supports it). */
+    bool active();
+    /* Reads the target GPU frame time (unit: milliseconds). */
+    float targetMs();
+    /* Reads and updates the target GPU frame time (unit: milliseconds; 0
+     * turns it off). */
+    float targetMs(float newVal);
+    /* Reads the lowest scale. */
+    float minScale();
+    /* Reads and updates the lowest scale (clamped to scaleStep to 1). */
+    float minScale(float newVal);
+    /* Reads the scale (1 if inactive). */
+    float scale();
+    /* Reads the render width at the scale (unit: pixels). */
+    int width();
+    /* Reads the render height at the scale (unit: pixels). */
+    int height();
+    /* Reads the render width of the last scene (unit: pixels; the scale
+     * may have changed since). */
+    int sceneWidth();
+    /* Reads the render height of the last scene (unit: pixels). */
+    int sceneHeight();
+    /* Begins a frame's scene (with its full size framebuffer bound): sets
+     * the viewport of the scale, and starts the frame's timing (does
+     * nothing if inactive). */
+    void begin();
+    /* Ends a frame's scene: stops its timing, and updates the scale from
+     * the timings that are ready (does nothing if inactive). */
+    void end();
+    /* Upscales the scene of a framebuffer to the draw framebuffer (of the
+     * full size). */
+    void blit(GLuint framebuffer);
+    /* Reads the statistics. */
+    ScaleStats stats();
+};
+
+}  // namespace gpuLib
+
+// GPU__SCALE_HPP
+#endif
@@ -0,0 +1,256 @@
+/* File name: grid.cpp
+ *
+ * Intro:
+ * C++ implementation of the hashed grid custom library. */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#include "grid.hpp"
+
+#include <cmath>
+
+Grid::Grid(float cellSize) {
+    _cellSize = cellSize;
+    _invCellSize = 1.0f / cellSize;
+    _maxRadius = 0.0f;
+    _count = 0;
+    _cellMoves = 0;
+}
+
+float Grid::cellSize() {
+    return _cellSize;
+}
+
+int Grid::count() {
+    return _count;
+}
+
+bool Grid::has(int id) {
+    return id >= 0 and id < (int)_items.size() and _items[id].cell != -1;
+}
+
+int Grid::_coord(float v) {
+    return (int)std::floor(v * _invCellSize);
+}
+
+int64_t Grid::_key(int x, int y, int z) {
+    // 21 bits per axis; far cells may share keys, which only costs tests
+    int64_t const mask = 0x1FFFFF;
+    return (x & mask) << 42 | (y & mask) << 21 | (z & mask);
+}
+
+void Grid::_link(int id, int64_t cell) {
+    std::vector<int> &bucket = _cells[cell];
+    _items[id].cell = cell;
+    _items[id].slot = (int)bucket.size();
+    bucket.push_back(id);
+}
+
+void Grid::_unlink(int id) {
+    // Swap the last id of the bucket into the freed slot
+    Item &item = _items[id];
+    auto cell = _cells.find(item.cell);
+    std::vector<int> &bucket = cell->second;
+    int last = bucket.back();
+    bucket[item.slot] = last;
+    _items[last].slot = item.slot;
+    bucket.pop_back();
+    item.cell = -1;
+    // Only the cells in use are kept, so the scans stay short
+    if (bucket.empty()) {
+        _cells.erase(cell);
+    }
+}
+
+void Grid::insert(int id, glm::vec3 pos, float radius) {
+    if (id >= (int)_items.size()) {
+        Item empty;
+        empty.cell = -1;
+        _items.resize(id + 1, empty);
+    }
+    if (has(id)) {
+        _unlink(id);
+        _count -= 1;
+    }
+    _items[id].pos = pos;
+    _items[id].radius = radius;
+    _maxRadius = radius > _maxRadius ? radius : _maxRadius;
+    _link(id, _key(_coord(pos.x), _coord(pos.y), _coord(pos.z)));
+    _count += 1;
+}
+
+void Grid::insert(std::vector<int> const &ids,
+                  std::vector<glm::vec3> const &positions,
+                  std::vector<float> const &radii) {
+    int maxId = -1;
+    for (int id : ids) {
+        maxId = id > maxId ? id : maxId;
+    }
+    if (maxId >= (int)_items.size()) {
+        Item empty;
+        empty.cell = -1;
+        _items.resize(maxId + 1, empty);
+    }
+    _cells.reserve(_cells.size() + ids.size() / 4);
+    for (size_t i = 0; i < ids.size(); i += 1) {
+        insert(ids[i], positions[i], radii[i]);
+    }
+}
+
+void Grid::move(int id, glm::vec3 pos) {
+    if (!has(id)) {
+        return;
+    }
+    Item &item = _items[id];
+    item.pos = pos;
+    int64_t cell = _key(_coord(pos.x), _coord(pos.y), _coord(pos.z));
+    if (cell == item.cell) {
+        return;
+    }
+    _unlink(id);
+    _link(id, cell);
+    _cellMoves += 1;
+}
+
+void Grid::remove(int id) {
+    if (has(id)) {
+        _unlink(id);
+        _count -= 1;
+    }
+}
+
+void Grid::remove(std::vector<int> const &ids) {
+    for (int id : ids) {
+        remove(id);
+    }
+}
+
+void Grid::clear() {
+    _items.clear();
+    _cells.clear();
+    _maxRadius = 0.0f;
+    _count = 0;
+    _cellMoves = 0;
+}
+
+template <class Visit>
+void Grid::_visitCells(glm::vec3 lo, glm::vec3 hi, Visit const &visit) {
+    // Objects reach out of their cells by up to the largest radius
+    int cLo[3];
+    int cHi[3];
+    double cellCount = 1.0;
+    for (int i = 0; i < 3; i += 1) {
+        cLo[i] = _coord(lo[i] - _maxRadius);
+        cHi[i] = _coord(hi[i] + _maxRadius);
+        cellCount *= (double)(cHi[i] - cLo[i] + 1);
+    }
+
+    // Large ranges are cheaper to scan through the cells in use
+    if (cellCount > (double)_cells.size()) {
+        for (auto &cell : _cells) {
+            visit(cell.second);
+        }
+        return;
+    }
+    for (int x = cLo[0]; x <= cHi[0]; x += 1) {
+        for (int y = cLo[1]; y <= cHi[1]; y += 1) {
+            for (int z = cLo[2]; z <= cHi[2]; z += 1) {
+                auto cell = _cells.find(_key(x, y, z));
+                if (cell != _cells.end()) {
+                    visit(cell->second);
+                }
+            }
+        }
+    }
+}
+
+void Grid::sphere(glm::vec3 center, float radius, std::vector<int> &result) {
+    glm::vec3 extent(radius, radius, radius);
+    _visitCells(center - extent, center + extent, [&](std::vector<int> &ids) {
+        for (int id : ids) {
+            Item const &item = _items[id];
+            float reach = radius + item.radius;
+            glm::vec3 offset = item.pos - center;
+            if (glm::dot(offset, offset) <= reach * reach) {
+                result.push_back(id);
+            }
+        }
+    });
+}
+
+void Grid::box(glm::vec3 lo, glm::vec3 hi, std::vector<int> &result) {
+    _visitCells(lo, hi, [&](std::vector<int> &ids) {
+        for (int id : ids) {
+            // Distance from the center to the box
+            Item const &item = _items[id];
+            glm::vec3 nearest = glm::min(glm::max(item.pos, lo), hi);
+            glm::vec3 offset = item.pos - nearest;
+            if (glm::dot(offset, offset) <= item.radius * item.radius) {
+                result.push_back(id);
+            }
+        }
+    });
+}
+
+int Grid::nearest(glm::vec3 pos, float maxDist) {
+    int best = -1;
+    float bestDist2 = maxDist * maxDist;
+    auto test = [&](std::vector<int> &ids) {
+        for (int id : ids) {
+            glm::vec3 offset = _items[id].pos - pos;
+            float dist2 = glm::dot(offset, offset);
+            if (dist2 <= bestDist2) {
+                best = id;
+                bestDist2 = dist2;
+            }
+        }
+    };
+
+    // Search shells of cells around the position's cell; after shell r, the
+    // cells left are at least r cells away
+    int cx = _coord(pos.x);
+    int cy = _coord(pos.y);
+    int cz = _coord(pos.z);
+    int rMax = (int)std::ceil(maxDist * _invCellSize);
+    for (int r = 0; r <= rMax; r += 1) {
+        double side = 2.0 * r + 1.0;
+        if (side * side * side > (double)_cells.size()) {
+            for (auto &cell : _cells) {
+                test(cell.second);
+            }
+            break;
+        }
+        for (int x = -r; x <= r; x += 1) {
+            for (int y = -r; y <= r; y += 1) {
+                bool onShell = x == -r or x == r or y == -r or y == r;
+                int zStep = onShell or r == 0 ? 1 : 2 * r;
+                for (int z = -r; z <= r; z += zStep) {
+                    auto cell = _cells.find(_key(cx + x, cy + y, cz + z));
+                    if (cell != _cells.end()) {
+                        test(cell->second);
+                    }
+                }
+            }
+        }
+        float shellDist = (float)r * _cellSize;
+        if (best >= 0 and bestDist2 <= shellDist * shellDist) {
+            break;
+        }
+    }
+    return best;
+}
+
+GridStats Grid::stats() {
+    GridStats stats;
+    stats.objs = _count;
+    stats.cells = (int)_cells.size();
+    stats.maxBucket = 0;
+    for (auto &cell : _cells) {
+        int size = (int)cell.second.size();
+        stats.maxBucket = size > stats.maxBucket ? size : stats.maxBucket;
+    }
+    stats.cellMoves = _cellMoves;
+    _cellMoves = 0;
+    return stats;
+}
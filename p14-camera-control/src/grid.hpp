@@ -0,0 +1,117 @@
+/* File name: grid.hpp
+ *
+ * Intro:
+ * C++ header of the hashed grid custom library.
+ * A dynamic spatial index of moving objects, each stored as a sphere in the
+ * uniform grid cell that holds its center. Only the cells in use are stored,
+ * in a hash map, so the world has no bounds. The grid is loose: objects are
+ * not split across cells, and the queries widen their reach by the largest
+ * radius instead. Moving an object within its cell only updates its
+ * position, and moving it across cells swaps it out of one cell's bucket and
+ * into another's, so updates take O(1) amortized time, and nothing is
+ * rebuilt per frame.
+ *
+ * Dependencies:
+ * 1. GLM library (libglm-dev) */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#ifndef GRID_HPP
+#define GRID_HPP
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/ext.hpp>
+
+/* Hashed grid statistics. */
+struct GridStats {
+    /* Stored objects. */
+    int objs;
+    /* Cells holding objects. */
+    int cells;
+    /* Largest object count of a cell. */
+    int maxBucket;
+    /* Moves across cells since the last statistics. */
+    long cellMoves;
+};
+
+/* (Hashed) grid. */
+class Grid {
+   private:
+    /* Stored object. */
+    struct Item {
+        glm::vec3 pos;
+        float radius;
+        /* Cell key (-1 if the object is not stored). */
+        int64_t cell;
+        /* Index in the cell's bucket. */
+        int slot;
+    };
+
+    float _cellSize;
+    float _invCellSize;
+    /* Largest radius of the objects ever stored (queries widen by it). */
+    float _maxRadius;
+    /* Objects by id (ids are dense small integers, as object indices). */
+    std::vector<Item> _items;
+    /* Object ids of each cell in use (empty cells are dropped). */
+    std::unordered_map<int64_t, std::vector<int>> _cells;
+    int _count;
+    long _cellMoves;
+
+    /* Finds the cell coordinate of a position coordinate. */
+    int _coord(float v);
+    /* Finds the key of a cell. */
+    static int64_t _key(int x, int y, int z);
+    /* Adds an object's id to the bucket of a cell. */
+    void _link(int id, int64_t cell);
+    /* Removes an object's id from its cell's bucket. */
+    void _unlink(int id);
+    /* Calls visit(bucket) for each cell in use that may hold objects whose
+     * spheres overlap the box. */
+    template <class Visit>
+    void _visitCells(glm::vec3 lo, glm::vec3 hi, Visit const &visit);
+
+   public:
+    /* Initializes an empty grid with the specified cell size (unit: world
+     * space lengths). Good cell sizes are a few times the typical radius. */
+    Grid(float cellSize);
+    /* Reads the cell size. */
+    float cellSize();
+    /* Reads the stored object count. */
+    int count();
+    /* Finds whether an object is stored. */
+    bool has(int id);
+    /* Stores an object (replacing it if it is already stored). */
+    void insert(int id, glm::vec3 pos, float radius);
+    /* Stores objects ids[i] at positions[i] with radii[i]. */
+    void insert(std::vector<int> const &ids,
+                std::vector<glm::vec3> const &positions,
+                std::vector<float> const &radii);
+    /* Moves an object if it is stored. */
+    void move(int id, glm::vec3 pos);
+    /* Removes an object if it is stored. */
+    void remove(int id);
+    /* Removes objects. */
+    void remove(std::vector<int> const &ids);
+    /* Removes all objects. */
+    void clear();
+    /* Finds the objects whose spheres overlap a sphere. The objects are
+     * appended to result, in no particular order. */
+    void sphere(glm::vec3 center, float radius, std::vector<int> &result);
+    /* Finds the objects whose spheres overlap an axis-aligned box. The
+     * objects are appended to result, in no particular order. */
+    void box(glm::vec3 lo, glm::vec3 hi, std::vector<int> &result);
+    /* Finds the object whose center is nearest to a position, within the
+     * distance maxDist; returns -1 if there is none. */
+    int nearest(glm::vec3 pos, float maxDist);
+    /* Reads the statistics and restarts the move count. */
+    GridStats stats();
+};
+
+// GRID_HPP
+#endif
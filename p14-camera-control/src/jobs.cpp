@@ -0,0 +1,114 @@
+/* File name: jobs.cpp
+ *
+ * Intro:
+ * C++ implementation of the job system custom library. */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#include "jobs.hpp"
+
+Jobs::Jobs(int threads) {
+    if (threads <= 0) {
+        threads = (int)std::thread::hardware_concurrency();
+    }
+    if (threads <= 0) {
+        threads = 1;
+    }
+
+    _body = nullptr;
+    _count = 0;
+    _grain = 1;
+    _next = 0;
+    _gen = 0;
+    _busy = 0;
+    _stopping = false;
+
+    for (int worker = 1; worker < threads; worker += 1) {
+        _threads.emplace_back(&Jobs::_run, this, worker);
+    }
+}
+
+Jobs::~Jobs() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = true;
+    }
+    _start.notify_all();
+    for (std::thread &thread : _threads) {
+        thread.join();
+    }
+}
+
+int Jobs::threadCount() {
+    return (int)_threads.size() + 1;
+}
+
+void Jobs::parallelFor(int count, int grain, Body const &body) {
+    if (count <= 0) {
+        return;
+    }
+    if (grain <= 0) {
+        grain = 1;
+    }
+
+    // Small loops and single thread systems run inline
+    if (_threads.empty() or count <= grain) {
+        body(0, count, 0);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _body = &body;
+        _count = count;
+        _grain = grain;
+        _next = 0;
+        _busy = (int)_threads.size();
+        _gen += 1;
+    }
+    _start.notify_all();
+
+    _work(0);
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    _done.wait(lock, [this] { return _busy == 0; });
+    _body = nullptr;
+}
+
+void Jobs::_work(int worker) {
+    while (true) {
+        int begin = _next.fetch_add(_grain);
+        if (begin >= _count) {
+            break;
+        }
+        int end = begin + _grain < _count ? begin + _grain : _count;
+        (*_body)(begin, end, worker);
+    }
+}
+
+void Jobs::_run(int worker) {
+    long seenGen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            // clang-format off
+            _start.wait(lock, [this, seenGen] {
+                return _stopping or _gen != seenGen;
+            });
+            // clang-format on
+            if (_stopping) {
+                return;
+            }
+            seenGen = _gen;
+        }
+
+        _work(worker);
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _busy -= 1;
+        }
+        _done.notify_one();
+    }
+}
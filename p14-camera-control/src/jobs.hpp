@@ -0,0 +1,69 @@
+/* File name: jobs.hpp
+ *
+ * Intro:
+ * C++ header of the job system custom library.
+ * A fixed set of worker threads runs parallel loops. The calling thread
+ * joins the work, so a job system with 1 thread runs everything inline.
+ * 
+ * Dependencies:
+ * 1. C++ threads (-pthread) */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#ifndef JOBS_HPP
+#define JOBS_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/* Job system. */
+class Jobs {
+   public:
+    /* Loop body; runs the items in [begin, end) on the worker worker. */
+    typedef std::function<void(int begin, int end, int worker)> Body;
+
+   private:
+    /* Worker threads (the calling thread is worker 0 and is not stored). */
+    std::vector<std::thread> _threads;
+    std::mutex _mutex;
+    /* Wakes the workers when a loop starts or the system stops. */
+    std::condition_variable _start;
+    /* Wakes the caller when the workers finish a loop. */
+    std::condition_variable _done;
+    /* Current loop. */
+    Body const *_body;
+    int _count;
+    int _grain;
+    /* Next unclaimed item of the current loop. */
+    std::atomic<int> _next;
+    /* Loop generation; increases for each loop. */
+    long _gen;
+    /* Workers still running the current loop. */
+    int _busy;
+    bool _stopping;
+
+    void _work(int worker);
+    void _run(int worker);
+
+   public:
+    /* Initializes a job system with the specified thread count (including the
+     * calling thread). A count of 0 uses all hardware threads. */
+    Jobs(int threads);
+    /* Stops and joins the worker threads. */
+    ~Jobs();
+    /* Reads the thread count (including the calling thread). */
+    int threadCount();
+    /* Runs the body over [0, count) in chunks of grain items and waits.
+     * Note:
+     * The chunks are claimed in order but may run in any order on any
+     * thread; results must not depend on the worker that runs them. */
+    void parallelFor(int count, int grain, Body const &body);
+};
+
+// JOBS_HPP
+#endif
@@ -11,7 +11,8 @@
 int main(int argc, char **argv) {
     // Initialize GLUT
     glutInit(&argc, argv);
-    glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGBA);
+    parseArgs(argc, argv);
+    glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGBA | GLUT_DEPTH);
     glutInitWindowSize(winWidth, winHeight);
     glutInitWindowPosition(100, 100);
     glutCreateWindow(winTitle);
@@ -24,10 +25,30 @@ int main(int argc, char **argv) {
     initGLEW();
 
     glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    // The Hi-Z pyramid is built from the depth buffer
+    glEnable(GL_DEPTH_TEST);
 
+    loadScene();
+    loadObjBvh();
+    loadCollider();
+    showVertexFormatStats();
     loadVertexBuffer();
     loadIndexBuffer();
+    loadVertexArray();
+    showArenaStats();
+    showResStats();
     loadShaderProgram();
+    timeVertexFetch();
+    if (drawPath == drawGpu) {
+        loadCullPrograms();
+        loadCullMeshes();
+        loadCullObjs();
+    }
+    loadShaderWatch();
+    loadFrameGraph();
+    if (capturePath != nullptr) {
+        startCapture();
+    }
 
     // Draw
     glutMainLoop();
@@ -35,6 +56,104 @@ int main(int argc, char **argv) {
     return 0;
 }
 
+static void parseArgs(int argc, char **argv) {
+    char const funcName[] = "parseArgs";
+
+    for (int i = 1; i < argc; i += 1) {
+        char const *arg = argv[i];
+        char const *val = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (val == nullptr) {
+            errShowLine(funcName, "error: missing value: %s", arg);
+            showUsage(argv[0]);
+            exit(1);
+        }
+        i += 1;
+
+        bool ok = true;
+        if (strcmp(arg, "--objs") == 0) {
+            long count = atol(val);
+            ok = count > 0;
+            gen.count(count);
+            genScene = true;
+        } else if (strcmp(arg, "--seed") == 0) {
+            gen.seed(strtoull(val, NULL, 10));
+        } else if (strcmp(arg, "--dist") == 0) {
+            sceneLib::Dist dist;
+            ok = sceneLib::parseDist(val, dist);
+            gen.dist(dist);
+        } else if (strcmp(arg, "--extent") == 0) {
+            float extent = atof(val);
+            ok = extent > 0.0f;
+            gen.extent(extent);
+        } else if (strcmp(arg, "--meshes") == 0) {
+            int kinds = 0;
+            ok = sceneLib::parseKinds(val, kinds) and kinds != 0;
+            gen.kinds(kinds);
+        } else if (strcmp(arg, "--subdiv") == 0) {
+            int subdiv = atoi(val);
+            ok = subdiv >= 0 and subdiv <= 8;
+            gen.subdiv(subdiv);
+        } else if (strcmp(arg, "--threads") == 0) {
+            threadCount = atoi(val);
+            ok = threadCount >= 0;
+        } else if (strcmp(arg, "--draw") == 0) {
+            ok = false;
+            for (int path = drawDirect; path <= drawGpu; path += 1) {
+                if (strcmp(val, drawNames[path]) == 0) {
+                    drawPath = path;
+                    ok = true;
+                }
+            }
+            drawSet = true;
+        } else if (strcmp(arg, "--occlusion") == 0) {
+            ok = strcmp(val, "on") == 0 or strcmp(val, "off") == 0;
+            occlusion = strcmp(val, "on") == 0;
+        } else if (strcmp(arg, "--cpu-occlusion") == 0) {
+            ok = strcmp(val, "on") == 0 or strcmp(val, "off") == 0;
+            cpuOcclusion = strcmp(val, "on") == 0;
+        } else if (strcmp(arg, "--collision") == 0) {
+            ok = strcmp(val, "on") == 0 or strcmp(val, "off") == 0;
+            collision = strcmp(val, "on") == 0;
+        } else if (strcmp(arg, "--capture") == 0) {
+            capturePath = val;
+        } else if (strcmp(arg, "--frames") == 0) {
+            int depth = atoi(val);
+            ok = depth >= 1 and depth <= gpuLib::framesMaxDepth;
+            frames.depth(depth);
+        } else if (strcmp(arg, "--target-ms") == 0) {
+            float targetMs = atof(val);
+            ok = targetMs >= 0.0f;
+            dynRes.targetMs(targetMs);
+        } else if (strcmp(arg, "--min-scale") == 0) {
+            float minScale = atof(val);
+            ok = minScale > 0.0f and minScale <= 1.0f;
+            dynRes.minScale(minScale);
+        } else {
+            errShowLine(funcName, "error: unknown option: %s", arg);
+            showUsage(argv[0]);
+            exit(1);
+        }
+
+        if (!ok) {
+            errShowLine(funcName, "error: invalid value: %s %s", arg, val);
+            showUsage(argv[0]);
+            exit(1);
+        }
+    }
+}
+
+static void showUsage(char const *exeName) {
+    fprintf(stderr, "usage: %s [--objs N] [--seed S]", exeName);
+    fprintf(stderr, " [--dist uniform|ball|clusters] [--extent E]");
+    fprintf(stderr, " [--meshes tetra,sphere,grid] [--subdiv N]");
+    fprintf(stderr, " [--threads N] [--draw direct|indirect|gpu]");
+    fprintf(stderr, " [--occlusion on|off] [--cpu-occlusion on|off]");
+    fprintf(stderr, " [--collision on|off] [--frames N]");
+    fprintf(stderr, " [--capture FILE.png|FILE.y4m]");
+    fprintf(stderr, " [--target-ms MS] [--min-scale S]\n");
+    fflush(stderr);
+}
+
 static void initCam() {
     cam.ctrl().enabled(true);
 }
@@ -43,40 +162,523 @@ static void loadGLUTFuncs() {
     glutDisplayFunc(display);
     glutIdleFunc(display);
     glutSpecialFunc(onKey);
+    glutKeyboardFunc(onChar);
+    glutMouseFunc(onMouse);
+    glutMotionFunc(onMotion);
+    glutPassiveMotionFunc(onMotion);
+    glutEntryFunc(onEntry);
+    glutCloseFunc(onClose);
 }
 
 static void display() {
     static float const rotateSpeed = 0.1f;
     static int transCount = 0;
-    static Trans trans;
-    static Persp persp(winWidth, winHeight, 1.0f, 100.0f, 60.0f);
-    static Pipeline pipeline(&trans, &persp, &cam);
 
+    // Wait until the GPU has finished the frame whose slot this one reuses
+    frames.begin();
+    frameArena.begin(frames.slot());
+    long heapStart = heapAllocs();
+
+    // Only the default scene's tetrahedron rotates
     transCount += 1;
-    trans.rot(0.0f, rotateSpeed * transCount, 0.0f);
-    trans.pos(0.0f, 0.0f, 3.0f);
+    if (!genScene) {
+        Trans &trans = scene.objs()[0].trans;
+        trans.rot(0.0f, rotateSpeed * transCount, 0.0f);
+        // Moving objects keep their tree; only the boxes are refit
+        findObjBoxes();
+        objBvh.refit(objBoxes);
+    }
+
+    reloadShaders();
+    // The levels of detail follow the pixels actually rendered
+    lodSel.view(persp, dynRes.height());
+
+    // The view projection is shared by all objects; the frustum planes found
+    // from it are in world space
+    pipelineLib::Pipeline<Persp, Cam> viewPipeline(&persp, &cam);
+    glm::mat4 viewProj = viewPipeline.mapping();
+    Frustum frustum(viewProj);
+
+    // Hover picking
+    if (cursorX >= 0) {
+        double pickUs;
+        PickHit hit = pickObj(viewProj, cursorX, cursorY, pickUs);
+        if (hit.obj != hoverObj) {
+            hoverObj = hit.obj;
+            printf("pick: hover object %d (%.1f us)\n", hoverObj, pickUs);
+            fflush(stdout);
+        }
+    }
+
+    // The scene, its upscale, and the capture's readback
+    frameViewProj = viewProj;
+    frameGraph.execute();
+
+    if (softCompare) {
+        softCompare = false;
+        compareSoft(viewProj, frustum);
+    }
+
+    glutSwapBuffers();
+    frames.end();
+    // Delete the released GL objects once the GPU is done with them
+    gpuRes.collect();
+    submitHeapAllocs += heapAllocs() - heapStart;
+}
+
+static void drawScene() {
+    glm::mat4 const &viewProj = frameViewProj;
+    Frustum frustum(viewProj);
 
-    glClear(GL_COLOR_BUFFER_BIT);
+    // The framebuffer is the graph's; the viewport is the scale's
+    dynRes.begin();
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+    auto start = std::chrono::steady_clock::now();
+
+    // All meshes live in the same arenas, so one vertex array serves them all
+    loadVertexArray();
+    glBindVertexArray(gpuRes.name(vertexArray));
+    int visible = 0;
+    long tris = 0;
+    if (drawPath == drawGpu) {
+        drawCulled(viewProj);
+    } else {
+        if (cpuOcclusion) {
+            occludeObjs(viewProj, frustum);
+        }
+        indirect.clear();
+        // Only the objects in the frustum's BVH nodes are visited
+        objHits.clear();
+        objBvh.frustum(frustum, objHits);
+        FrameVector<DrawItem> drawList{FrameAlloc<DrawItem>(frameArena)};
+        drawList.reserve(objHits.size());
+        for (int i : objHits) {
+            Obj &obj = scene.objs()[i];
+            if (cpuOcclusion and !occlVisible[i]) {
+                continue;
+            }
+            glm::mat4 world;
+            if (!selectObj(obj, frustum, world)) {
+                continue;
+            }
+            visible += 1;
+            tris += scene.lods()[obj.mesh].count(obj.lod) / 3;
+            uint64_t key = (uint64_t)obj.mesh << 40 |
+                           (uint64_t)obj.lod << 32 | (uint32_t)i;
+            drawList.push_back(DrawItem{key, i, viewProj * world});
+        }
+
+        // Draws of one mesh in a row share its dequantization uniforms
+        // clang-format off
+        std::sort(
+            drawList.begin(), drawList.end(),
+            [](DrawItem const &a, DrawItem const &b) { return a.key < b.key; }
+        );
+        // clang-format on
+        for (DrawItem const &item : drawList) {
+            Obj &obj = scene.objs()[item.obj];
+            if (drawPath == drawIndirect) {
+                addObjDraw(obj, item.mapping);
+            } else {
+                drawObj(obj, item.mapping);
+            }
+        }
+        if (drawPath == drawIndirect) {
+            indirect.submit(0, frames.slot());
+        }
+    }
+    glBindVertexArray(0);
+
+    auto end = std::chrono::steady_clock::now();
+    std::chrono::duration<double, std::milli> elapsed = end - start;
+    dynRes.end();
+    showSubmitStats(elapsed.count(), visible, tris);
+}
+
+static bool selectObj(Obj &obj, Frustum &frustum, glm::mat4 &world) {
+    world = obj.trans.world();
+
+    // Cull with the mesh's bounding sphere, moved to world space
+    glm::vec4 sphere = scene.spheres()[obj.mesh];
+    glm::vec3 scale = obj.trans.scale();
+    float maxScale = glm::max(scale[0], glm::max(scale[1], scale[2]));
+    glm::vec3 center = glm::vec3(world * glm::vec4(glm::vec3(sphere), 1.0f));
+    if (!frustum.sphere(center, sphere.w * maxScale)) {
+        return false;
+    }
+
+    // Select the level of detail from the projected error
+    meshLib::Lod &lod = scene.lods()[obj.mesh];
+    float dist = glm::distance(obj.trans.pos(), cam.pos());
+    obj.lod = lodSel.select(lod, obj.lod, maxScale, dist);
+    return true;
+}
+
+static void drawObj(Obj &obj, glm::mat4 const &objMapping) {
+    drawReflect.set(mapping, objMapping);
+
+    // Dequantize with the object's mesh (skipped while the mesh repeats)
+    meshLib::Quant &quant = scene.quants()[obj.mesh];
+    drawReflect.set(posScale, quant.scale());
+    drawReflect.set(posOffset, quant.offset());
+
+    // Draw the mesh's range of the arenas
+    meshLib::Lod &lod = scene.lods()[obj.mesh];
+    GLint baseVertex = vertexArena->offset(vertexAllocs[obj.mesh]);
+    long first = indexArena->offset(indexAllocs[obj.mesh]) + lod.first(obj.lod);
     // clang-format off
-    glUniformMatrix4fv(
-        mapping, 1, GL_FALSE, glm::value_ptr(pipeline.mapping())
+    glDrawElementsBaseVertex(
+        GL_TRIANGLES, lod.count(obj.lod), GL_UNSIGNED_INT,
+        (void *)(first * sizeof(unsigned int)), baseVertex
     );
     // clang-format on
+}
 
-    // Draw based on the vertices and indices
-    glEnableVertexAttribArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, 0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
-    glDrawElements(GL_TRIANGLES, 12, GL_UNSIGNED_INT, 0);
-    glDisableVertexAttribArray(0);
+static void addObjDraw(Obj &obj, glm::mat4 const &objMapping) {
+    // The same arena ranges as drawObj, as an indirect command
+    meshLib::Lod &lod = scene.lods()[obj.mesh];
+    gpuLib::DrawCmd cmd;
+    cmd.count = lod.count(obj.lod);
+    cmd.instanceCount = 1;
+    cmd.firstIndex = indexArena->offset(indexAllocs[obj.mesh]);
+    cmd.firstIndex += lod.first(obj.lod);
+    cmd.baseVertex = vertexArena->offset(vertexAllocs[obj.mesh]);
+    cmd.baseInstance = 0;
 
-    glutSwapBuffers();
+    // The shader finds the draw's data with gl_DrawIDARB
+    meshLib::Quant &quant = scene.quants()[obj.mesh];
+    gpuLib::DrawData data;
+    data.mapping = objMapping;
+    data.posScale = glm::vec4(quant.scale(), 0.0f);
+    data.posOffset = glm::vec4(quant.offset(), 0.0f);
+
+    indirect.add(cmd, data);
+}
+
+static void occludeObjs(glm::mat4 const &viewProj, Frustum &frustum) {
+    std::vector<Obj> &objs = scene.objs();
+    int count = (int)objs.size();
+    occlSpheres.resize(count);
+    occlSizes.resize(count);
+    occl.clear();
+
+    // World space spheres and projected sizes; the spheres outside the
+    // frustum are marked with a negative radius
+    // clang-format off
+    jobs->parallelFor(count, 256, [&](int begin, int end, int worker) {
+        for (int i = begin; i < end; i += 1) {
+            Obj &obj = objs[i];
+            glm::vec4 sphere = scene.spheres()[obj.mesh];
+            glm::vec3 scale = obj.trans.scale();
+            float maxScale = glm::max(scale[0], glm::max(scale[1], scale[2]));
+            glm::vec4 local = glm::vec4(glm::vec3(sphere), 1.0f);
+            glm::vec4 center = obj.trans.world() * local;
+            float radius = sphere.w * maxScale;
+            if (!frustum.sphere(glm::vec3(center), radius)) {
+                occlSpheres[i] = glm::vec4(glm::vec3(center), -1.0f);
+                occlSizes[i] = 0.0f;
+                continue;
+            }
+            occlSpheres[i] = glm::vec4(glm::vec3(center), radius);
+            float dist = glm::distance(glm::vec3(center), cam.pos());
+            float diameter = radius * 2.0f / glm::max(dist, 1e-3f);
+            occlSizes[i] = diameter * lodSel.pxPerUnit();
+        }
+    });
+    // clang-format on
+
+    // The largest objects on screen hide the most, so they are the occluders
+    FrameVector<int> picks{FrameAlloc<int>(frameArena)};
+    picks.reserve(count);
+    for (int i = 0; i < count; i += 1) {
+        if (occlSizes[i] >= occluderMinPx) {
+            picks.push_back(i);
+        }
+    }
+    if ((int)picks.size() > occluderMax) {
+        // clang-format off
+        std::nth_element(
+            picks.begin(), picks.begin() + occluderMax, picks.end(),
+            [](int a, int b) { return occlSizes[a] > occlSizes[b]; }
+        );
+        // clang-format on
+        picks.resize(occluderMax);
+    }
+    for (int i : picks) {
+        Obj &obj = objs[i];
+        meshLib::Lod &lod = scene.lods()[obj.mesh];
+        glm::mat4 objMapping = viewProj * obj.trans.world();
+        // clang-format off
+        occl.addOccluder(
+            objMapping, scene.meshes()[obj.mesh].positions(),
+            lod.indices().data() + lod.first(obj.lod), lod.count(obj.lod)
+        );
+        // clang-format on
+    }
+
+    occl.rasterize(*jobs);
+    occl.test(*jobs, viewProj, occlSpheres, occlVisible);
+}
+
+static void compareSoft(glm::mat4 const &viewProj, Frustum &frustum) {
+    // The scene is compared before its upscale, at the size it was rendered
+    // at, as a filtered upscale differs from any rendering at the full size
+    int width = dynRes.sceneWidth();
+    int height = dynRes.sceneHeight();
+    if (soft.width() != width or soft.height() != height) {
+        soft = Soft(width, height);
+    }
+
+    // Render the objects the CPU paths draw, from the same buffers
+    soft.clear(glm::vec4(0.0f, 0.0f, 0.0f, 0.0f));
+    for (size_t i = 0; i < scene.objs().size(); i += 1) {
+        Obj &obj = scene.objs()[i];
+        if (cpuOcclusion and drawPath != drawGpu and !occlVisible[i]) {
+            continue;
+        }
+        glm::mat4 world;
+        if (!selectObj(obj, frustum, world)) {
+            continue;
+        }
+        meshLib::Quant &quant = scene.quants()[obj.mesh];
+        meshLib::Lod &lod = scene.lods()[obj.mesh];
+        unsigned int *indices = lod.indices().data() + lod.first(obj.lod);
+        // clang-format off
+        soft.draw(
+            viewProj * world, quant.scale(), quant.offset(), quant.vertices(),
+            indices, lod.count(obj.lod)
+        );
+        // clang-format on
+    }
+    soft.flush(*jobs);
+
+    // The scene's framebuffer (the back buffer if it is drawn to the window)
+    // still holds the GL frame, in its lower left corner
+    GLuint sceneFramebuffer = frameGraph.framebuffer(scenePass);
+    std::vector<uint32_t> glColors(width * height);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, sceneFramebuffer);
+    glReadBuffer(sceneFramebuffer != 0 ? GL_COLOR_ATTACHMENT0 : GL_BACK);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    // clang-format off
+    glReadPixels(
+        0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, glColors.data()
+    );
+    // clang-format on
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    glReadBuffer(GL_BACK);
+
+    SoftDiff diff = softDiff(glColors, soft.colors(), softTolerance);
+    SoftStats stats = soft.stats();
+    printf("soft: %d draws, %ld triangles, ", stats.draws, stats.tris);
+    printf("%ld tile bins, ", stats.binned);
+    printf("setup %.2f ms, raster %.2f ms ", stats.setupMs, stats.rasterMs);
+    printf("(%s)\n", soft.simd() ? "avx2" : "scalar");
+    printf("soft: max diff %d, ", diff.maxDiff);
+    printf("%.3f%% pixels over %d, ", diff.badFraction * 100.0f, softTolerance);
+    printf("%s\n", diff.badFraction <= softMaxBad ? "match" : "MISMATCH");
+    fflush(stdout);
+
+    softWritePpm("gl.ppm", width, height, glColors);
+    softWritePpm("soft.ppm", width, height, soft.colors());
+}
+
+static void drawCulled(glm::mat4 const &viewProj) {
+    // The objects stay on the GPU; only the rotating one is updated, so
+    // the levels of detail and late flags the shader keeps stay intact
+    if (!genScene) {
+        cull.obj(0, findCullObj(0));
+    }
+    cull.view(viewProj, cam.pos(), lodSel);
+    if (!occlusion) {
+        cull.cull();
+        cull.draw(0);
+        return;
+    }
+
+    // Early pass: what the previous frame's depth does not hide
+    cull.cullEarly(hiz, prevViewProj);
+    cull.draw(0);
+    // Late pass: what the early pass's depth does not hide, among the rest
+    hiz.build(dynRes.width(), dynRes.height());
+    cull.cullLate(hiz);
+    cull.draw(0);
+    // The complete depth is the next frame's occluder
+    hiz.build(dynRes.width(), dynRes.height());
+    prevViewProj = viewProj;
+}
+
+static void showSubmitStats(double ms, int visible, long tris) {
+    submitMs += ms;
+    submitVisible += visible;
+    submitTris += tris;
+    submitWaitMs += frames.stats().waitMs;
+    submitFrames += 1;
+    if (submitFrames < submitStatFrames) {
+        return;
+    }
+
+    printf("draw: %s, ", drawNames[drawPath]);
+    printf("%zu objects, ", scene.objs().size());
+    if (drawPath == drawGpu) {
+        // The GPU path's counts are read back only here, as the read waits
+        // for the GPU; they are the last frame's
+        gpuLib::CullStats stats = cull.stats();
+        printf("%d visible ", stats.visible);
+        printf("(%d late), ", stats.late);
+        printf("%d occluded, ", stats.occluded);
+        printf("%ld triangles, ", stats.tris);
+    } else {
+        printf("%ld visible, ", submitVisible / submitFrames);
+        printf("%ld triangles, ", submitTris / submitFrames);
+    }
+    printf("submit %.3f ms/frame\n", submitMs / submitFrames);
+    gpuLib::FramesStats framesStats = frames.stats();
+    printf("frames: %d in flight, ", framesStats.depth);
+    printf("waited %.3f ms/frame ", submitWaitMs / submitFrames);
+    printf("(max %.3f ms)\n", framesStats.maxWaitMs);
+    FrameArenaStats arenaStats = frameArena.stats();
+    double heapPerFrame = submitHeapAllocs / (double)submitFrames;
+    printf("heap: %.2f allocations/frame, ", heapPerFrame);
+    printf("frame arena %zu B ", arenaStats.used);
+    printf("(peak %zu B, ", arenaStats.peak);
+    printf("%zu B per frame in flight)\n", arenaStats.capacity);
+    if (dynRes.active()) {
+        // The timings are a few frames old, as they are never waited for
+        gpuLib::ScaleStats stats = dynRes.stats();
+        printf("resolution: %dx%d ", stats.width, stats.height);
+        printf("(scale %.2f), ", stats.scale);
+        printf("gpu %.3f ms ", stats.gpuMs);
+        printf("(target %.1f ms), ", dynRes.targetMs());
+        printf("%ld drops, %ld rises\n", stats.drops, stats.rises);
+    }
+    if (capture.active()) {
+        CaptureStats stats = capture.stats();
+        printf("capture: %ld frames, ", stats.captured);
+        printf("%ld dropped, ", stats.dropped);
+        long captured = std::max(stats.captured, 1L);
+        printf("readback %.3f ms/frame\n", stats.totalReadMs / captured);
+    }
+    if (drawPath == drawDirect) {
+        shaderLib::ReflectStats stats = drawReflect.stats();
+        printf("uniforms: %ld uploads, ", stats.uploads);
+        printf("%ld skipped (since load)\n", stats.skipped);
+    }
+    if (cpuOcclusion and drawPath != drawGpu) {
+        // The last frame's occlusion culling
+        OcclStats stats = occl.stats();
+        printf("occlusion: %d occluders, ", stats.occluders);
+        printf("%d triangles, ", stats.tris);
+        printf("%d/%d culled, ", stats.culled, stats.tested);
+        printf("raster %.3f ms ", stats.rasterMs);
+        printf("(%s), ", occl.simd() ? "avx2" : "scalar");
+        printf("test %.3f ms\n", stats.testMs);
+    }
+    fflush(stdout);
+
+    submitMs = 0.0;
+    submitVisible = 0;
+    submitTris = 0;
+    submitWaitMs = 0.0;
+    submitHeapAllocs = 0;
+    submitFrames = 0;
 }
 
 static void onKey(int key, int x, int y) {
-    cam.ctrl().onKey(key);
+    if (!cam.ctrl().onKey(key) or !collision) {
+        return;
+    }
+
+    camLib::CollideStats stats = collider.stats();
+    if (stats.hit) {
+        printf("collide: slid in %d iterations, ", stats.iterations);
+        printf("%d objects, %d triangles tested, ", stats.objs, stats.tested);
+        printf("%.1f us\n", stats.us);
+        fflush(stdout);
+    }
+}
+
+static void onMouse(int button, int state, int x, int y) {
+    cursorX = x;
+    cursorY = y;
+    if (button != GLUT_LEFT_BUTTON or state != GLUT_DOWN) {
+        return;
+    }
+
+    pipelineLib::Pipeline<Persp, Cam> viewPipeline(&persp, &cam);
+    double pickUs;
+    PickHit hit = pickObj(viewPipeline.mapping(), x, y, pickUs);
+    if (hit.obj < 0) {
+        printf("pick: nothing at (%d, %d), %.1f us\n", x, y, pickUs);
+    } else {
+        Obj &obj = scene.objs()[hit.obj];
+        printf("pick: object %d (mesh %d), ", hit.obj, obj.mesh);
+        printf("triangle %d, ", hit.tri / 3);
+        printf("at (%.2f, %.2f, %.2f), ", hit.pos.x, hit.pos.y, hit.pos.z);
+        printf("%d objects tested, %.1f us\n", pick.tested(), pickUs);
+    }
+    fflush(stdout);
+}
+
+static void onMotion(int x, int y) {
+    cursorX = x;
+    cursorY = y;
+}
+
+static void onEntry(int state) {
+    if (state == GLUT_LEFT) {
+        cursorX = -1;
+        cursorY = -1;
+    }
+}
+
+static void onClose() {
+    // The reads in flight need the GL context, which goes after this
+    stopCapture();
+}
+
+static PickHit pickObj(glm::mat4 const &viewProj, int x, int y,
+                       double &pickUs) {
+    auto start = std::chrono::steady_clock::now();
+
+    // The viewport follows the window
+    int width = glutGet(GLUT_WINDOW_WIDTH);
+    int height = glutGet(GLUT_WINDOW_HEIGHT);
+    glm::vec3 origin;
+    glm::vec3 dir;
+    pickRay(viewProj, x, y, width, height, origin, dir);
+    PickHit hit = pick.ray(scene, objBvh, origin, dir);
+
+    auto end = std::chrono::steady_clock::now();
+    std::chrono::duration<double, std::micro> elapsed = end - start;
+    pickUs = elapsed.count();
+    return hit;
+}
+
+static void onChar(unsigned char key, int x, int y) {
+    if (key == 'c' or key == 'C') {
+        vertexArena->compact();
+        indexArena->compact();
+        if (drawPath == drawGpu) {
+            loadCullMeshes();
+        }
+        showArenaStats();
+        showResStats();
+    }
+    if (key == 's' or key == 'S') {
+        softCompare = true;
+    }
+    if (key == 'g' or key == 'G') {
+        frameGraph.dump(stdout);
+        fflush(stdout);
+    }
+    if (key == 'v' or key == 'V') {
+        if (capture.active()) {
+            stopCapture();
+        } else {
+            startCapture();
+        }
+    }
 }
 
 static void initGLEW() {
@@ -88,80 +690,465 @@ static void initGLEW() {
         errShowLine(funcName, "error string: %s", glewGetErrorString(result));
         exit(1);
     }
+
+    // The quantized normals need the packed 10-10-10-2 vertex type
+    if (!GLEW_VERSION_3_3 and !GLEW_ARB_vertex_type_2_10_10_10_rev) {
+        errShowLine(funcName, "error: GL_INT_2_10_10_10_REV not supported");
+        exit(1);
+    }
+
+    // The arenas need buffer copies and base vertex draws
+    if (!GLEW_VERSION_3_2 and !GLEW_ARB_draw_elements_base_vertex) {
+        errShowLine(funcName, "error: glDrawElementsBaseVertex not supported");
+        exit(1);
+    }
+    if (!GLEW_VERSION_3_1 and !GLEW_ARB_copy_buffer) {
+        errShowLine(funcName, "error: glCopyBufferSubData not supported");
+        exit(1);
+    }
+
+    // Fall back to the next supported path unless a path was asked for
+    if (drawPath == drawGpu and !gpuLib::cullSupported()) {
+        if (drawSet) {
+            errShowLine(funcName, "error: GPU culling not supported");
+            exit(1);
+        }
+        drawPath = drawIndirect;
+    }
+    if (drawPath == drawIndirect and !gpuLib::indirectSupported()) {
+        if (drawSet) {
+            errShowLine(funcName, "error: indirect draws not supported");
+            exit(1);
+        }
+        drawPath = drawDirect;
+    }
+}
+
+static void loadScene() {
+    jobs = new Jobs(threadCount);
+
+    if (genScene) {
+        // Keep the generated objects in front of the camera
+        gen.center(glm::vec3(0.0f, 0.0f, gen.extent() + 5.0f));
+        persp.far(gen.extent() * 4.0f + 10.0f);
+
+        auto start = std::chrono::steady_clock::now();
+        gen.gen(scene, *jobs);
+        auto end = std::chrono::steady_clock::now();
+        std::chrono::duration<double, std::milli> elapsed = end - start;
+        printf("scene: %zu objects, ", scene.objs().size());
+        printf("%ld triangles, ", scene.triCount());
+        printf("generated in %.1f ms ", elapsed.count());
+        printf("on %d threads\n", jobs->threadCount());
+        fflush(stdout);
+    } else {
+        Mesh mesh;
+        sceneLib::tetraMesh(mesh);
+        int obj = scene.addObj(scene.addMesh(mesh));
+        scene.objs()[obj].trans.pos(0.0f, 0.0f, 3.0f);
+    }
+
+    scene.prepare();
+}
+
+static void findObjBoxes() {
+    objBoxes.resize(scene.objs().size());
+    for (size_t i = 0; i < scene.objs().size(); i += 1) {
+        // The box of the mesh's bounding sphere, moved to world space
+        Obj &obj = scene.objs()[i];
+        glm::vec4 sphere = scene.spheres()[obj.mesh];
+        glm::vec3 scale = obj.trans.scale();
+        float maxScale = glm::max(scale[0], glm::max(scale[1], scale[2]));
+        glm::mat4 world = obj.trans.world();
+        glm::vec4 center = world * glm::vec4(glm::vec3(sphere), 1.0f);
+        glm::vec3 radius(sphere.w * maxScale);
+        objBoxes[i].lo = glm::vec3(center) - radius;
+        objBoxes[i].hi = glm::vec3(center) + radius;
+    }
+}
+
+static void loadObjBvh() {
+    findObjBoxes();
+    objBvh.build(objBoxes, *jobs);
+    BvhStats stats = objBvh.stats();
+    printf("bvh: %d nodes, %d leaves, ", stats.nodes, stats.leaves);
+    printf("depth %d, built in %.1f ms\n", stats.depth, stats.buildMs);
+
+    // Picking and the camera's collision share the meshes' BVHs
+    auto start = std::chrono::steady_clock::now();
+    scene.buildBvhs(*jobs);
+    auto end = std::chrono::steady_clock::now();
+    std::chrono::duration<double, std::milli> elapsed = end - start;
+    printf("bvh: mesh BVHs built in %.1f ms\n", elapsed.count());
+    fflush(stdout);
+}
+
+static void loadCollider() {
+    if (!collision) {
+        return;
+    }
+
+    // The objects' and meshes' BVHs are shared, so moving objects need only
+    // the objects' refit
+    collider.attach(scene, objBvh);
+    cam.ctrl().collider(&collider);
+    printf("collide: %zu meshes, ", scene.meshes().size());
+    printf("radius %g\n", collider.radius());
+    fflush(stdout);
+}
+
+static void showVertexFormatStats() {
+    long vertexCount = 0;
+    float posErr = 0.0f;
+    for (size_t i = 0; i < scene.meshes().size(); i += 1) {
+        vertexCount += scene.meshes()[i].vertexCount();
+        posErr = glm::max(posErr, scene.quants()[i].posErr());
+    }
+    int baseStride = meshLib::Quant::baseStride();
+    int floatStride = meshLib::Quant::floatStride();
+    int quantStride = meshLib::Quant::quantStride();
+    long baseBytes = (long)vertexCount * baseStride;
+    long quantBytes = (long)vertexCount * quantStride;
+    float growth = (float)quantStride / (float)baseStride - 1.0f;
+
+    // Against the vertex it replaced (a float32 position), the quantized
+    // vertex is larger, as it also carries the normal and color; against
+    // the float32 layout of the same attributes, it is smaller
+    printf("vertex format: float32 position %d B/vertex, ", baseStride);
+    printf("quantized %d B/vertex ", quantStride);
+    printf("(float32 of the same attributes %d B)\n", floatStride);
+    printf("vertex buffer: float32 position %ld B, ", baseBytes);
+    printf("quantized %ld B, ", quantBytes);
+    printf("growth %.1f%%\n", growth * 100.0f);
+    float saving = 1.0f - (float)quantStride / (float)floatStride;
+    printf("vertex bytes: %.1f%% fewer ", saving * 100.0f);
+    printf("than float32 of the same attributes, ");
+    printf("max position error %g\n", posErr);
+    fflush(stdout);
+}
+
+static void timeVertexFetch() {
+    char const funcName[] = "timeVertexFetch";
+
+    if (!(GLEW_VERSION_3_3 or GLEW_ARB_timer_query)) {
+        printf("vertex fetch: not timed (no timer queries)\n");
+        fflush(stdout);
+        return;
+    }
+
+    // The vertices of every mesh, in both layouts
+    std::vector<meshLib::QuantVertex> quantVertices;
+    std::vector<meshLib::FloatVertex> floatVertices;
+    for (size_t i = 0; i < scene.meshes().size(); i += 1) {
+        std::vector<meshLib::QuantVertex> &vertices =
+            scene.quants()[i].vertices();
+        // clang-format off
+        quantVertices.insert(
+            quantVertices.end(), vertices.begin(), vertices.end()
+        );
+        // clang-format on
+        meshLib::appendFloatVertices(scene.meshes()[i], floatVertices);
+    }
+    GLsizei vertexCount = (GLsizei)quantVertices.size();
+    if (vertexCount == 0) {
+        return;
+    }
+
+    // One program reads both layouts (at the same locations)
+    shaderPre.clear();
+    std::vector<shaderLib::Source> sources(2);
+    char const *fileNames[2] = {fetchVsFileName, fsFileName};
+    sources[0].type = GL_VERTEX_SHADER;
+    sources[1].type = GL_FRAGMENT_SHADER;
+    for (int i = 0; i < 2; i += 1) {
+        if (!shaderPre.expand(fileNames[i], sources[i].text)) {
+            // clang-format off
+            errShowLine(
+                funcName, "warning: %s, not timed", shaderPre.error().c_str()
+            );
+            // clang-format on
+            return;
+        }
+        sources[i].hash = shaderPre.hash();
+    }
+    GLuint program = shaderCache.program(sources);
+    if (program == 0) {
+        errShowLine(funcName, "warning: building fetch.vs, not timed");
+        return;
+    }
+    glUseProgram(program);
+
+    // The points are clipped, so the draws time the vertex fetch and the
+    // vertex shader, not the rasterization
+    double ms[2];
+    for (int layout = 0; layout < 2; layout += 1) {
+        bool quant = layout == 0;
+        GLsizei stride = quant ? meshLib::QuantFmt::stride
+                               : meshLib::FloatFmt::stride;
+        long bytes = (long)vertexCount * stride;
+        void const *data = quant ? (void const *)quantVertices.data()
+                                 : (void const *)floatVertices.data();
+        gpuLib::ResHandle buffer = gpuRes.create(gpuLib::resBuffer);
+        GLuint bufferName = gpuRes.name(buffer);
+        glBindBuffer(GL_ARRAY_BUFFER, bufferName);
+        glBufferData(GL_ARRAY_BUFFER, bytes, data, GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        gpuRes.bytes(buffer, bytes);
+        GLuint array = quant ? meshLib::QuantFmt::vao(bufferName, 0)
+                             : meshLib::FloatFmt::vao(bufferName, 0);
+        gpuLib::ResHandle arrayRes =
+            gpuRes.adopt(gpuLib::resVertexArray, array);
+        gpuLib::ResHandle query = gpuRes.create(gpuLib::resQuery);
+
+        // A warm-up draw, then the timed ones
+        glBindVertexArray(array);
+        glDrawArrays(GL_POINTS, 0, vertexCount);
+        glBeginQuery(GL_TIME_ELAPSED, gpuRes.name(query));
+        for (int i = 0; i < fetchRepeats; i += 1) {
+            glDrawArrays(GL_POINTS, 0, vertexCount);
+        }
+        glEndQuery(GL_TIME_ELAPSED);
+        glBindVertexArray(0);
+        // Waits for the GPU; this runs once, before the first frame
+        GLuint64 ns = 0;
+        glGetQueryObjectui64v(gpuRes.name(query), GL_QUERY_RESULT, &ns);
+        ms[layout] = ns / 1000000.0;
+
+        gpuRes.release(query);
+        gpuRes.release(arrayRes);
+        gpuRes.release(buffer);
+    }
+    glUseProgram(drawProgram);
+
+    double fetched = (double)vertexCount * fetchRepeats;
+    printf("vertex fetch: %ld vertices, ", (long)fetched);
+    printf("quantized %.3f ms ", ms[0]);
+    printf("(%.2f Gvertices/s), ", fetched / (ms[0] * 1e6));
+    printf("float32 %.3f ms ", ms[1]);
+    printf("(%.2f Gvertices/s)\n", fetched / (ms[1] * 1e6));
+    fflush(stdout);
 }
 
 static void loadVertexBuffer() {
-    int const vertexCount = 4;
-    glm::vec3 vertices[vertexCount];
-    {
-        glm::vec3 *v = vertices;
-        v[0] = glm::vec3(-1.0f, -1.0f, 0.5773f);
-        v[1] = glm::vec3(0.0f, -1.0f, -1.1548f);
-        v[2] = glm::vec3(1.0f, -1.0f, 0.5773f);
-        v[3] = glm::vec3(0.0f, 1.0f, 0.0f);
-    }
-
-    // Put vertices into buffer
-    glGenBuffers(1, &vertexBuffer);
-    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
-    // clang-format off
-    glBufferData(
-        GL_ARRAY_BUFFER,
-        vertexCount * sizeof(glm::vec3),
-        vertices,
-        GL_STATIC_DRAW
-    );
-    // clang-format on
+    size_t meshCount = scene.meshes().size();
+    int vertexSize = sizeof(meshLib::QuantVertex);
+    vertexArena = new gpuLib::Arena(gpuRes, vertexSize, 1 << 16);
+    vertexAllocs.resize(meshCount);
+
+    // Put each mesh's vertices into its range of the arena
+    for (size_t i = 0; i < meshCount; i += 1) {
+        meshLib::Quant &quant = scene.quants()[i];
+        std::vector<meshLib::QuantVertex> &vertices = quant.vertices();
+        vertexAllocs[i] = vertexArena->alloc(vertices.size());
+        vertexArena->upload(vertexAllocs[i], vertices.data(), vertices.size());
+    }
 }
 
 static void loadIndexBuffer() {
-    int const indexCount = 12;
-    // clang-format off
-    unsigned int indices[indexCount] = {
-        0, 3, 1,
-        1, 3, 2,
-        2, 3, 0,
-        0, 2, 1
-    };
-    // clang-format on
+    size_t meshCount = scene.meshes().size();
+    indexArena = new gpuLib::Arena(gpuRes, sizeof(unsigned int), 1 << 18);
+    indexAllocs.resize(meshCount);
 
-    // Put indices into buffer
-    glGenBuffers(1, &indexBuffer);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+    // Put each mesh's indices into its range of the arena
+    for (size_t i = 0; i < meshCount; i += 1) {
+        // The indices of all levels of detail, relative to the base vertex
+        std::vector<unsigned int> &indices = scene.lods()[i].indices();
+        indexAllocs[i] = indexArena->alloc(indices.size());
+        indexArena->upload(indexAllocs[i], indices.data(), indices.size());
+    }
+}
+
+static void loadVertexArray() {
+    unsigned int gen = vertexArena->gen() + indexArena->gen();
+    if (gpuRes.live(vertexArray) and gen == vertexArrayGen) {
+        return;
+    }
+
+    gpuRes.release(vertexArray);
+    // The attribute setup is generated from meshLib::QuantFmt
     // clang-format off
-    glBufferData(
-        GL_ELEMENT_ARRAY_BUFFER,
-        indexCount * sizeof(int),
-        indices,
-        GL_STATIC_DRAW
+    GLuint array = meshLib::QuantFmt::vao(
+        vertexArena->buffer(), indexArena->buffer()
     );
     // clang-format on
+    vertexArray = gpuRes.adopt(gpuLib::resVertexArray, array);
+    vertexArrayGen = gen;
+}
+
+static void loadCullMeshes() {
+    size_t meshCount = scene.meshes().size();
+    std::vector<gpuLib::CullMesh> meshes(meshCount);
+    for (size_t i = 0; i < meshCount; i += 1) {
+        meshLib::Quant &quant = scene.quants()[i];
+        meshLib::Lod &lod = scene.lods()[i];
+        gpuLib::CullMesh &mesh = meshes[i];
+        mesh.posScale = glm::vec4(quant.scale(), 0.0f);
+        mesh.posOffset = glm::vec4(quant.offset(), 0.0f);
+        mesh.baseVertex = vertexArena->offset(vertexAllocs[i]);
+        mesh.firstIndex = indexArena->offset(indexAllocs[i]);
+        mesh.levelCount = glm::min(lod.levelCount(), gpuLib::cullMaxLevels);
+        for (int level = 0; level < mesh.levelCount; level += 1) {
+            mesh.levels[level].first = lod.first(level);
+            mesh.levels[level].count = lod.count(level);
+            mesh.levels[level].err = lod.err(level);
+        }
+    }
+    cull.meshes(meshes);
+}
+
+static void loadCullObjs() {
+    std::vector<gpuLib::CullObj> objs(scene.objs().size());
+    for (size_t i = 0; i < objs.size(); i += 1) {
+        objs[i] = findCullObj((int)i);
+    }
+    cull.objs(objs);
+}
+
+static gpuLib::CullObj findCullObj(int index) {
+    Obj &obj = scene.objs()[index];
+    gpuLib::CullObj cullObj;
+    cullObj.world = obj.trans.world();
+
+    // Move the mesh's bounding sphere to world space once, here
+    glm::vec4 sphere = scene.spheres()[obj.mesh];
+    glm::vec3 scale = obj.trans.scale();
+    float maxScale = glm::max(scale[0], glm::max(scale[1], scale[2]));
+    glm::vec4 center = cullObj.world * glm::vec4(glm::vec3(sphere), 1.0f);
+    cullObj.sphere = glm::vec4(glm::vec3(center), sphere.w * maxScale);
+    cullObj.mesh = obj.mesh;
+    cullObj.lod = obj.lod;
+    cullObj.scale = maxScale;
+    cullObj.late = 0;
+    return cullObj;
+}
+
+static void showArenaStats() {
+    showArenaLine("vertex arena", *vertexArena);
+    showArenaLine("index arena", *indexArena);
+    fflush(stdout);
+}
+
+static void showArenaLine(char const *name, gpuLib::Arena &arena) {
+    gpuLib::AllocStats stats = arena.stats();
+    long elemSize = arena.elemSize();
+    printf("%s: %d allocs, ", name, stats.allocs);
+    printf("%ld/%ld B used ", stats.used * elemSize, stats.capacity * elemSize);
+    printf("(%.1f%%), ", stats.utilization * 100.0f);
+    printf("%d free ranges, ", stats.freeRanges);
+    printf("largest free %ld B, ", stats.largestFree * elemSize);
+    printf("fragmentation %.1f%%\n", stats.fragmentation * 100.0f);
+}
+
+static void showResStats() {
+    gpuLib::ResStats stats = gpuRes.stats();
+    printf("gl objects: ");
+    for (int i = 0; i < gpuLib::resTypeCount; i += 1) {
+        printf("%d %s", stats.live[i], gpuLib::resTypeNames[i]);
+        if (i == gpuLib::resBuffer or i == gpuLib::resTexture) {
+            printf(" (%ld B)", stats.bytes[i]);
+        }
+        printf(", ");
+    }
+    printf("%d pending (%ld B), ", stats.pending, stats.pendingBytes);
+    printf("%ld deleted\n", stats.deleted);
+    fflush(stdout);
+}
+
+static void loadFrameGraph() {
+    char const funcName[] = "loadFrameGraph";
+
+    int backBuffer = frameGraph.import("back buffer", 0, winWidth, winHeight);
+    scenePass = frameGraph.pass("scene", drawScene);
+    if (dynRes.active()) {
+        // The scene is drawn offscreen, at the scale, and upscaled
+        // clang-format off
+        int color = frameGraph.texture(
+            "scene color", gpuLib::GraphDesc{winWidth, winHeight, GL_RGBA8}
+        );
+        int depth = frameGraph.texture(
+            "scene depth",
+            gpuLib::GraphDesc{winWidth, winHeight, GL_DEPTH_COMPONENT24}
+        );
+        // clang-format on
+        frameGraph.write(scenePass, color);
+        frameGraph.write(scenePass, depth);
+        int upscalePass = frameGraph.pass("upscale", []() {
+            dynRes.blit(frameGraph.framebuffer(scenePass));
+        });
+        frameGraph.read(upscalePass, color);
+        frameGraph.write(upscalePass, backBuffer);
+    } else {
+        frameGraph.write(scenePass, backBuffer);
+    }
+    // The readback writes nothing in the graph, so it is kept explicitly;
+    // it reads the finished frame before the swap, without waiting
+    int capturePass = frameGraph.pass("capture", []() { capture.frame(); });
+    frameGraph.read(capturePass, backBuffer);
+    frameGraph.keep(capturePass);
+
+    if (!frameGraph.compile()) {
+        errShowLine(funcName, "error: compiling the frame graph");
+        exit(1);
+    }
+    gpuLib::GraphStats stats = frameGraph.stats();
+    printf("graph: %d passes ", stats.passes - stats.culled);
+    printf("(%d culled), ", stats.culled);
+    printf("%d transients in %d textures ", stats.transients, stats.textures);
+    printf("(%ld B)\n", stats.bytes);
+    fflush(stdout);
+}
+
+static void startCapture() {
+    char const funcName[] = "startCapture";
+
+    char const *path = capturePath != nullptr ? capturePath : "capture.y4m";
+    if (!capture.start(path, captureFps)) {
+        errShowLine(funcName, "error: cannot capture to %s", path);
+        return;
+    }
+    printf("capture: started, writing %s\n", path);
+    fflush(stdout);
+}
+
+static void stopCapture() {
+    if (!capture.active()) {
+        return;
+    }
+    capture.stop();
+    CaptureStats stats = capture.stats();
+    long captured = std::max(stats.captured, 1L);
+    long written = std::max(stats.written, 1L);
+    printf("capture: %ld frames written ", stats.written);
+    printf("to %s, ", capture.path().c_str());
+    printf("%ld dropped, %ld failed, ", stats.dropped, stats.failed);
+    printf("readback %.3f ms/frame, ", stats.totalReadMs / captured);
+    printf("encode %.3f ms/frame\n", stats.totalEncodeMs / written);
+    fflush(stdout);
 }
 
 static void loadShaderProgram() {
     char const funcName[] = "loadShaderProgram";
 
-    GLuint program = glCreateProgram();
-    if (program == 0) {
-        errShowLine(funcName, "error: creating shader program");
+    // The shaders built into the program; hot reloads read the disk later
+    shaderPre.embeds(shaderLib::embeds, shaderLib::embedCount);
+
+    // Expand the shader files; the indirect and gpu paths read their per-draw
+    // data from a shader storage buffer instead of uniforms
+    std::vector<shaderLib::Source> sources;
+    std::string error;
+    if (!readProgram(progDraw, sources, error)) {
+        errShowLine(funcName, "error: %s", error.c_str());
         exit(1);
     }
 
-    // Load shader texts
-    readShaderFile(vsFileName, vsText);
-    readShaderFile(fsFileName, fsText);
-    addShaderTextToProgram(program, GL_VERTEX_SHADER, vsText.c_str());
-    addShaderTextToProgram(program, GL_FRAGMENT_SHADER, fsText.c_str());
-
-    // Link and validate
-    GLint result = 0;
-    glLinkProgram(program);
-    glGetProgramiv(program, GL_LINK_STATUS, &result);
-    if (result == 0) {
-        errShowLine(funcName, "error: linking shader program");
-        errShowProgramLog(funcName, program);
+    // Compile and link (or find the program in the cache)
+    GLuint program = shaderCache.program(sources);
+    if (program == 0) {
+        errShowLine(funcName, "error: building shader program");
+        errShowLine(funcName, "info log: %s", shaderCache.log().c_str());
         exit(1);
     }
+    GLint result = 0;
     glValidateProgram(program);
     glGetProgramiv(program, GL_VALIDATE_STATUS, &result);
     if (result == 0) {
@@ -171,66 +1158,246 @@ static void loadShaderProgram() {
     }
 
     glUseProgram(program);
+    drawProgram = program;
 
-    // Bind shader variable "mapping"
-    mapping = glGetUniformLocation(program, "mapping");
-    if (mapping == 0xFFFFFFFF) {
-        errShowLine(funcName, "error: binding shader variable \"mapping\"");
+    // Check that the vertex format feeds every shader input
+    GLint unfedLoc = meshLib::QuantFmt::unfedLoc(program);
+    if (unfedLoc >= 0) {
+        errShowLine(funcName, "error: no vertex attribute at %d", unfedLoc);
         exit(1);
     }
-}
-
-static void readShaderFile(char const *name, std::string &content) {
-    char const funcName[] = "readShaderFile";
 
-    std::fstream file;
-    file.open(name, std::ios::in);
-    if (!file.is_open()) {
-        errShowLine(funcName, "error: reading file: %s", name);
-        exit(1);
+    if (drawPath != drawDirect) {
+        return;
     }
 
-    std::string line;
-    content = "";
-    while (getline(file, line)) {
-        line += "\n";
-        content += line;
+    // Bind shader variables
+    if (!bindDrawUniforms(program)) {
+        errShowLine(funcName, "error: binding shader variables");
+        exit(1);
     }
+    shaderLib::ReflectStats stats = drawReflect.stats();
+    printf("reflect: %d uniforms, ", stats.uniforms);
+    printf("%d inputs, %d blocks\n", stats.inputs, stats.blocks);
 }
 
 // clang-format off
-static void addShaderTextToProgram(
-    GLuint program, GLenum type, char const *text
+static bool readProgram(
+    int prog, std::vector<shaderLib::Source> &sources, std::string &error
 ) {
     // clang-format on
-    char const funcName[] = "addShaderTextToProgram";
+    // The variant's defines
+    shaderPre.clear();
+    if (prog == progCull) {
+        shaderPre.define("OCCLUSION", occlusion ? "1" : "0");
+    }
 
-    GLuint shader = glCreateShader(type);
-    if (shader == 0) {
-        errShowLine(funcName, "error: creating shader");
-        exit(1);
+    GLenum types[2];
+    char const *fileNames[2];
+    int stageCount = 1;
+    if (prog == progDraw) {
+        types[0] = GL_VERTEX_SHADER;
+        fileNames[0] = drawPath == drawDirect ? vsFileName : indirectVsFileName;
+        types[1] = GL_FRAGMENT_SHADER;
+        fileNames[1] = fsFileName;
+        stageCount = 2;
+    } else {
+        types[0] = GL_COMPUTE_SHADER;
+        fileNames[0] = prog == progCull ? csFileName : hizFileName;
     }
 
-    // Bind shader text
-    int const textCount = 1;
-    GLchar const *glTexts[textCount];
-    glTexts[0] = text;
-    GLint textLengths[textCount];
-    textLengths[0] = strlen(text);
-    glShaderSource(shader, textCount, glTexts, textLengths);
-
-    // Compile
-    glCompileShader(shader);
-    GLint compilationResult = 0;
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &compilationResult);
-    if (compilationResult == 0) {
-        errShowLine(funcName, "error: compiling shader");
-        errShowLine(funcName, "shader type: %d", type);
-        errShowShaderLog(funcName, shader);
+    sources.resize(stageCount);
+    std::vector<std::string> &files = progFiles[prog];
+    for (int i = 0; i < stageCount; i += 1) {
+        sources[i].type = types[i];
+        if (!shaderPre.expand(fileNames[i], sources[i].text)) {
+            error = shaderPre.error();
+            return false;
+        }
+        sources[i].hash = shaderPre.hash();
+        for (std::string const &file : shaderPre.files()) {
+            if (std::find(files.begin(), files.end(), file) == files.end()) {
+                files.push_back(file);
+            }
+        }
+    }
+    return true;
+}
+
+static void loadShaderWatch() {
+    if (!shaderWatch.ok()) {
+        printf("reload: inotify not available, shaders not watched\n");
+        fflush(stdout);
+        return;
+    }
+
+    watchProgram(progDraw);
+    if (drawPath == drawGpu) {
+        watchProgram(progCull);
+        watchProgram(progHiz);
+    }
+    // Edited files are on the disk, not in the program
+    shaderPre.disk(true);
+
+    bool parallel = shaderLib::buildParallel();
+    printf("reload: watching %zu shader files, ", watchFiles.size());
+    printf("parallel compile %s\n", parallel ? "on" : "off");
+    shaderLib::CacheStats stats = shaderCache.stats();
+    printf("shader cache: %d programs, ", stats.programs);
+    printf("%ld hits, %ld misses, ", stats.hits, stats.misses);
+    printf("compiled in %.1f ms\n", stats.compileMs);
+    fflush(stdout);
+}
+
+static void watchProgram(int prog) {
+    for (std::string const &file : progFiles[prog]) {
+        bool watched = false;
+        for (size_t i = 0; i < watchFiles.size(); i += 1) {
+            watched = watched or (watchFiles[i] == file and
+                                  watchPrograms[i] == prog);
+        }
+        if (!watched and shaderWatch.add(file.c_str()) >= 0) {
+            watchFiles.push_back(file);
+            watchPrograms.push_back(prog);
+        }
+    }
+}
+
+static void reloadShaders() {
+    static std::vector<int> changed;
+
+    changed.clear();
+    shaderWatch.poll(changed);
+    for (int id : changed) {
+        int prog = watchPrograms[id];
+        if (reloadBuilds[prog].active()) {
+            reloadAgain[prog] = true;
+        } else {
+            startReload(prog);
+        }
+    }
+
+    for (int prog = 0; prog < progCount; prog += 1) {
+        shaderLib::Build &build = reloadBuilds[prog];
+        if (build.active() and build.done()) {
+            char const *name = progNames[prog];
+            if (!build.ok()) {
+                printf("reload: %s program failed, ", name);
+                printf("keeping the old one\n%s", build.log().c_str());
+            } else if (swapReload(prog, build.take())) {
+                printf("reload: %s program swapped in, ", name);
+                printf("built in %.1f ms\n", build.ms());
+            }
+            fflush(stdout);
+        }
+        if (reloadAgain[prog] and !build.active()) {
+            reloadAgain[prog] = false;
+            startReload(prog);
+        }
+    }
+}
+
+static void startReload(int prog) {
+    std::string error;
+    if (!readProgram(prog, reloadSources[prog], error)) {
+        printf("reload: %s program failed, ", progNames[prog]);
+        printf("keeping the old one\n%s\n", error.c_str());
+        fflush(stdout);
+        return;
+    }
+    // Includes may have been added
+    watchProgram(prog);
+
+    // A variant built before (an undone edit) needs no build
+    GLuint cached = shaderCache.find(reloadSources[prog]);
+    if (cached != 0) {
+        if (swapReload(prog, cached)) {
+            printf("reload: %s program swapped in ", progNames[prog]);
+            printf("from the cache\n");
+            fflush(stdout);
+        }
+        return;
+    }
+
+    shaderLib::Build &build = reloadBuilds[prog];
+    build.start(gpuRes);
+    for (shaderLib::Source const &source : reloadSources[prog]) {
+        build.add(source.type, source.text);
+    }
+    build.link();
+}
+
+static bool swapReload(int prog, GLuint program) {
+    char const funcName[] = "swapReload";
+
+    GLuint oldProgram = program;
+    if (prog == progCull) {
+        oldProgram = cull.program(program);
+    } else if (prog == progHiz) {
+        oldProgram = hiz.program(program);
+    } else {
+        // The draw program must still fit the vertex format and the uniforms
+        GLint unfedLoc = meshLib::QuantFmt::unfedLoc(program);
+        bool direct = drawPath == drawDirect;
+        if (unfedLoc >= 0 or (direct and !bindDrawUniforms(program))) {
+            errShowLine(funcName, "error: program does not fit, keeping old");
+            shaderCache.drop(program);
+            return false;
+        }
+
+        glUseProgram(program);
+        oldProgram = drawProgram;
+        drawProgram = program;
+    }
+
+    // The old program goes; the new one serves its variant from now on
+    if (oldProgram != program) {
+        shaderCache.drop(oldProgram);
+    }
+    shaderCache.put(reloadSources[prog], program);
+    return true;
+}
+
+static void loadCullPrograms() {
+    cull.program(loadComputeProgram(progCull));
+    hiz.program(loadComputeProgram(progHiz));
+}
+
+static GLuint loadComputeProgram(int prog) {
+    char const funcName[] = "loadComputeProgram";
+
+    std::vector<shaderLib::Source> sources;
+    std::string error;
+    if (!readProgram(prog, sources, error)) {
+        errShowLine(funcName, "error: %s", error.c_str());
+        exit(1);
+    }
+    GLuint program = shaderCache.program(sources);
+    if (program == 0) {
+        errShowLine(funcName, "error: building shader program");
+        errShowLine(funcName, "info log: %s", shaderCache.log().c_str());
         exit(1);
     }
+    return program;
+}
 
-    glAttachShader(program, shader);
+static bool bindDrawUniforms(GLuint program) {
+    shaderLib::Reflect reflect;
+    if (!reflect.load(program)) {
+        return false;
+    }
+    auto newMapping = reflect.bind<glm::mat4>(mappingName);
+    auto newPosScale = reflect.bind<glm::vec3>(posScaleName);
+    auto newPosOffset = reflect.bind<glm::vec3>(posOffsetName);
+    if (!newMapping.ok() or !newPosScale.ok() or !newPosOffset.ok()) {
+        return false;
+    }
+
+    drawReflect = std::move(reflect);
+    mapping = newMapping;
+    posScale = newPosScale;
+    posOffset = newPosOffset;
+    return true;
 }
 
 static void errShowLine(char const *funcName, char const *format, ...) {
@@ -251,10 +1418,3 @@ static void errShowProgramLog(char const *funcName, GLuint program) {
     glGetProgramInfoLog(program, logLength, NULL, log);
     errShowLine(funcName, "info log: %s", log);
 }
-
-static void errShowShaderLog(char const *funcName, GLuint shader) {
-    int const logLength = 1023;
-    GLchar log[logLength + 1] = {0};
-    glGetShaderInfoLog(shader, logLength, NULL, log);
-    errShowLine(funcName, "info log: %s", log);
-}
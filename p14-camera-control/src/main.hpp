@@ -4,7 +4,79 @@
  * C++ header of a program that shows a tetrahedron with various colors (red,
  * green, blue, black) rotating around the Y axis. The tetrahedron is shown
  * using camera space. One can move the camera with the four arrow keys on the
- * keyboard.
+ * keyboard. The vertices are quantized at import and dequantized in the
+ * vertex shader. At load, the meshes' vertices are drawn as clipped points
+ * in the quantized layout and in the float32 layout of the same attributes,
+ * and the vertex fetch of each is timed with a timer query and shown in
+ * stdout.
+ * 
+ * Usage:
+ * ./main.x [--objs N] [--seed S] [--dist uniform|ball|clusters] [--extent E]
+ *          [--meshes tetra,sphere,grid] [--subdiv N] [--threads N]
+ *          [--draw direct|indirect|gpu] [--occlusion on|off]
+ *          [--cpu-occlusion on|off] [--collision on|off] [--frames N]
+ *          [--capture FILE.png|FILE.y4m] [--target-ms MS] [--min-scale S]
+ * Without --objs, the program shows the single rotating tetrahedron. With
+ * --objs, it shows a generated stress test scene of N objects.
+ * The objects outside the view frustum are culled on the CPU, with a BVH over
+ * their bounding boxes. The visible ones are drawn with one call per object
+ * (direct), or batched into one multi draw indirect call (indirect). With
+ * gpu, a compute shader culls the objects and compacts their draws instead,
+ * and the CPU only issues the dispatch and the draw. The default is the last
+ * path the GL context supports. On the gpu path, objects hidden behind others
+ * are also culled with a Hi-Z pyramid unless --occlusion is off. On the other
+ * paths, --cpu-occlusion on culls them on the CPU instead: the largest objects
+ * on screen are rasterized as occluders into a low resolution depth buffer,
+ * and the others are tested against it. The CPU submission time and the drawn
+ * triangles per frame are shown in stdout.
+ * The object under the cursor is picked every frame and shown in stdout when
+ * it changes; click an object to show the hit details and the picking time.
+ * The camera is a small sphere that collides with the objects' triangles and
+ * slides along them, unless --collision is off.
+ * The CPU records at most --frames N frames (1 to 3, 2 by default) ahead of
+ * the GPU; each frame waits for the fence of the frame N frames before it,
+ * and the indirect path's draw buffers are kept once per frame in flight.
+ * The time spent waiting is shown with the submission time.
+ * With --capture, the rendered frames are recorded from the start, as PNG
+ * files (FILE00000.png, ...) or one Y4M stream; press V to start or stop
+ * recording (to capture.y4m without --capture). Frames are read back through
+ * a ring of pixel buffers and encoded on a background thread, so recording
+ * does not stall the frames.
+ * The scene is rendered offscreen at a scale of the window size and upscaled
+ * to the window with a filtered blit. The scale (--min-scale S, 0.5 by
+ * default, to 1) follows the GPU time of the scene, measured with timer
+ * queries, to hold --target-ms MS (16.7 by default; 0 renders to the window
+ * directly); the levels of detail follow the scaled height. The scale and
+ * the GPU time are shown with the submission time.
+ * The frame is a render graph of passes (the scene, its upscale, and the
+ * capture) that declare the resources they read and write; the graph culls
+ * the unused passes, orders them, shares textures between transients whose
+ * lifetimes do not overlap, and binds each framebuffer once. Press G to dump
+ * the compiled graph.
+ * Each frame's transient data (the CPU paths' draw list, sorted by mesh so
+ * repeated meshes skip their uniform uploads) comes from a frame arena with
+ * one buffer per frame in flight, reset at the frame's start, as do the CPU
+ * occlusion pass's occluder picks. The heap allocations per frame are shown
+ * with the submission time; they settle to 0 once the arena's buffers have
+ * grown, except while a shader reload builds.
+ * The shader files may #include others (quant.glsl, draw.glsl), and the cull
+ * shader is built as the variant of the --occlusion setting; each variant is
+ * compiled once and kept in a program cache. The shader files are validated
+ * and embedded into the program at build time, so it starts from any
+ * directory. The shader files, includes and all, are watched while the
+ * program runs (from this directory). An edited shader is rebuilt in the
+ * background, and its program is swapped in once it links; until then, and
+ * if it fails, the old program keeps drawing. The direct path's uniforms are
+ * bound by reflecting the draw program, and unchanged values are not
+ * uploaded again; the uploads and skips are shown with the submit time.
+ * Press C to compact the GPU buffer arenas and show their statistics, and
+ * the live GL objects and bytes by type. The GL objects are deleted once the
+ * GPU is done with them, as fences show.
+ * Press S to render the frame with the software renderer as well, compare it
+ * with the GL frame (at the scene's dynamic resolution, before the upscale),
+ * and write both to gl.ppm and soft.ppm. The objects are
+ * the ones the direct and indirect paths draw, so the gpu path may differ
+ * where its occlusion culling hides objects.
  * 
  * References:
  * 1. ogldev.org/www/tutorial14/tutorial14.html
@@ -14,11 +86,16 @@
  * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
 
 // Include C++ libraries
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <vector>
 // Include C libraries
+#include <cstddef>
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <cmath>
 // Include GLEW before other GL libraries
@@ -32,45 +109,271 @@
 #include "persp.hpp"
 #include "cam.hpp"
 #include "cam/ctrl.hpp"
+#include "cam/collide.hpp"
 #include "pipeline.hpp"
+#include "pipeline/fixed.hpp"
+#include "mesh.hpp"
+#include "mesh/quant.hpp"
+#include "mesh/lod.hpp"
+#include "vfmt.hpp"
+#include "jobs.hpp"
+#include "scene.hpp"
+#include "scene/gen.hpp"
+#include "gpu/alloc.hpp"
+#include "gpu/arena.hpp"
+#include "gpu/res.hpp"
+#include "gpu/frames.hpp"
+#include "gpu/scale.hpp"
+#include "gpu/graph.hpp"
+#include "capture.hpp"
+#include "gpu/indirect.hpp"
+#include "gpu/cull.hpp"
+#include "gpu/hiz.hpp"
+#include "frustum.hpp"
+#include "frame.hpp"
+#include "draw.hpp"
+#include "occl.hpp"
+#include "soft.hpp"
+#include "bvh.hpp"
+#include "pick.hpp"
+#include "shader/watch.hpp"
+#include "shader/build.hpp"
+#include "shader/pre.hpp"
+#include "shader/cache.hpp"
+#include "shader/embed.hpp"
+#include "shader/reflect.hpp"
 
 // Define variables
 static char const winTitle[] = "Camera Control";
 static int const winWidth = 1024;
 static int const winHeight = 768;
 static Cam cam;
-static GLuint vertexBuffer;
-static GLuint indexBuffer;
+static Persp persp(winWidth, winHeight, 1.0f, 100.0f, 60.0f);
+static Scene scene;
+static sceneLib::Gen gen;
+static bool genScene = false;
+static int threadCount = 0;
+static Jobs *jobs = nullptr;
+static meshLib::LodSel lodSel;
+/* Owner of the GL objects (buffers, shaders, programs, vertex arrays,
+ * framebuffers, textures, and queries). */
+static gpuLib::Res gpuRes;
+static gpuLib::Frames frames(2);
+/* Arena of the frames' transient data. */
+static FrameArena frameArena(gpuLib::framesMaxDepth, 1 << 20);
+static Capture capture(gpuRes, winWidth, winHeight);
+/* Dynamic resolution of the scene (a 60 fps target). */
+static gpuLib::Scale dynRes(gpuRes, winWidth, winHeight, 16.7f);
+/* Render graph of a frame, and its scene pass. */
+static gpuLib::Graph frameGraph(gpuRes);
+static int scenePass = -1;
+/* View projection of the frame (for the graph's passes). */
+static glm::mat4 frameViewProj(1.0f);
+/* Capture path (nullptr without --capture), and the Y4M frame rate. */
+static char const *capturePath = nullptr;
+static int const captureFps = 60;
+static gpuLib::Arena *vertexArena = nullptr;
+static gpuLib::Arena *indexArena = nullptr;
+static std::vector<int> vertexAllocs;
+static std::vector<int> indexAllocs;
+static gpuLib::ResHandle vertexArray;
+static unsigned int vertexArrayGen = 0;
+static int const drawDirect = 0;
+static int const drawIndirect = 1;
+static int const drawGpu = 2;
+static char const *const drawNames[] = {"direct", "indirect", "gpu"};
+static int drawPath = drawGpu;
+static bool drawSet = false;
+static gpuLib::Indirect indirect(gpuRes);
+static gpuLib::Cull cull(gpuRes);
+static gpuLib::HiZ hiz(gpuRes, winWidth, winHeight);
+static bool occlusion = true;
+static glm::mat4 prevViewProj(1.0f);
+static Occl occl(winWidth / 4, winHeight / 4);
+static bool cpuOcclusion = false;
+static int const occluderMax = 64;
+static float const occluderMinPx = 64.0f;
+static std::vector<glm::vec4> occlSpheres;
+static std::vector<float> occlSizes;
+static std::vector<unsigned char> occlVisible;
+static Soft soft(winWidth, winHeight);
+static bool softCompare = false;
+static int const softTolerance = 2;
+static float const softMaxBad = 0.01f;
+static Bvh objBvh;
+static std::vector<BvhBox> objBoxes;
+static std::vector<int> objHits;
+static Pick pick;
+static camLib::Collider collider;
+static bool collision = true;
+/* Cursor position (unit: pixels, from the top left; -1 outside the window). */
+static int cursorX = -1;
+static int cursorY = -1;
+static int hoverObj = -1;
+static int const submitStatFrames = 120;
+static double submitMs = 0.0;
+static long submitVisible = 0;
+static long submitTris = 0;
+static double submitWaitMs = 0.0;
+static long submitHeapAllocs = 0;
+static int submitFrames = 0;
 static char const vsFileName[] = "./shader.vs";
-static std::string vsText;
+static char const indirectVsFileName[] = "./indirect.vs";
+static char const fetchVsFileName[] = "./fetch.vs";
+/* Timed draws of the vertices in each layout (see timeVertexFetch). */
+static int const fetchRepeats = 20;
 static char const fsFileName[] = "./shader.fs";
-static std::string fsText;
-static GLuint mapping;
+static char const csFileName[] = "./cull.cs";
+static char const hizFileName[] = "./hiz.cs";
+static GLuint drawProgram = 0;
+/* Shader programs (built from the shader files, and hot-reloaded). */
+static int const progDraw = 0;
+static int const progCull = 1;
+static int const progHiz = 2;
+static int const progCount = 3;
+static char const *const progNames[] = {"draw", "cull", "hiz"};
+static shaderLib::Pre shaderPre;
+static shaderLib::Cache shaderCache(gpuRes);
+/* Files each program is expanded from (with the included ones). */
+static std::vector<std::string> progFiles[progCount];
+static shaderLib::Watch shaderWatch;
+/* Watched files and their programs (by watch id). */
+static std::vector<std::string> watchFiles;
+static std::vector<int> watchPrograms;
+static shaderLib::Build reloadBuilds[progCount];
+/* Sources of the programs being rebuilt. */
+static std::vector<shaderLib::Source> reloadSources[progCount];
+/* Whether a program changed again while it was being built. */
+static bool reloadAgain[progCount] = {false, false, false};
+/* Reflection of the direct path's draw program, and its uniforms. */
+static shaderLib::Reflect drawReflect;
+static shaderLib::Uniform<glm::mat4> mapping;
+static shaderLib::Uniform<glm::vec3> posScale;
+static shaderLib::Uniform<glm::vec3> posOffset;
+/* Hashes of the uniforms' names. */
+static constexpr uint32_t mappingName = shaderLib::reflectHash("mapping");
+static constexpr uint32_t posScaleName = shaderLib::reflectHash("posScale");
+static constexpr uint32_t posOffsetName = shaderLib::reflectHash("posOffset");
 
 // Define functions
+/* Parses the command line options (after GLUT has taken its own). */
+static void parseArgs(int, char **);
+/* Shows the command line usage in stderr. */
+static void showUsage(char const *);
 /* Initializes the camera. */
 static void initCam();
 /* Loads the GLUT function callbacks. */
 static void loadGLUTFuncs();
 /* Displays the objects to be rendered. */
 static void display();
+/* Draws the scene objects (the frame graph's scene pass). */
+static void drawScene();
+/* Culls a scene object against the view frustum and selects its level of
+ * detail; finds its world matrix and returns whether it is visible. */
+static bool selectObj(Obj &, Frustum &, glm::mat4 &);
+/* Draws a scene object (direct path). */
+static void drawObj(Obj &, glm::mat4 const &);
+/* Adds a scene object to the indirect batch (indirect path). */
+static void addObjDraw(Obj &, glm::mat4 const &);
+/* Culls the hidden scene objects on the CPU; finds occlVisible. */
+static void occludeObjs(glm::mat4 const &, Frustum &);
+/* Renders the objects drawn by the CPU paths with the software renderer at
+ * the scene's size, compares the result with the GL scene before its
+ * upscale, and shows the difference in stdout; writes both frames to gl.ppm
+ * and soft.ppm. */
+static void compareSoft(glm::mat4 const &, Frustum &);
+/* Draws the scene objects with GPU culling (gpu path). */
+static void drawCulled(glm::mat4 const &);
+/* Shows the average CPU submission time in stdout every few frames. */
+static void showSubmitStats(double, int, long);
 /* Reacts to key inputs. */
 static void onKey(int, int, int);
+/* Reacts to mouse button inputs. */
+static void onMouse(int, int, int, int);
+/* Reacts to cursor movements. */
+static void onMotion(int, int);
+/* Reacts to the cursor entering or leaving the window. */
+static void onEntry(int);
+/* Finishes the capture when the window closes. */
+static void onClose();
+/* Picks the scene object under a screen position; finds the picking time
+ * (unit: microseconds). */
+static PickHit pickObj(glm::mat4 const &, int, int, double &);
+/* Reacts to character key inputs. */
+static void onChar(unsigned char, int, int);
 /* Initializes GLEW. */
 static void initGLEW();
-/* Loads the vertex buffer. */
+/* Loads the scene, quantizes its meshes' vertices, and generates their levels
+ * of detail. */
+static void loadScene();
+/* Finds the world space boxes of the scene objects (from their bounding
+ * spheres) into objBoxes. */
+static void findObjBoxes();
+/* Builds the BVH over the scene objects, and the scene's mesh BVHs (for
+ * picking and collision). */
+static void loadObjBvh();
+/* Attaches the camera's collider to the scene's mesh BVHs and the objects'
+ * BVH. */
+static void loadCollider();
+/* Shows the vertex format's memory usage in stdout. */
+static void showVertexFormatStats();
+/* Times the vertex fetch of the meshes' vertices in the quantized and the
+ * float32 layouts (the same attributes), and shows the times in stdout. */
+static void timeVertexFetch();
+/* Loads the meshes' vertices into the vertex arena. */
 static void loadVertexBuffer();
-/* Loads the index buffer */
+/* Loads the meshes' indices into the index arena. */
 static void loadIndexBuffer();
-/* Loads the shader program. */
+/* Loads the vertex array that reads the arenas; reloads it whenever an arena
+ * moves to a new buffer. */
+static void loadVertexArray();
+/* Loads the meshes' levels of detail and arena ranges for GPU culling;
+ * reloads them whenever the arenas are compacted. */
+static void loadCullMeshes();
+/* Loads the objects for GPU culling. */
+static void loadCullObjs();
+/* Finds an object's GPU culling record. */
+static gpuLib::CullObj findCullObj(int);
+/* Shows the GPU buffer arenas' statistics in stdout. */
+static void showArenaStats();
+/* Shows the statistics of a GPU buffer arena in stdout. */
+static void showArenaLine(char const *, gpuLib::Arena &);
+/* Shows the live GL objects and their bytes by type in stdout. */
+static void showResStats();
+/* Loads the frame graph, and shows its statistics in stdout. */
+static void loadFrameGraph();
+/* Starts capturing the rendered frames. */
+static void startCapture();
+/* Stops capturing, and shows the capture statistics in stdout. */
+static void stopCapture();
+/* Loads the shader program of the draw path. */
 static void loadShaderProgram();
-/* Reads from the specified shader file to a specified string. */
-static void readShaderFile(char const *, std::string &);
-/* Adds a shader text to a shader program */
-static void addShaderTextToProgram(GLuint, GLenum, char const *);
+/* Expands the shader files of a program into its sources, with the defines
+ * of its variant; finds the error on failure and returns false. */
+static bool readProgram(int, std::vector<shaderLib::Source> &, std::string &);
+/* Watches the shader files of the loaded programs, and turns on parallel
+ * shader compilation if it is supported; shows the shader cache's
+ * statistics in stdout. */
+static void loadShaderWatch();
+/* Watches the files of a program that are not watched yet. */
+static void watchProgram(int);
+/* Starts rebuilding the programs whose shader files changed, and swaps in the
+ * finished ones that linked (once per frame, without waiting). */
+static void reloadShaders();
+/* Starts rebuilding a program from its shader files. */
+static void startReload(int);
+/* Swaps a rebuilt program in for the old one unless it does not fit the
+ * vertex format or uniforms; returns whether it was swapped in. */
+static bool swapReload(int, GLuint);
+/* Loads the GPU culling and Hi-Z compute shader programs. */
+static void loadCullPrograms();
+/* Loads a compute shader program. */
+static GLuint loadComputeProgram(int);
+/* Reflects the direct path's draw program and binds its uniforms; returns
+ * false, keeping the old ones, if they are not all active with their
+ * types. */
+static bool bindDrawUniforms(GLuint);
 /* Shows an error information line in stderr. */
 static void errShowLine(char const *, char const *, ...);
 /* Gets and shows the GL shader program info log in stderr. */
 static void errShowProgramLog(char const *, GLuint);
-/* Gets and shows the GL shader info log in stderr. */
-static void errShowShaderLog(char const *, GLuint);
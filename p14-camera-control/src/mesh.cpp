@@ -0,0 +1,98 @@
+/* File name: mesh.cpp
+ *
+ * Intro:
+ * C++ implementation of the mesh custom library. */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#include "mesh.hpp"
+
+Mesh::Mesh() {
+}
+
+std::vector<glm::vec3> &Mesh::positions() {
+    return _positions;
+}
+
+std::vector<glm::vec3> &Mesh::normals() {
+    return _normals;
+}
+
+std::vector<glm::vec4> &Mesh::colors() {
+    return _colors;
+}
+
+std::vector<unsigned int> &Mesh::indices() {
+    return _indices;
+}
+
+int Mesh::vertexCount() {
+    return (int)_positions.size();
+}
+
+int Mesh::indexCount() {
+    return (int)_indices.size();
+}
+
+void Mesh::genNormals() {
+    _normals.assign(_positions.size(), glm::vec3(0.0f, 0.0f, 0.0f));
+
+    // Accumulate the area-weighted face normals on each corner
+    for (size_t i = 0; i + 2 < _indices.size(); i += 3) {
+        unsigned int a = _indices[i];
+        unsigned int b = _indices[i + 1];
+        unsigned int c = _indices[i + 2];
+        glm::vec3 ab = _positions[b] - _positions[a];
+        glm::vec3 ac = _positions[c] - _positions[a];
+        glm::vec3 faceNormal = glm::cross(ab, ac);
+        _normals[a] += faceNormal;
+        _normals[b] += faceNormal;
+        _normals[c] += faceNormal;
+    }
+
+    for (glm::vec3 &normal : _normals) {
+        float len = glm::length(normal);
+        if (len > 0.0f) {
+            normal /= len;
+        } else {
+            normal = glm::vec3(0.0f, 1.0f, 0.0f);
+        }
+    }
+}
+
+void Mesh::genColors() {
+    _colors.resize(_positions.size());
+    for (size_t i = 0; i < _positions.size(); i += 1) {
+        glm::vec3 rgb = glm::clamp(_positions[i], 0.0f, 1.0f);
+        _colors[i] = glm::vec4(rgb, 1.0f);
+    }
+}
+
+void Mesh::bounds(glm::vec3 &lo, glm::vec3 &hi) {
+    if (_positions.empty()) {
+        lo = glm::vec3(0.0f, 0.0f, 0.0f);
+        hi = glm::vec3(0.0f, 0.0f, 0.0f);
+        return;
+    }
+
+    lo = _positions[0];
+    hi = _positions[0];
+    for (glm::vec3 const &position : _positions) {
+        lo = glm::min(lo, position);
+        hi = glm::max(hi, position);
+    }
+}
+
+glm::vec4 Mesh::sphere() {
+    glm::vec3 lo;
+    glm::vec3 hi;
+    bounds(lo, hi);
+    glm::vec3 center = (lo + hi) * 0.5f;
+
+    float radius = 0.0f;
+    for (glm::vec3 const &position : _positions) {
+        radius = glm::max(radius, glm::distance(position, center));
+    }
+    return glm::vec4(center, radius);
+}
@@ -0,0 +1,63 @@
+/* File name: mesh.hpp
+ *
+ * Intro:
+ * C++ header of the mesh custom library.
+ * 
+ * Dependencies:
+ * 1. GLM library (libglm-dev)
+ * 2. All modules of the mesh library (mesh/*.hpp) */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#ifndef MESH_HPP
+#define MESH_HPP
+
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/ext.hpp>
+
+/* Mesh. */
+class Mesh {
+   private:
+    /* Vertex positions. */
+    std::vector<glm::vec3> _positions;
+    /* Vertex normals. */
+    std::vector<glm::vec3> _normals;
+    /* Vertex colors. */
+    std::vector<glm::vec4> _colors;
+    /* Triangle indices (3 per triangle). */
+    std::vector<unsigned int> _indices;
+
+   public:
+    /* Initializes an empty mesh. */
+    Mesh();
+    /* Reads the vertex positions' reference. */
+    std::vector<glm::vec3> &positions();
+    /* Reads the vertex normals' reference. */
+    std::vector<glm::vec3> &normals();
+    /* Reads the vertex colors' reference. */
+    std::vector<glm::vec4> &colors();
+    /* Reads the triangle indices' reference. */
+    std::vector<unsigned int> &indices();
+    /* Reads the vertex count. */
+    int vertexCount();
+    /* Reads the index count. */
+    int indexCount();
+    /* Finds the vertex normals by averaging the adjacent face normals. */
+    void genNormals();
+    /* Finds the vertex colors from the positions.
+     * Note:
+     * The colors follow the rule that shader.vs used to apply on the fly,
+     * which is the position clamped to [0, 1] with an alpha of 1. */
+    void genColors();
+    /* Finds the axis-aligned bounding box of the positions. */
+    void bounds(glm::vec3 &lo, glm::vec3 &hi);
+    /* Finds a bounding sphere of the positions, centered at the bounding box
+     * center (xyz: center; w: radius). */
+    glm::vec4 sphere();
+};
+
+// MESH_HPP
+#endif
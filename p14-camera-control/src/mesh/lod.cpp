@@ -0,0 +1,427 @@
+/* File name: lod.cpp
+ *
+ * Intro:
+ * C++ implementation of the mesh libraries' lod (Level of detail) module. */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#include "lod.hpp"
+#include "../mesh.hpp"
+#include "../persp.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <queue>
+#include <unordered_map>
+
+namespace meshLib {
+
+// Implement simplification helpers
+
+/* Symmetric 4x4 quadric, stored as its upper triangle. */
+struct Quadric {
+    double q[10] = {0};
+
+    /* Adds the quadric of the plane n . x + d = 0, scaled by w. */
+    void addPlane(glm::dvec3 n, double d, double w) {
+        double a = n.x, b = n.y, c = n.z;
+        q[0] += w * a * a;
+        q[1] += w * a * b;
+        q[2] += w * a * c;
+        q[3] += w * a * d;
+        q[4] += w * b * b;
+        q[5] += w * b * c;
+        q[6] += w * b * d;
+        q[7] += w * c * c;
+        q[8] += w * c * d;
+        q[9] += w * d * d;
+    }
+
+    void add(Quadric const &o) {
+        for (int i = 0; i < 10; i += 1) {
+            q[i] += o.q[i];
+        }
+    }
+
+    /* Finds the quadric error of the point p. */
+    double err(glm::dvec3 p) const {
+        double x = p.x, y = p.y, z = p.z;
+        // clang-format off
+        return q[0] * x * x + 2 * q[1] * x * y + 2 * q[2] * x * z + 2 * q[3] * x
+             + q[4] * y * y + 2 * q[5] * y * z + 2 * q[6] * y
+             + q[7] * z * z + 2 * q[8] * z
+             + q[9];
+        // clang-format on
+    }
+};
+
+/* Edge collapse candidate (u moves onto v). */
+struct Collapse {
+    double cost;
+    unsigned int u;
+    unsigned int v;
+    unsigned int verU;
+    unsigned int verV;
+
+    bool operator>(Collapse const &o) const {
+        return cost > o.cost;
+    }
+};
+
+/* Progressive QEM simplifier that keeps the original vertices. */
+class Simplifier {
+   private:
+    std::vector<glm::dvec3> _pos;
+    std::vector<unsigned int> _tris;
+    std::vector<bool> _triAlive;
+    std::vector<std::vector<unsigned int>> _vertTris;
+    std::vector<Quadric> _quadrics;
+    std::vector<unsigned int> _versions;
+    std::vector<bool> _vertAlive;
+    // clang-format off
+    std::priority_queue<
+        Collapse, std::vector<Collapse>, std::greater<Collapse>
+    > _heap;
+    // clang-format on
+    int _aliveTris;
+    double _maxCost;
+
+    glm::dvec3 _triNormal(unsigned int t, unsigned int moved, glm::dvec3 to) {
+        glm::dvec3 p[3];
+        for (int i = 0; i < 3; i += 1) {
+            unsigned int v = _tris[t * 3 + i];
+            p[i] = v == moved ? to : _pos[v];
+        }
+        return glm::cross(p[1] - p[0], p[2] - p[0]);
+    }
+
+    /* Collects the live neighbors of v. */
+    void _neighbors(unsigned int v, std::vector<unsigned int> &result) {
+        result.clear();
+        for (unsigned int t : _vertTris[v]) {
+            if (!_triAlive[t]) {
+                continue;
+            }
+            for (int i = 0; i < 3; i += 1) {
+                unsigned int w = _tris[t * 3 + i];
+                auto found = std::find(result.begin(), result.end(), w);
+                if (w != v and found == result.end()) {
+                    result.push_back(w);
+                }
+            }
+        }
+    }
+
+    void _push(unsigned int u, unsigned int v) {
+        Quadric q = _quadrics[u];
+        q.add(_quadrics[v]);
+        double costUV = q.err(_pos[v]);
+        double costVU = q.err(_pos[u]);
+        Collapse c;
+        if (costUV <= costVU) {
+            c = {costUV, u, v, _versions[u], _versions[v]};
+        } else {
+            c = {costVU, v, u, _versions[v], _versions[u]};
+        }
+        _heap.push(c);
+    }
+
+    /* Finds whether collapsing u onto v keeps the mesh manifold and does not
+     * flip any triangle. */
+    bool _valid(unsigned int u, unsigned int v) {
+        std::vector<unsigned int> nu;
+        std::vector<unsigned int> nv;
+        _neighbors(u, nu);
+        _neighbors(v, nv);
+        int shared = 0;
+        for (unsigned int w : nu) {
+            if (std::find(nv.begin(), nv.end(), w) != nv.end()) {
+                shared += 1;
+            }
+        }
+        if (shared > 2) {
+            return false;
+        }
+
+        for (unsigned int t : _vertTris[u]) {
+            if (!_triAlive[t]) {
+                continue;
+            }
+            unsigned int *tri = &_tris[t * 3];
+            if (tri[0] == v or tri[1] == v or tri[2] == v) {
+                continue;
+            }
+            glm::dvec3 before = _triNormal(t, u, _pos[u]);
+            glm::dvec3 after = _triNormal(t, u, _pos[v]);
+            if (glm::dot(before, after) <= 0.0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void _collapse(unsigned int u, unsigned int v) {
+        for (unsigned int t : _vertTris[u]) {
+            if (!_triAlive[t]) {
+                continue;
+            }
+            unsigned int *tri = &_tris[t * 3];
+            if (tri[0] == v or tri[1] == v or tri[2] == v) {
+                _triAlive[t] = false;
+                _aliveTris -= 1;
+                continue;
+            }
+            for (int i = 0; i < 3; i += 1) {
+                if (tri[i] == u) {
+                    tri[i] = v;
+                }
+            }
+            _vertTris[v].push_back(t);
+        }
+        _vertTris[u].clear();
+        _vertAlive[u] = false;
+        _quadrics[v].add(_quadrics[u]);
+        _versions[v] += 1;
+
+        // Re-queue the edges around the merged vertex
+        std::vector<unsigned int> nv;
+        _neighbors(v, nv);
+        for (unsigned int w : nv) {
+            _push(v, w);
+        }
+    }
+
+   public:
+    Simplifier(Mesh &mesh) {
+        std::vector<glm::vec3> &positions = mesh.positions();
+        size_t n = positions.size();
+        _pos.resize(n);
+        for (size_t i = 0; i < n; i += 1) {
+            _pos[i] = glm::dvec3(positions[i]);
+        }
+        _tris = mesh.indices();
+        size_t triCount = _tris.size() / 3;
+        _tris.resize(triCount * 3);
+        _triAlive.assign(triCount, true);
+        _vertTris.resize(n);
+        _quadrics.resize(n);
+        _versions.assign(n, 0);
+        _vertAlive.assign(n, true);
+        _aliveTris = (int)triCount;
+        _maxCost = 0.0;
+
+        // Face planes
+        std::unordered_map<uint64_t, int> edgeUses;
+        for (size_t t = 0; t < triCount; t += 1) {
+            unsigned int *tri = &_tris[t * 3];
+            glm::dvec3 n3 = _triNormal(t, tri[0], _pos[tri[0]]);
+            double len = glm::length(n3);
+            if (len > 0.0) {
+                n3 /= len;
+                double d = -glm::dot(n3, _pos[tri[0]]);
+                for (int i = 0; i < 3; i += 1) {
+                    _quadrics[tri[i]].addPlane(n3, d, 1.0);
+                }
+            }
+            for (int i = 0; i < 3; i += 1) {
+                _vertTris[tri[i]].push_back(t);
+                unsigned int a = std::min(tri[i], tri[(i + 1) % 3]);
+                unsigned int b = std::max(tri[i], tri[(i + 1) % 3]);
+                edgeUses[((uint64_t)a << 32) | b] += 1;
+            }
+        }
+
+        // Boundary planes (perpendicular to the face through the edge) keep
+        // open borders from shrinking
+        double const boundaryWeight = 10.0;
+        for (size_t t = 0; t < triCount; t += 1) {
+            unsigned int *tri = &_tris[t * 3];
+            glm::dvec3 faceN = _triNormal(t, tri[0], _pos[tri[0]]);
+            for (int i = 0; i < 3; i += 1) {
+                unsigned int a = tri[i];
+                unsigned int b = tri[(i + 1) % 3];
+                uint64_t key = ((uint64_t)std::min(a, b) << 32);
+                key |= std::max(a, b);
+                if (edgeUses[key] != 1) {
+                    continue;
+                }
+                glm::dvec3 n3 = glm::cross(_pos[b] - _pos[a], faceN);
+                double len = glm::length(n3);
+                if (len <= 0.0) {
+                    continue;
+                }
+                n3 /= len;
+                double d = -glm::dot(n3, _pos[a]);
+                _quadrics[a].addPlane(n3, d, boundaryWeight);
+                _quadrics[b].addPlane(n3, d, boundaryWeight);
+            }
+        }
+
+        for (auto const &use : edgeUses) {
+            _push((unsigned int)(use.first >> 32), (unsigned int)use.first);
+        }
+    }
+
+    int aliveTris() {
+        return _aliveTris;
+    }
+
+    /* Finds the geometric error so far (unit: object space lengths). */
+    float err() {
+        return (float)std::sqrt(_maxCost);
+    }
+
+    /* Collapses edges until at most target triangles are left. */
+    void simplify(int target) {
+        while (_aliveTris > target and !_heap.empty()) {
+            Collapse c = _heap.top();
+            _heap.pop();
+            if (!_vertAlive[c.u] or !_vertAlive[c.v]) {
+                continue;
+            }
+            if (_versions[c.u] != c.verU or _versions[c.v] != c.verV) {
+                continue;
+            }
+            if (!_valid(c.u, c.v)) {
+                continue;
+            }
+            _collapse(c.u, c.v);
+            _maxCost = std::max(_maxCost, c.cost);
+        }
+    }
+
+    /* Appends the live triangles' indices. */
+    void snapshot(std::vector<unsigned int> &result) {
+        for (size_t t = 0; t < _triAlive.size(); t += 1) {
+            if (_triAlive[t]) {
+                result.insert(result.end(), &_tris[t * 3], &_tris[t * 3] + 3);
+            }
+        }
+    }
+};
+
+Lod::Lod() {
+}
+
+void Lod::gen(Mesh &mesh, int maxLevels, float ratio, int minTris) {
+    _indices.clear();
+    _firsts.clear();
+    _counts.clear();
+    _errs.clear();
+
+    // Level 0 is the mesh itself
+    _firsts.push_back(0);
+    _counts.push_back(mesh.indexCount());
+    _errs.push_back(0.0f);
+    _indices = mesh.indices();
+
+    Simplifier simplifier(mesh);
+    while ((int)_counts.size() < maxLevels) {
+        int tris = simplifier.aliveTris();
+        int target = std::max(minTris, (int)(tris * ratio));
+        if (target >= tris) {
+            break;
+        }
+        simplifier.simplify(target);
+        // Stop once the collapses stall (too few triangles removed)
+        if (simplifier.aliveTris() > tris - (tris - target) / 4) {
+            break;
+        }
+        _firsts.push_back((int)_indices.size());
+        simplifier.snapshot(_indices);
+        _counts.push_back((int)_indices.size() - _firsts.back());
+        _errs.push_back(simplifier.err());
+    }
+}
+
+int Lod::levelCount() {
+    return (int)_counts.size();
+}
+
+std::vector<unsigned int> &Lod::indices() {
+    return _indices;
+}
+
+int Lod::first(int level) {
+    return _firsts[level];
+}
+
+int Lod::count(int level) {
+    return _counts[level];
+}
+
+float Lod::err(int level) {
+    return _errs[level];
+}
+
+LodSel::LodSel() {
+    _maxErrPx = 1.0f;
+    _hyst = 0.25f;
+    _pxPerUnit = 1.0f;
+}
+
+float LodSel::maxErrPx() {
+    return _maxErrPx;
+}
+
+float LodSel::maxErrPx(float newVal) {
+    float oldVal = _maxErrPx;
+    _maxErrPx = newVal;
+    return oldVal;
+}
+
+float LodSel::hyst() {
+    return _hyst;
+}
+
+float LodSel::hyst(float newVal) {
+    float oldVal = _hyst;
+    _hyst = newVal;
+    return oldVal;
+}
+
+float LodSel::pxPerUnit() {
+    return _pxPerUnit;
+}
+
+void LodSel::view(Persp &persp, int viewportHeight) {
+    // A length l at distance d spans l / d * (h / 2) / tan(fov / 2) pixels
+    float halfFov = glm::radians(persp.fov()) * 0.5f;
+    _pxPerUnit = (float)viewportHeight * 0.5f / std::tan(halfFov);
+}
+
+float LodSel::errPx(Lod &lod, int level, float scale, float dist) {
+    // Inside the near range, any error is fully visible
+    float d = std::max(dist, 1e-3f);
+    return lod.err(level) * scale / d * _pxPerUnit;
+}
+
+int LodSel::select(Lod &lod, int current, float scale, float dist) {
+    int levels = lod.levelCount();
+    current = std::min(std::max(current, 0), levels - 1);
+
+    // Refine as soon as the current level's error shows
+    if (errPx(lod, current, scale, dist) > _maxErrPx) {
+        int result = current;
+        while (result > 0 and errPx(lod, result, scale, dist) > _maxErrPx) {
+            result -= 1;
+        }
+        return result;
+    }
+
+    // Coarsen only with a margin below the threshold
+    float coarsenPx = _maxErrPx * (1.0f - _hyst);
+    int result = current;
+    for (int level = current + 1; level < levels; level += 1) {
+        if (errPx(lod, level, scale, dist) <= coarsenPx) {
+            result = level;
+        } else {
+            break;
+        }
+    }
+    return result;
+}
+
+}  // namespace meshLib
@@ -0,0 +1,111 @@
+/* File name: lod.hpp
+ *
+ * Intro:
+ * C++ header of the mesh libraries' lod (Level of detail) module.
+ * The levels are found offline with quadric error metric (QEM) edge collapses
+ * that keep the mesh's vertices, so all levels share one vertex buffer and
+ * differ only in their indices. At runtime, a level is selected per object from
+ * its projected screen-space error.
+ *
+ * References:
+ * 1. M. Garland and P. S. Heckbert, "Surface simplification using quadric
+ *    error metrics," in Proc. SIGGRAPH, 1997, pp. 209-216.
+ *
+ * Dependencies:
+ * 1. GLM library (libglm-dev)
+ * 2. The mesh libraries' main module (../mesh.hpp)
+ * 3. The perspective custom library (../persp.hpp) */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#ifndef MESH__LOD_HPP
+#define MESH__LOD_HPP
+
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/ext.hpp>
+
+// Forward declare Mesh (from ../mesh.hpp) and Persp (from ../persp.hpp)
+class Mesh;
+class Persp;
+// Include ../mesh.hpp and ../persp.hpp in mesh/lod.cpp to complete the
+// declarations above
+
+/* Mesh library */
+namespace meshLib {
+
+/* Level of detail chain. */
+class Lod {
+   private:
+    /* Indices of all levels, concatenated from the finest to the coarsest. */
+    std::vector<unsigned int> _indices;
+    /* First index of each level. */
+    std::vector<int> _firsts;
+    /* Index count of each level. */
+    std::vector<int> _counts;
+    /* Geometric error of each level (unit: object space lengths). */
+    std::vector<float> _errs;
+
+   public:
+    /* Constructs an empty chain. */
+    Lod();
+    /* Generates the chain of the specified mesh.
+     * Level 0 is the mesh itself. Each next level keeps about ratio of the
+     * previous level's triangles. The chain stops at maxLevels levels, at
+     * minTris triangles, or when the simplification stalls. */
+    void gen(Mesh &mesh, int maxLevels, float ratio, int minTris);
+    /* Reads the level count. */
+    int levelCount();
+    /* Reads the indices' (of all levels) reference. */
+    std::vector<unsigned int> &indices();
+    /* Reads the first index of a level. */
+    int first(int level);
+    /* Reads the index count of a level. */
+    int count(int level);
+    /* Reads the geometric error of a level (unit: object space lengths). */
+    float err(int level);
+};
+
+/* Level of detail selection. */
+class LodSel {
+   private:
+    /* Largest allowed screen-space error (unit: pixels). */
+    float _maxErrPx;
+    /* Hysteresis, as a fraction of the largest allowed error. */
+    float _hyst;
+    /* Pixels per unit length at distance 1 (found from the perspective). */
+    float _pxPerUnit;
+
+   public:
+    /* Constructs a default selection.
+     * maxErrPx: 1; hyst: 0.25; pxPerUnit: 1. */
+    LodSel();
+    /* Reads the largest allowed screen-space error (unit: pixels). */
+    float maxErrPx();
+    /* Reads and updates the largest allowed screen-space error. */
+    float maxErrPx(float newVal);
+    /* Reads the hysteresis. */
+    float hyst();
+    /* Reads and updates the hysteresis. */
+    float hyst(float newVal);
+    /* Reads the pixels per unit length at distance 1. */
+    float pxPerUnit();
+    /* Updates the pixels per unit length from the perspective's field of view
+     * and the viewport height (unit: pixels). */
+    void view(Persp &persp, int viewportHeight);
+    /* Finds the projected error of a level (unit: pixels).
+     * scale: the object's largest scale; dist: the distance to the camera. */
+    float errPx(Lod &lod, int level, float scale, float dist);
+    /* Selects the level of an object that currently uses the level current.
+     * Note:
+     * Coarser levels are only taken once their error is below
+     * (1 - hyst) * maxErrPx, so objects near a threshold do not flicker. */
+    int select(Lod &lod, int current, float scale, float dist);
+};
+
+}  // namespace meshLib
+
+// MESH__LOD_HPP
+#endif
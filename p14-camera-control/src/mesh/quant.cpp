@@ -0,0 +1,137 @@
+/* File name: quant.cpp
+ * 
+ * Intro:
+ * C++ implementation of the mesh libraries' quant (Quantization) module. */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#include "quant.hpp"
+#include "../mesh.hpp"
+
+#include <cmath>
+
+namespace meshLib {
+
+Quant::Quant() {
+    _scale = glm::vec3(1.0f, 1.0f, 1.0f);
+    _offset = glm::vec3(0.0f, 0.0f, 0.0f);
+    _posErr = 0.0f;
+}
+
+void Quant::quantize(Mesh &mesh) {
+    if ((int)mesh.normals().size() != mesh.vertexCount()) {
+        mesh.genNormals();
+    }
+    if ((int)mesh.colors().size() != mesh.vertexCount()) {
+        mesh.genColors();
+    }
+
+    glm::vec3 lo;
+    glm::vec3 hi;
+    mesh.bounds(lo, hi);
+    _offset = lo;
+    _scale = hi - lo;
+    // Keep flat axes invertible
+    for (int i = 0; i < 3; i += 1) {
+        if (_scale[i] <= 0.0f) {
+            _scale[i] = 1.0f;
+        }
+    }
+
+    std::vector<glm::vec3> &positions = mesh.positions();
+    std::vector<glm::vec3> &normals = mesh.normals();
+    std::vector<glm::vec4> &colors = mesh.colors();
+    _vertices.resize(positions.size());
+    _posErr = 0.0f;
+
+    for (size_t i = 0; i < positions.size(); i += 1) {
+        QuantVertex &v = _vertices[i];
+        glm::vec3 unit = (positions[i] - _offset) / _scale;
+        for (int j = 0; j < 3; j += 1) {
+            v.pos[j] = packUnorm16(unit[j]);
+        }
+        v.pos[3] = 0;
+        v.normal = packSnorm1010102(normals[i]);
+        for (int j = 0; j < 4; j += 1) {
+            v.color[j] = packUnorm8(colors[i][j]);
+        }
+
+        // Track the round trip error
+        for (int j = 0; j < 3; j += 1) {
+            float back = (v.pos[j] / 65535.0f) * _scale[j] + _offset[j];
+            float err = std::fabs(back - positions[i][j]);
+            if (err > _posErr) {
+                _posErr = err;
+            }
+        }
+    }
+}
+
+glm::vec3 Quant::scale() {
+    return _scale;
+}
+
+glm::vec3 Quant::offset() {
+    return _offset;
+}
+
+std::vector<QuantVertex> &Quant::vertices() {
+    return _vertices;
+}
+
+float Quant::posErr() {
+    return _posErr;
+}
+
+int Quant::baseStride() {
+    return 3 * sizeof(float);
+}
+
+int Quant::floatStride() {
+    return FloatFmt::stride;
+}
+
+int Quant::quantStride() {
+    return QuantFmt::stride;
+}
+
+void appendFloatVertices(Mesh &mesh, std::vector<FloatVertex> &vertices) {
+    std::vector<glm::vec3> &positions = mesh.positions();
+    std::vector<glm::vec3> &normals = mesh.normals();
+    std::vector<glm::vec4> &colors = mesh.colors();
+    for (int i = 0; i < mesh.vertexCount(); i += 1) {
+        FloatVertex vertex;
+        for (int j = 0; j < 3; j += 1) {
+            vertex.pos[j] = positions[i][j];
+            vertex.normal[j] = normals[i][j];
+        }
+        for (int j = 0; j < 4; j += 1) {
+            vertex.color[j] = colors[i][j];
+        }
+        vertices.push_back(vertex);
+    }
+}
+
+uint32_t packSnorm1010102(glm::vec3 v) {
+    uint32_t result = 0;
+    for (int i = 0; i < 3; i += 1) {
+        float c = glm::clamp(v[i], -1.0f, 1.0f);
+        int32_t q = (int32_t)std::lround(c * 511.0f);
+        result |= ((uint32_t)q & 0x3FFu) << (10 * i);
+    }
+    // The 2-bit W component stays 0
+    return result;
+}
+
+uint16_t packUnorm16(float v) {
+    float c = glm::clamp(v, 0.0f, 1.0f);
+    return (uint16_t)std::lround(c * 65535.0f);
+}
+
+uint8_t packUnorm8(float v) {
+    float c = glm::clamp(v, 0.0f, 1.0f);
+    return (uint8_t)std::lround(c * 255.0f);
+}
+
+}  // namespace meshLib
@@ -0,0 +1,125 @@
+/* File name: quant.hpp
+ * 
+ * Intro:
+ * C++ header of the mesh libraries' quant (Quantization) module.
+ * 
+ * Dependencies:
+ * 1. GLEW library (libglew-dev)
+ * 2. GLM library (libglm-dev)
+ * 3. The vertex format custom library (../vfmt.hpp)
+ * 4. The mesh libraries' main module (../mesh.hpp) */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#ifndef MESH__QUANT_HPP
+#define MESH__QUANT_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <glm/ext.hpp>
+
+#include "../vfmt.hpp"
+
+// Forward declare Mesh (from ../mesh.hpp)
+class Mesh;
+// Include ../mesh.hpp in mesh/quant.cpp to complete the declarations above
+
+/* Mesh library */
+namespace meshLib {
+
+/* Quantized vertex (16 bytes).
+ * Note:
+ * The vertex it replaced (a float32 position only) takes 12 bytes, so it is
+ * 4 bytes larger but also carries the normal and color; the float32 layout
+ * of the same attributes would take 40 bytes. */
+struct QuantVertex {
+    /* Position, 16-bit unsigned normalized within the mesh's bounding box.
+     * The 4th component is unused and keeps the next attribute aligned. */
+    uint16_t pos[4];
+    /* Normal, signed normalized 10-10-10-2 (GL_INT_2_10_10_10_REV). */
+    uint32_t normal;
+    /* Color, 8-bit unsigned normalized RGBA. */
+    uint8_t color[4];
+};
+
+/* Vertex format of QuantVertex.
+ * Note:
+ * The locations match the layout declarations in shader.vs. */
+using QuantFmt = VFmt<
+    QuantVertex,
+    VFMT_ATTR(QuantVertex, pos, 0, GL_UNSIGNED_SHORT, 4, VFMT_NORM),
+    VFMT_ATTR(QuantVertex, normal, 1, GL_INT_2_10_10_10_REV, 4, VFMT_NORM),
+    VFMT_ATTR(QuantVertex, color, 2, GL_UNSIGNED_BYTE, 4, VFMT_NORM)
+>;
+
+/* Float32 vertex of the same attributes (40 bytes); only drawn to time the
+ * vertex fetch against the quantized layout. */
+struct FloatVertex {
+    float pos[3];
+    float normal[3];
+    float color[4];
+};
+
+/* Vertex format of FloatVertex (at the locations of QuantFmt). */
+using FloatFmt = VFmt<
+    FloatVertex,
+    VFMT_ATTR(FloatVertex, pos, 0, GL_FLOAT, 3, VFMT_FLOAT),
+    VFMT_ATTR(FloatVertex, normal, 1, GL_FLOAT, 3, VFMT_FLOAT),
+    VFMT_ATTR(FloatVertex, color, 2, GL_FLOAT, 4, VFMT_FLOAT)
+>;
+
+/* (Vertex) quantization. */
+class Quant {
+   private:
+    /* Dequantization scale (the bounding box's size). */
+    glm::vec3 _scale;
+    /* Dequantization offset (the bounding box's minimum corner). */
+    glm::vec3 _offset;
+    /* Quantized vertices. */
+    std::vector<QuantVertex> _vertices;
+    /* Largest position error caused by the quantization. */
+    float _posErr;
+
+   public:
+    /* Constructs an empty quantization.
+     * scale: 1; offset: 0; vertices: empty; posErr: 0. */
+    Quant();
+    /* Quantizes the specified mesh, replacing the earlier results.
+     * Note:
+     * The mesh's normals and colors are generated if they are missing. */
+    void quantize(Mesh &mesh);
+    /* Reads the dequantization scale.
+     * Dequantized position = quantized position * scale + offset. */
+    glm::vec3 scale();
+    /* Reads the dequantization offset. */
+    glm::vec3 offset();
+    /* Reads the quantized vertices' reference. */
+    std::vector<QuantVertex> &vertices();
+    /* Reads the largest position error caused by the quantization. */
+    float posErr();
+    /* Finds the stride of the vertex it replaced (float32 position). */
+    static int baseStride();
+    /* Finds the stride of the float32 layout (position, normal, color). */
+    static int floatStride();
+    /* Finds the stride of the quantized layout. */
+    static int quantStride();
+};
+
+/* Appends the float32 vertices of a quantized mesh (whose normals and
+ * colors are generated) to the specified vertices. */
+void appendFloatVertices(Mesh &mesh, std::vector<FloatVertex> &vertices);
+/* Packs a unit vector into signed normalized 10-10-10-2. */
+uint32_t packSnorm1010102(glm::vec3 v);
+/* Packs a [0, 1] value into 16-bit unsigned normalized. */
+uint16_t packUnorm16(float v);
+/* Packs a [0, 1] value into 8-bit unsigned normalized. */
+uint8_t packUnorm8(float v);
+
+}  // namespace meshLib
+
+// MESH__QUANT_HPP
+#endif
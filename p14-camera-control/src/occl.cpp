@@ -0,0 +1,260 @@
+/* File name: occl.cpp
+ *
+ * Intro:
+ * C++ implementation of the occlusion culling custom library. */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#include "occl.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+
+using occlLib::Tile;
+using occlLib::Tri;
+using occlLib::tileHeight;
+using occlLib::tileWidth;
+
+/* Smallest clip space w of a rasterized vertex. */
+static float const minW = 1e-3f;
+
+/* Reads a monotonic clock (unit: milliseconds). */
+static double nowMs() {
+    auto t = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration<double, std::milli>(t).count();
+}
+
+Occl::Occl(int width, int height) {
+    _tilesX = (width + tileWidth - 1) / tileWidth;
+    _tilesY = (height + tileHeight - 1) / tileHeight;
+    _tiles.resize(_tilesX * _tilesY);
+    _raster = occlLib::rasterScalar;
+    simd(true);
+    clear();
+}
+
+int Occl::width() {
+    return _tilesX * tileWidth;
+}
+
+int Occl::height() {
+    return _tilesY * tileHeight;
+}
+
+bool Occl::simd() {
+    return _raster == occlLib::rasterAvx2;
+}
+
+bool Occl::simd(bool newVal) {
+    bool oldVal = simd();
+    bool avx2 = newVal and occlLib::avx2Supported();
+    _raster = avx2 ? occlLib::rasterAvx2 : occlLib::rasterScalar;
+    return oldVal;
+}
+
+void Occl::clear() {
+    for (Tile &tile : _tiles) {
+        tile.zMax0 = 1.0f;
+        tile.zMax1 = 0.0f;
+        tile.mask = 0;
+    }
+    _tris.clear();
+    _stats.occluders = 0;
+    _stats.tris = 0;
+    _stats.tested = 0;
+    _stats.culled = 0;
+    _stats.rasterMs = 0.0;
+    _stats.testMs = 0.0;
+}
+
+bool Occl::_setup(glm::vec4 const *clips, Tri &tri) {
+    // Occluders are optional, so near plane crossings are dropped instead of
+    // clipped
+    glm::vec3 v[3];
+    for (int i = 0; i < 3; i += 1) {
+        if (clips[i].w < minW) {
+            return false;
+        }
+        glm::vec3 ndc = glm::vec3(clips[i]) / clips[i].w;
+        v[i][0] = (ndc[0] * 0.5f + 0.5f) * (float)width();
+        v[i][1] = (ndc[1] * 0.5f + 0.5f) * (float)height();
+        v[i][2] = ndc[2] * 0.5f + 0.5f;
+    }
+
+    // Counterclockwise order, so the edge functions are positive inside
+    float area = (v[1][0] - v[0][0]) * (v[2][1] - v[0][1]);
+    area -= (v[2][0] - v[0][0]) * (v[1][1] - v[0][1]);
+    if (std::fabs(area) < 1e-6f) {
+        return false;
+    }
+    if (area < 0.0f) {
+        glm::vec3 t = v[1];
+        v[1] = v[2];
+        v[2] = t;
+        area = -area;
+    }
+
+    for (int i = 0; i < 3; i += 1) {
+        glm::vec3 &p = v[i];
+        glm::vec3 &q = v[(i + 1) % 3];
+        tri.a[i] = p[1] - q[1];
+        tri.b[i] = q[0] - p[0];
+        tri.c[i] = p[0] * q[1] - p[1] * q[0];
+    }
+
+    float dx1 = v[1][0] - v[0][0];
+    float dy1 = v[1][1] - v[0][1];
+    float dz1 = v[1][2] - v[0][2];
+    float dx2 = v[2][0] - v[0][0];
+    float dy2 = v[2][1] - v[0][1];
+    float dz2 = v[2][2] - v[0][2];
+    tri.za = (dz1 * dy2 - dz2 * dy1) / area;
+    tri.zb = (dz2 * dx1 - dz1 * dx2) / area;
+    tri.zc = v[0][2] - tri.za * v[0][0] - tri.zb * v[0][1];
+    tri.zMax = glm::max(v[0][2], glm::max(v[1][2], v[2][2]));
+
+    float xLo = glm::min(v[0][0], glm::min(v[1][0], v[2][0]));
+    float xHi = glm::max(v[0][0], glm::max(v[1][0], v[2][0]));
+    float yLo = glm::min(v[0][1], glm::min(v[1][1], v[2][1]));
+    float yHi = glm::max(v[0][1], glm::max(v[1][1], v[2][1]));
+    tri.x0 = glm::max((int)std::floor(xLo), 0);
+    tri.x1 = glm::min((int)std::ceil(xHi), width());
+    tri.y0 = glm::max((int)std::floor(yLo), 0);
+    tri.y1 = glm::min((int)std::ceil(yHi), height());
+    return tri.x0 < tri.x1 and tri.y0 < tri.y1;
+}
+
+void Occl::addOccluder(glm::mat4 const &mapping,
+                       std::vector<glm::vec3> const &positions,
+                       unsigned int const *indices, int count) {
+    _stats.occluders += 1;
+    for (int i = 0; i + 2 < count; i += 3) {
+        glm::vec4 clips[3];
+        for (int j = 0; j < 3; j += 1) {
+            glm::vec3 const &p = positions[indices[i + j]];
+            clips[j] = mapping * glm::vec4(p, 1.0f);
+        }
+        Tri tri;
+        if (_setup(clips, tri)) {
+            _tris.push_back(tri);
+        }
+    }
+}
+
+void Occl::rasterize(Jobs &jobs) {
+    double start = nowMs();
+
+    // Each band of tile rows is written by one worker only
+    // clang-format off
+    jobs.parallelFor(_tilesY, 2, [this](int begin, int end, int worker) {
+        for (Tri const &tri : _tris) {
+            _raster(tri, _tiles.data(), _tilesX, begin, end);
+        }
+    });
+    // clang-format on
+
+    _stats.tris += (int)_tris.size();
+    _stats.rasterMs += nowMs() - start;
+}
+
+bool Occl::testBox(glm::mat4 const &viewProj, glm::vec3 lo, glm::vec3 hi) {
+    // Screen rectangle and nearest depth of the box
+    glm::vec3 sLo(1e30f, 1e30f, 1e30f);
+    glm::vec3 sHi(-1e30f, -1e30f, -1e30f);
+    for (int i = 0; i < 8; i += 1) {
+        glm::vec3 corner(i & 1 ? hi[0] : lo[0], i & 2 ? hi[1] : lo[1],
+                         i & 4 ? hi[2] : lo[2]);
+        glm::vec4 clip = viewProj * glm::vec4(corner, 1.0f);
+        // Crossing the near plane: too close to be hidden
+        if (clip.w < minW) {
+            return true;
+        }
+        glm::vec3 ndc = glm::vec3(clip) / clip.w;
+        sLo = glm::min(sLo, ndc);
+        sHi = glm::max(sHi, ndc);
+    }
+    float z = sLo[2] * 0.5f + 0.5f;
+    int x0 = (int)std::floor((sLo[0] * 0.5f + 0.5f) * (float)width());
+    int x1 = (int)std::ceil((sHi[0] * 0.5f + 0.5f) * (float)width());
+    int y0 = (int)std::floor((sLo[1] * 0.5f + 0.5f) * (float)height());
+    int y1 = (int)std::ceil((sHi[1] * 0.5f + 0.5f) * (float)height());
+    x0 = glm::max(x0, 0);
+    y0 = glm::max(y0, 0);
+    x1 = glm::min(x1, width());
+    y1 = glm::min(y1, height());
+    // Off screen: nothing is known there
+    if (x0 >= x1 or y0 >= y1) {
+        return true;
+    }
+
+    for (int ty = y0 / tileHeight; ty <= (y1 - 1) / tileHeight; ty += 1) {
+        for (int tx = x0 / tileWidth; tx <= (x1 - 1) / tileWidth; tx += 1) {
+            // The rectangle's pixels in the tile
+            int cx0 = glm::max(x0 - tx * tileWidth, 0);
+            int cx1 = glm::min(x1 - tx * tileWidth, tileWidth);
+            int cy0 = glm::max(y0 - ty * tileHeight, 0);
+            int cy1 = glm::min(y1 - ty * tileHeight, tileHeight);
+            uint32_t rowMask = ((1u << cx1) - 1) & ~((1u << cx0) - 1);
+            uint32_t rectMask = 0;
+            for (int row = cy0; row < cy1; row += 1) {
+                rectMask |= rowMask << (row * tileWidth);
+            }
+
+            Tile const &tile = _tiles[ty * _tilesX + tx];
+            if (!occlLib::tileHides(tile, rectMask, z)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void Occl::test(Jobs &jobs, glm::mat4 const &viewProj,
+                std::vector<glm::vec4> const &spheres,
+                std::vector<unsigned char> &visible) {
+    double start = nowMs();
+    visible.resize(spheres.size());
+    // The body captures only this and the state, small enough for
+    // std::function to hold without a heap allocation
+    struct State {
+        glm::mat4 const &viewProj;
+        std::vector<glm::vec4> const &spheres;
+        std::vector<unsigned char> &visible;
+        std::atomic<int> tested;
+        std::atomic<int> culled;
+    } state{viewProj, spheres, visible, {0}, {0}};
+
+    // clang-format off
+    jobs.parallelFor((int)spheres.size(), 256,
+        [this, &state](int begin, int end, int worker) {
+            int chunkTested = 0;
+            int chunkCulled = 0;
+            for (int i = begin; i < end; i += 1) {
+                glm::vec4 const &sphere = state.spheres[i];
+                if (sphere.w < 0.0f) {
+                    state.visible[i] = 0;
+                    continue;
+                }
+                glm::vec3 center(sphere);
+                glm::vec3 r(sphere.w, sphere.w, sphere.w);
+                bool hit = testBox(state.viewProj, center - r, center + r);
+                state.visible[i] = hit;
+                chunkTested += 1;
+                chunkCulled += hit ? 0 : 1;
+            }
+            state.tested += chunkTested;
+            state.culled += chunkCulled;
+        }
+    );
+    // clang-format on
+
+    _stats.tested += state.tested;
+    _stats.culled += state.culled;
+    _stats.testMs += nowMs() - start;
+}
+
+OcclStats Occl::stats() {
+    return _stats;
+}
@@ -0,0 +1,100 @@
+/* File name: occl.hpp
+ *
+ * Intro:
+ * C++ header of the occlusion culling custom library.
+ * Selected occluder meshes are rasterized on the CPU into a low resolution
+ * masked depth buffer (occl/raster.hpp). The occludees' bounding boxes are
+ * then tested against it before the draws are submitted. Both steps run on
+ * the job system's threads: the rasterization splits the buffer into bands of
+ * tile rows, and the tests split the occludees.
+ * 
+ * Dependencies:
+ * 1. GLM library (libglm-dev)
+ * 2. The occl libraries' raster module (occl/raster.hpp)
+ * 3. The job system custom library (jobs.hpp) */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#ifndef OCCL_HPP
+#define OCCL_HPP
+
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/ext.hpp>
+
+#include "jobs.hpp"
+#include "occl/raster.hpp"
+
+/* Occlusion culling statistics (since the last clear). */
+struct OcclStats {
+    /* Added occluders. */
+    int occluders;
+    /* Rasterized occluder triangles. */
+    int tris;
+    /* Tested occludees. */
+    int tested;
+    /* Occludees found hidden. */
+    int culled;
+    /* Rasterization time (unit: milliseconds). */
+    double rasterMs;
+    /* Test time (unit: milliseconds). */
+    double testMs;
+};
+
+/* Occl (CPU occlusion culling). */
+class Occl {
+   private:
+    /* Buffer size (unit: tiles). */
+    int _tilesX;
+    int _tilesY;
+    std::vector<occlLib::Tile> _tiles;
+    /* Occluder triangles, set up for rasterization. */
+    std::vector<occlLib::Tri> _tris;
+    /* Rasterization kernel. */
+    occlLib::RasterFunc _raster;
+    OcclStats _stats;
+
+    /* Sets up a triangle from its clip space vertices; returns false if it
+     * crosses the near plane or has no area. */
+    bool _setup(glm::vec4 const *clips, occlLib::Tri &tri);
+
+   public:
+    /* Initializes an empty buffer of about the specified size (unit: pixels;
+     * rounded up to whole tiles). Uses the AVX2 kernel where supported. */
+    Occl(int width, int height);
+    /* Reads the buffer width (unit: pixels). */
+    int width();
+    /* Reads the buffer height (unit: pixels). */
+    int height();
+    /* Reads whether the AVX2 kernel is used. */
+    bool simd();
+    /* Reads and updates whether the AVX2 kernel is used (only takes effect
+     * where AVX2 is supported). */
+    bool simd(bool newVal);
+    /* Empties the buffer, the occluders, and the statistics. */
+    void clear();
+    /* Adds an occluder's triangles.
+     * mapping: object space to clip space; indices: count indices (a
+     * multiple of 3) into positions. */
+    void addOccluder(glm::mat4 const &mapping,
+                     std::vector<glm::vec3> const &positions,
+                     unsigned int const *indices, int count);
+    /* Rasterizes the occluders into the buffer. */
+    void rasterize(Jobs &jobs);
+    /* Finds whether the box [lo, hi] (world space) may be visible.
+     * viewProj: world space to clip space. */
+    bool testBox(glm::mat4 const &viewProj, glm::vec3 lo, glm::vec3 hi);
+    /* Tests the bounding boxes of spheres (xyz: world space center; w:
+     * radius) and updates visible; spheres with a negative radius are skipped
+     * (for example, outside the frustum). */
+    void test(Jobs &jobs, glm::mat4 const &viewProj,
+              std::vector<glm::vec4> const &spheres,
+              std::vector<unsigned char> &visible);
+    /* Reads the statistics. */
+    OcclStats stats();
+};
+
+// OCCL_HPP
+#endif
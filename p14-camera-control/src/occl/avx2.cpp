@@ -0,0 +1,60 @@
+/* File name: avx2.cpp
+ *
+ * Intro:
+ * C++ implementation of the occl (Occlusion culling) libraries' raster
+ * (Occluder rasterization) module's AVX2 kernel.
+ * Only this file is compiled with AVX2 enabled (see the Makefile), and it is
+ * only called where occlLib::avx2Supported finds AVX2 at runtime. */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#include "raster.hpp"
+
+#if defined(__AVX2__) and defined(__FMA__)
+#include <immintrin.h>
+#endif
+
+namespace occlLib {
+
+#if defined(__AVX2__) and defined(__FMA__)
+
+/* Finds the coverage mask of a tile, one row of 8 pixel centers at a time. */
+static uint32_t coverAvx2(Tri const &tri, int tx, int ty) {
+    // clang-format off
+    __m256 xs = _mm256_add_ps(
+        _mm256_set1_ps((float)(tx * tileWidth)),
+        _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f)
+    );
+    // clang-format on
+    __m256 zero = _mm256_setzero_ps();
+
+    uint32_t result = 0;
+    for (int row = 0; row < tileHeight; row += 1) {
+        float y = (float)(ty * tileHeight + row) + 0.5f;
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (int i = 0; i < 3; i += 1) {
+            __m256 rowC = _mm256_set1_ps(tri.b[i] * y + tri.c[i]);
+            __m256 e = _mm256_fmadd_ps(_mm256_set1_ps(tri.a[i]), xs, rowC);
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(e, zero, _CMP_GT_OQ));
+        }
+        uint32_t bits = (uint32_t)_mm256_movemask_ps(inside);
+        result |= bits << (row * tileWidth);
+    }
+    return result;
+}
+
+void rasterAvx2(Tri const &tri, Tile *tiles, int tilesX, int row0, int row1) {
+    rasterTri(tri, tiles, tilesX, row0, row1, coverAvx2);
+}
+
+#else
+
+// Built without AVX2: fall back to the scalar kernel
+void rasterAvx2(Tri const &tri, Tile *tiles, int tilesX, int row0, int row1) {
+    rasterScalar(tri, tiles, tilesX, row0, row1);
+}
+
+#endif
+
+}  // namespace occlLib
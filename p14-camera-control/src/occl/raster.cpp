@@ -0,0 +1,47 @@
+/* File name: raster.cpp
+ *
+ * Intro:
+ * C++ implementation of the occl (Occlusion culling) libraries' raster
+ * (Occluder rasterization) module (scalar kernel and kernel selection). */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#include "raster.hpp"
+
+namespace occlLib {
+
+/* Finds the coverage mask of a tile, one pixel center at a time. */
+static uint32_t coverScalar(Tri const &tri, int tx, int ty) {
+    uint32_t result = 0;
+    for (int row = 0; row < tileHeight; row += 1) {
+        float y = (float)(ty * tileHeight + row) + 0.5f;
+        for (int col = 0; col < tileWidth; col += 1) {
+            float x = (float)(tx * tileWidth + col) + 0.5f;
+            bool inside = true;
+            for (int i = 0; i < 3; i += 1) {
+                inside = inside and tri.a[i] * x + tri.b[i] * y + tri.c[i] > 0;
+            }
+            if (inside) {
+                result |= 1u << (row * tileWidth + col);
+            }
+        }
+    }
+    return result;
+}
+
+void rasterScalar(Tri const &tri, Tile *tiles, int tilesX, int row0,
+                  int row1) {
+    rasterTri(tri, tiles, tilesX, row0, row1, coverScalar);
+}
+
+bool avx2Supported() {
+#if defined(__GNUC__) and (defined(__x86_64__) or defined(__i386__))
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") and __builtin_cpu_supports("fma");
+#else
+    return false;
+#endif
+}
+
+}  // namespace occlLib
@@ -0,0 +1,155 @@
+/* File name: raster.hpp
+ *
+ * Intro:
+ * C++ header of the occl (Occlusion culling) libraries' raster (Occluder
+ * rasterization) module.
+ * The depth buffer is split into tiles of 8x4 pixels. A tile keeps a
+ * reference depth that bounds all its pixels and a working layer: a 32-bit
+ * coverage mask and a depth that bounds the covered pixels. Occluder
+ * triangles are merged into the working layer, and once it covers the whole
+ * tile, it becomes the new reference. The layout and merge rules follow
+ * masked occlusion culling; the depths are the farthest ones, so every test
+ * stays conservative.
+ * The coverage masks are found by a scalar kernel or an AVX2 kernel (8
+ * pixels per edge function evaluation), picked at runtime.
+ *
+ * References:
+ * 1. J. Hasselgren, M. Andersson, and T. Akenine-Moller, "Masked software
+ *    occlusion culling," in Proc. High Performance Graphics, 2016.
+ *
+ * Dependencies:
+ * 1. GCC or Clang (for __builtin_cpu_supports) */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#ifndef OCCL__RASTER_HPP
+#define OCCL__RASTER_HPP
+
+#include <cstdint>
+
+/* Occlusion culling library */
+namespace occlLib {
+
+/* Tile width and height (unit: pixels). */
+int const tileWidth = 8;
+int const tileHeight = 4;
+/* Coverage mask of a whole tile. */
+uint32_t const fullMask = 0xFFFFFFFFu;
+
+/* Depth tile (depths: 0 is the near plane, 1 is the far plane). */
+struct Tile {
+    /* Reference depth (bounds all pixels). */
+    float zMax0;
+    /* Working layer depth (bounds the covered pixels). */
+    float zMax1;
+    /* Working layer coverage (bit: row * tileWidth + column). */
+    uint32_t mask;
+};
+
+/* Screen space occluder triangle, set up for rasterization. */
+struct Tri {
+    /* Edge functions a * x + b * y + c; positive inside. */
+    float a[3];
+    float b[3];
+    float c[3];
+    /* Depth plane za * x + zb * y + zc. */
+    float za;
+    float zb;
+    float zc;
+    /* Farthest vertex depth. */
+    float zMax;
+    /* Pixel bounding box [x0, x1) x [y0, y1). */
+    int x0;
+    int y0;
+    int x1;
+    int y1;
+};
+
+/* Rasterization kernel; rasterizes a triangle into the tile rows
+ * [row0, row1) of a buffer tilesX tiles wide. */
+typedef void (*RasterFunc)(Tri const &tri, Tile *tiles, int tilesX, int row0,
+                           int row1);
+
+/* Finds the triangle's farthest depth over a tile, from its depth plane at the
+ * tile corners, capped at its farthest vertex. */
+inline float tileZ(Tri const &tri, int tx, int ty) {
+    float x0 = (float)(tx * tileWidth);
+    float y0 = (float)(ty * tileHeight);
+    float x1 = x0 + (float)tileWidth;
+    float y1 = y0 + (float)tileHeight;
+    float z00 = tri.za * x0 + tri.zb * y0 + tri.zc;
+    float z10 = tri.za * x1 + tri.zb * y0 + tri.zc;
+    float z01 = tri.za * x0 + tri.zb * y1 + tri.zc;
+    float z11 = tri.za * x1 + tri.zb * y1 + tri.zc;
+    float z = z00 > z10 ? z00 : z10;
+    z = z > z01 ? z : z01;
+    z = z > z11 ? z : z11;
+    return z < tri.zMax ? z : tri.zMax;
+}
+
+/* Merges a triangle's coverage of a tile into the tile. */
+inline void updateTile(Tile &tile, uint32_t cover, float z) {
+    if (cover == 0 or z >= tile.zMax0) {
+        return;
+    }
+
+    // Closer to the reference than to the working layer: merging would push
+    // the working layer back, so start a new one (dropping coverage is
+    // always conservative)
+    if (tile.mask != 0 and z - tile.zMax1 > tile.zMax0 - z) {
+        tile.mask = 0;
+        tile.zMax1 = 0.0f;
+    }
+    tile.mask |= cover;
+    tile.zMax1 = tile.zMax1 > z ? tile.zMax1 : z;
+
+    // A full working layer becomes the reference
+    if (tile.mask == fullMask) {
+        tile.zMax0 = tile.zMax1;
+        tile.mask = 0;
+        tile.zMax1 = 0.0f;
+    }
+}
+
+/* Finds whether a tile hides a box that covers the pixels rectMask of the
+ * tile and whose nearest depth is z. */
+inline bool tileHides(Tile const &tile, uint32_t rectMask, float z) {
+    float bound = tile.zMax0;
+    if ((rectMask & ~tile.mask) == 0 and tile.zMax1 < bound) {
+        bound = tile.zMax1;
+    }
+    return z > bound;
+}
+
+/* Rasterizes a triangle with the coverage function cover(tri, tx, ty). */
+template <class Cover>
+inline void rasterTri(Tri const &tri, Tile *tiles, int tilesX, int row0,
+                      int row1, Cover cover) {
+    int tx0 = tri.x0 / tileWidth;
+    int tx1 = (tri.x1 - 1) / tileWidth + 1;
+    int ty0 = tri.y0 / tileHeight;
+    int ty1 = (tri.y1 - 1) / tileHeight + 1;
+    ty0 = ty0 > row0 ? ty0 : row0;
+    ty1 = ty1 < row1 ? ty1 : row1;
+    for (int ty = ty0; ty < ty1; ty += 1) {
+        for (int tx = tx0; tx < tx1; tx += 1) {
+            uint32_t mask = cover(tri, tx, ty);
+            if (mask != 0) {
+                updateTile(tiles[ty * tilesX + tx], mask, tileZ(tri, tx, ty));
+            }
+        }
+    }
+}
+
+/* Rasterizes a triangle (scalar kernel). */
+void rasterScalar(Tri const &tri, Tile *tiles, int tilesX, int row0, int row1);
+/* Rasterizes a triangle (AVX2 kernel; only call it where avx2Supported). */
+void rasterAvx2(Tri const &tri, Tile *tiles, int tilesX, int row0, int row1);
+/* Finds whether the CPU supports the AVX2 kernel. */
+bool avx2Supported();
+
+}  // namespace occlLib
+
+// OCCL__RASTER_HPP
+#endif
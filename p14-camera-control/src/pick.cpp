@@ -0,0 +1,67 @@
+/* File name: pick.cpp
+ *
+ * Intro:
+ * C++ implementation of the picking custom library. */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#include "pick.hpp"
+
+Pick::Pick() {
+    _tested = 0;
+}
+
+PickHit Pick::ray(Scene &scene, Bvh &objBvh, glm::vec3 origin,
+                  glm::vec3 dir) {
+    PickHit result;
+    result.obj = -1;
+    result.tri = -1;
+    _tested = 0;
+
+    auto hitObj = [&](int obj, float tMax) {
+        _tested += 1;
+        Obj &object = scene.objs()[obj];
+        Mesh &mesh = scene.meshes()[object.mesh];
+        std::vector<glm::vec3> &positions = mesh.positions();
+        std::vector<unsigned int> &indices = mesh.indices();
+
+        // An affine map keeps the distances along the mapped ray
+        glm::mat4 inv = glm::inverse(object.trans.world());
+        glm::vec3 objOrigin = glm::vec3(inv * glm::vec4(origin, 1.0f));
+        glm::vec3 objDir = glm::vec3(inv * glm::vec4(dir, 0.0f));
+        auto hitTri = [&](int tri, float tTri) {
+            float t;
+            glm::vec3 a = positions[indices[tri * 3]];
+            glm::vec3 b = positions[indices[tri * 3 + 1]];
+            glm::vec3 c = positions[indices[tri * 3 + 2]];
+            if (!bvhRayTri(objOrigin, objDir, a, b, c, t) or t >= tTri) {
+                return tTri;
+            }
+            result.obj = obj;
+            result.tri = tri * 3;
+            return t;
+        };
+        Bvh &meshBvh = scene.meshBvhs()[object.mesh];
+        return meshBvh.ray(objOrigin, objDir, tMax, hitTri);
+    };
+    result.t = objBvh.ray(origin, dir, 1.0f, hitObj);
+    result.pos = origin + dir * result.t;
+    return result;
+}
+
+int Pick::tested() {
+    return _tested;
+}
+
+void pickRay(glm::mat4 const &viewProj, int x, int y, int width, int height,
+             glm::vec3 &origin, glm::vec3 &dir) {
+    // Pixel center to NDC; GLUT rows go from the top
+    float ndcX = ((float)x + 0.5f) / (float)width * 2.0f - 1.0f;
+    float ndcY = 1.0f - ((float)y + 0.5f) / (float)height * 2.0f;
+    glm::mat4 inv = glm::inverse(viewProj);
+    glm::vec4 nearPos = inv * glm::vec4(ndcX, ndcY, -1.0f, 1.0f);
+    glm::vec4 farPos = inv * glm::vec4(ndcX, ndcY, 1.0f, 1.0f);
+    origin = glm::vec3(nearPos) / nearPos.w;
+    dir = glm::vec3(farPos) / farPos.w - origin;
+}
@@ -0,0 +1,69 @@
+/* File name: pick.hpp
+ *
+ * Intro:
+ * C++ header of the picking custom library.
+ * A screen position is unprojected through the inverse of the view
+ * projection into a world space ray. The ray is cast in two levels: the
+ * objects' BVH finds the objects whose boxes it enters, and each of those
+ * objects is tested in its own object space against its mesh's triangle BVH
+ * (the scene's, see scene.hpp). The meshes' BVHs are shared by all objects
+ * that use them, so a scene of millions of triangles is picked in
+ * microseconds.
+ *
+ * Dependencies:
+ * 1. GLM library (libglm-dev)
+ * 2. The bounding volume hierarchy custom library (bvh.hpp)
+ * 3. The scene libraries' main module (scene.hpp) */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#ifndef PICK_HPP
+#define PICK_HPP
+
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/ext.hpp>
+
+#include "bvh.hpp"
+#include "scene.hpp"
+
+/* Picking result. */
+struct PickHit {
+    /* Hit object (-1 if nothing is hit). */
+    int obj;
+    /* Hit triangle of the object's mesh (the index of its first index). */
+    int tri;
+    /* Hit distance along the ray (unit: lengths of the ray direction; 1 if
+     * nothing is hit). */
+    float t;
+    /* Hit position (world space). */
+    glm::vec3 pos;
+};
+
+/* Pick (Picking). */
+class Pick {
+   private:
+    /* Objects tested by the last ray. */
+    int _tested;
+
+   public:
+    /* Initializes a picking. */
+    Pick();
+    /* Casts a world space ray (from pickRay) against the scene's objects, up
+     * to t = 1. objBvh: the BVH over the objects' world space boxes (in
+     * object order); the scene's mesh BVHs must be built. */
+    PickHit ray(Scene &scene, Bvh &objBvh, glm::vec3 origin, glm::vec3 dir);
+    /* Reads the objects tested by the last ray. */
+    int tested();
+};
+
+/* Finds the world space ray under a screen position (unit: pixels, from the
+ * top left, as in GLUT) of a viewport of the specified size. The ray starts
+ * on the near plane and reaches the far plane at t = 1. */
+void pickRay(glm::mat4 const &viewProj, int x, int y, int width, int height,
+             glm::vec3 &origin, glm::vec3 &dir);
+
+// PICK_HPP
+#endif
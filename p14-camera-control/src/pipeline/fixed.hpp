@@ -0,0 +1,137 @@
+/* File name: fixed.hpp
+ *
+ * Intro:
+ * C++ header of the pipeline (Rendering pipeline) libraries' fixed (Fixed
+ * stages) module.
+ * The stage combination of a fixed pipeline is resolved at compile time into a
+ * straight-line matrix product. Missing stages fold away as identities, so no
+ * null checks or identity multiplications are left at runtime. The runtime
+ * Pipeline class (../pipeline.hpp) stays the flexible option.
+ *
+ * Usage:
+ * pipelineLib::Pipeline<Trans, Persp, Cam> pipeline(&trans, &persp, &cam);
+ * glm::mat4 mapping = pipeline.mapping();
+ *
+ * Dependencies:
+ * 1. GLM library (libglm-dev)
+ * 2. The transformation custom library (../trans.hpp)
+ * 3. The perspective custom library (../persp.hpp)
+ * 4. The camera custom library (../cam.hpp) */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#ifndef PIPELINE__FIXED_HPP
+#define PIPELINE__FIXED_HPP
+
+#include <tuple>
+#include <type_traits>
+
+#include <glm/glm.hpp>
+#include <glm/ext.hpp>
+
+#include "../trans.hpp"
+#include "../persp.hpp"
+#include "../cam.hpp"
+
+/* Rendering pipeline library */
+namespace pipelineLib {
+
+/* Compile-time identity matrix. */
+struct Ident {};
+
+// Identity folding: products with Ident are resolved at compile time
+
+constexpr Ident mul(Ident, Ident) {
+    return Ident();
+}
+
+inline glm::mat4 const &mul(Ident, glm::mat4 const &m) {
+    return m;
+}
+
+inline glm::mat4 const &mul(glm::mat4 const &m, Ident) {
+    return m;
+}
+
+inline glm::mat4 mul(glm::mat4 const &a, glm::mat4 const &b) {
+    return a * b;
+}
+
+/* Converts a folded product into a matrix. */
+inline glm::mat4 toMat(Ident) {
+    return glm::mat4(1.0f);
+}
+
+/* Converts a folded product into a matrix. */
+inline glm::mat4 const &toMat(glm::mat4 const &m) {
+    return m;
+}
+
+/* Finds whether the type T is one of the types Ts. */
+template <class T, class... Ts>
+constexpr bool has() {
+    return (std::is_same<T, Ts>::value or ...);
+}
+
+/* Rendering pipeline with fixed stages. */
+template <class... Stages>
+class Pipeline {
+    // clang-format off
+    static_assert(
+        ((has<Stages, Trans, Persp, Cam>()) and ...),
+        "pipeline stages must be Trans, Persp, or Cam"
+    );
+    // clang-format on
+
+   private:
+    std::tuple<Stages *...> _stages;
+
+    /* Finds the world part of the product. */
+    auto _world() {
+        if constexpr (has<Trans, Stages...>()) {
+            return std::get<Trans *>(_stages)->world();
+        } else {
+            return Ident();
+        }
+    }
+
+    /* Finds the view part of the product. */
+    auto _view() {
+        if constexpr (has<Cam, Stages...>()) {
+            return std::get<Cam *>(_stages)->view();
+        } else {
+            return Ident();
+        }
+    }
+
+    /* Finds the projection part of the product. */
+    auto _proj() {
+        if constexpr (has<Persp, Stages...>()) {
+            // Without a camera, the projection brings its own +Z view
+            if constexpr (has<Cam, Stages...>()) {
+                return std::get<Persp *>(_stages)->proj();
+            } else {
+                return std::get<Persp *>(_stages)->projView();
+            }
+        } else {
+            return Ident();
+        }
+    }
+
+   public:
+    /* Initializes the pipeline with its stages (one pointer per stage). */
+    Pipeline(Stages *...stages) : _stages(stages...) {
+    }
+
+    /* Finds the composite mapping matrix. */
+    glm::mat4 mapping() {
+        // In matrix left-multiplication, the order is from right to left
+        return toMat(mul(mul(_proj(), _view()), _world()));
+    }
+};
+
+}  // namespace pipelineLib
+
+// PIPELINE__FIXED_HPP
+#endif
@@ -0,0 +1,90 @@
+/* File name: scene.cpp
+ *
+ * Intro:
+ * C++ implementation of the scene custom library. */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#include "scene.hpp"
+
+Scene::Scene() {
+}
+
+std::vector<Mesh> &Scene::meshes() {
+    return _meshes;
+}
+
+std::vector<meshLib::Quant> &Scene::quants() {
+    return _quants;
+}
+
+std::vector<meshLib::Lod> &Scene::lods() {
+    return _lods;
+}
+
+std::vector<glm::vec4> &Scene::spheres() {
+    return _spheres;
+}
+
+std::vector<Bvh> &Scene::meshBvhs() {
+    return _meshBvhs;
+}
+
+std::vector<Obj> &Scene::objs() {
+    return _objs;
+}
+
+int Scene::addMesh(Mesh const &mesh) {
+    _meshes.push_back(mesh);
+    return (int)_meshes.size() - 1;
+}
+
+int Scene::addObj(int mesh) {
+    Obj obj;
+    obj.mesh = mesh;
+    obj.lod = 0;
+    _objs.push_back(obj);
+    return (int)_objs.size() - 1;
+}
+
+void Scene::prepare() {
+    _quants.resize(_meshes.size());
+    _lods.resize(_meshes.size());
+    _spheres.resize(_meshes.size());
+    for (size_t i = 0; i < _meshes.size(); i += 1) {
+        // Quantize at import; the float32 positions are not uploaded
+        _quants[i].quantize(_meshes[i]);
+        // All levels share the vertices and differ only in their indices
+        _lods[i].gen(_meshes[i], 6, 0.5f, 4);
+        _spheres[i] = _meshes[i].sphere();
+    }
+}
+
+void Scene::buildBvhs(Jobs &jobs) {
+    _meshBvhs.clear();
+    _meshBvhs.resize(_meshes.size());
+    std::vector<BvhBox> boxes;
+    for (size_t i = 0; i < _meshes.size(); i += 1) {
+        std::vector<glm::vec3> &positions = _meshes[i].positions();
+        std::vector<unsigned int> &indices = _meshes[i].indices();
+        int triCount = (int)indices.size() / 3;
+        boxes.resize(triCount);
+        for (int j = 0; j < triCount; j += 1) {
+            glm::vec3 a = positions[indices[j * 3]];
+            glm::vec3 b = positions[indices[j * 3 + 1]];
+            glm::vec3 c = positions[indices[j * 3 + 2]];
+            boxes[j].lo = glm::min(a, glm::min(b, c));
+            boxes[j].hi = glm::max(a, glm::max(b, c));
+        }
+        _meshBvhs[i].build(boxes, jobs);
+    }
+}
+
+long Scene::triCount() {
+    long result = 0;
+    for (Obj const &obj : _objs) {
+        result += _meshes[obj.mesh].indexCount() / 3;
+    }
+    return result;
+}
@@ -0,0 +1,92 @@
+/* File name: scene.hpp
+ *
+ * Intro:
+ * C++ header of the scene custom library.
+ * A scene holds meshes (with their quantized vertices and levels of detail)
+ * and the objects that place the meshes in the world. The triangle BVHs of
+ * its meshes are built once and shared by all the queries in object space
+ * (picking and the camera's collision).
+ * 
+ * Dependencies:
+ * 1. GLM library (libglm-dev)
+ * 2. The transformation custom library (trans.hpp)
+ * 3. The mesh custom library (mesh.hpp, mesh/*.hpp)
+ * 4. All modules of the scene library (scene/*.hpp)
+ * 5. The bounding volume hierarchy custom library (bvh.hpp)
+ * 6. The job system custom library (jobs.hpp) */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#ifndef SCENE_HPP
+#define SCENE_HPP
+
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/ext.hpp>
+
+#include "trans.hpp"
+#include "mesh.hpp"
+#include "mesh/quant.hpp"
+#include "mesh/lod.hpp"
+#include "bvh.hpp"
+#include "jobs.hpp"
+
+/* Scene object. */
+struct Obj {
+    /* Index of the object's mesh in the scene. */
+    int mesh;
+    /* Transformation (object space to world space). */
+    Trans trans;
+    /* Currently selected level of detail. */
+    int lod;
+};
+
+/* Scene. */
+class Scene {
+   private:
+    /* Meshes. */
+    std::vector<Mesh> _meshes;
+    /* Quantized vertices of each mesh. */
+    std::vector<meshLib::Quant> _quants;
+    /* Level of detail chain of each mesh. */
+    std::vector<meshLib::Lod> _lods;
+    /* Bounding sphere of each mesh (xyz: center; w: radius). */
+    std::vector<glm::vec4> _spheres;
+    /* Triangle BVH of each mesh (object space, finest level). */
+    std::vector<Bvh> _meshBvhs;
+    /* Objects. */
+    std::vector<Obj> _objs;
+
+   public:
+    /* Initializes an empty scene. */
+    Scene();
+    /* Reads the meshes' reference. */
+    std::vector<Mesh> &meshes();
+    /* Reads the quantized vertices' (of each mesh) reference. */
+    std::vector<meshLib::Quant> &quants();
+    /* Reads the level of detail chains' (of each mesh) reference. */
+    std::vector<meshLib::Lod> &lods();
+    /* Reads the bounding spheres' (of each mesh) reference. */
+    std::vector<glm::vec4> &spheres();
+    /* Reads the triangle BVHs' (of each mesh) reference. */
+    std::vector<Bvh> &meshBvhs();
+    /* Reads the objects' reference. */
+    std::vector<Obj> &objs();
+    /* Adds a mesh and returns its index. */
+    int addMesh(Mesh const &mesh);
+    /* Adds an object of the specified mesh and returns its index. */
+    int addObj(int mesh);
+    /* Quantizes the meshes, generates their levels of detail, and finds their
+     * bounding spheres. */
+    void prepare();
+    /* Builds the triangle BVHs of the meshes (each triangle's box, at the
+     * finest level of detail). */
+    void buildBvhs(Jobs &jobs);
+    /* Finds the total triangle count of the objects at level of detail 0. */
+    long triCount();
+};
+
+// SCENE_HPP
+#endif
@@ -0,0 +1,378 @@
+/* File name: gen.cpp
+ * 
+ * Intro:
+ * C++ implementation of the scene libraries' gen (Generation) module. */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#include "gen.hpp"
+#include "../jobs.hpp"
+#include "../mesh.hpp"
+#include "../scene.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace sceneLib {
+
+// Implement generation helpers
+
+/* Objects per chunk; each chunk has its own random stream. */
+static int const chunkSize = 4096;
+
+/* Small random generator (SplitMix64). */
+struct Rng {
+    uint64_t state;
+
+    Rng(uint64_t seed) {
+        state = seed;
+    }
+
+    uint64_t next() {
+        state += 0x9E3779B97F4A7C15ull;
+        uint64_t z = state;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    /* Finds a uniform value in [0, 1). */
+    float unit() {
+        return (float)(next() >> 40) / (float)(1ull << 24);
+    }
+
+    /* Finds a uniform value in [lo, hi). */
+    float range(float lo, float hi) {
+        return lo + (hi - lo) * unit();
+    }
+
+    /* Finds a standard normal value (Box-Muller). */
+    float normal() {
+        float u = glm::max(unit(), 1e-7f);
+        float v = unit();
+        return std::sqrt(-2.0f * std::log(u)) * std::cos(6.2831853f * v);
+    }
+};
+
+Gen::Gen() {
+    _count = 1000;
+    _seed = 1;
+    _dist = distUniform;
+    _extent = 50.0f;
+    _center = glm::vec3(0.0f, 0.0f, 0.0f);
+    _kinds = kindTetra | kindSphere | kindGrid;
+    _subdiv = 3;
+    _gridCells = 16;
+}
+
+long Gen::count() {
+    return _count;
+}
+
+long Gen::count(long newVal) {
+    long oldVal = _count;
+    _count = newVal;
+    return oldVal;
+}
+
+uint64_t Gen::seed() {
+    return _seed;
+}
+
+uint64_t Gen::seed(uint64_t newVal) {
+    uint64_t oldVal = _seed;
+    _seed = newVal;
+    return oldVal;
+}
+
+Dist Gen::dist() {
+    return _dist;
+}
+
+Dist Gen::dist(Dist newVal) {
+    Dist oldVal = _dist;
+    _dist = newVal;
+    return oldVal;
+}
+
+float Gen::extent() {
+    return _extent;
+}
+
+float Gen::extent(float newVal) {
+    float oldVal = _extent;
+    _extent = newVal;
+    return oldVal;
+}
+
+glm::vec3 Gen::center() {
+    return _center;
+}
+
+glm::vec3 Gen::center(glm::vec3 newVal) {
+    glm::vec3 oldVal = _center;
+    _center = newVal;
+    return oldVal;
+}
+
+int Gen::kinds() {
+    return _kinds;
+}
+
+int Gen::kinds(int newVal) {
+    int oldVal = _kinds;
+    _kinds = newVal;
+    return oldVal;
+}
+
+int Gen::subdiv() {
+    return _subdiv;
+}
+
+int Gen::subdiv(int newVal) {
+    int oldVal = _subdiv;
+    _subdiv = newVal;
+    return oldVal;
+}
+
+int Gen::gridCells() {
+    return _gridCells;
+}
+
+int Gen::gridCells(int newVal) {
+    int oldVal = _gridCells;
+    _gridCells = newVal;
+    return oldVal;
+}
+
+void Gen::gen(Scene &scene, Jobs &jobs) {
+    // Add one mesh per kind
+    std::vector<int> meshIds;
+    if (_kinds & kindTetra) {
+        Mesh mesh;
+        tetraMesh(mesh);
+        meshIds.push_back(scene.addMesh(mesh));
+    }
+    if (_kinds & kindSphere) {
+        Mesh mesh;
+        sphereMesh(mesh, _subdiv);
+        meshIds.push_back(scene.addMesh(mesh));
+    }
+    if (_kinds & kindGrid) {
+        Mesh mesh;
+        gridMesh(mesh, _gridCells);
+        meshIds.push_back(scene.addMesh(mesh));
+    }
+    if (meshIds.empty() or _count <= 0) {
+        return;
+    }
+
+    // Cluster centers come from their own stream so that they do not depend
+    // on the object count's chunking
+    std::vector<glm::vec3> clusters;
+    float clusterSigma = 0.0f;
+    if (_dist == distClusters) {
+        int clusterCount = (int)glm::clamp(_count / 10000 + 1, 1l, 64l);
+        Rng rng(_seed ^ 0xC1A55E5ull);
+        for (int i = 0; i < clusterCount; i += 1) {
+            glm::vec3 c;
+            for (int j = 0; j < 3; j += 1) {
+                c[j] = rng.range(-_extent, _extent);
+            }
+            clusters.push_back(_center + c);
+        }
+        clusterSigma = _extent / (2.0f * std::cbrt((float)clusterCount));
+    }
+
+    std::vector<Obj> &objs = scene.objs();
+    size_t first = objs.size();
+    objs.resize(first + _count);
+    int chunkCount = (int)((_count + chunkSize - 1) / chunkSize);
+
+    jobs.parallelFor(chunkCount, 1, [&](int begin, int end, int worker) {
+        for (int chunk = begin; chunk < end; chunk += 1) {
+            Rng rng(_seed * 0x2545F4914F6CDD1Dull + (uint64_t)chunk);
+            long lo = (long)chunk * chunkSize;
+            long hi = glm::min(lo + chunkSize, _count);
+            for (long i = lo; i < hi; i += 1) {
+                Obj &obj = objs[first + i];
+                obj.mesh = meshIds[rng.next() % meshIds.size()];
+                obj.lod = 0;
+
+                glm::vec3 pos;
+                if (_dist == distBall) {
+                    // Rejection sampling in the unit cube
+                    do {
+                        for (int j = 0; j < 3; j += 1) {
+                            pos[j] = rng.range(-1.0f, 1.0f);
+                        }
+                    } while (glm::dot(pos, pos) > 1.0f);
+                    pos = _center + pos * _extent;
+                } else if (_dist == distClusters) {
+                    glm::vec3 c = clusters[rng.next() % clusters.size()];
+                    for (int j = 0; j < 3; j += 1) {
+                        pos[j] = c[j] + rng.normal() * clusterSigma;
+                    }
+                } else {
+                    for (int j = 0; j < 3; j += 1) {
+                        pos[j] = _center[j] + rng.range(-_extent, _extent);
+                    }
+                }
+
+                float s = rng.range(0.5f, 1.5f);
+                float rx = rng.range(0.0f, 360.0f);
+                float ry = rng.range(0.0f, 360.0f);
+                float rz = rng.range(0.0f, 360.0f);
+                obj.trans = Trans();
+                obj.trans.pos(pos[0], pos[1], pos[2]);
+                obj.trans.rot(rx, ry, rz);
+                obj.trans.scale(s, s, s);
+            }
+        }
+    });
+}
+
+bool parseDist(char const *name, Dist &result) {
+    if (strcmp(name, "uniform") == 0) {
+        result = distUniform;
+    } else if (strcmp(name, "ball") == 0) {
+        result = distBall;
+    } else if (strcmp(name, "clusters") == 0) {
+        result = distClusters;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool parseKinds(char const *names, int &result) {
+    std::string list = names;
+    int kinds = 0;
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t end = list.find(',', start);
+        if (end == std::string::npos) {
+            end = list.size();
+        }
+        std::string name = list.substr(start, end - start);
+        if (name == "tetra") {
+            kinds |= kindTetra;
+        } else if (name == "sphere") {
+            kinds |= kindSphere;
+        } else if (name == "grid") {
+            kinds |= kindGrid;
+        } else {
+            return false;
+        }
+        start = end + 1;
+    }
+    result = kinds;
+    return true;
+}
+
+void tetraMesh(Mesh &mesh) {
+    // clang-format off
+    mesh.positions() = {
+        glm::vec3(-1.0f, -1.0f, 0.5773f),
+        glm::vec3(0.0f, -1.0f, -1.1548f),
+        glm::vec3(1.0f, -1.0f, 0.5773f),
+        glm::vec3(0.0f, 1.0f, 0.0f)
+    };
+    mesh.indices() = {
+        0, 3, 1,
+        1, 3, 2,
+        2, 3, 0,
+        0, 2, 1
+    };
+    // clang-format on
+    mesh.normals().clear();
+    mesh.colors().clear();
+}
+
+void sphereMesh(Mesh &mesh, int subdiv) {
+    float const t = (1.0f + std::sqrt(5.0f)) / 2.0f;
+    std::vector<glm::vec3> &v = mesh.positions();
+    // clang-format off
+    v = {
+        glm::vec3(-1, t, 0), glm::vec3(1, t, 0),
+        glm::vec3(-1, -t, 0), glm::vec3(1, -t, 0),
+        glm::vec3(0, -1, t), glm::vec3(0, 1, t),
+        glm::vec3(0, -1, -t), glm::vec3(0, 1, -t),
+        glm::vec3(t, 0, -1), glm::vec3(t, 0, 1),
+        glm::vec3(-t, 0, -1), glm::vec3(-t, 0, 1)
+    };
+    std::vector<unsigned int> &f = mesh.indices();
+    f = {
+        0, 11, 5, 0, 5, 1, 0, 1, 7, 0, 7, 10, 0, 10, 11,
+        1, 5, 9, 5, 11, 4, 11, 10, 2, 10, 7, 6, 7, 1, 8,
+        3, 9, 4, 3, 4, 2, 3, 2, 6, 3, 6, 8, 3, 8, 9,
+        4, 9, 5, 2, 4, 11, 6, 2, 10, 8, 6, 7, 9, 8, 1
+    };
+    // clang-format on
+    for (glm::vec3 &p : v) {
+        p = glm::normalize(p);
+    }
+
+    // Split each triangle into 4, sharing the edge midpoints
+    for (int level = 0; level < subdiv; level += 1) {
+        std::map<std::pair<unsigned int, unsigned int>, unsigned int> mids;
+        auto mid = [&](unsigned int a, unsigned int b) {
+            std::pair<unsigned int, unsigned int> key;
+            key = std::make_pair(glm::min(a, b), glm::max(a, b));
+            auto found = mids.find(key);
+            if (found != mids.end()) {
+                return found->second;
+            }
+            v.push_back(glm::normalize(v[a] + v[b]));
+            unsigned int index = (unsigned int)v.size() - 1;
+            mids[key] = index;
+            return index;
+        };
+        std::vector<unsigned int> next;
+        next.reserve(f.size() * 4);
+        for (size_t i = 0; i + 2 < f.size(); i += 3) {
+            unsigned int a = f[i], b = f[i + 1], c = f[i + 2];
+            unsigned int ab = mid(a, b), bc = mid(b, c), ca = mid(c, a);
+            // clang-format off
+            next.insert(next.end(), {
+                a, ab, ca, b, bc, ab, c, ca, bc, ab, bc, ca
+            });
+            // clang-format on
+        }
+        f.swap(next);
+    }
+    mesh.normals().clear();
+    mesh.colors().clear();
+}
+
+void gridMesh(Mesh &mesh, int cells) {
+    cells = glm::max(cells, 1);
+    std::vector<glm::vec3> &v = mesh.positions();
+    std::vector<unsigned int> &f = mesh.indices();
+    v.clear();
+    f.clear();
+    for (int i = 0; i <= cells; i += 1) {
+        for (int j = 0; j <= cells; j += 1) {
+            float x = (float)j / cells * 2.0f - 1.0f;
+            float z = (float)i / cells * 2.0f - 1.0f;
+            v.push_back(glm::vec3(x, 0.0f, z));
+        }
+    }
+    for (int i = 0; i < cells; i += 1) {
+        for (int j = 0; j < cells; j += 1) {
+            unsigned int a = i * (cells + 1) + j;
+            unsigned int b = a + 1;
+            unsigned int c = a + cells + 1;
+            unsigned int d = c + 1;
+            f.insert(f.end(), {a, c, b, b, c, d});
+        }
+    }
+    mesh.normals().clear();
+    mesh.colors().clear();
+}
+
+}  // namespace sceneLib
@@ -0,0 +1,127 @@
+/* File name: gen.hpp
+ * 
+ * Intro:
+ * C++ header of the scene libraries' gen (Generation) module.
+ * Generates procedural stress test scenes of tetrahedra, subdivided spheres,
+ * and grids. The objects are generated in parallel, in fixed-size chunks with
+ * one random stream per chunk, so a seed gives the same scene for any thread
+ * count.
+ * 
+ * Dependencies:
+ * 1. GLM library (libglm-dev)
+ * 2. The job system custom library (../jobs.hpp)
+ * 3. The mesh custom library (../mesh.hpp)
+ * 4. The scene libraries' main module (../scene.hpp) */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#ifndef SCENE__GEN_HPP
+#define SCENE__GEN_HPP
+
+#include <cstdint>
+
+#include <glm/glm.hpp>
+#include <glm/ext.hpp>
+
+// Forward declare Jobs (from ../jobs.hpp), Mesh (from ../mesh.hpp), and
+// Scene (from ../scene.hpp)
+class Jobs;
+class Mesh;
+class Scene;
+// Include ../jobs.hpp, ../mesh.hpp, and ../scene.hpp in scene/gen.cpp to
+// complete the declarations above
+
+/* Scene library */
+namespace sceneLib {
+
+/* Mesh kinds (bit flags). */
+enum Kind { kindTetra = 1, kindSphere = 2, kindGrid = 4 };
+
+/* Spatial distributions of the objects. */
+enum Dist {
+    /* Uniform in a cube of half size extent. */
+    distUniform,
+    /* Uniform in a ball of radius extent. */
+    distBall,
+    /* Gaussian clusters in a cube of half size extent. */
+    distClusters,
+};
+
+/* (Scene) generation. */
+class Gen {
+   private:
+    /* Object count. */
+    long _count;
+    /* Random seed. */
+    uint64_t _seed;
+    /* Spatial distribution. */
+    Dist _dist;
+    /* Size of the distribution (unit: world space lengths). */
+    float _extent;
+    /* Center of the distribution. */
+    glm::vec3 _center;
+    /* Mesh kinds to use (Kind bit flags). */
+    int _kinds;
+    /* Sphere subdivision level (20 * 4 ^ subdiv triangles). */
+    int _subdiv;
+    /* Grid cells per side (2 * cells ^ 2 triangles). */
+    int _gridCells;
+
+   public:
+    /* Constructs a default generation.
+     * count: 1000; seed: 1; dist: uniform; extent: 50; center: 0, 0, 0;
+     * kinds: all; subdiv: 3; gridCells: 16. */
+    Gen();
+    /* Reads the object count. */
+    long count();
+    /* Reads and updates the object count. */
+    long count(long newVal);
+    /* Reads the random seed. */
+    uint64_t seed();
+    /* Reads and updates the random seed. */
+    uint64_t seed(uint64_t newVal);
+    /* Reads the spatial distribution. */
+    Dist dist();
+    /* Reads and updates the spatial distribution. */
+    Dist dist(Dist newVal);
+    /* Reads the distribution's size. */
+    float extent();
+    /* Reads and updates the distribution's size. */
+    float extent(float newVal);
+    /* Reads the distribution's center. */
+    glm::vec3 center();
+    /* Reads and updates the distribution's center. */
+    glm::vec3 center(glm::vec3 newVal);
+    /* Reads the mesh kinds (Kind bit flags). */
+    int kinds();
+    /* Reads and updates the mesh kinds (Kind bit flags). */
+    int kinds(int newVal);
+    /* Reads the sphere subdivision level. */
+    int subdiv();
+    /* Reads and updates the sphere subdivision level. */
+    int subdiv(int newVal);
+    /* Reads the grid cells per side. */
+    int gridCells();
+    /* Reads and updates the grid cells per side. */
+    int gridCells(int newVal);
+    /* Adds the meshes and the generated objects to the scene. */
+    void gen(Scene &scene, Jobs &jobs);
+};
+
+/* Parses a distribution name (uniform, ball, clusters). */
+bool parseDist(char const *name, Dist &result);
+/* Parses a comma separated list of mesh kinds (tetra, sphere, grid). */
+bool parseKinds(char const *names, int &result);
+
+/* Fills the mesh with the tetrahedron. */
+void tetraMesh(Mesh &mesh);
+/* Fills the mesh with a unit sphere subdivided from an icosahedron. */
+void sphereMesh(Mesh &mesh, int subdiv);
+/* Fills the mesh with a unit grid on the XZ plane, with cells per side. */
+void gridMesh(Mesh &mesh, int cells);
+
+}  // namespace sceneLib
+
+// SCENE__GEN_HPP
+#endif
@@ -0,0 +1,163 @@
+/* File name: build.cpp
+ *
+ * Intro:
+ * C++ implementation of the shader libraries' build (Program build)
+ * module. */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#include "build.hpp"
+
+#include <chrono>
+
+namespace shaderLib {
+
+/* Whether parallel compilation is on (completion can be polled). */
+static bool parallel = false;
+
+/* Reads a steady clock (unit: milliseconds). */
+static double nowMs() {
+    auto t = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration<double, std::milli>(t).count();
+}
+
+/* Appends a shader's or program's info log to a log. */
+static void appendLog(GLuint object, bool program, std::string &log) {
+    GLint length = 0;
+    if (program) {
+        glGetProgramiv(object, GL_INFO_LOG_LENGTH, &length);
+    } else {
+        glGetShaderiv(object, GL_INFO_LOG_LENGTH, &length);
+    }
+    if (length <= 1) {
+        return;
+    }
+    std::vector<GLchar> text(length);
+    if (program) {
+        glGetProgramInfoLog(object, length, NULL, text.data());
+    } else {
+        glGetShaderInfoLog(object, length, NULL, text.data());
+    }
+    log += text.data();
+}
+
+Build::Build() {
+    _res = nullptr;
+    _program = 0;
+    _linked = false;
+    _done = false;
+    _startMs = 0.0;
+    _ms = 0.0;
+}
+
+Build::~Build() {
+    cancel();
+}
+
+void Build::_dropShaders() {
+    for (gpuLib::ResHandle shader : _shaders) {
+        glDetachShader(_program, _res->name(shader));
+        _res->release(shader);
+    }
+    _shaders.clear();
+}
+
+void Build::start(gpuLib::Res &res) {
+    cancel();
+    _res = &res;
+    _programRes = _res->create(gpuLib::resProgram);
+    _program = _res->name(_programRes);
+    _linked = false;
+    _done = false;
+    _startMs = nowMs();
+}
+
+void Build::add(GLenum type, std::string const &text) {
+    gpuLib::ResHandle shaderRes = _res->create(gpuLib::resShader, type);
+    GLuint shader = _res->name(shaderRes);
+    GLchar const *glText = text.c_str();
+    GLint length = (GLint)text.size();
+    glShaderSource(shader, 1, &glText, &length);
+    glCompileShader(shader);
+    glAttachShader(_program, shader);
+    _shaders.push_back(shaderRes);
+}
+
+void Build::link() {
+    glLinkProgram(_program);
+    _linked = true;
+}
+
+bool Build::active() {
+    return _program != 0;
+}
+
+bool Build::done() {
+    if (_program == 0 or !_linked) {
+        return false;
+    }
+    GLint result = GL_TRUE;
+    if (parallel) {
+        glGetProgramiv(_program, GL_COMPLETION_STATUS_KHR, &result);
+    }
+    if (result == GL_TRUE and !_done) {
+        _ms = nowMs() - _startMs;
+        _done = true;
+    }
+    return result == GL_TRUE;
+}
+
+bool Build::ok() {
+    GLint result = 0;
+    glGetProgramiv(_program, GL_LINK_STATUS, &result);
+    if (result != 0) {
+        return true;
+    }
+
+    _log.clear();
+    for (gpuLib::ResHandle shader : _shaders) {
+        appendLog(_res->name(shader), false, _log);
+    }
+    appendLog(_program, true, _log);
+    cancel();
+    return false;
+}
+
+GLuint Build::take() {
+    _dropShaders();
+    GLuint program = _program;
+    _program = 0;
+    return program;
+}
+
+void Build::cancel() {
+    if (_program == 0) {
+        return;
+    }
+    _dropShaders();
+    _res->release(_programRes);
+    _program = 0;
+}
+
+double Build::ms() {
+    return _ms;
+}
+
+std::string const &Build::log() {
+    return _log;
+}
+
+bool buildParallel() {
+    // Both extensions share the function and the status query's value
+    if (GLEW_KHR_parallel_shader_compile) {
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+        parallel = true;
+    } else if (GLEW_ARB_parallel_shader_compile) {
+        glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+        parallel = true;
+    }
+    return parallel;
+}
+
+}  // namespace shaderLib
@@ -0,0 +1,100 @@
+/* File name: build.hpp
+ *
+ * Intro:
+ * C++ header of the shader libraries' build (Program build) module.
+ * A program build compiles and links a shader program without waiting for
+ * the driver. With KHR_parallel_shader_compile, the driver compiles on its
+ * own threads, and the build is polled for completion once per frame, so the
+ * frames keep going with the old program meanwhile. The build is only taken
+ * once it has linked; a failed build keeps its logs and leaves the old
+ * program in use. Without the extension, the first status query waits for
+ * the driver instead. The shaders and the program are objects of a resource
+ * manager; the taken program stays in the manager, and is found there by its
+ * name to be released.
+ *
+ * Dependencies:
+ * 1. GLEW library (libglew-dev); KHR_parallel_shader_compile (or
+ *    ARB_parallel_shader_compile) for builds that do not stall
+ * 2. The gpu libraries' res module (../gpu/res.hpp) */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#ifndef SHADER__BUILD_HPP
+#define SHADER__BUILD_HPP
+
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "../gpu/res.hpp"
+
+/* Shader library */
+namespace shaderLib {
+
+/* (Program) build. */
+class Build {
+   private:
+    /* Resource manager of the build (nullptr before the first start). */
+    gpuLib::Res *_res;
+    /* Program being built (0 if there is no build), and its handle. */
+    GLuint _program;
+    gpuLib::ResHandle _programRes;
+    /* Shaders attached to the program. */
+    std::vector<gpuLib::ResHandle> _shaders;
+    /* Whether the link has been issued. */
+    bool _linked;
+    /* Whether the driver has been seen to finish the build. */
+    bool _done;
+    /* Build start time (unit: milliseconds, of a steady clock). */
+    double _startMs;
+    /* Time from the start to completion (unit: milliseconds). */
+    double _ms;
+    /* Compile and link logs of the last failed build. */
+    std::string _log;
+
+    /* Detaches and releases the shaders. */
+    void _dropShaders();
+
+   public:
+    /* Constructs an idle build. */
+    Build();
+    /* Destructs the build, releasing the program it has not given away. */
+    ~Build();
+    /* Starts a new build with objects of a resource manager, dropping any
+     * unfinished one. */
+    void start(gpuLib::Res &res);
+    /* Adds a shader of the specified type (GL_VERTEX_SHADER, ...) and issues
+     * its compilation. */
+    void add(GLenum type, std::string const &text);
+    /* Issues the link; the shaders' statuses are not waited for. */
+    void link();
+    /* Finds whether a build has been started and not yet taken or
+     * cancelled. */
+    bool active();
+    /* Finds whether the driver has finished the build (without waiting for
+     * it if parallel compilation is on). */
+    bool done();
+    /* Finds whether the finished build linked. On failure, the logs are kept,
+     * and the program is released. */
+    bool ok();
+    /* Takes the linked program (detaching and releasing its shaders); the
+     * build becomes idle. */
+    GLuint take();
+    /* Drops the build. */
+    void cancel();
+    /* Reads the time the last finished build took (unit: milliseconds). */
+    double ms();
+    /* Reads the compile and link logs of the last failed build. */
+    std::string const &log();
+};
+
+/* Turns on parallel shader compilation if the GL context supports it (after
+ * GLEW is initialized); returns whether it does. */
+bool buildParallel();
+
+}  // namespace shaderLib
+
+// SHADER__BUILD_HPP
+#endif
@@ -0,0 +1,108 @@
+/* File name: cache.cpp
+ *
+ * Intro:
+ * C++ implementation of the shader libraries' cache (Program cache)
+ * module. */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#include "cache.hpp"
+
+#include <chrono>
+
+#include "build.hpp"
+#include "embed.hpp"
+
+namespace shaderLib {
+
+/* Reads a steady clock (unit: milliseconds). */
+static double nowMs() {
+    auto t = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration<double, std::milli>(t).count();
+}
+
+Cache::Cache(gpuLib::Res &res) : _res(res) {
+    _stats.programs = 0;
+    _stats.hits = 0;
+    _stats.misses = 0;
+    _stats.failures = 0;
+    _stats.compileMs = 0.0;
+}
+
+uint64_t Cache::key(std::vector<Source> const &sources) {
+    uint64_t hash = embedHash(nullptr, 0);
+    for (Source const &source : sources) {
+        hash = embedHash(&source.type, sizeof(source.type), hash);
+        hash = embedHash(&source.hash, sizeof(source.hash), hash);
+    }
+    return hash;
+}
+
+GLuint Cache::find(std::vector<Source> const &sources) {
+    auto found = _programs.find(key(sources));
+    if (found == _programs.end()) {
+        return 0;
+    }
+    _stats.hits += 1;
+    return found->second;
+}
+
+GLuint Cache::program(std::vector<Source> const &sources) {
+    GLuint program = find(sources);
+    if (program != 0) {
+        return program;
+    }
+
+    _stats.misses += 1;
+    double start = nowMs();
+    Build build;
+    build.start(_res);
+    for (Source const &source : sources) {
+        build.add(source.type, source.text);
+    }
+    build.link();
+    // The link status waits for the driver
+    bool ok = build.ok();
+    _stats.compileMs += nowMs() - start;
+    if (!ok) {
+        _stats.failures += 1;
+        _log = build.log();
+        return 0;
+    }
+
+    program = build.take();
+    _programs[key(sources)] = program;
+    return program;
+}
+
+void Cache::put(std::vector<Source> const &sources, GLuint program) {
+    GLuint &slot = _programs[key(sources)];
+    if (slot != 0 and slot != program) {
+        _res.release(_res.find(gpuLib::resProgram, slot));
+    }
+    slot = program;
+}
+
+void Cache::drop(GLuint program) {
+    for (auto it = _programs.begin(); it != _programs.end();) {
+        if (it->second == program) {
+            it = _programs.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    _res.release(_res.find(gpuLib::resProgram, program));
+}
+
+std::string const &Cache::log() {
+    return _log;
+}
+
+CacheStats Cache::stats() {
+    CacheStats result = _stats;
+    result.programs = (int)_programs.size();
+    return result;
+}
+
+}  // namespace shaderLib
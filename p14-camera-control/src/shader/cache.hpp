@@ -0,0 +1,94 @@
+/* File name: cache.hpp
+ *
+ * Intro:
+ * C++ header of the shader libraries' cache (Program cache) module.
+ * Linked programs are kept by the hashes of their stages' sources, each
+ * found by the preprocessor from its files' hashes and its defines (see
+ * pre.hpp), so each variant of a program is compiled once and shared by
+ * everything that asks for it, and no text is hashed at load time. The cache
+ * owns its programs, as objects of a resource manager, so a dropped program
+ * is deleted once the GPU is done with it.
+ *
+ * Dependencies:
+ * 1. GLEW library (libglew-dev)
+ * 2. The shader libraries' build module (build.hpp)
+ * 3. The shader libraries' embed module (embed.hpp)
+ * 4. The gpu libraries' res module (../gpu/res.hpp) */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#ifndef SHADER__CACHE_HPP
+#define SHADER__CACHE_HPP
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "../gpu/res.hpp"
+
+/* Shader library */
+namespace shaderLib {
+
+/* Shader source (expanded text) of a program stage. */
+struct Source {
+    /* Shader type (GL_VERTEX_SHADER, ...). */
+    GLenum type;
+    std::string text;
+    /* Hash of the text (Pre::hash). */
+    uint64_t hash;
+};
+
+/* Program cache statistics. */
+struct CacheStats {
+    /* Cached programs. */
+    int programs;
+    /* Requests served from the cache. */
+    long hits;
+    /* Requests that compiled a program. */
+    long misses;
+    /* Compilations that failed. */
+    int failures;
+    /* Total compile and link time of the misses (unit: milliseconds). */
+    double compileMs;
+};
+
+/* (Program) cache. */
+class Cache {
+   private:
+    gpuLib::Res &_res;
+    /* Programs by key. */
+    std::unordered_map<uint64_t, GLuint> _programs;
+    CacheStats _stats;
+    /* Compile and link logs of the last failure. */
+    std::string _log;
+
+   public:
+    /* Constructs an empty cache of programs of a resource manager. */
+    Cache(gpuLib::Res &res);
+    /* Finds the key of a program's sources. */
+    static uint64_t key(std::vector<Source> const &sources);
+    /* Finds a cached program; returns 0 if it is not cached. Counts a hit if
+     * it is cached. */
+    GLuint find(std::vector<Source> const &sources);
+    /* Finds a cached program, or compiles, links, and caches it; returns 0 if
+     * it does not compile or link (see log). */
+    GLuint program(std::vector<Source> const &sources);
+    /* Caches a program built elsewhere (replacing the program of the same
+     * sources, if any). */
+    void put(std::vector<Source> const &sources, GLuint program);
+    /* Releases a cached program. */
+    void drop(GLuint program);
+    /* Reads the compile and link logs of the last failure. */
+    std::string const &log();
+    /* Reads the statistics. */
+    CacheStats stats();
+};
+
+}  // namespace shaderLib
+
+// SHADER__CACHE_HPP
+#endif
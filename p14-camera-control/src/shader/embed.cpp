@@ -0,0 +1,28 @@
+/* File name: embed.cpp
+ *
+ * Intro:
+ * C++ implementation of the shader libraries' embed (Embedded shaders)
+ * module. */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#include "embed.hpp"
+
+#include <cstring>
+
+namespace shaderLib {
+
+Embed const *embedFind(Embed const *table, int count, char const *name) {
+    if (strncmp(name, "./", 2) == 0) {
+        name += 2;
+    }
+    for (int i = 0; i < count; i += 1) {
+        if (strcmp(table[i].name, name) == 0) {
+            return &table[i];
+        }
+    }
+    return nullptr;
+}
+
+}  // namespace shaderLib
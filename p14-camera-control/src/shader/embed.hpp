@@ -0,0 +1,55 @@
+/* File name: embed.hpp
+ *
+ * Intro:
+ * C++ header of the shader libraries' embed (Embedded shaders) module.
+ * The shader files are embedded into the program at build time: shaders.x
+ * (see ../shaders.hpp) generates the table below as constexpr arrays, with the
+ * files' lengths and hashes worked out ahead, so loading a program reads no
+ * files and measures no strings. The preprocessor (pre.hpp) reads the
+ * embedded files unless it is told to read the disk. */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#ifndef SHADER__EMBED_HPP
+#define SHADER__EMBED_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+/* Shader library */
+namespace shaderLib {
+
+/* Embedded shader file. */
+struct Embed {
+    /* File name (as given to shaders.x). */
+    char const *name;
+    char const *text;
+    /* Text length (unit: bytes). */
+    size_t length;
+    /* Text hash (see embedHash). */
+    uint64_t hash;
+};
+
+/* The embedded files (generated by shaders.x into the object directory). */
+extern Embed const embeds[];
+extern int const embedCount;
+
+/* Finds the 64-bit FNV-1a hash of some bytes, continuing from hash. */
+inline uint64_t embedHash(void const *data, size_t size,
+                          uint64_t hash = 0xcbf29ce484222325ull) {
+    unsigned char const *bytes = (unsigned char const *)data;
+    for (size_t i = 0; i < size; i += 1) {
+        hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
+/* Finds an embedded file by name (a leading "./" is ignored); returns
+ * nullptr if it is not embedded. */
+Embed const *embedFind(Embed const *table, int count, char const *name);
+
+}  // namespace shaderLib
+
+// SHADER__EMBED_HPP
+#endif
@@ -0,0 +1,244 @@
+/* File name: pre.cpp
+ *
+ * Intro:
+ * C++ implementation of the shader libraries' pre (Preprocessor) module. */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#include "pre.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace shaderLib {
+
+/* Deepest include nesting (deeper means an include cycle). */
+static int const maxDepth = 32;
+
+/* Finds whether a line is a directive; finds the text after it. */
+static bool isDirective(std::string const &line, char const *name,
+                        std::string &rest) {
+    size_t at = line.find_first_not_of(" \t");
+    if (at == std::string::npos or line[at] != '#') {
+        return false;
+    }
+    at = line.find_first_not_of(" \t", at + 1);
+    size_t nameLen = std::char_traits<char>::length(name);
+    if (at == std::string::npos or line.compare(at, nameLen, name) != 0) {
+        return false;
+    }
+    rest = line.substr(at + nameLen);
+    return true;
+}
+
+Pre::Pre() {
+    _hash = 0;
+    _embeds = nullptr;
+    _embedCount = 0;
+    _disk = true;
+    _lineNext = false;
+}
+
+void Pre::embeds(Embed const *table, int count) {
+    _embeds = table;
+    _embedCount = count;
+    _disk = false;
+}
+
+bool Pre::disk() {
+    return _disk;
+}
+
+bool Pre::disk(bool newVal) {
+    bool oldVal = _disk;
+    _disk = newVal;
+    return oldVal;
+}
+
+void Pre::define(char const *name, char const *value) {
+    for (auto &define : _defines) {
+        if (define.first == name) {
+            define.second = value;
+            return;
+        }
+    }
+    _defines.push_back(std::make_pair(std::string(name), std::string(value)));
+    std::sort(_defines.begin(), _defines.end());
+}
+
+void Pre::undef(char const *name) {
+    for (size_t i = 0; i < _defines.size(); i += 1) {
+        if (_defines[i].first == name) {
+            _defines.erase(_defines.begin() + i);
+            return;
+        }
+    }
+}
+
+void Pre::clear() {
+    _defines.clear();
+}
+
+std::string Pre::key() {
+    std::string result;
+    for (auto &define : _defines) {
+        result += define.first + "=" + define.second + ";";
+    }
+    return result;
+}
+
+bool Pre::expand(char const *path, std::string &result) {
+    _files.clear();
+    _error.clear();
+    result.clear();
+    _hash = embedHash(nullptr, 0);
+    if (!_expand(path, 0, result)) {
+        return false;
+    }
+    std::string defines = key();
+    _hash = embedHash(defines.data(), defines.size(), _hash);
+    return true;
+}
+
+uint64_t Pre::hash() {
+    return _hash;
+}
+
+std::vector<std::string> const &Pre::files() {
+    return _files;
+}
+
+std::string const &Pre::error() {
+    return _error;
+}
+
+void Pre::_addDefines(std::string &result) {
+    for (auto &define : _defines) {
+        result += "#define " + define.first + " " + define.second + "\n";
+    }
+}
+
+std::string Pre::_line(int line, int index) {
+    int number = _lineNext ? line : line - 1;
+    return "#line " + std::to_string(number) + " " + std::to_string(index) +
+           "\n";
+}
+
+bool Pre::_read(std::string const &path, std::string &storage,
+               char const *&text, size_t &length, uint64_t &hash) {
+    Embed const *embed = nullptr;
+    if (!_disk) {
+        embed = embedFind(_embeds, _embedCount, path.c_str());
+    }
+    if (embed != nullptr) {
+        text = embed->text;
+        length = embed->length;
+        hash = embed->hash;
+        return true;
+    }
+
+    std::fstream file;
+    file.open(path, std::ios::in | std::ios::binary);
+    if (!file.is_open()) {
+        _error = "reading file: " + path;
+        return false;
+    }
+    storage.assign(std::istreambuf_iterator<char>(file),
+                   std::istreambuf_iterator<char>());
+    text = storage.data();
+    length = storage.size();
+    hash = embedHash(text, length);
+    return true;
+}
+
+bool Pre::_expand(std::string const &path, int depth, std::string &result) {
+    if (depth > maxDepth) {
+        _error = "includes nested too deep (a cycle?): " + path;
+        return false;
+    }
+    if (std::find(_files.begin(), _files.end(), path) != _files.end()) {
+        return true;
+    }
+
+    std::string storage;
+    char const *text;
+    size_t length;
+    uint64_t fileHash;
+    if (!_read(path, storage, text, length, fileHash)) {
+        return false;
+    }
+    _hash = embedHash(&fileHash, sizeof(fileHash), _hash);
+    std::vector<std::string> lines;
+    size_t begin = 0;
+    while (begin < length) {
+        char const *end = (char const *)memchr(text + begin, '\n',
+                                               length - begin);
+        size_t lineEnd = end == nullptr ? length : end - text;
+        lines.push_back(std::string(text + begin, lineEnd - begin));
+        begin = lineEnd + 1;
+    }
+    int index = (int)_files.size();
+    _files.push_back(path);
+
+    std::string dir;
+    size_t slash = path.rfind('/');
+    if (slash != std::string::npos) {
+        dir = path.substr(0, slash + 1);
+    }
+    std::string rest;
+    bool hasVersion = false;
+    if (depth == 0) {
+        // Without #version, the shader is GLSL 1.10
+        _lineNext = false;
+        for (std::string const &line : lines) {
+            if (!hasVersion and isDirective(line, "version", rest)) {
+                hasVersion = true;
+                int version = atoi(rest.c_str());
+                bool es = rest.find("es") != std::string::npos;
+                _lineNext = version >= 330 or (es and version >= 300);
+            }
+        }
+    }
+    // Nothing but comments may come before #version
+    if (depth != 0) {
+        result += _line(1, index);
+    } else if (!hasVersion) {
+        _addDefines(result);
+        result += _line(1, 0);
+    }
+
+    for (size_t i = 0; i < lines.size(); i += 1) {
+        std::string next = _line((int)i + 2, index);
+        if (isDirective(lines[i], "include", rest)) {
+            size_t open = rest.find('"');
+            size_t close = rest.find('"', open + 1);
+            bool ok = open != std::string::npos and
+                      close != std::string::npos and close > open + 1;
+            if (!ok) {
+                _error = path + ":" + std::to_string(i + 1) +
+                         ": bad #include" + rest;
+                return false;
+            }
+            std::string name = rest.substr(open + 1, close - open - 1);
+            std::string incPath = name[0] == '/' ? name : dir + name;
+            if (!_expand(incPath, depth + 1, result)) {
+                return false;
+            }
+            result += next;
+            continue;
+        }
+
+        result += lines[i] + "\n";
+        if (depth == 0 and isDirective(lines[i], "version", rest)) {
+            _addDefines(result);
+            result += next;
+        }
+    }
+    return true;
+}
+
+}  // namespace shaderLib
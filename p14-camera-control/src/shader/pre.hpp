@@ -0,0 +1,101 @@
+/* File name: pre.hpp
+ *
+ * Intro:
+ * C++ header of the shader libraries' pre (Preprocessor) module.
+ * A shader file is expanded into one shader text before it is compiled.
+ * #include "name" lines are replaced by the named file (relative to the
+ * including file), each file at most once per text, as if all of them had
+ * #pragma once. The injected defines go right after the #version line (or
+ * first if there is none), so a variant is one file expanded with one set of
+ * defines. #line directives keep the driver's messages on the files' own
+ * lines, with the source string number being the file's index in files();
+ * they are numbered for the top file's #version, as GLSL 3.30 changed
+ * "#line N" from numbering the next line N + 1 to numbering it N.
+ * The other preprocessing is left to the driver. The files are read from the
+ * embedded shaders (see embed.hpp) when they are there, unless the disk is
+ * asked for, as hot reloading does.
+ *
+ * Dependencies:
+ * 1. The shader libraries' embed module (embed.hpp) */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#ifndef SHADER__PRE_HPP
+#define SHADER__PRE_HPP
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "embed.hpp"
+
+/* Shader library */
+namespace shaderLib {
+
+/* Pre (Preprocessor). */
+class Pre {
+   private:
+    /* Injected defines (name, value), in name order. */
+    std::vector<std::pair<std::string, std::string>> _defines;
+    /* Files read by the last expansion. */
+    std::vector<std::string> _files;
+    /* Error of the last expansion. */
+    std::string _error;
+    /* Hash of the last expansion. */
+    uint64_t _hash;
+    /* Embedded files. */
+    Embed const *_embeds;
+    int _embedCount;
+    /* Whether the files are read from the disk (not the embedded ones). */
+    bool _disk;
+    /* Whether "#line N" numbers the next line N (GLSL 3.30, GLSL ES 3.00,
+     * and later), not N + 1; found from the top file's #version. */
+    bool _lineNext;
+    /* Reads a file; finds its text, length, and hash. A file read from the
+     * disk is kept in storage. */
+    bool _read(std::string const &path, std::string &storage,
+               char const *&text, size_t &length, uint64_t &hash);
+    /* Expands a file into result; depth: the include depth. */
+    bool _expand(std::string const &path, int depth, std::string &result);
+    /* Appends the defines to result. */
+    void _addDefines(std::string &result);
+    /* Finds the #line directive that numbers the next line line (from 1) of
+     * the file index. */
+    std::string _line(int line, int index);
+
+   public:
+    /* Constructs a preprocessor with no defines that reads the disk. */
+    Pre();
+    /* Reads the files from a table of embedded files when they are there;
+     * turns off reading the disk. */
+    void embeds(Embed const *table, int count);
+    /* Reads whether the files are read from the disk. */
+    bool disk();
+    /* Reads and updates whether the files are read from the disk (instead of
+     * the embedded ones). */
+    bool disk(bool newVal);
+    /* Injects a define (replacing one of the same name). */
+    void define(char const *name, char const *value = "1");
+    /* Removes a define. */
+    void undef(char const *name);
+    /* Removes all defines. */
+    void clear();
+    /* Finds the variant key: the defines as "NAME=VALUE;...", in name
+     * order. */
+    std::string key();
+    /* Expands a shader file into result; returns false on errors. */
+    bool expand(char const *path, std::string &result);
+    /* Reads the hash of the last expansion: of its files' hashes, in order,
+     * and its defines. Equal hashes mean equal texts. */
+    uint64_t hash();
+    /* Reads the files read by the last expansion (the top file first). */
+    std::vector<std::string> const &files();
+    /* Reads the error of the last expansion. */
+    std::string const &error();
+};
+
+}  // namespace shaderLib
+
+// SHADER__PRE_HPP
+#endif
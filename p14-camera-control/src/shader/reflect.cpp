@@ -0,0 +1,307 @@
+/* File name: reflect.cpp
+ *
+ * Intro:
+ * C++ implementation of the shader libraries' reflect (Program reflection)
+ * module. */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#include "reflect.hpp"
+
+/* Finds the size of a uniform's value of a GL type (unit: bytes). */
+static size_t typeBytes(GLenum type) {
+    switch (type) {
+        case GL_FLOAT_VEC2:
+        case GL_INT_VEC2:
+        case GL_UNSIGNED_INT_VEC2:
+            return 8;
+        case GL_FLOAT_VEC3:
+        case GL_INT_VEC3:
+        case GL_UNSIGNED_INT_VEC3:
+            return 12;
+        case GL_FLOAT_VEC4:
+        case GL_INT_VEC4:
+        case GL_UNSIGNED_INT_VEC4:
+        case GL_FLOAT_MAT2:
+            return 16;
+        case GL_FLOAT_MAT3:
+            return 36;
+        case GL_FLOAT_MAT4:
+            return 64;
+        default:
+            // Scalars, booleans, samplers, and images
+            return 4;
+    }
+}
+
+/* Adds a resource to a table by name (without an array's "[0]"). */
+template <class T>
+static T &addNamed(std::vector<T> &table, std::string name) {
+    size_t bracket = name.find('[');
+    if (bracket != std::string::npos) {
+        name.resize(bracket);
+    }
+    table.emplace_back();
+    table.back().name = name;
+    table.back().hash = shaderLib::reflectHash(name.c_str());
+    return table.back();
+}
+
+/* Sorts a table by hash; returns false if two names share a hash. */
+template <class T>
+static bool sortByHash(std::vector<T> &table) {
+    std::sort(table.begin(), table.end(), [](T const &a, T const &b) {
+        return a.hash < b.hash;
+    });
+    for (size_t i = 1; i < table.size(); i += 1) {
+        if (table[i - 1].hash == table[i].hash) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Finds a resource of a table sorted by hash; returns nullptr if there is
+ * none. */
+template <class T>
+static T const *findByHash(std::vector<T> const &table, uint32_t hash) {
+    auto it = std::lower_bound(
+        table.begin(), table.end(), hash,
+        [](T const &a, uint32_t hash) { return a.hash < hash; });
+    if (it == table.end() or it->hash != hash) {
+        return nullptr;
+    }
+    return &*it;
+}
+
+/* Reads the name of a resource of a program interface. */
+static std::string resourceName(GLuint program, GLenum iface, GLuint index,
+                                GLint length) {
+    std::vector<char> name(length + 1, 0);
+    glGetProgramResourceName(program, iface, index, length + 1, nullptr,
+                             name.data());
+    return std::string(name.data());
+}
+
+namespace shaderLib {
+
+bool ReflectType<int>::fits(GLenum type) {
+    switch (type) {
+        case GL_INT:
+        case GL_BOOL:
+        case GL_SAMPLER_2D:
+        case GL_SAMPLER_3D:
+        case GL_SAMPLER_CUBE:
+        case GL_SAMPLER_2D_ARRAY:
+        case GL_SAMPLER_2D_SHADOW:
+        case GL_IMAGE_2D:
+            return true;
+        default:
+            return false;
+    }
+}
+
+Reflect::Reflect() {
+    _program = 0;
+    _stats.uniforms = 0;
+    _stats.inputs = 0;
+    _stats.blocks = 0;
+    _stats.uploads = 0;
+    _stats.skipped = 0;
+}
+
+void Reflect::_queryInterfaces() {
+    GLint count = 0;
+    glGetProgramInterfaceiv(_program, GL_UNIFORM, GL_ACTIVE_RESOURCES, &count);
+    GLenum const uniformProps[] = {GL_NAME_LENGTH, GL_TYPE, GL_LOCATION,
+                                   GL_ARRAY_SIZE, GL_BLOCK_INDEX};
+    for (GLint i = 0; i < count; i += 1) {
+        GLint values[5];
+        // clang-format off
+        glGetProgramResourceiv(
+            _program, GL_UNIFORM, i, 5, uniformProps, 5, nullptr, values
+        );
+        // clang-format on
+        // Block members and atomic counters have no locations
+        if (values[4] != -1 or values[2] < 0) {
+            continue;
+        }
+        std::string name = resourceName(_program, GL_UNIFORM, i, values[0]);
+        ReflectVar &var = addNamed(_uniforms, name);
+        var.type = values[1];
+        var.location = values[2];
+        var.size = values[3];
+    }
+
+    glGetProgramInterfaceiv(_program, GL_PROGRAM_INPUT, GL_ACTIVE_RESOURCES,
+                            &count);
+    GLenum const inputProps[] = {GL_NAME_LENGTH, GL_TYPE, GL_LOCATION,
+                                 GL_ARRAY_SIZE};
+    for (GLint i = 0; i < count; i += 1) {
+        GLint values[4];
+        // clang-format off
+        glGetProgramResourceiv(
+            _program, GL_PROGRAM_INPUT, i, 4, inputProps, 4, nullptr, values
+        );
+        // clang-format on
+        std::string name =
+            resourceName(_program, GL_PROGRAM_INPUT, i, values[0]);
+        if (name.compare(0, 3, "gl_") == 0) {
+            continue;
+        }
+        ReflectVar &var = addNamed(_inputs, name);
+        var.type = values[1];
+        var.location = values[2];
+        var.size = values[3];
+    }
+
+    GLenum const kinds[] = {GL_UNIFORM_BLOCK, GL_SHADER_STORAGE_BLOCK};
+    GLenum const blockProps[] = {GL_NAME_LENGTH, GL_BUFFER_BINDING,
+                                 GL_BUFFER_DATA_SIZE};
+    for (GLenum kind : kinds) {
+        glGetProgramInterfaceiv(_program, kind, GL_ACTIVE_RESOURCES, &count);
+        for (GLint i = 0; i < count; i += 1) {
+            GLint values[3];
+            // clang-format off
+            glGetProgramResourceiv(
+                _program, kind, i, 3, blockProps, 3, nullptr, values
+            );
+            // clang-format on
+            std::string name = resourceName(_program, kind, i, values[0]);
+            ReflectBlock &block = addNamed(_blocks, name);
+            block.kind = kind;
+            block.binding = values[1];
+            block.bytes = values[2];
+        }
+    }
+}
+
+void Reflect::_queryActive() {
+    GLint count = 0;
+    GLint maxLength = 0;
+    glGetProgramiv(_program, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(_program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+    std::vector<char> name(maxLength + 1, 0);
+    for (GLint i = 0; i < count; i += 1) {
+        GLint size = 0;
+        GLenum type = 0;
+        // clang-format off
+        glGetActiveUniform(
+            _program, i, maxLength + 1, nullptr, &size, &type, name.data()
+        );
+        // clang-format on
+        GLint location = glGetUniformLocation(_program, name.data());
+        if (location < 0) {
+            continue;
+        }
+        ReflectVar &var = addNamed(_uniforms, name.data());
+        var.type = type;
+        var.location = location;
+        var.size = size;
+    }
+
+    glGetProgramiv(_program, GL_ACTIVE_ATTRIBUTES, &count);
+    glGetProgramiv(_program, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxLength);
+    name.assign(maxLength + 1, 0);
+    for (GLint i = 0; i < count; i += 1) {
+        GLint size = 0;
+        GLenum type = 0;
+        // clang-format off
+        glGetActiveAttrib(
+            _program, i, maxLength + 1, nullptr, &size, &type, name.data()
+        );
+        // clang-format on
+        if (strncmp(name.data(), "gl_", 3) == 0) {
+            continue;
+        }
+        ReflectVar &var = addNamed(_inputs, name.data());
+        var.type = type;
+        var.location = glGetAttribLocation(_program, name.data());
+        var.size = size;
+    }
+
+    // Storage blocks need the interface queries; uniform blocks are GL 3.1
+    glGetProgramiv(_program, GL_ACTIVE_UNIFORM_BLOCKS, &count);
+    glGetProgramiv(_program, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH,
+                   &maxLength);
+    name.assign(maxLength + 1, 0);
+    for (GLint i = 0; i < count; i += 1) {
+        glGetActiveUniformBlockName(_program, i, maxLength + 1, nullptr,
+                                    name.data());
+        ReflectBlock &block = addNamed(_blocks, name.data());
+        block.kind = GL_UNIFORM_BLOCK;
+        glGetActiveUniformBlockiv(_program, i, GL_UNIFORM_BLOCK_BINDING,
+                                  &block.binding);
+        glGetActiveUniformBlockiv(_program, i, GL_UNIFORM_BLOCK_DATA_SIZE,
+                                  &block.bytes);
+    }
+}
+
+bool Reflect::load(GLuint program) {
+    _program = program;
+    _uniforms.clear();
+    _inputs.clear();
+    _blocks.clear();
+    if (GLEW_VERSION_4_3 or GLEW_ARB_program_interface_query) {
+        _queryInterfaces();
+    } else {
+        _queryActive();
+    }
+    bool apart = sortByHash(_uniforms);
+    apart = sortByHash(_inputs) and apart;
+    apart = sortByHash(_blocks) and apart;
+
+    // Nothing is cached until it is uploaded
+    _offsets.resize(_uniforms.size());
+    size_t total = 0;
+    for (size_t i = 0; i < _uniforms.size(); i += 1) {
+        _offsets[i] = total;
+        total += typeBytes(_uniforms[i].type) * _uniforms[i].size;
+    }
+    _values.assign(total, 0);
+    _known.assign(_uniforms.size(), 0);
+
+    _stats.uniforms = (int)_uniforms.size();
+    _stats.inputs = (int)_inputs.size();
+    _stats.blocks = (int)_blocks.size();
+    return apart;
+}
+
+GLuint Reflect::program() {
+    return _program;
+}
+
+std::vector<ReflectVar> const &Reflect::uniforms() {
+    return _uniforms;
+}
+
+std::vector<ReflectVar> const &Reflect::inputs() {
+    return _inputs;
+}
+
+std::vector<ReflectBlock> const &Reflect::blocks() {
+    return _blocks;
+}
+
+ReflectVar const *Reflect::uniform(uint32_t hash) {
+    return findByHash(_uniforms, hash);
+}
+
+ReflectVar const *Reflect::input(uint32_t hash) {
+    return findByHash(_inputs, hash);
+}
+
+ReflectBlock const *Reflect::block(uint32_t hash) {
+    return findByHash(_blocks, hash);
+}
+
+void Reflect::invalidate() {
+    _known.assign(_known.size(), 0);
+}
+
+ReflectStats Reflect::stats() {
+    return _stats;
+}
+
+}  // namespace shaderLib
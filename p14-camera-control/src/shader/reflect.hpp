@@ -0,0 +1,275 @@
+/* File name: reflect.hpp
+ *
+ * Intro:
+ * C++ header of the shader libraries' reflect (Program reflection) module.
+ * A linked program's active uniforms, inputs (vertex attributes), and
+ * uniform and storage blocks are enumerated once, with the program interface
+ * queries where they are supported, into tables sorted by the names' hashes.
+ * The names are hashed at compile time (reflectHash), so code binds a typed
+ * uniform handle by hash and no strings are compared or looked up per frame.
+ * Uploads through the handles go through a cache of the uniforms' values and
+ * skip the values that did not change.
+ *
+ * Dependencies:
+ * 1. GLEW library (libglew-dev)
+ * 2. GLM library (libglm-dev) */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#ifndef SHADER__REFLECT_HPP
+#define SHADER__REFLECT_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <glm/ext.hpp>
+
+/* Shader library */
+namespace shaderLib {
+
+/* Finds the 32-bit FNV-1a hash of a name, at compile time for literals. */
+constexpr uint32_t reflectHash(char const *name,
+                               uint32_t hash = 2166136261u) {
+    return *name == 0 ? hash
+                      : reflectHash(name + 1, (hash ^ (unsigned char)*name) *
+                                                  16777619u);
+}
+
+/* Active uniform or input of a program. */
+struct ReflectVar {
+    /* Name (without an array's "[0]"). */
+    std::string name;
+    /* Hash of the name (reflectHash). */
+    uint32_t hash;
+    /* GL type (GL_FLOAT_VEC3, ...). */
+    GLenum type;
+    /* Location. */
+    GLint location;
+    /* Array size (1 if not an array). */
+    int size;
+};
+
+/* Active uniform or storage block of a program. */
+struct ReflectBlock {
+    std::string name;
+    /* Hash of the name (reflectHash). */
+    uint32_t hash;
+    /* GL_UNIFORM_BLOCK or GL_SHADER_STORAGE_BLOCK. */
+    GLenum kind;
+    /* Binding point. */
+    GLint binding;
+    /* Data size (unit: bytes). */
+    GLint bytes;
+};
+
+/* Program reflection statistics. */
+struct ReflectStats {
+    int uniforms;
+    int inputs;
+    int blocks;
+    /* Uploads made through the handles. */
+    long uploads;
+    /* Uploads skipped because the value did not change. */
+    long skipped;
+};
+
+/* Value type of a uniform handle: the GL types it fits and its upload call.
+ * Specialized for the types the shaders use. */
+template <class T>
+struct ReflectType;
+
+template <>
+struct ReflectType<int> {
+    static bool fits(GLenum type);
+    static void upload(GLint location, int count, int const *values) {
+        glUniform1iv(location, count, values);
+    }
+};
+
+template <>
+struct ReflectType<unsigned> {
+    static bool fits(GLenum type) {
+        return type == GL_UNSIGNED_INT;
+    }
+    static void upload(GLint location, int count, unsigned const *values) {
+        glUniform1uiv(location, count, values);
+    }
+};
+
+template <>
+struct ReflectType<float> {
+    static bool fits(GLenum type) {
+        return type == GL_FLOAT;
+    }
+    static void upload(GLint location, int count, float const *values) {
+        glUniform1fv(location, count, values);
+    }
+};
+
+template <>
+struct ReflectType<glm::vec2> {
+    static bool fits(GLenum type) {
+        return type == GL_FLOAT_VEC2;
+    }
+    static void upload(GLint location, int count, glm::vec2 const *values) {
+        glUniform2fv(location, count, glm::value_ptr(values[0]));
+    }
+};
+
+template <>
+struct ReflectType<glm::vec3> {
+    static bool fits(GLenum type) {
+        return type == GL_FLOAT_VEC3;
+    }
+    static void upload(GLint location, int count, glm::vec3 const *values) {
+        glUniform3fv(location, count, glm::value_ptr(values[0]));
+    }
+};
+
+template <>
+struct ReflectType<glm::vec4> {
+    static bool fits(GLenum type) {
+        return type == GL_FLOAT_VEC4;
+    }
+    static void upload(GLint location, int count, glm::vec4 const *values) {
+        glUniform4fv(location, count, glm::value_ptr(values[0]));
+    }
+};
+
+template <>
+struct ReflectType<glm::ivec2> {
+    static bool fits(GLenum type) {
+        return type == GL_INT_VEC2;
+    }
+    static void upload(GLint location, int count, glm::ivec2 const *values) {
+        glUniform2iv(location, count, glm::value_ptr(values[0]));
+    }
+};
+
+template <>
+struct ReflectType<glm::mat4> {
+    static bool fits(GLenum type) {
+        return type == GL_FLOAT_MAT4;
+    }
+    static void upload(GLint location, int count, glm::mat4 const *values) {
+        glUniformMatrix4fv(location, count, GL_FALSE,
+                           glm::value_ptr(values[0]));
+    }
+};
+
+/* Typed handle of a uniform (of a Reflect). */
+template <class T>
+struct Uniform {
+    GLint location = -1;
+    /* Index of the uniform in its Reflect's table. */
+    int slot = -1;
+
+    /* Finds whether the handle is bound to a uniform. */
+    bool ok() const {
+        return slot >= 0;
+    }
+};
+
+/* (Program) reflection. */
+class Reflect {
+   private:
+    GLuint _program;
+    /* Active uniforms, inputs, and blocks, sorted by hash. */
+    std::vector<ReflectVar> _uniforms;
+    std::vector<ReflectVar> _inputs;
+    std::vector<ReflectBlock> _blocks;
+    /* Offsets of the uniforms' cached values in _values. */
+    std::vector<size_t> _offsets;
+    /* Cached values of the uniforms (as last uploaded). */
+    std::vector<unsigned char> _values;
+    /* Whether each uniform's cached value is known. */
+    std::vector<unsigned char> _known;
+    ReflectStats _stats;
+
+    /* Enumerates with the program interface queries (GL 4.3). */
+    void _queryInterfaces();
+    /* Enumerates with the older active uniform and attribute queries. */
+    void _queryActive();
+
+   public:
+    /* Constructs a reflection of no program. */
+    Reflect();
+    /* Enumerates the active resources of a linked program (dropping the
+     * cached values); returns false if two of their names share a hash. */
+    bool load(GLuint program);
+    /* Reads the reflected program. */
+    GLuint program();
+    /* Reads the active uniforms (outside blocks), inputs, and blocks. */
+    std::vector<ReflectVar> const &uniforms();
+    std::vector<ReflectVar> const &inputs();
+    std::vector<ReflectBlock> const &blocks();
+    /* Finds a uniform, input, or block by the hash of its name; returns
+     * nullptr if it is not active. */
+    ReflectVar const *uniform(uint32_t hash);
+    ReflectVar const *input(uint32_t hash);
+    ReflectBlock const *block(uint32_t hash);
+    /* Binds a typed handle to a uniform by the hash of its name; the handle
+     * is not ok if the uniform is not active or its type does not fit T. */
+    template <class T>
+    Uniform<T> bind(uint32_t hash);
+    /* Uploads a uniform's value unless it is the cached one. The program must
+     * be in use. */
+    template <class T>
+    void set(Uniform<T> handle, T const &value);
+    /* Uploads the first count elements of an array uniform unless they are
+     * the cached ones. The program must be in use. */
+    template <class T>
+    void set(Uniform<T> handle, T const *values, int count);
+    /* Forgets the cached values (after uploads made around the handles). */
+    void invalidate();
+    /* Reads the statistics. */
+    ReflectStats stats();
+};
+
+template <class T>
+Uniform<T> Reflect::bind(uint32_t hash) {
+    Uniform<T> handle;
+    ReflectVar const *var = uniform(hash);
+    if (var != nullptr and ReflectType<T>::fits(var->type)) {
+        handle.location = var->location;
+        handle.slot = (int)(var - _uniforms.data());
+    }
+    return handle;
+}
+
+template <class T>
+void Reflect::set(Uniform<T> handle, T const &value) {
+    set(handle, &value, 1);
+}
+
+template <class T>
+void Reflect::set(Uniform<T> handle, T const *values, int count) {
+    if (!handle.ok()) {
+        return;
+    }
+    count = std::min(count, _uniforms[handle.slot].size);
+    size_t bytes = sizeof(T) * count;
+    unsigned char *cached = &_values[_offsets[handle.slot]];
+    if (_known[handle.slot] and memcmp(cached, values, bytes) == 0) {
+        _stats.skipped += 1;
+        return;
+    }
+    memcpy(cached, values, bytes);
+    // A partial upload leaves the rest of an unknown array unknown
+    if (count == _uniforms[handle.slot].size) {
+        _known[handle.slot] = 1;
+    }
+    ReflectType<T>::upload(handle.location, count, values);
+    _stats.uploads += 1;
+}
+
+}  // namespace shaderLib
+
+// SHADER__REFLECT_HPP
+#endif
@@ -0,0 +1,93 @@
+/* File name: watch.cpp
+ *
+ * Intro:
+ * C++ implementation of the shader libraries' watch (File watch) module. */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#include "watch.hpp"
+
+#include <algorithm>
+
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace shaderLib {
+
+/* Events that leave a complete new file: a write ends, or a file is renamed
+ * into place. */
+static uint32_t const watchMask = IN_CLOSE_WRITE | IN_MOVED_TO;
+
+Watch::Watch() {
+    _fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+}
+
+Watch::~Watch() {
+    if (_fd >= 0) {
+        close(_fd);
+    }
+}
+
+bool Watch::ok() {
+    return _fd >= 0;
+}
+
+int Watch::add(char const *path) {
+    if (_fd < 0) {
+        return -1;
+    }
+
+    std::string dir = ".";
+    std::string name = path;
+    size_t slash = name.rfind('/');
+    if (slash != std::string::npos) {
+        dir = slash == 0 ? "/" : name.substr(0, slash);
+        name = name.substr(slash + 1);
+    }
+
+    // Watching a directory again returns its existing descriptor
+    int wd = inotify_add_watch(_fd, dir.c_str(), watchMask);
+    if (wd < 0) {
+        return -1;
+    }
+    File file;
+    file.wd = wd;
+    file.name = name;
+    _files.push_back(file);
+    return (int)_files.size() - 1;
+}
+
+void Watch::poll(std::vector<int> &changed) {
+    if (_fd < 0) {
+        return;
+    }
+
+    size_t first = changed.size();
+    alignas(inotify_event) char buf[4096];
+    while (true) {
+        ssize_t len = read(_fd, buf, sizeof(buf));
+        if (len <= 0) {
+            break;
+        }
+        for (ssize_t at = 0; at < len;) {
+            inotify_event *event = (inotify_event *)(buf + at);
+            at += sizeof(inotify_event) + event->len;
+            if (event->len == 0) {
+                continue;
+            }
+            for (size_t i = 0; i < _files.size(); i += 1) {
+                File &file = _files[i];
+                if (file.wd != event->wd or file.name != event->name) {
+                    continue;
+                }
+                auto begin = changed.begin() + first;
+                if (std::find(begin, changed.end(), (int)i) == changed.end()) {
+                    changed.push_back((int)i);
+                }
+            }
+        }
+    }
+}
+
+}  // namespace shaderLib
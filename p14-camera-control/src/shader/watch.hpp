@@ -0,0 +1,59 @@
+/* File name: watch.hpp
+ *
+ * Intro:
+ * C++ header of the shader libraries' watch (File watch) module.
+ * Shader files are watched with inotify. The directories holding them are
+ * watched rather than the files themselves, since many editors save by
+ * writing a new file and renaming it over the old one, which would end a
+ * watch on the file. The events are read without blocking, so the watch can
+ * be polled once per frame.
+ *
+ * Dependencies:
+ * 1. Linux inotify (sys/inotify.h) */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#ifndef SHADER__WATCH_HPP
+#define SHADER__WATCH_HPP
+
+#include <string>
+#include <vector>
+
+/* Shader library */
+namespace shaderLib {
+
+/* (File) watch. */
+class Watch {
+   private:
+    /* Watched file. */
+    struct File {
+        /* Watch descriptor of the file's directory. */
+        int wd;
+        /* File name within the directory. */
+        std::string name;
+    };
+
+    /* inotify file descriptor (-1 if inotify is not available). */
+    int _fd;
+    /* Files by id. */
+    std::vector<File> _files;
+
+   public:
+    /* Constructs a watch of no files. */
+    Watch();
+    /* Destructs the watch. */
+    ~Watch();
+    /* Finds whether inotify is available. */
+    bool ok();
+    /* Watches a file; returns its id, or -1 if it cannot be watched. */
+    int add(char const *path);
+    /* Finds the files written since the last poll, without blocking; appends
+     * their ids to changed, once each. */
+    void poll(std::vector<int> &changed);
+};
+
+}  // namespace shaderLib
+
+// SHADER__WATCH_HPP
+#endif
@@ -0,0 +1,136 @@
+/* File name: shaders.cpp
+ * 
+ * Intro:
+ * C++ implementation of the program defined in shaders.hpp. */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#include "shaders.hpp"
+
+int main(int argc, char **argv) {
+    if (argc >= 4 and strcmp(argv[1], "embed") == 0) {
+        return embed(argv[2], argc - 3, argv + 3);
+    }
+    if (argc >= 4 and strcmp(argv[1], "expand") == 0) {
+        return expand(argv[2], argv[3], argc - 4, argv + 4);
+    }
+    showUsage(argv[0]);
+    return 1;
+}
+
+static int embed(char const *outName, int fileCount, char **fileNames) {
+    FILE *out = fopen(outName, "w");
+    if (out == nullptr) {
+        fprintf(stderr, "shaders: error: writing file: %s\n", outName);
+        return 1;
+    }
+
+    fprintf(out, "// Generated by shaders.x from the shader files; ");
+    fprintf(out, "edit those instead.\n\n");
+    fprintf(out, "#include \"shader/embed.hpp\"\n\n");
+    fprintf(out, "namespace shaderLib {\n\n");
+    std::vector<size_t> lengths(fileCount);
+    std::vector<uint64_t> hashes(fileCount);
+    for (int i = 0; i < fileCount; i += 1) {
+        std::fstream file;
+        file.open(fileNames[i], std::ios::in | std::ios::binary);
+        if (!file.is_open()) {
+            fprintf(stderr, "shaders: error: reading file: %s\n", fileNames[i]);
+            fclose(out);
+            remove(outName);
+            return 1;
+        }
+        std::string text(std::istreambuf_iterator<char>(file),
+                         (std::istreambuf_iterator<char>()));
+        lengths[i] = text.size();
+        hashes[i] = shaderLib::embedHash(text.data(), text.size());
+
+        fprintf(out, "// %s\n", fileNames[i]);
+        fprintf(out, "static constexpr char text%d[] =", i);
+        writeLiteral(out, text);
+        fprintf(out, ";\n\n");
+    }
+
+    fprintf(out, "constexpr Embed embeds[] = {\n");
+    for (int i = 0; i < fileCount; i += 1) {
+        fprintf(out, "    {\"%s\", text%d, ", fileNames[i], i);
+        fprintf(out, "%zu, 0x%016llxull},\n", lengths[i],
+                (unsigned long long)hashes[i]);
+    }
+    fprintf(out, "};\n");
+    fprintf(out, "constexpr int embedCount = %d;\n\n", fileCount);
+    fprintf(out, "}  // namespace shaderLib\n");
+    fclose(out);
+    return 0;
+}
+
+// clang-format off
+static int expand(
+    char const *outName, char const *fileName, int defineCount,
+    char **defines
+) {
+    // clang-format on
+    shaderLib::Pre pre;
+    for (int i = 0; i < defineCount; i += 1) {
+        std::string define = defines[i];
+        size_t eq = define.find('=');
+        if (eq == std::string::npos) {
+            pre.define(define.c_str());
+        } else {
+            std::string value = define.substr(eq + 1);
+            pre.define(define.substr(0, eq).c_str(), value.c_str());
+        }
+    }
+
+    std::string text;
+    if (!pre.expand(fileName, text)) {
+        fprintf(stderr, "shaders: error: %s\n", pre.error().c_str());
+        return 1;
+    }
+    FILE *out = fopen(outName, "w");
+    if (out == nullptr) {
+        fprintf(stderr, "shaders: error: writing file: %s\n", outName);
+        return 1;
+    }
+    fwrite(text.data(), 1, text.size(), out);
+    fclose(out);
+    return 0;
+}
+
+static void writeLiteral(FILE *out, std::string const &text) {
+    if (text.empty()) {
+        fprintf(out, " \"\"");
+        return;
+    }
+
+    // One literal per line; octal escapes always take 3 digits, so the next
+    // character cannot extend them
+    bool lineStart = true;
+    for (char c : text) {
+        if (lineStart) {
+            fprintf(out, "\n    \"");
+            lineStart = false;
+        }
+        unsigned char u = (unsigned char)c;
+        if (c == '\n') {
+            fprintf(out, "\\n\"");
+            lineStart = true;
+        } else if (c == '\\' or c == '"') {
+            fprintf(out, "\\%c", c);
+        } else if (u < 0x20 or u >= 0x7f) {
+            fprintf(out, "\\%03o", u);
+        } else {
+            fputc(c, out);
+        }
+    }
+    if (!lineStart) {
+        fprintf(out, "\"");
+    }
+}
+
+static void showUsage(char const *exeName) {
+    fprintf(stderr, "usage: %s embed OUT FILE ...\n", exeName);
+    fprintf(stderr, "       %s expand OUT FILE [NAME=VALUE ...]\n", exeName);
+    fflush(stderr);
+}
@@ -0,0 +1,38 @@
+/* File name: shaders.hpp
+ * 
+ * Intro:
+ * C++ header of a build tool that embeds the shader files into the camera
+ * control program (see shader/embed.hpp), and expands them for an offline
+ * GLSL validator. It runs on the build machine and needs no GL libraries.
+ * 
+ * Usage:
+ * ./shaders.x embed OUT FILE ...
+ * Writes the files as the shaderLib::embeds table (C++) to OUT.
+ * ./shaders.x expand OUT FILE [NAME=VALUE ...]
+ * Writes FILE expanded by the shader preprocessor with the defines to OUT. */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+// Include C++ libraries
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+// Include C libraries
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+// Include custom libraries
+#include "shader/embed.hpp"
+#include "shader/pre.hpp"
+
+// Define functions
+/* Writes the embedded files' table; returns the exit status. */
+static int embed(char const *, int, char **);
+/* Writes an expanded file; returns the exit status. */
+static int expand(char const *, char const *, int, char **);
+/* Writes a text as C++ string literal lines. */
+static void writeLiteral(FILE *, std::string const &);
+/* Shows the command line usage in stderr. */
+static void showUsage(char const *);
@@ -0,0 +1,259 @@
+/* File name: soft.cpp
+ *
+ * Intro:
+ * C++ implementation of the software rendering custom library. */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#include "soft.hpp"
+
+#include <chrono>
+#include <cstdio>
+
+#include "occl/raster.hpp"
+
+using softLib::Tri;
+using softLib::Vert;
+
+/* Reads a monotonic clock (unit: milliseconds). */
+static double nowMs() {
+    auto t = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration<double, std::milli>(t).count();
+}
+
+Soft::Soft(int width, int height) {
+    _width = width;
+    _height = height;
+    _tilesX = (width + tileSize - 1) / tileSize;
+    _tilesY = (height + tileSize - 1) / tileSize;
+    _colors.resize(width * height);
+    _depths.resize(width * height);
+    _raster = softLib::rasterScalar;
+    simd(true);
+    clear(glm::vec4(0.0f, 0.0f, 0.0f, 0.0f));
+
+    _stats.draws = 0;
+    _stats.tris = 0;
+    _stats.binned = 0;
+    _stats.setupMs = 0.0;
+    _stats.rasterMs = 0.0;
+}
+
+int Soft::width() {
+    return _width;
+}
+
+int Soft::height() {
+    return _height;
+}
+
+bool Soft::simd() {
+    return _raster == softLib::rasterAvx2;
+}
+
+bool Soft::simd(bool newVal) {
+    bool oldVal = simd();
+    bool avx2 = newVal and occlLib::avx2Supported();
+    _raster = avx2 ? softLib::rasterAvx2 : softLib::rasterScalar;
+    return oldVal;
+}
+
+void Soft::clear(glm::vec4 color) {
+    // clang-format off
+    uint32_t packed = softLib::packColor(
+        color[0], color[1], color[2], color[3]
+    );
+    // clang-format on
+    std::fill(_colors.begin(), _colors.end(), packed);
+    std::fill(_depths.begin(), _depths.end(), 1.0f);
+}
+
+void Soft::draw(glm::mat4 const &mapping, glm::vec3 posScale,
+                glm::vec3 posOffset,
+                std::vector<meshLib::QuantVertex> const &vertices,
+                unsigned int const *indices, int count) {
+    Draw draw;
+    draw.mapping = mapping;
+    draw.posScale = posScale;
+    draw.posOffset = posOffset;
+    draw.vertices = &vertices;
+    draw.indices = indices;
+    draw.count = count;
+    _draws.push_back(draw);
+}
+
+void Soft::_binTri(Tri const &tri, Bin &bin) {
+    int index = (int)bin.tris.size();
+    bin.tris.push_back(tri);
+    for (int ty = tri.y0 / tileSize; ty <= (tri.y1 - 1) / tileSize; ty += 1) {
+        for (int tx = tri.x0 / tileSize; tx <= (tri.x1 - 1) / tileSize;
+             tx += 1) {
+            bin.tiles[ty * _tilesX + tx].push_back(index);
+        }
+    }
+}
+
+void Soft::_setup(int begin, int end, Bin &bin, std::vector<Vert> &verts) {
+    bin.tris.clear();
+    bin.tiles.resize(_tilesX * _tilesY);
+    for (std::vector<int> &tile : bin.tiles) {
+        tile.clear();
+    }
+
+    for (int d = begin; d < end; d += 1) {
+        Draw const &draw = _draws[d];
+
+        // shader.vs: dequantize, map, and pass the color through
+        std::vector<meshLib::QuantVertex> const &vertices = *draw.vertices;
+        verts.resize(vertices.size());
+        for (size_t i = 0; i < vertices.size(); i += 1) {
+            meshLib::QuantVertex const &vertex = vertices[i];
+            glm::vec3 q;
+            glm::vec4 color;
+            for (int j = 0; j < 3; j += 1) {
+                q[j] = (float)vertex.pos[j] / 65535.0f;
+            }
+            for (int j = 0; j < 4; j += 1) {
+                color[j] = (float)vertex.color[j] / 255.0f;
+            }
+            glm::vec3 position = q * draw.posScale + draw.posOffset;
+            verts[i].clip = draw.mapping * glm::vec4(position, 1.0f);
+            verts[i].color = color;
+        }
+
+        for (int i = 0; i + 2 < draw.count; i += 3) {
+            Vert tri[3];
+            for (int j = 0; j < 3; j += 1) {
+                tri[j] = verts[draw.indices[i + j]];
+            }
+
+            // Triangles crossing the near plane become up to 2 triangles
+            Vert poly[4];
+            int polyCount = softLib::clipNear(tri, poly);
+            for (int j = 1; j + 1 < polyCount; j += 1) {
+                Vert fan[3] = {poly[0], poly[j], poly[j + 1]};
+                Tri setUp;
+                if (softLib::setup(fan, _width, _height, setUp)) {
+                    _binTri(setUp, bin);
+                }
+            }
+        }
+    }
+}
+
+void Soft::flush(Jobs &jobs) {
+    double start = nowMs();
+
+    // Contiguous chunks of draws keep the draw order within each tile
+    int drawCount = (int)_draws.size();
+    int chunkCount = jobs.threadCount() * 4;
+    chunkCount = chunkCount < drawCount ? chunkCount : drawCount;
+    _bins.resize(chunkCount);
+    _verts.resize(jobs.threadCount());
+    // clang-format off
+    jobs.parallelFor(chunkCount, 1, [&](int begin, int end, int worker) {
+        for (int c = begin; c < end; c += 1) {
+            int first = (int)((long)drawCount * c / chunkCount);
+            int last = (int)((long)drawCount * (c + 1) / chunkCount);
+            _setup(first, last, _bins[c], _verts[worker]);
+        }
+    });
+    // clang-format on
+
+    double mid = nowMs();
+
+    // One tile per task; tiles own disjoint pixels
+    int tileCount = _tilesX * _tilesY;
+    // clang-format off
+    jobs.parallelFor(tileCount, 1, [&](int begin, int end, int worker) {
+        for (int t = begin; t < end; t += 1) {
+            int x0 = t % _tilesX * tileSize;
+            int y0 = t / _tilesX * tileSize;
+            int x1 = x0 + tileSize < _width ? x0 + tileSize : _width;
+            int y1 = y0 + tileSize < _height ? y0 + tileSize : _height;
+            for (int c = 0; c < chunkCount; c += 1) {
+                Bin &bin = _bins[c];
+                for (int index : bin.tiles[t]) {
+                    _raster(
+                        bin.tris[index], x0, y0, x1, y1, _colors.data(),
+                        _depths.data(), _width
+                    );
+                }
+            }
+        }
+    });
+    // clang-format on
+
+    _stats.draws = drawCount;
+    _stats.tris = 0;
+    _stats.binned = 0;
+    for (int c = 0; c < chunkCount; c += 1) {
+        _stats.tris += (long)_bins[c].tris.size();
+        for (std::vector<int> const &tile : _bins[c].tiles) {
+            _stats.binned += (long)tile.size();
+        }
+    }
+    _stats.setupMs = mid - start;
+    _stats.rasterMs = nowMs() - mid;
+    _draws.clear();
+}
+
+std::vector<uint32_t> &Soft::colors() {
+    return _colors;
+}
+
+SoftStats Soft::stats() {
+    return _stats;
+}
+
+SoftDiff softDiff(std::vector<uint32_t> const &a,
+                  std::vector<uint32_t> const &b, int tolerance) {
+    SoftDiff result;
+    result.maxDiff = 0;
+    result.badPixels = 0;
+    result.badFraction = 0.0f;
+
+    size_t count = a.size() < b.size() ? a.size() : b.size();
+    for (size_t i = 0; i < count; i += 1) {
+        int pixelDiff = 0;
+        for (int j = 0; j < 4; j += 1) {
+            int ca = (int)(a[i] >> (j * 8) & 0xFF);
+            int cb = (int)(b[i] >> (j * 8) & 0xFF);
+            int diff = ca > cb ? ca - cb : cb - ca;
+            pixelDiff = diff > pixelDiff ? diff : pixelDiff;
+        }
+        if (pixelDiff > result.maxDiff) {
+            result.maxDiff = pixelDiff;
+        }
+        result.badPixels += pixelDiff > tolerance ? 1 : 0;
+    }
+    if (count > 0) {
+        result.badFraction = (float)result.badPixels / (float)count;
+    }
+    return result;
+}
+
+bool softWritePpm(char const *name, int width, int height,
+                  std::vector<uint32_t> const &colors) {
+    FILE *file = fopen(name, "wb");
+    if (file == NULL) {
+        return false;
+    }
+
+    // PPM rows go from the top
+    fprintf(file, "P6\n%d %d\n255\n", width, height);
+    std::vector<unsigned char> row(width * 3);
+    for (int y = height - 1; y >= 0; y -= 1) {
+        for (int x = 0; x < width; x += 1) {
+            uint32_t color = colors[y * width + x];
+            for (int j = 0; j < 3; j += 1) {
+                row[x * 3 + j] = (unsigned char)(color >> (j * 8) & 0xFF);
+            }
+        }
+        fwrite(row.data(), 1, row.size(), file);
+    }
+    bool ok = ferror(file) == 0;
+    fclose(file);
+    return ok;
+}
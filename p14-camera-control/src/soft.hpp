@@ -0,0 +1,144 @@
+/* File name: soft.hpp
+ *
+ * Intro:
+ * C++ header of the software rendering custom library.
+ * A CPU rendering backend for headless nodes and CI. It consumes the same
+ * quantized vertices and level of detail indices as the GL path, with the
+ * mapping matrices found by the pipelines, and follows shader.vs and
+ * shader.fs: the positions are dequantized and mapped, and the quantized
+ * colors (found from the clamped positions at import) are interpolated.
+ * Draws are queued and rendered on flush in two parallel phases: the vertex
+ * stage sets up the triangles of chunks of draws and bins them into 64x64
+ * pixel tiles, then each tile is rasterized by one worker, in draw order.
+ * 
+ * Dependencies:
+ * 1. GLM library (libglm-dev)
+ * 2. The soft libraries' raster module (soft/raster.hpp)
+ * 3. The mesh libraries' quant module (mesh/quant.hpp)
+ * 4. The job system custom library (jobs.hpp) */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#ifndef SOFT_HPP
+#define SOFT_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/ext.hpp>
+
+#include "jobs.hpp"
+#include "mesh/quant.hpp"
+#include "soft/raster.hpp"
+
+/* Software rendering statistics (of the last flush). */
+struct SoftStats {
+    /* Flushed draws. */
+    int draws;
+    /* Set up triangles. */
+    long tris;
+    /* Binned triangle-tile pairs. */
+    long binned;
+    /* Vertex stage and binning time (unit: milliseconds). */
+    double setupMs;
+    /* Rasterization time (unit: milliseconds). */
+    double rasterMs;
+};
+
+/* Framebuffer difference. */
+struct SoftDiff {
+    /* Largest channel difference (0 to 255). */
+    int maxDiff;
+    /* Pixels with a channel difference above the tolerance. */
+    long badPixels;
+    /* Fraction of the pixels with a difference above the tolerance. */
+    float badFraction;
+};
+
+/* Soft (Software renderer). */
+class Soft {
+   private:
+    /* Queued draw. */
+    struct Draw {
+        glm::mat4 mapping;
+        glm::vec3 posScale;
+        glm::vec3 posOffset;
+        std::vector<meshLib::QuantVertex> const *vertices;
+        unsigned int const *indices;
+        int count;
+    };
+
+    /* Set up triangles of a chunk of draws, binned into tiles. */
+    struct Bin {
+        std::vector<softLib::Tri> tris;
+        /* Triangle indices of each tile, in draw order. */
+        std::vector<std::vector<int>> tiles;
+    };
+
+    int _width;
+    int _height;
+    int _tilesX;
+    int _tilesY;
+    /* Framebuffer (RGBA8, rows from the bottom, like glReadPixels). */
+    std::vector<uint32_t> _colors;
+    std::vector<float> _depths;
+    std::vector<Draw> _draws;
+    std::vector<Bin> _bins;
+    /* Vertex stage results of each worker. */
+    std::vector<std::vector<softLib::Vert>> _verts;
+    /* Rasterization kernel. */
+    softLib::RasterFunc _raster;
+    SoftStats _stats;
+
+    /* Runs the vertex stage and bins the triangles of the draws [begin,
+     * end) into a bin. */
+    void _setup(int begin, int end, Bin &bin, std::vector<softLib::Vert> &);
+    /* Bins a set up triangle. */
+    void _binTri(softLib::Tri const &tri, Bin &bin);
+
+   public:
+    /* Tile width and height (unit: pixels). */
+    static int const tileSize = 64;
+
+    /* Initializes a framebuffer of the specified size (unit: pixels). Uses
+     * the AVX2 kernel where supported. */
+    Soft(int width, int height);
+    /* Reads the width (unit: pixels). */
+    int width();
+    /* Reads the height (unit: pixels). */
+    int height();
+    /* Reads whether the AVX2 kernel is used. */
+    bool simd();
+    /* Reads and updates whether the AVX2 kernel is used (only takes effect
+     * where AVX2 is supported). */
+    bool simd(bool newVal);
+    /* Clears the colors to color and the depths to 1. */
+    void clear(glm::vec4 color);
+    /* Queues a draw of count indices (a multiple of 3) into vertices.
+     * mapping: object space to clip space; posScale and posOffset: the
+     * dequantization of the vertices (see meshLib::Quant). The vertices and
+     * indices must stay alive until the flush. */
+    void draw(glm::mat4 const &mapping, glm::vec3 posScale, glm::vec3 posOffset,
+              std::vector<meshLib::QuantVertex> const &vertices,
+              unsigned int const *indices, int count);
+    /* Renders the queued draws. */
+    void flush(Jobs &jobs);
+    /* Reads the colors' reference. */
+    std::vector<uint32_t> &colors();
+    /* Reads the statistics. */
+    SoftStats stats();
+};
+
+/* Compares two RGBA8 framebuffers of the same size; channel differences up to
+ * tolerance count as equal. */
+SoftDiff softDiff(std::vector<uint32_t> const &a,
+                  std::vector<uint32_t> const &b, int tolerance);
+/* Writes an RGBA8 framebuffer (rows from the bottom) to a binary PPM file;
+ * returns false on failure. */
+bool softWritePpm(char const *name, int width, int height,
+                  std::vector<uint32_t> const &colors);
+
+// SOFT_HPP
+#endif
@@ -0,0 +1,122 @@
+/* File name: avx2.cpp
+ *
+ * Intro:
+ * C++ implementation of the soft (Software rendering) libraries' raster
+ * (Triangle rasterization) module's AVX2 kernel.
+ * Only this file is compiled with AVX2 enabled (see the Makefile), and it is
+ * only called where occlLib::avx2Supported finds AVX2 at runtime. */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#include "raster.hpp"
+
+#if defined(__AVX2__) and defined(__FMA__)
+#include <immintrin.h>
+#endif
+
+namespace softLib {
+
+#if defined(__AVX2__) and defined(__FMA__)
+
+/* Evaluates a plane at 8 pixel centers (same operation order as the scalar
+ * kernel). */
+static inline __m256 evalPlane(float const *p, __m256 px, float py) {
+    __m256 xTerm = _mm256_mul_ps(_mm256_set1_ps(p[0]), px);
+    __m256 yTerm = _mm256_set1_ps(p[1] * py);
+    return _mm256_add_ps(_mm256_add_ps(xTerm, yTerm), _mm256_set1_ps(p[2]));
+}
+
+/* Packs a channel to its byte of RGBA8 (same rounding as packColor). */
+static inline __m256i packChannel(__m256 v, int shift) {
+    __m256 scaled = _mm256_mul_ps(v, _mm256_set1_ps(255.0f));
+    scaled = _mm256_add_ps(scaled, _mm256_set1_ps(0.5f));
+    scaled = _mm256_max_ps(scaled, _mm256_setzero_ps());
+    scaled = _mm256_min_ps(scaled, _mm256_set1_ps(255.0f));
+    __m256i bytes = _mm256_cvttps_epi32(scaled);
+    return _mm256_slli_epi32(bytes, shift);
+}
+
+void rasterAvx2(Tri const &tri, int x0, int y0, int x1, int y1,
+                uint32_t *colors, float *depths, int width) {
+    x0 = x0 > tri.x0 ? x0 : tri.x0;
+    y0 = y0 > tri.y0 ? y0 : tri.y0;
+    x1 = x1 < tri.x1 ? x1 : tri.x1;
+    y1 = y1 < tri.y1 ? y1 : tri.y1;
+
+    __m256 zero = _mm256_setzero_ps();
+    __m256 one = _mm256_set1_ps(1.0f);
+    __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    __m256 offsets = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f,
+                                    7.5f);
+    __m256 topLeft[3];
+    for (int i = 0; i < 3; i += 1) {
+        topLeft[i] = _mm256_castsi256_ps(_mm256_set1_epi32(-tri.topLeft[i]));
+    }
+
+    for (int y = y0; y < y1; y += 1) {
+        float py = (float)y + 0.5f;
+        for (int x = x0; x < x1; x += 8) {
+            __m256 px = _mm256_add_ps(_mm256_set1_ps((float)x), offsets);
+            // Pixels past x1 are masked off
+            __m256i limit = _mm256_set1_epi32(x1 - x);
+            __m256 mask = _mm256_castsi256_ps(_mm256_cmpgt_epi32(limit, lanes));
+
+            for (int i = 0; i < 3; i += 1) {
+                __m256 xTerm = _mm256_mul_ps(_mm256_set1_ps(tri.a[i]), px);
+                __m256 yTerm = _mm256_set1_ps(tri.b[i] * py);
+                __m256 e = _mm256_add_ps(_mm256_add_ps(xTerm, yTerm),
+                                         _mm256_set1_ps(tri.c[i]));
+                __m256 gt = _mm256_cmp_ps(e, zero, _CMP_GT_OQ);
+                __m256 eq = _mm256_cmp_ps(e, zero, _CMP_EQ_OQ);
+                __m256 in = _mm256_or_ps(gt, _mm256_and_ps(eq, topLeft[i]));
+                mask = _mm256_and_ps(mask, in);
+            }
+            if (_mm256_movemask_ps(mask) == 0) {
+                continue;
+            }
+
+            // Depth clipping and the less depth test
+            int index = y * width + x;
+            __m256i maskInt = _mm256_castps_si256(mask);
+            __m256 z = evalPlane(tri.planes[0], px, py);
+            __m256 stored = _mm256_maskload_ps(depths + index, maskInt);
+            mask = _mm256_and_ps(mask, _mm256_cmp_ps(z, zero, _CMP_GE_OQ));
+            mask = _mm256_and_ps(mask, _mm256_cmp_ps(z, one, _CMP_LE_OQ));
+            mask = _mm256_and_ps(mask, _mm256_cmp_ps(z, stored, _CMP_LT_OQ));
+            if (_mm256_movemask_ps(mask) == 0) {
+                continue;
+            }
+            maskInt = _mm256_castps_si256(mask);
+
+            // Perspective correct colors
+            __m256 invW = evalPlane(tri.planes[1], px, py);
+            __m256 w = _mm256_div_ps(one, invW);
+            __m256i packed = _mm256_setzero_si256();
+            for (int j = 0; j < 4; j += 1) {
+                __m256 cw = evalPlane(tri.planes[2 + j], px, py);
+                __m256 c = _mm256_mul_ps(cw, w);
+                packed = _mm256_or_si256(packed, packChannel(c, j * 8));
+            }
+
+            _mm256_maskstore_ps(depths + index, maskInt, z);
+            // clang-format off
+            _mm256_maskstore_epi32(
+                (int *)(colors + index), maskInt, packed
+            );
+            // clang-format on
+        }
+    }
+}
+
+#else
+
+// Built without AVX2: fall back to the scalar kernel
+void rasterAvx2(Tri const &tri, int x0, int y0, int x1, int y1,
+                uint32_t *colors, float *depths, int width) {
+    rasterScalar(tri, x0, y0, x1, y1, colors, depths, width);
+}
+
+#endif
+
+}  // namespace softLib
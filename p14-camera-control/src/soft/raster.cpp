@@ -0,0 +1,164 @@
+/* File name: raster.cpp
+ *
+ * Intro:
+ * C++ implementation of the soft (Software rendering) libraries' raster
+ * (Triangle rasterization) module (setup, clipping, and scalar kernel). */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#include "raster.hpp"
+
+#include <cmath>
+
+namespace softLib {
+
+bool setup(Vert const *verts, int width, int height, Tri &tri) {
+    // Screen space positions (GL viewport: origin at the bottom left) and
+    // attributes
+    float xs[3];
+    float ys[3];
+    float attrs[3][attrCount];
+    for (int i = 0; i < 3; i += 1) {
+        glm::vec4 const &clip = verts[i].clip;
+        float invW = 1.0f / clip.w;
+        xs[i] = (clip.x * invW * 0.5f + 0.5f) * (float)width;
+        ys[i] = (clip.y * invW * 0.5f + 0.5f) * (float)height;
+        attrs[i][0] = clip.z * invW * 0.5f + 0.5f;
+        attrs[i][1] = invW;
+        for (int j = 0; j < 4; j += 1) {
+            attrs[i][2 + j] = verts[i].color[j] * invW;
+        }
+    }
+
+    // Counterclockwise order, so the edge functions are positive inside
+    float area = (xs[1] - xs[0]) * (ys[2] - ys[0]);
+    area -= (xs[2] - xs[0]) * (ys[1] - ys[0]);
+    if (area == 0.0f) {
+        return false;
+    }
+    int order[3] = {0, 1, 2};
+    if (area < 0.0f) {
+        order[1] = 2;
+        order[2] = 1;
+        area = -area;
+    }
+    float x[3];
+    float y[3];
+    float v[3][attrCount];
+    for (int i = 0; i < 3; i += 1) {
+        x[i] = xs[order[i]];
+        y[i] = ys[order[i]];
+        for (int j = 0; j < attrCount; j += 1) {
+            v[i][j] = attrs[order[i]][j];
+        }
+    }
+
+    for (int i = 0; i < 3; i += 1) {
+        int k = (i + 1) % 3;
+        float dx = x[k] - x[i];
+        float dy = y[k] - y[i];
+        tri.a[i] = -dy;
+        tri.b[i] = dx;
+        tri.c[i] = x[i] * y[k] - y[i] * x[k];
+        // Counterclockwise with Y up: left edges go down, top edges go left
+        tri.topLeft[i] = dy < 0.0f or (dy == 0.0f and dx < 0.0f);
+    }
+
+    float dx1 = x[1] - x[0];
+    float dy1 = y[1] - y[0];
+    float dx2 = x[2] - x[0];
+    float dy2 = y[2] - y[0];
+    for (int j = 0; j < attrCount; j += 1) {
+        float dv1 = v[1][j] - v[0][j];
+        float dv2 = v[2][j] - v[0][j];
+        float pa = (dv1 * dy2 - dv2 * dy1) / area;
+        float pb = (dv2 * dx1 - dv1 * dx2) / area;
+        tri.planes[j][0] = pa;
+        tri.planes[j][1] = pb;
+        tri.planes[j][2] = v[0][j] - pa * x[0] - pb * y[0];
+    }
+
+    // Pixels whose centers may be covered
+    float xLo = std::fmin(x[0], std::fmin(x[1], x[2]));
+    float xHi = std::fmax(x[0], std::fmax(x[1], x[2]));
+    float yLo = std::fmin(y[0], std::fmin(y[1], y[2]));
+    float yHi = std::fmax(y[0], std::fmax(y[1], y[2]));
+    tri.x0 = (int)std::fmax(std::floor(xLo - 0.5f), 0.0f);
+    tri.x1 = (int)std::fmin(std::ceil(xHi + 0.5f), (float)width);
+    tri.y0 = (int)std::fmax(std::floor(yLo - 0.5f), 0.0f);
+    tri.y1 = (int)std::fmin(std::ceil(yHi + 0.5f), (float)height);
+    return tri.x0 < tri.x1 and tri.y0 < tri.y1;
+}
+
+int clipNear(Vert const *verts, Vert *out) {
+    // GL's near plane: z >= -w
+    float dists[3];
+    for (int i = 0; i < 3; i += 1) {
+        dists[i] = verts[i].clip.z + verts[i].clip.w;
+    }
+
+    int count = 0;
+    for (int i = 0; i < 3; i += 1) {
+        int k = (i + 1) % 3;
+        if (dists[i] >= 0.0f) {
+            out[count] = verts[i];
+            count += 1;
+        }
+        if ((dists[i] >= 0.0f) != (dists[k] >= 0.0f)) {
+            float t = dists[i] / (dists[i] - dists[k]);
+            Vert &vert = out[count];
+            vert.clip = glm::mix(verts[i].clip, verts[k].clip, t);
+            vert.color = glm::mix(verts[i].color, verts[k].color, t);
+            count += 1;
+        }
+    }
+    return count;
+}
+
+void rasterScalar(Tri const &tri, int x0, int y0, int x1, int y1,
+                  uint32_t *colors, float *depths, int width) {
+    x0 = x0 > tri.x0 ? x0 : tri.x0;
+    y0 = y0 > tri.y0 ? y0 : tri.y0;
+    x1 = x1 < tri.x1 ? x1 : tri.x1;
+    y1 = y1 < tri.y1 ? y1 : tri.y1;
+
+    for (int y = y0; y < y1; y += 1) {
+        float py = (float)y + 0.5f;
+        for (int x = x0; x < x1; x += 1) {
+            float px = (float)x + 0.5f;
+            bool inside = true;
+            for (int i = 0; i < 3; i += 1) {
+                float e = tri.a[i] * px + tri.b[i] * py + tri.c[i];
+                bool edge = e == 0.0f and tri.topLeft[i];
+                inside = inside and (e > 0.0f or edge);
+            }
+            if (!inside) {
+                continue;
+            }
+
+            float attrs[attrCount];
+            for (int j = 0; j < attrCount; j += 1) {
+                float const *p = tri.planes[j];
+                attrs[j] = p[0] * px + p[1] * py + p[2];
+            }
+            // Depth clipping (near and far) and the less depth test
+            float z = attrs[0];
+            int index = y * width + x;
+            if (z < 0.0f or z > 1.0f or !(z < depths[index])) {
+                continue;
+            }
+
+            // shader.fs: the interpolated color
+            float w = 1.0f / attrs[1];
+            depths[index] = z;
+            // clang-format off
+            colors[index] = packColor(
+                attrs[2] * w, attrs[3] * w, attrs[4] * w, attrs[5] * w
+            );
+            // clang-format on
+        }
+    }
+}
+
+}  // namespace softLib
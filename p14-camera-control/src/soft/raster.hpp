@@ -0,0 +1,95 @@
+/* File name: raster.hpp
+ *
+ * Intro:
+ * C++ header of the soft (Software rendering) libraries' raster (Triangle
+ * rasterization) module.
+ * A triangle is set up in screen space as three edge functions and six
+ * attribute planes (depth, 1/w, and the color channels over w), so every
+ * attribute is found per pixel with one multiply-add per axis and the colors
+ * stay perspective correct. Pixels are covered following the top-left rule,
+ * like GL. The kernels rasterize a triangle into one tile of the framebuffer;
+ * the scalar kernel evaluates one pixel at a time and the AVX2 kernel 8.
+ *
+ * Dependencies:
+ * 1. GLM library (libglm-dev) */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#ifndef SOFT__RASTER_HPP
+#define SOFT__RASTER_HPP
+
+#include <cstdint>
+
+#include <glm/glm.hpp>
+#include <glm/ext.hpp>
+
+/* Software rendering library */
+namespace softLib {
+
+/* Attribute planes: depth, 1/w, and red, green, blue, alpha over w. */
+int const attrCount = 6;
+
+/* Vertex after the vertex stage. */
+struct Vert {
+    /* Clip space position (shader.vs gl_Position). */
+    glm::vec4 clip;
+    /* Color (shader.vs color). */
+    glm::vec4 color;
+};
+
+/* Screen space triangle, set up for rasterization. */
+struct Tri {
+    /* Edge functions a * x + b * y + c; positive inside. */
+    float a[3];
+    float b[3];
+    float c[3];
+    /* Whether a pixel center on the edge is covered (top-left rule). */
+    bool topLeft[3];
+    /* Attribute planes p[0] * x + p[1] * y + p[2]. */
+    float planes[attrCount][3];
+    /* Pixel bounding box [x0, x1) x [y0, y1). */
+    int x0;
+    int y0;
+    int x1;
+    int y1;
+};
+
+/* Rasterization kernel; rasterizes a triangle into the pixels [x0, x1) x
+ * [y0, y1) of a framebuffer width pixels wide, with a less depth test. */
+typedef void (*RasterFunc)(Tri const &tri, int x0, int y0, int x1, int y1,
+                           uint32_t *colors, float *depths, int width);
+
+/* Sets up a triangle of a framebuffer of the specified size (unit: pixels);
+ * returns false if it has no area or no pixels. The vertices must be in front
+ * of the near plane (see clipNear). */
+bool setup(Vert const *verts, int width, int height, Tri &tri);
+/* Clips a triangle against the near plane; writes up to 4 vertices of a
+ * convex polygon to out and returns their count. */
+int clipNear(Vert const *verts, Vert *out);
+/* Packs a color to RGBA8 (red in the lowest byte, like GL_RGBA and
+ * GL_UNSIGNED_BYTE on little endian CPUs). */
+inline uint32_t packColor(float r, float g, float b, float a) {
+    float channels[4] = {r, g, b, a};
+    uint32_t result = 0;
+    for (int i = 0; i < 4; i += 1) {
+        float v = channels[i] * 255.0f + 0.5f;
+        v = v > 0.0f ? v : 0.0f;
+        v = v < 255.0f ? v : 255.0f;
+        result |= (uint32_t)v << (i * 8);
+    }
+    return result;
+}
+
+/* Rasterizes a triangle (scalar kernel). */
+void rasterScalar(Tri const &tri, int x0, int y0, int x1, int y1,
+                  uint32_t *colors, float *depths, int width);
+/* Rasterizes a triangle (AVX2 kernel; only call it where
+ * occlLib::avx2Supported). */
+void rasterAvx2(Tri const &tri, int x0, int y0, int x1, int y1,
+                uint32_t *colors, float *depths, int width);
+
+}  // namespace softLib
+
+// SOFT__RASTER_HPP
+#endif
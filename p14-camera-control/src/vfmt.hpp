@@ -0,0 +1,261 @@
+/* File name: vfmt.hpp
+ *
+ * Intro:
+ * C++ header of the vertex format custom library.
+ * A vertex format describes an interleaved vertex struct with attribute
+ * traits. The strides, offsets, GL types, and the vertex array setup are all
+ * found at compile time. The compiler checks that each attribute's type is
+ * known, its component count fits the type, its mode fits the type (no
+ * normalized or integer floats), its size matches its member, and its
+ * offset is a multiple of 4 bytes; and that the attributes
+ * are in memory order without overlapping, their locations are distinct,
+ * and their sizes add up to the vertex size (no padding or unread members).
+ * It does not check the locations against the shaders.
+ *
+ * Usage:
+ * struct V { uint16_t pos[4]; uint8_t color[4]; };
+ * using VFormat = VFmt<
+ *     V,
+ *     VFMT_ATTR(V, pos, 0, GL_UNSIGNED_SHORT, 4, VFMT_NORM),
+ *     VFMT_ATTR(V, color, 2, GL_UNSIGNED_BYTE, 4, VFMT_NORM)
+ * >;
+ * GLuint vao = VFormat::vao(vertexBuffer, indexBuffer);
+ *
+ * Dependencies:
+ * 1. GLEW library (libglew-dev)
+ */
+
+/* Copyright 2022 Yucheng Liu. GNU GPL3 license.
+ * GNU GPL3 license copy: https://www.gnu.org/licenses/gpl-3.0.txt */
+
+#ifndef VFMT_HPP
+#define VFMT_HPP
+
+#include <cstddef>
+
+#include <GL/glew.h>
+
+/* Attribute modes: how the shader sees the stored components. */
+// Float components, read as they are (glVertexAttribPointer)
+#define VFMT_FLOAT 0
+// Integer components, normalized to [0, 1] or [-1, 1] (glVertexAttribPointer)
+#define VFMT_NORM 1
+// Integer components, read as integers (glVertexAttribIPointer)
+#define VFMT_INT 2
+
+/* Describes the attribute that reads the member of the vertex struct V.
+ * Finds the member's offset and size so that the trait can check them. */
+#define VFMT_ATTR(V, member, loc, type, count, mode) \
+    VAttr<loc, type, count, mode, offsetof(V, member), sizeof(V::member)>
+
+/* Vertex format library */
+namespace vfmtLib {
+
+/* Finds whether the GL type packs all components into one 32-bit word. */
+constexpr bool packed(GLenum type) {
+    return type == GL_INT_2_10_10_10_REV or
+           type == GL_UNSIGNED_INT_2_10_10_10_REV or
+           type == GL_UNSIGNED_INT_10F_11F_11F_REV;
+}
+
+/* Finds the size of one component of the GL type (unit: bytes).
+ * Returns 0 for unknown types. */
+constexpr size_t typeSize(GLenum type) {
+    switch (type) {
+        case GL_BYTE:
+        case GL_UNSIGNED_BYTE:
+            return 1;
+        case GL_SHORT:
+        case GL_UNSIGNED_SHORT:
+        case GL_HALF_FLOAT:
+            return 2;
+        case GL_INT:
+        case GL_UNSIGNED_INT:
+        case GL_FLOAT:
+        case GL_FIXED:
+            return 4;
+        case GL_DOUBLE:
+            return 8;
+        default:
+            return packed(type) ? 4 : 0;
+    }
+}
+
+/* Finds the size of an attribute (unit: bytes). */
+constexpr size_t attrSize(GLenum type, GLint count) {
+    return packed(type) ? 4 : typeSize(type) * count;
+}
+
+/* Finds whether the GL type is a floating point type. */
+constexpr bool floatType(GLenum type) {
+    return type == GL_FLOAT or type == GL_HALF_FLOAT or type == GL_DOUBLE or
+           type == GL_FIXED or type == GL_UNSIGNED_INT_10F_11F_11F_REV;
+}
+
+/* Finds whether each attribute's byte range ends at or before the next
+ * one's offset (so the ranges are in memory order and do not overlap); the
+ * ranges are not checked against the vertex size here. */
+template <size_t N>
+constexpr bool ordered(size_t const (&offsets)[N], size_t const (&sizes)[N]) {
+    for (size_t i = 0; i < N; i += 1) {
+        if (i + 1 < N and offsets[i] + sizes[i] > offsets[i + 1]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Finds whether the attribute locations are distinct. */
+template <size_t N>
+constexpr bool distinct(GLuint const (&locs)[N]) {
+    for (size_t i = 0; i < N; i += 1) {
+        for (size_t j = i + 1; j < N; j += 1) {
+            if (locs[i] == locs[j]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+}  // namespace vfmtLib
+
+/* Vertex attribute trait. */
+// clang-format off
+template <
+    GLuint Loc, GLenum Type, GLint Count, int Mode, size_t Offset, size_t Size
+>
+// clang-format on
+struct VAttr {
+    /* Shader location (layout (location = N)). */
+    static constexpr GLuint loc = Loc;
+    /* GL component type. */
+    static constexpr GLenum type = Type;
+    /* Component count. */
+    static constexpr GLint count = Count;
+    /* Mode (VFMT_FLOAT, VFMT_NORM, or VFMT_INT). */
+    static constexpr int mode = Mode;
+    /* Offset in the vertex (unit: bytes). */
+    static constexpr size_t offset = Offset;
+    /* Size (unit: bytes). */
+    static constexpr size_t size = vfmtLib::attrSize(Type, Count);
+
+    static_assert(vfmtLib::typeSize(Type) != 0, "unknown GL attribute type");
+    static_assert(Count >= 1 and Count <= 4, "attribute count not in [1, 4]");
+    // clang-format off
+    static_assert(
+        !vfmtLib::packed(Type) or Count == 4 or
+        (Type == GL_UNSIGNED_INT_10F_11F_11F_REV and Count == 3),
+        "packed attribute type with a wrong component count"
+    );
+    static_assert(
+        size == Size, "attribute size differs from the member's size"
+    );
+    static_assert(
+        Offset % 4 == 0, "attribute not aligned to 4 bytes"
+    );
+    static_assert(
+        Mode != VFMT_INT or !vfmtLib::floatType(Type),
+        "integer attribute with a floating point type"
+    );
+    static_assert(
+        Mode != VFMT_NORM or !vfmtLib::floatType(Type),
+        "normalized attribute with a floating point type"
+    );
+    // clang-format on
+
+    /* Points the attribute at the currently bound vertex buffer. */
+    static void pointer(GLsizei stride) {
+        void *ptr = (void *)offset;
+        if (Mode == VFMT_INT) {
+            glVertexAttribIPointer(Loc, Count, Type, stride, ptr);
+        } else {
+            GLboolean norm = Mode == VFMT_NORM ? GL_TRUE : GL_FALSE;
+            glVertexAttribPointer(Loc, Count, Type, norm, stride, ptr);
+        }
+    }
+};
+
+/* Vertex format of the vertex struct V with the attributes Attrs. */
+template <class V, class... Attrs>
+struct VFmt {
+    /* Vertex stride (unit: bytes). */
+    static constexpr GLsizei stride = sizeof(V);
+    /* Attribute count. */
+    static constexpr int attrCount = sizeof...(Attrs);
+    /* Attribute locations, in declaration order. */
+    static constexpr GLuint locs[] = {Attrs::loc...};
+    /* Attribute offsets (unit: bytes), in declaration order. */
+    static constexpr size_t offsets[] = {Attrs::offset...};
+    /* Attribute sizes (unit: bytes), in declaration order. */
+    static constexpr size_t sizes[] = {Attrs::size...};
+    /* Total attribute size (unit: bytes). */
+    static constexpr size_t attrBytes = (Attrs::size + ... + 0);
+
+    static_assert(attrCount > 0, "vertex format without attributes");
+    // clang-format off
+    static_assert(
+        vfmtLib::ordered(offsets, sizes),
+        "attributes overlap or are not declared in memory order"
+    );
+    static_assert(
+        vfmtLib::distinct(locs), "attribute locations repeat"
+    );
+    static_assert(
+        attrBytes == sizeof(V),
+        "vertex has padding or members that no attribute reads"
+    );
+    // clang-format on
+
+    /* Enables and points all attributes at the currently bound vertex
+     * buffer. */
+    static void setup() {
+        (glEnableVertexAttribArray(Attrs::loc), ...);
+        (Attrs::pointer(stride), ...);
+    }
+
+    /* Finds whether the format feeds the shader location. */
+    static constexpr bool feeds(GLuint loc) {
+        for (GLuint l : locs) {
+            if (l == loc) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /* Creates a vertex array that reads the vertex and index buffers. */
+    static GLuint vao(GLuint vertexBuffer, GLuint indexBuffer) {
+        GLuint result = 0;
+        glGenVertexArrays(1, &result);
+        glBindVertexArray(result);
+        glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+        setup();
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+        glBindVertexArray(0);
+        return result;
+    }
+
+    /* Finds the first active shader attribute location that the format does
+     * not feed.
+     * Returns -1 if the format feeds all active attributes. */
+    static GLint unfedLoc(GLuint program) {
+        GLint count = 0;
+        glGetProgramiv(program, GL_ACTIVE_ATTRIBUTES, &count);
+        for (GLint i = 0; i < count; i += 1) {
+            GLchar name[256] = {0};
+            GLint size = 0;
+            GLenum type = 0;
+            glGetActiveAttrib(program, i, 255, NULL, &size, &type, name);
+            GLint loc = glGetAttribLocation(program, name);
+            // Built-in inputs (gl_VertexID etc.) have no location
+            if (loc >= 0 and !feeds((GLuint)loc)) {
+                return loc;
+            }
+        }
+        return -1;
+    }
+};
+
+// VFMT_HPP
+#endif